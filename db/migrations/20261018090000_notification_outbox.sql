@@ -0,0 +1,35 @@
+-- migrate:up
+-- Общая очередь уведомлений для нескольких экземпляров: событие
+-- вставляется один раз по dedup_key, доставку забирает любой узел
+CREATE TABLE notification_outbox (
+    id BIGSERIAL PRIMARY KEY,
+    dedup_key TEXT NOT NULL UNIQUE,
+    channel TEXT NOT NULL,
+    chat_id BIGINT NOT NULL DEFAULT 0,
+    device_id TEXT NOT NULL,
+    metric_type TEXT NOT NULL,
+    direction TEXT NOT NULL,
+    value DOUBLE PRECISION NOT NULL,
+    resolved BOOLEAN NOT NULL DEFAULT FALSE,
+    suppressed_before INTEGER NOT NULL DEFAULT 0,
+    event_us BIGINT NOT NULL,
+    status TEXT NOT NULL DEFAULT 'pending',
+    attempts INTEGER NOT NULL DEFAULT 0,
+    available_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    locked_by TEXT,
+    locked_until TIMESTAMP,
+    last_error TEXT,
+    created_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    delivered_at TIMESTAMP,
+    CONSTRAINT valid_channel CHECK (channel IN ('telegram', 'email')),
+    CONSTRAINT valid_status CHECK (status IN ('pending', 'delivered', 'failed'))
+);
+
+-- Выборка узлами-отправителями идет только по ожидающим
+CREATE INDEX idx_notification_outbox_pending
+    ON notification_outbox(available_at) WHERE status = 'pending';
+CREATE INDEX idx_notification_outbox_created
+    ON notification_outbox(created_at);
+
+-- migrate:down
+DROP TABLE IF EXISTS notification_outbox;
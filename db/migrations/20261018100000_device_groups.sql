@@ -0,0 +1,38 @@
+-- migrate:up
+-- Группы устройств пользователя (комнаты, здания) и правила по
+-- агрегатам группы
+CREATE TABLE device_groups (
+    id SERIAL PRIMARY KEY,
+    chat_id BIGINT NOT NULL,
+    name TEXT NOT NULL,
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    UNIQUE(chat_id, name)
+);
+
+CREATE TABLE device_group_members (
+    group_id INTEGER NOT NULL REFERENCES device_groups(id) ON DELETE CASCADE,
+    device_id TEXT NOT NULL,
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (group_id, device_id)
+);
+
+CREATE INDEX idx_device_group_members_device
+    ON device_group_members(device_id);
+
+CREATE TABLE device_group_alerts (
+    group_id INTEGER NOT NULL REFERENCES device_groups(id) ON DELETE CASCADE,
+    metric_type TEXT NOT NULL,
+    aggregate TEXT NOT NULL,
+    direction TEXT NOT NULL,
+    threshold REAL NOT NULL,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (group_id, metric_type, aggregate, direction),
+    CONSTRAINT valid_metric CHECK (metric_type IN ('temperature', 'humidity')),
+    CONSTRAINT valid_aggregate CHECK (aggregate IN ('mean', 'min', 'max')),
+    CONSTRAINT valid_direction CHECK (direction IN ('above', 'below'))
+);
+
+-- migrate:down
+DROP TABLE IF EXISTS device_group_alerts;
+DROP TABLE IF EXISTS device_group_members;
+DROP TABLE IF EXISTS device_groups;
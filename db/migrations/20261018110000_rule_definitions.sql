@@ -0,0 +1,13 @@
+-- migrate:up
+-- Правила на языке выражений: RuleEngine перечитывает таблицу без
+-- перезапуска (см. RuleProgram)
+CREATE TABLE rule_definitions (
+    name TEXT PRIMARY KEY,
+    expression TEXT NOT NULL,
+    priority INTEGER NOT NULL DEFAULT 0,
+    enabled BOOLEAN NOT NULL DEFAULT true,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- migrate:down
+DROP TABLE IF EXISTS rule_definitions;
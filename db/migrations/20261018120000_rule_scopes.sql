@@ -0,0 +1,14 @@
+-- migrate:up
+-- Область действия правила: одно устройство или группа; без области
+-- правило проверяется для всех устройств
+ALTER TABLE rule_definitions
+    ADD COLUMN device_id TEXT,
+    ADD COLUMN group_id INTEGER REFERENCES device_groups(id) ON DELETE CASCADE,
+    ADD CONSTRAINT rule_definitions_single_scope
+        CHECK (device_id IS NULL OR group_id IS NULL);
+
+-- migrate:down
+ALTER TABLE rule_definitions
+    DROP CONSTRAINT IF EXISTS rule_definitions_single_scope,
+    DROP COLUMN IF EXISTS group_id,
+    DROP COLUMN IF EXISTS device_id;
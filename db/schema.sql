@@ -19,6 +19,66 @@ SET default_tablespace = '';
 
 SET default_table_access_method = heap;
 
+--
+-- Name: device_group_alerts; Type: TABLE; Schema: public; Owner: -
+--
+
+CREATE TABLE public.device_group_alerts (
+    group_id integer NOT NULL,
+    metric_type text NOT NULL,
+    aggregate text NOT NULL,
+    direction text NOT NULL,
+    threshold real NOT NULL,
+    updated_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP,
+    CONSTRAINT valid_aggregate CHECK ((aggregate = ANY (ARRAY['mean'::text, 'min'::text, 'max'::text]))),
+    CONSTRAINT valid_direction CHECK ((direction = ANY (ARRAY['above'::text, 'below'::text]))),
+    CONSTRAINT valid_metric CHECK ((metric_type = ANY (ARRAY['temperature'::text, 'humidity'::text])))
+);
+
+
+--
+-- Name: device_group_members; Type: TABLE; Schema: public; Owner: -
+--
+
+CREATE TABLE public.device_group_members (
+    group_id integer NOT NULL,
+    device_id text NOT NULL,
+    created_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP
+);
+
+
+--
+-- Name: device_groups; Type: TABLE; Schema: public; Owner: -
+--
+
+CREATE TABLE public.device_groups (
+    id integer NOT NULL,
+    chat_id bigint NOT NULL,
+    name text NOT NULL,
+    created_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP
+);
+
+
+--
+-- Name: device_groups_id_seq; Type: SEQUENCE; Schema: public; Owner: -
+--
+
+CREATE SEQUENCE public.device_groups_id_seq
+    AS integer
+    START WITH 1
+    INCREMENT BY 1
+    NO MINVALUE
+    NO MAXVALUE
+    CACHE 1;
+
+
+--
+-- Name: device_groups_id_seq; Type: SEQUENCE OWNED BY; Schema: public; Owner: -
+--
+
+ALTER SEQUENCE public.device_groups_id_seq OWNED BY public.device_groups.id;
+
+
 --
 -- Name: iot_test; Type: TABLE; Schema: public; Owner: -
 --
@@ -52,6 +112,70 @@ CREATE SEQUENCE public.iot_test_id_seq
 ALTER SEQUENCE public.iot_test_id_seq OWNED BY public.iot_test.id;
 
 
+--
+-- Name: notification_outbox; Type: TABLE; Schema: public; Owner: -
+--
+
+CREATE TABLE public.notification_outbox (
+    id bigint NOT NULL,
+    dedup_key text NOT NULL,
+    channel text NOT NULL,
+    chat_id bigint DEFAULT 0 NOT NULL,
+    device_id text NOT NULL,
+    metric_type text NOT NULL,
+    direction text NOT NULL,
+    value double precision NOT NULL,
+    resolved boolean DEFAULT false NOT NULL,
+    suppressed_before integer DEFAULT 0 NOT NULL,
+    event_us bigint NOT NULL,
+    status text DEFAULT 'pending'::text NOT NULL,
+    attempts integer DEFAULT 0 NOT NULL,
+    available_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP NOT NULL,
+    locked_by text,
+    locked_until timestamp without time zone,
+    last_error text,
+    created_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP NOT NULL,
+    delivered_at timestamp without time zone,
+    CONSTRAINT valid_channel CHECK ((channel = ANY (ARRAY['telegram'::text, 'email'::text]))),
+    CONSTRAINT valid_status CHECK ((status = ANY (ARRAY['pending'::text, 'delivered'::text, 'failed'::text])))
+);
+
+
+--
+-- Name: notification_outbox_id_seq; Type: SEQUENCE; Schema: public; Owner: -
+--
+
+CREATE SEQUENCE public.notification_outbox_id_seq
+    START WITH 1
+    INCREMENT BY 1
+    NO MINVALUE
+    NO MAXVALUE
+    CACHE 1;
+
+
+--
+-- Name: notification_outbox_id_seq; Type: SEQUENCE OWNED BY; Schema: public; Owner: -
+--
+
+ALTER SEQUENCE public.notification_outbox_id_seq OWNED BY public.notification_outbox.id;
+
+
+--
+-- Name: rule_definitions; Type: TABLE; Schema: public; Owner: -
+--
+
+CREATE TABLE public.rule_definitions (
+    name text NOT NULL,
+    expression text NOT NULL,
+    priority integer DEFAULT 0 NOT NULL,
+    enabled boolean DEFAULT true NOT NULL,
+    updated_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP,
+    device_id text,
+    group_id integer,
+    CONSTRAINT rule_definitions_single_scope CHECK (((device_id IS NULL) OR (group_id IS NULL)))
+);
+
+
 --
 -- Name: schema_migrations; Type: TABLE; Schema: public; Owner: -
 --
@@ -197,6 +321,13 @@ CREATE SEQUENCE public.user_devices_id_seq
 ALTER SEQUENCE public.user_devices_id_seq OWNED BY public.user_devices.id;
 
 
+--
+-- Name: device_groups id; Type: DEFAULT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.device_groups ALTER COLUMN id SET DEFAULT nextval('public.device_groups_id_seq'::regclass);
+
+
 --
 -- Name: iot_test id; Type: DEFAULT; Schema: public; Owner: -
 --
@@ -204,6 +335,13 @@ ALTER SEQUENCE public.user_devices_id_seq OWNED BY public.user_devices.id;
 ALTER TABLE ONLY public.iot_test ALTER COLUMN id SET DEFAULT nextval('public.iot_test_id_seq'::regclass);
 
 
+--
+-- Name: notification_outbox id; Type: DEFAULT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.notification_outbox ALTER COLUMN id SET DEFAULT nextval('public.notification_outbox_id_seq'::regclass);
+
+
 --
 -- Name: telemetry_data id; Type: DEFAULT; Schema: public; Owner: -
 --
@@ -225,6 +363,38 @@ ALTER TABLE ONLY public.user_device_alerts ALTER COLUMN id SET DEFAULT nextval('
 ALTER TABLE ONLY public.user_devices ALTER COLUMN id SET DEFAULT nextval('public.user_devices_id_seq'::regclass);
 
 
+--
+-- Name: device_group_alerts device_group_alerts_pkey; Type: CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.device_group_alerts
+    ADD CONSTRAINT device_group_alerts_pkey PRIMARY KEY (group_id, metric_type, aggregate, direction);
+
+
+--
+-- Name: device_group_members device_group_members_pkey; Type: CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.device_group_members
+    ADD CONSTRAINT device_group_members_pkey PRIMARY KEY (group_id, device_id);
+
+
+--
+-- Name: device_groups device_groups_chat_id_name_key; Type: CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.device_groups
+    ADD CONSTRAINT device_groups_chat_id_name_key UNIQUE (chat_id, name);
+
+
+--
+-- Name: device_groups device_groups_pkey; Type: CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.device_groups
+    ADD CONSTRAINT device_groups_pkey PRIMARY KEY (id);
+
+
 --
 -- Name: iot_test iot_test_pkey; Type: CONSTRAINT; Schema: public; Owner: -
 --
@@ -233,6 +403,30 @@ ALTER TABLE ONLY public.iot_test
     ADD CONSTRAINT iot_test_pkey PRIMARY KEY (id);
 
 
+--
+-- Name: notification_outbox notification_outbox_dedup_key_key; Type: CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.notification_outbox
+    ADD CONSTRAINT notification_outbox_dedup_key_key UNIQUE (dedup_key);
+
+
+--
+-- Name: notification_outbox notification_outbox_pkey; Type: CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.notification_outbox
+    ADD CONSTRAINT notification_outbox_pkey PRIMARY KEY (id);
+
+
+--
+-- Name: rule_definitions rule_definitions_pkey; Type: CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.rule_definitions
+    ADD CONSTRAINT rule_definitions_pkey PRIMARY KEY (name);
+
+
 --
 -- Name: schema_migrations schema_migrations_pkey; Type: CONSTRAINT; Schema: public; Owner: -
 --
@@ -297,6 +491,27 @@ ALTER TABLE ONLY public.user_devices
     ADD CONSTRAINT user_devices_pkey PRIMARY KEY (id);
 
 
+--
+-- Name: idx_device_group_members_device; Type: INDEX; Schema: public; Owner: -
+--
+
+CREATE INDEX idx_device_group_members_device ON public.device_group_members USING btree (device_id);
+
+
+--
+-- Name: idx_notification_outbox_created; Type: INDEX; Schema: public; Owner: -
+--
+
+CREATE INDEX idx_notification_outbox_created ON public.notification_outbox USING btree (created_at);
+
+
+--
+-- Name: idx_notification_outbox_pending; Type: INDEX; Schema: public; Owner: -
+--
+
+CREATE INDEX idx_notification_outbox_pending ON public.notification_outbox USING btree (available_at) WHERE (status = 'pending'::text);
+
+
 --
 -- Name: idx_telemetry_device_id; Type: INDEX; Schema: public; Owner: -
 --
@@ -311,6 +526,30 @@ CREATE INDEX idx_telemetry_device_id ON public.telemetry_data USING btree (devic
 CREATE INDEX idx_telemetry_timestamp ON public.telemetry_data USING btree ("timestamp" DESC);
 
 
+--
+-- Name: device_group_alerts device_group_alerts_group_id_fkey; Type: FK CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.device_group_alerts
+    ADD CONSTRAINT device_group_alerts_group_id_fkey FOREIGN KEY (group_id) REFERENCES public.device_groups(id) ON DELETE CASCADE;
+
+
+--
+-- Name: device_group_members device_group_members_group_id_fkey; Type: FK CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.device_group_members
+    ADD CONSTRAINT device_group_members_group_id_fkey FOREIGN KEY (group_id) REFERENCES public.device_groups(id) ON DELETE CASCADE;
+
+
+--
+-- Name: rule_definitions rule_definitions_group_id_fkey; Type: FK CONSTRAINT; Schema: public; Owner: -
+--
+
+ALTER TABLE ONLY public.rule_definitions
+    ADD CONSTRAINT rule_definitions_group_id_fkey FOREIGN KEY (group_id) REFERENCES public.device_groups(id) ON DELETE CASCADE;
+
+
 --
 -- PostgreSQL database dump complete
 --
@@ -323,4 +562,8 @@ CREATE INDEX idx_telemetry_timestamp ON public.telemetry_data USING btree ("time
 --
 
 INSERT INTO public.schema_migrations (version) VALUES
-    ('20251203110925');
+    ('20251203110925'),
+    ('20261018090000'),
+    ('20261018100000'),
+    ('20261018110000'),
+    ('20261018120000');
@@ -19,12 +19,14 @@ namespace iot_core::api {
 TelemetryServer::TelemetryServer(
     std::shared_ptr<core::DatabaseRepository> database,
     std::shared_ptr<services::AlertProcessingService> alertService,
-    std::shared_ptr<core::NotificationService> notifier)
+    std::shared_ptr<core::NotificationService> notifier,
+    std::shared_ptr<engine::RuleEngine> ruleEngine)
     : database_(std::move(database)),
       alertService_(std::move(alertService)),
       notifier_(std::move(notifier)),
+      ruleEngine_(std::move(ruleEngine)),
       serverImpl_(std::make_unique<TelemetryServerImpl>(
-          database_, alertService_, notifier_)) {
+          database_, alertService_, notifier_, ruleEngine_)) {
   serverImpl_->setup(this);
   statistics_.startTime = std::chrono::steady_clock::now();
 
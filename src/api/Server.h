@@ -12,6 +12,10 @@
 #include "../core/NotificationService.h"
 #include "../services/AlertService.h"
 
+namespace iot_core::engine {
+class RuleEngine;
+}
+
 namespace iot_core::api {
 
 // Forward declaration приватной реализации
@@ -22,7 +26,8 @@ class TelemetryServer {
   TelemetryServer(
       std::shared_ptr<core::DatabaseRepository> database,
       std::shared_ptr<services::AlertProcessingService> alertService,
-      std::shared_ptr<core::NotificationService> notifier);
+      std::shared_ptr<core::NotificationService> notifier,
+      std::shared_ptr<engine::RuleEngine> ruleEngine = nullptr);
 
   ~TelemetryServer();
 
@@ -47,6 +52,7 @@ class TelemetryServer {
   std::shared_ptr<core::DatabaseRepository> database_;
   std::shared_ptr<services::AlertProcessingService> alertService_;
   std::shared_ptr<core::NotificationService> notifier_;
+  std::shared_ptr<engine::RuleEngine> ruleEngine_;  // может быть nullptr
 
   std::unique_ptr<TelemetryServerImpl> serverImpl_;
 
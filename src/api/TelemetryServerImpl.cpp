@@ -7,6 +7,10 @@
 #include <iostream>
 #include <sstream>
 
+#include "../engine/RuleEngine.h"
+#include "../storage/HotWindowCache.h"
+#include "../storage/IngestSpool.h"
+#include "../storage/TimeSeriesStore.h"
 #include "../utils/Formatter.h"
 #include "Server.h"
 
@@ -14,15 +18,29 @@ using json = nlohmann::json;
 
 namespace iot_core::api {
 
+namespace {
+
+json latencyJson(const utils::LatencyHistogram::Snapshot& histogram) {
+  return {{"count", histogram.count},
+          {"avg_us", histogram.meanNanos() / 1000.0},
+          {"p50_us", histogram.percentileNanos(0.50) / 1000.0},
+          {"p99_us", histogram.percentileNanos(0.99) / 1000.0},
+          {"max_us", histogram.maxNanos / 1000.0}};
+}
+
+}  // namespace
+
 // ==================== TelemetryServerImpl ====================
 
 TelemetryServerImpl::TelemetryServerImpl(
     std::shared_ptr<core::DatabaseRepository> database,
     std::shared_ptr<services::AlertProcessingService> alertService,
-    std::shared_ptr<core::NotificationService> notifier)
+    std::shared_ptr<core::NotificationService> notifier,
+    std::shared_ptr<engine::RuleEngine> ruleEngine)
     : database_(std::move(database)),
       alertService_(std::move(alertService)),
       notifier_(std::move(notifier)),
+      ruleEngine_(std::move(ruleEngine)),
       server_(std::make_unique<httplib::Server>()) {
   setupCors();
   setupRoutes();
@@ -162,13 +180,45 @@ void TelemetryServerImpl::setupRoutes() {
       double temperature = data["temperature"];
       double humidity = data["humidity"];
 
+      // Сохранение в локальное хранилище (если включено)
+      models::IoTData telemetry;
+      telemetry.deviceId = deviceId;
+      telemetry.temperature = temperature;
+      telemetry.humidity = humidity;
+      telemetry.timestampUs =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count();
+      database_->recordTelemetry(telemetry);
+
+      // С журналом приема ответ не ждет БД: в БД показание попадет при
+      // воспроизведении журнала, а оповещения и контакт с устройством
+      // проверяются сразу - и во время недоступности БД
+      if (database_->enqueueTelemetry(telemetry)) {
+        alertService_->processTelemetryData(deviceId, temperature, humidity,
+                                            telemetry.timestampUs);
+
+        json response = {{"status", "queued"},
+                         {"message", "Telemetry data accepted"},
+                         {"device_id", deviceId},
+                         {"timestamp", utils::Formatter::formatTimestamp(
+                                           telemetry.timestampUs)}};
+
+        res.status = 202;
+        res.set_content(response.dump(), "application/json");
+        return;
+      }
+
       // Обработка данных
-      alertService_->processTelemetryData(deviceId, temperature, humidity);
+      alertService_->processTelemetryData(deviceId, temperature, humidity,
+                                          telemetry.timestampUs);
 
       json response = {
           {"status", "success"},   {"message", "Telemetry data processed"},
           {"device_id", deviceId}, {"temperature", temperature},
-          {"humidity", humidity},  {"timestamp", getCurrentTimestamp()}};
+          {"humidity", humidity},
+          {"timestamp",
+           utils::Formatter::formatTimestamp(telemetry.timestampUs)}};
 
       res.status = 200;
       res.set_content(response.dump(), "application/json");
@@ -192,7 +242,13 @@ void TelemetryServerImpl::setupRoutes() {
                      limit = std::clamp(limit, 1, 100);
                    }
 
-                   auto data = database_->getRecentTelemetry(limit);
+                   // С device_id история читается через окно недавних
+                   // показаний, если оно покрывает запрос
+                   auto data = req.has_param("device_id")
+                                   ? database_->getDeviceTelemetry(
+                                         req.get_param_value("device_id"),
+                                         limit)
+                                   : database_->getRecentTelemetry(limit);
                    json response = json::array();
 
                    for (const auto& item : data) {
@@ -200,7 +256,9 @@ void TelemetryServerImpl::setupRoutes() {
                                          {"device_id", item.deviceId},
                                          {"temperature", item.temperature},
                                          {"humidity", item.humidity},
-                                         {"timestamp", item.timestamp}});
+                                         {"timestamp",
+                                          utils::Formatter::formatTimestamp(
+                                              item.timestampUs)}});
                    }
 
                    res.set_content(response.dump(), "application/json");
@@ -223,9 +281,149 @@ void TelemetryServerImpl::setupRoutes() {
                       {{"total_alerts", stats.totalAlerts},
                        {"temperature_alerts", stats.temperatureAlerts},
                        {"humidity_alerts", stats.humidityAlerts},
-                       {"users_notified", stats.usersNotified}}},
+                       {"users_notified", stats.usersNotified},
+                       {"resolved_alerts", stats.resolvedAlerts},
+                       {"offline_alerts", stats.offlineAlerts},
+                       {"online_alerts", stats.onlineAlerts},
+                       {"anomaly_alerts", stats.anomalyAlerts},
+                       {"active_alerts", stats.activeAlerts},
+                       {"rate_limited",
+                        {{"allowed", stats.rateLimits.allowed},
+                         {"by_chat", stats.rateLimits.suppressedByChat},
+                         {"by_device", stats.rateLimits.suppressedByDevice},
+                         {"global", stats.rateLimits.suppressedGlobal}}}}},
                      {"timestamp", getCurrentTimestamp()}};
 
+    auto executor = alertService_->getExecutorStatistics();
+    response["alert_executor_statistics"] = {
+        {"shards", executor.shards},
+        {"queued", executor.queued},
+        {"max_queue_depth", executor.maxQueueDepth},
+        {"executed", executor.executed},
+        {"failed", executor.failed}};
+    if (auto shared = alertService_->getSharedOutbox()) {
+      auto outbox = shared->getStatistics();
+      response["shared_outbox_statistics"] = {
+          {"node_id", shared->nodeId()},
+          {"published", outbox.published},
+          {"duplicates", outbox.duplicates},
+          {"publish_errors", outbox.publishErrors},
+          {"claimed", outbox.claimed},
+          {"delivered", outbox.delivered},
+          {"retried", outbox.retried},
+          {"failed", outbox.failed},
+          {"purged", outbox.purged}};
+    }
+
+    response["threshold_index_statistics"] = {
+        {"devices", stats.thresholdIndex.devices},
+        {"loads", stats.thresholdIndex.loads},
+        {"updates", stats.thresholdIndex.updates}};
+    response["group_aggregate_statistics"] = {
+        {"groups", stats.groupAggregates.groups},
+        {"updates", stats.groupAggregates.updates},
+        {"rescans", stats.groupAggregates.rescans},
+        {"reloads", stats.groupAggregates.reloads}};
+
+    auto outbox = notifier_->getOutboxStatistics();
+    response["notification_statistics"] = {
+        {"queued", outbox.queued},
+        {"in_flight", outbox.inFlight},
+        {"delivered", outbox.delivered},
+        {"retried", outbox.retried},
+        {"failed", outbox.failed},
+        {"dropped", outbox.dropped},
+        {"avg_latency_ms", outbox.avgLatencyMs},
+        {"max_latency_ms", outbox.maxLatencyMs}};
+
+    auto coalescer = notifier_->getCoalescerStatistics();
+    response["notification_statistics"]["coalesced_alerts"] = coalescer.alerts;
+    response["notification_statistics"]["coalesced_messages"] =
+        coalescer.flushes;
+    response["notification_statistics"]["open_windows"] =
+        coalescer.openWindows;
+    auto emailDigest = notifier_->getEmailDigestStatistics();
+    response["notification_statistics"]["email_alerts"] = emailDigest.alerts;
+    response["notification_statistics"]["email_digests"] =
+        emailDigest.flushes;
+
+    if (auto telegram = notifier_->getTelegramClient()) {
+      auto client = telegram->getStatistics();
+      response["telegram_client_statistics"] = {
+          {"requests", client.requests},
+          {"failures", client.failures},
+          {"rate_limited", client.rateLimited},
+          {"sessions", client.sessions},
+          {"avg_latency_ms", client.avgLatencyMs}};
+    }
+
+    if (auto hotWindow = database_->getHotWindow()) {
+      auto window = hotWindow->getStatistics();
+      response["hot_window_statistics"] = {
+          {"devices", window.devices},
+          {"points", window.points},
+          {"memory_bytes", window.memoryBytes},
+          {"hits", window.hits},
+          {"misses", window.misses},
+          {"evicted_blocks", window.evictedBlocks}};
+    }
+
+    if (auto spool = database_->getIngestSpool()) {
+      auto journal = spool->getStatistics();
+      response["spool_statistics"] = {
+          {"pending_records", journal.pendingRecords},
+          {"lag_seconds", journal.lagSeconds},
+          {"disk_bytes", journal.diskBytes},
+          {"segments", journal.segments},
+          {"appended", journal.appended},
+          {"replayed", journal.replayed},
+          {"replay_failures", journal.replayFailures},
+          {"dropped", journal.dropped},
+          {"rejected", journal.rejected},
+          {"quarantined", journal.quarantined}};
+    }
+
+    if (ruleEngine_) {
+      auto rules = ruleEngine_->getStatistics();
+      // Самые дорогие правила первыми
+      std::sort(rules.rules.begin(), rules.rules.end(),
+                [](const auto& a, const auto& b) {
+                  return a.condition.totalNanos + a.action.totalNanos >
+                         b.condition.totalNanos + b.action.totalNanos;
+                });
+      json perRule = json::array();
+      for (const auto& rule : rules.rules) {
+        perRule.push_back({{"name", rule.name},
+                           {"evaluations", rule.evaluations},
+                           {"triggers", rule.triggers},
+                           {"errors", rule.errors},
+                           {"condition", latencyJson(rule.condition)},
+                           {"action", latencyJson(rule.action)}});
+      }
+      response["rule_statistics"] = {
+          {"total_processed", rules.totalProcessed},
+          {"rules_triggered", rules.rulesTriggered},
+          {"rules", perRule}};
+
+      auto anomalies = ruleEngine_->getAnomalyStatistics();
+      response["anomaly_statistics"] = {
+          {"devices", anomalies.devices},
+          {"observed", anomalies.observed},
+          {"anomalies", anomalies.anomalies},
+          {"memory_bytes", anomalies.memoryBytes}};
+    }
+
+    if (auto store = database_->getLocalStore()) {
+      auto storage = store->getStatistics();
+      response["storage_statistics"] = {
+          {"devices", storage.devices},
+          {"segments", storage.segments},
+          {"active_points", storage.activePoints},
+          {"sealed_points", storage.sealedPoints},
+          {"disk_bytes", storage.diskBytes},
+          {"compactions", storage.compactions}};
+    }
+
     res.set_content(response.dump(), "application/json");
   });
 
@@ -20,6 +20,10 @@
 #include "../services/AlertService.h"
 #include "httplib.h"
 
+namespace iot_core::engine {
+class RuleEngine;
+}
+
 namespace iot_core::api {
 
 class TelemetryServer;  // Forward declaration
@@ -29,7 +33,8 @@ class TelemetryServerImpl {
   TelemetryServerImpl(
       std::shared_ptr<core::DatabaseRepository> database,
       std::shared_ptr<services::AlertProcessingService> alertService,
-      std::shared_ptr<core::NotificationService> notifier);
+      std::shared_ptr<core::NotificationService> notifier,
+      std::shared_ptr<engine::RuleEngine> ruleEngine = nullptr);
 
   void setup(TelemetryServer* owner);
   bool listen(const std::string& host, int port);
@@ -45,6 +50,7 @@ class TelemetryServerImpl {
   std::shared_ptr<core::DatabaseRepository> database_;
   std::shared_ptr<services::AlertProcessingService> alertService_;
   std::shared_ptr<core::NotificationService> notifier_;
+  std::shared_ptr<engine::RuleEngine> ruleEngine_;  // может быть nullptr
   std::unique_ptr<httplib::Server> server_;
   std::thread serverThread_;
   std::string host_;
@@ -1,8 +1,5 @@
 #include "TelegramBotHandler.h"
 
-#include <cpr/cpr.h>
-#include <curl/curl.h>
-
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
@@ -42,29 +39,31 @@ void TelegramBotHandler::startPolling(const std::string& botToken) {
 
   std::cout << "🤖 Starting Telegram bot polling..." << std::endl;
 
+  // Бот и уведомления делят соединения и лимиты одного клиента
+  if (notifier_) {
+    telegram_ = notifier_->getTelegramClient();
+  }
+  if (!telegram_) {
+    telegram_ = std::make_shared<core::TelegramClient>(botToken_);
+  }
+
   running_ = true;
 
-  // Запускаем polling loop в отдельном потоке
-  pollingThread_ = std::thread([this]() {
+  // Запускаем polling loop в отдельном потоке; поток отделен, поэтому
+  // держит клиент сам
+  pollingThread_ = std::thread([this, telegram = telegram_]() {
     std::cout << "🔄 Telegram polling loop started" << std::endl;
 
     long lastUpdateId = 0;
 
     while (running_) {
       try {
-        std::string url =
-            "https://api.telegram.org/bot" + botToken_ + "/getUpdates";
+        // Long polling на отдельном постоянном соединении
+        auto response = telegram->getUpdates(lastUpdateId + 1, 10);
 
-        // Простой polling с таймаутом
-        auto response = cpr::Get(
-            cpr::Url{url},
-            cpr::Parameters{{"offset", std::to_string(lastUpdateId + 1)},
-                            {"timeout", "10"}},
-            cpr::Timeout{15000});
-
-        if (response.status_code == 200) {
+        if (response.ok()) {
           try {
-            auto data = json::parse(response.text);
+            auto data = json::parse(response.body);
 
             if (data["ok"] == true) {
               auto updates = data["result"];
@@ -124,10 +123,10 @@ void TelegramBotHandler::startPolling(const std::string& botToken) {
           } catch (const json::exception& e) {
             std::cerr << "❌ JSON parse error: " << e.what() << std::endl;
           }
-        } else if (response.status_code !=
+        } else if (response.statusCode !=
                    0) {  // 0 - это timeout, это нормально
-          std::cerr << "❌ Telegram API error: " << response.status_code
-                    << " - " << response.text << std::endl;
+          std::cerr << "❌ Telegram API error: " << response.statusCode
+                    << " - " << response.body << std::endl;
         }
 
       } catch (const std::exception& e) {
@@ -199,6 +198,82 @@ void TelegramBotHandler::setupCommandHandlers() {
          }
        }},
 
+      {"/history",
+       [this](long chatId, const auto& args) {
+         if (args.empty()) {
+           sendMessage(chatId,
+                       "❌ Использование: /history <device_id> [часы, 1-24]");
+           return;
+         }
+
+         std::string deviceId = args[0];
+         int hours = 1;
+         try {
+           if (args.size() > 1) {
+             hours = std::clamp(std::stoi(args[1]), 1, 24);
+           }
+         } catch (...) {
+           sendMessage(chatId, "❌ Неверное количество часов");
+           return;
+         }
+
+         try {
+           if (!database_->userHasDevice(chatId, deviceId)) {
+             sendMessage(chatId,
+                         "❌ Устройство `" + deviceId + "` не привязано");
+             return;
+           }
+
+           auto since = std::chrono::system_clock::now() -
+                        std::chrono::hours(hours);
+           int64_t sinceUs =
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   since.time_since_epoch())
+                   .count();
+           auto data = database_->getDeviceTelemetrySince(deviceId, sinceUs);
+
+           if (data.empty()) {
+             sendMessage(chatId, "📭 Нет данных за последние " +
+                                     std::to_string(hours) + " ч.");
+             return;
+           }
+
+           double minTemp = data.front().temperature;
+           double maxTemp = minTemp;
+           double sumTemp = 0.0;
+           double sumHum = 0.0;
+           for (const auto& item : data) {
+             minTemp = std::min(minTemp, item.temperature);
+             maxTemp = std::max(maxTemp, item.temperature);
+             sumTemp += item.temperature;
+             sumHum += item.humidity;
+           }
+
+           std::ostringstream message;
+           message << std::fixed << std::setprecision(1);
+           message << "📈 *История `" << deviceId << "` за " << hours
+                   << " ч.:*\n\n"
+                   << "• Записей: " << data.size() << "\n"
+                   << "• Температура: " << minTemp << "…" << maxTemp
+                   << "°C (средняя " << sumTemp / data.size() << "°C)\n"
+                   << "• Средняя влажность: " << sumHum / data.size()
+                   << "%\n\n*Последние:*\n";
+
+           size_t shown = std::min<size_t>(data.size(), 5);
+           for (size_t i = 0; i < shown; ++i) {
+             message << "• "
+                     << utils::Formatter::formatTimestamp(data[i].timestampUs)
+                     << ": "
+                     << data[i].temperature << "°C, " << data[i].humidity
+                     << "%\n";
+           }
+
+           sendMessage(chatId, message.str());
+         } catch (const std::exception& e) {
+           sendMessage(chatId, "❌ Ошибка получения истории");
+         }
+       }},
+
       {"/add_device",
        [this](long chatId, const auto& args) {
          if (args.empty()) {
@@ -225,6 +300,161 @@ void TelegramBotHandler::setupCommandHandlers() {
          }
        }},
 
+      {"/group_create",
+       [this](long chatId, const auto& args) {
+         if (args.empty()) {
+           sendMessage(chatId, "❌ Использование: /group_create <имя>");
+           return;
+         }
+
+         try {
+           database_->createDeviceGroup(chatId, args[0]);
+           sendMessage(chatId, "🏢 Группа `" + args[0] + "` создана");
+         } catch (...) {
+           sendMessage(chatId, "❌ Ошибка создания группы");
+         }
+       }},
+
+      {"/group_delete",
+       [this](long chatId, const auto& args) {
+         if (args.empty()) {
+           sendMessage(chatId, "❌ Использование: /group_delete <имя>");
+           return;
+         }
+
+         try {
+           if (!database_->deleteDeviceGroup(chatId, args[0])) {
+             sendMessage(chatId, "❌ Группа `" + args[0] + "` не найдена");
+             return;
+           }
+           sendMessage(chatId, "🗑️ Группа `" + args[0] + "` удалена");
+         } catch (...) {
+           sendMessage(chatId, "❌ Ошибка удаления группы");
+         }
+       }},
+
+      {"/group_add",
+       [this](long chatId, const auto& args) {
+         if (args.size() < 2) {
+           sendMessage(chatId,
+                       "❌ Использование: /group_add <группа> <device_id>");
+           return;
+         }
+
+         try {
+           if (!database_->userHasDevice(chatId, args[1])) {
+             sendMessage(chatId,
+                         "❌ Устройство `" + args[1] + "` не привязано");
+             return;
+           }
+           if (!database_->addDeviceToGroup(chatId, args[0], args[1])) {
+             sendMessage(chatId, "❌ Группа `" + args[0] + "` не найдена");
+             return;
+           }
+           sendMessage(chatId, "✅ Устройство `" + args[1] +
+                                   "` добавлено в группу `" + args[0] + "`");
+         } catch (...) {
+           sendMessage(chatId, "❌ Ошибка добавления устройства в группу");
+         }
+       }},
+
+      {"/group_remove",
+       [this](long chatId, const auto& args) {
+         if (args.size() < 2) {
+           sendMessage(chatId,
+                       "❌ Использование: /group_remove <группа> <device_id>");
+           return;
+         }
+
+         try {
+           if (!database_->removeDeviceFromGroup(chatId, args[0], args[1])) {
+             sendMessage(chatId, "❌ Устройства `" + args[1] +
+                                     "` нет в группе `" + args[0] + "`");
+             return;
+           }
+           sendMessage(chatId, "✅ Устройство `" + args[1] +
+                                   "` удалено из группы `" + args[0] + "`");
+         } catch (...) {
+           sendMessage(chatId, "❌ Ошибка удаления устройства из группы");
+         }
+       }},
+
+      {"/group_alert",
+       [this](long chatId, const auto& args) {
+         const std::string usage =
+             "❌ Использование: /group_alert <группа> <temp|hum> "
+             "<mean|min|max> <above|below> <значение>\n"
+             "Значение 0 удаляет правило";
+         if (args.size() < 5) {
+           sendMessage(chatId, usage);
+           return;
+         }
+
+         models::GroupAlertRule rule;
+         if (args[1] == "temp") {
+           rule.metricType = "temperature";
+         } else if (args[1] == "hum") {
+           rule.metricType = "humidity";
+         }
+         rule.aggregate = args[2];
+         rule.direction = args[3];
+         if (rule.metricType.empty() ||
+             (rule.aggregate != "mean" && rule.aggregate != "min" &&
+              rule.aggregate != "max") ||
+             (rule.direction != "above" && rule.direction != "below")) {
+           sendMessage(chatId, usage);
+           return;
+         }
+
+         try {
+           rule.threshold = std::stod(args[4]);
+         } catch (...) {
+           sendMessage(chatId, "❌ Неверное значение порога");
+           return;
+         }
+
+         try {
+           if (!database_->setGroupAlertRule(chatId, args[0], rule)) {
+             sendMessage(chatId, "❌ Группа `" + args[0] + "` не найдена");
+             return;
+           }
+           if (rule.threshold > 0) {
+             sendMessage(chatId,
+                         "⚙️ Правило группы `" + args[0] + "` установлено: " +
+                             args[1] + " " + rule.aggregate + " " +
+                             rule.direction + " " +
+                             std::to_string(rule.threshold).substr(0, 4));
+           } else {
+             sendMessage(chatId,
+                         "🗑️ Правило группы `" + args[0] + "` удалено");
+           }
+         } catch (...) {
+           sendMessage(chatId, "❌ Ошибка установки правила группы");
+         }
+       }},
+
+      {"/groups",
+       [this](long chatId, const auto& args) {
+         try {
+           auto groups = database_->getUserDeviceGroups(chatId);
+           std::vector<models::GroupAggregate> aggregates(groups.size());
+           std::vector<std::vector<models::GroupAlertRule>> rules;
+           rules.reserve(groups.size());
+           for (size_t i = 0; i < groups.size(); ++i) {
+             // Агрегаты считаются на лету по показаниям - без запроса к БД
+             if (alertService_) {
+               alertService_->getGroupAggregate(groups[i].id, aggregates[i]);
+             }
+             aggregates[i].members = groups[i].deviceIds.size();
+             rules.push_back(database_->getGroupAlertRules(groups[i].id));
+           }
+           sendMessage(chatId, utils::Formatter::formatGroupList(
+                                   groups, aggregates, rules));
+         } catch (...) {
+           sendMessage(chatId, "❌ Ошибка получения групп");
+         }
+       }},
+
       {"/alert_temp_high",
        [this](long chatId, const auto& args) {
          if (args.empty()) {
@@ -377,24 +607,19 @@ void TelegramBotHandler::setupCommandHandlers() {
 }
 
 void TelegramBotHandler::sendMessage(long chatId, const std::string& text) {
-  try {
-    json payload;
-    payload["chat_id"] = chatId;
-    payload["text"] = text;
-    payload["parse_mode"] = "Markdown";
-
-    std::string url =
-        "https://api.telegram.org/bot" + botToken_ + "/sendMessage";
+  if (!telegram_) {
+    std::cerr << "❌ Telegram client is not started" << std::endl;
+    return;
+  }
 
-    cpr::Response r = cpr::Post(
-        cpr::Url{url}, cpr::Header{{"Content-Type", "application/json"}},
-        cpr::Body{payload.dump()}, cpr::Timeout{10000});
+  try {
+    auto r = telegram_->sendMessage(chatId, text, "Markdown");
 
-    if (r.status_code == 200) {
+    if (r.ok()) {
       std::cout << "✅ Telegram message sent to " << chatId << std::endl;
     } else {
-      std::cerr << "❌ Failed to send Telegram message: " << r.status_code
-                << " - " << r.text << std::endl;
+      std::cerr << "❌ Failed to send Telegram message: " << r.statusCode
+                << " - " << r.body << std::endl;
     }
   } catch (const std::exception& e) {
     std::cerr << "❌ Exception sending Telegram message: " << e.what()
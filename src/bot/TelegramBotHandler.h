@@ -11,6 +11,7 @@
 
 #include "../core/Database.h"
 #include "../core/NotificationService.h"
+#include "../core/TelegramClient.h"
 #include "../services/AlertService.h"
 
 namespace iot_core::bot {
@@ -42,6 +43,7 @@ class TelegramBotHandler {
   std::thread pollingThread_;
   std::atomic<bool> running_{false};
   std::string botToken_;
+  std::shared_ptr<core::TelegramClient> telegram_;
 };
 
 }  // namespace iot_core::bot
\ No newline at end of file
@@ -0,0 +1,156 @@
+// src/core/AlertCoalescer.cpp
+#include "AlertCoalescer.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace iot_core::core {
+
+AlertCoalescer::AlertCoalescer(Options options) : options_(std::move(options)) {
+  options_.maxBatch = std::max<size_t>(1, options_.maxBatch);
+}
+
+AlertCoalescer::~AlertCoalescer() { stop(); }
+
+void AlertCoalescer::start(Flush flush) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    return;
+  }
+  flush_ = std::move(flush);
+  running_ = true;
+  flusher_ = std::thread([this]() { flusherLoop(); });
+}
+
+void AlertCoalescer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cv_.notify_all();
+  if (flusher_.joinable()) {
+    flusher_.join();
+  }
+
+  // Все, что осталось в окнах, уходит сразу
+  std::vector<std::pair<long, std::vector<models::AlertEvent>>> batches;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batches = takeDueLocked(Clock::now(), true);
+  }
+  deliver(std::move(batches));
+}
+
+void AlertCoalescer::add(long chatId, models::AlertEvent alert) {
+  std::vector<models::AlertEvent> full;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++statistics_.alerts;
+
+    if (!running_) {
+      // Окна не обслуживаются - отправляем сразу
+      full.push_back(std::move(alert));
+    } else {
+      auto [it, opened] = windows_.try_emplace(chatId);
+      Window& window = it->second;
+      if (opened) {
+        window.deadline = Clock::now() + options_.window;
+        deadlines_.emplace(window.deadline, chatId);
+      }
+      window.alerts.push_back(std::move(alert));
+
+      if (window.alerts.size() < options_.maxBatch) {
+        if (opened) {
+          cv_.notify_one();
+        }
+        return;
+      }
+
+      // Окно переполнено - закрываем досрочно
+      full = std::move(window.alerts);
+      auto range = deadlines_.equal_range(window.deadline);
+      for (auto d = range.first; d != range.second; ++d) {
+        if (d->second == chatId) {
+          deadlines_.erase(d);
+          break;
+        }
+      }
+      windows_.erase(it);
+    }
+    ++statistics_.flushes;
+  }
+
+  std::vector<std::pair<long, std::vector<models::AlertEvent>>> batches;
+  batches.emplace_back(chatId, std::move(full));
+  deliver(std::move(batches));
+}
+
+AlertCoalescer::Statistics AlertCoalescer::getStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics stats = statistics_;
+  stats.openWindows = windows_.size();
+  return stats;
+}
+
+void AlertCoalescer::flusherLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (running_) {
+    if (deadlines_.empty()) {
+      cv_.wait(lock);
+      continue;
+    }
+
+    auto deadline = deadlines_.begin()->first;
+    if (Clock::now() < deadline) {
+      cv_.wait_until(lock, deadline);
+      continue;
+    }
+
+    auto batches = takeDueLocked(Clock::now(), false);
+    lock.unlock();
+    deliver(std::move(batches));
+    lock.lock();
+  }
+}
+
+std::vector<std::pair<long, std::vector<models::AlertEvent>>>
+AlertCoalescer::takeDueLocked(Clock::time_point now, bool force) {
+  std::vector<std::pair<long, std::vector<models::AlertEvent>>> batches;
+
+  while (!deadlines_.empty() &&
+         (force || deadlines_.begin()->first <= now)) {
+    long chatId = deadlines_.begin()->second;
+    deadlines_.erase(deadlines_.begin());
+
+    auto it = windows_.find(chatId);
+    if (it == windows_.end()) {
+      continue;
+    }
+    batches.emplace_back(chatId, std::move(it->second.alerts));
+    windows_.erase(it);
+    ++statistics_.flushes;
+  }
+
+  return batches;
+}
+
+void AlertCoalescer::deliver(
+    std::vector<std::pair<long, std::vector<models::AlertEvent>>> batches) {
+  if (!flush_) {
+    return;
+  }
+  for (auto& [chatId, alerts] : batches) {
+    try {
+      flush_(chatId, std::move(alerts));
+    } catch (const std::exception& e) {
+      std::cerr << "❌ Ошибка отправки сводки оповещений для " << chatId
+                << ": " << e.what() << std::endl;
+    }
+  }
+}
+
+}  // namespace iot_core::core
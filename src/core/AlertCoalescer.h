@@ -0,0 +1,84 @@
+// src/core/AlertCoalescer.h
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../models/IoTData.h"
+
+namespace iot_core::core {
+
+/**
+ * @brief Объединение оповещений одного чата в сводку
+ *
+ * Первое оповещение для чата открывает окно; все, что приходит в этот
+ * чат до его закрытия, копится и уходит одним сообщением. Во время
+ * массовой аварии это сокращает число вызовов Telegram API на порядок и
+ * не упирается в лимиты. Окно закрывается досрочно при maxBatch
+ * оповещениях, при остановке сбрасываются все окна.
+ */
+class AlertCoalescer {
+ public:
+  struct Options {
+    std::chrono::milliseconds window{3000};
+    size_t maxBatch = 50;
+  };
+
+  struct Statistics {
+    uint64_t alerts = 0;   // принято оповещений
+    uint64_t flushes = 0;  // отправлено сообщений
+    size_t openWindows = 0;
+  };
+
+  using Flush =
+      std::function<void(long chatId, std::vector<models::AlertEvent> alerts)>;
+
+  explicit AlertCoalescer(Options options);
+  ~AlertCoalescer();
+
+  AlertCoalescer(const AlertCoalescer&) = delete;
+  AlertCoalescer& operator=(const AlertCoalescer&) = delete;
+
+  void start(Flush flush);
+  void stop();
+
+  void add(long chatId, models::AlertEvent alert);
+
+  Statistics getStatistics() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Window {
+    Clock::time_point deadline;
+    std::vector<models::AlertEvent> alerts;
+  };
+
+  void flusherLoop();
+  // Извлекает окна с истекшим сроком (все - при force); под mutex_
+  std::vector<std::pair<long, std::vector<models::AlertEvent>>> takeDueLocked(
+      Clock::time_point now, bool force);
+  void deliver(
+      std::vector<std::pair<long, std::vector<models::AlertEvent>>> batches);
+
+  Options options_;
+  Flush flush_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::unordered_map<long, Window> windows_;
+  // Сроки закрытия окон: ближайший - первым
+  std::multimap<Clock::time_point, long> deadlines_;
+  bool running_ = false;
+  Statistics statistics_;
+
+  std::thread flusher_;
+};
+
+}  // namespace iot_core::core
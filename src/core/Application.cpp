@@ -1,5 +1,6 @@
 #include "Application.h"
 
+#include <algorithm>
 #include <chrono>
 #include <csignal>
 #include <iomanip>
@@ -10,12 +11,18 @@
 #include "../api/Server.h"
 #include "../bot/TelegramBotHandler.h"
 #include "../core/DatabaseMigrator.h"
+#include "../engine/Backtester.h"
 #include "../engine/RuleEngine.h"
 #include "../services/AlertService.h"
 #include "../simulation/DeviceSimulator.h"
+#include "../storage/HotWindowCache.h"
+#include "../storage/IngestSpool.h"
+#include "../storage/StateSnapshot.h"
+#include "../storage/TimeSeriesStore.h"
 #include "ConfigManager.h"
 #include "Database.h"
 #include "NotificationService.h"
+#include "SharedNotificationOutbox.h"
 
 // Global pointer for signal handling
 static iot_core::core::Application* g_appInstance = nullptr;
@@ -89,6 +96,19 @@ void Application::run() {
     }
   }
 
+  // Start ingest spool replay
+  if (ingestSpool_) {
+    startSpoolReplay();
+    std::cout << "   📼 Ingest spool replay started" << std::endl;
+  }
+
+  // Периодический снимок состояния
+  if (runtimeConfig_.snapshotEnabled) {
+    startSnapshotting(runtimeConfig_.snapshotIntervalSeconds);
+    std::cout << "   💾 State snapshots every "
+              << runtimeConfig_.snapshotIntervalSeconds << " s" << std::endl;
+  }
+
   // Start Telegram bot
   if (telegramBot_ && runtimeConfig_.telegramEnabled &&
       !runtimeConfig_.telegramToken.empty()) {
@@ -286,6 +306,7 @@ void Application::shutdown() {
 
   // НОВОЕ: Останавливаем периодическую проверку удаленной БД
   stopRemotePolling();
+  stopSnapshotting();
 
   // Stop components
   if (deviceSimulator_) {
@@ -303,9 +324,158 @@ void Application::shutdown() {
     std::cout << "   • HTTP server stopped" << std::endl;
   }
 
+  // Догрузка журнала тоже порождает проверки - останавливаем ее раньше
+  if (ingestSpool_) {
+    ingestSpool_->stopReplay();
+  }
+
+  // Дорабатываем очереди проверки оповещений
+  if (alertService_) {
+    alertService_->stop();
+    std::cout << "   • Alert workers stopped" << std::endl;
+  }
+
+  // Источники данных остановлены - состояние больше не меняется
+  if (runtimeConfig_.snapshotEnabled && saveStateSnapshot()) {
+    std::cout << "   • State snapshot saved" << std::endl;
+  }
+
+  // Недоставленное в общей очереди заберут другие узлы или этот
+  // после перезапуска
+  if (sharedOutbox_) {
+    sharedOutbox_->stop();
+    std::cout << "   • Shared notification outbox stopped" << std::endl;
+  }
+
+  // Последние уведомления уходят после того, как проверки остановлены
+  if (notifier_) {
+    notifier_->shutdown();
+    std::cout << "   • Notification outbox drained" << std::endl;
+  }
+
+  // Журнал сбрасывается на диск; незагруженное догрузится при запуске
+  if (ingestSpool_) {
+    database_->attachIngestSpool(nullptr);
+    ingestSpool_->close();
+    std::cout << "   • Ingest spool closed" << std::endl;
+  }
+
+  // Хранилище закрываем последним: запечатываются активные блоки
+  if (timeSeriesStore_) {
+    database_->attachLocalStore(nullptr);
+    timeSeriesStore_->close();
+    std::cout << "   • Time-series store flushed" << std::endl;
+  }
+
   std::cout << "\n👋 IoT Platform shutdown complete.\n" << std::endl;
 }
 
+void Application::startSpoolReplay() {
+  ingestSpool_->startReplay(
+      [this](const std::vector<storage::SpoolRecord>& batch) {
+        std::vector<models::IoTData> telemetry;
+        telemetry.reserve(batch.size());
+        for (const auto& record : batch) {
+          models::IoTData data;
+          data.deviceId = record.deviceId;
+          data.temperature = record.temperature;
+          data.humidity = record.humidity;
+          data.timestampUs = record.timestampUs;
+          telemetry.push_back(std::move(data));
+        }
+
+        // Пока БД недоступна, пачка остается в журнале. Оповещения по
+        // этим показаниям проверены при приеме (TelemetryServerImpl)
+        std::vector<size_t> rejected;
+        if (!database_->saveTelemetryBatch(telemetry, rejected)) {
+          return false;
+        }
+
+        // Отвергнутые БД записи не должны держать журнал
+        if (!rejected.empty()) {
+          std::vector<storage::SpoolRecord> quarantined;
+          quarantined.reserve(rejected.size());
+          for (size_t index : rejected) {
+            quarantined.push_back(batch[index]);
+          }
+          if (!ingestSpool_->quarantine(quarantined)) {
+            return false;
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.telemetryProcessed += static_cast<int>(telemetry.size());
+        return true;
+      });
+}
+
+void Application::restoreStateSnapshot() {
+  auto snapshot = storage::SnapshotReader::open(runtimeConfig_.snapshotPath);
+  if (!snapshot) {
+    std::cout << "   ℹ️  Снимок состояния не найден, холодный старт"
+              << std::endl;
+    return;
+  }
+
+  size_t alertEntries = alertService_->restoreState(*snapshot);
+  bool rulesRestored = ruleEngine_->restoreState(*snapshot);
+
+  auto ageUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count() -
+               snapshot->createdAtUs();
+  std::cout << "   💾 Состояние восстановлено из снимка ("
+            << std::max<int64_t>(0, ageUs / 1'000'000) << " с назад): "
+            << alertEntries << " записей оповещений, правила: "
+            << (rulesRestored ? "да" : "нет") << std::endl;
+}
+
+bool Application::saveStateSnapshot() {
+  if (!alertService_ || !ruleEngine_) {
+    return false;
+  }
+
+  try {
+    storage::SnapshotWriter snapshot;
+    alertService_->saveState(snapshot);
+    ruleEngine_->saveState(snapshot);
+
+    auto nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+    return snapshot.writeTo(runtimeConfig_.snapshotPath, nowUs);
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка записи снимка состояния: " << e.what()
+              << std::endl;
+    return false;
+  }
+}
+
+void Application::startSnapshotting(int intervalSeconds) {
+  if (snapshotRunning_) {
+    return;
+  }
+
+  snapshotRunning_ = true;
+  snapshotThread_ = std::thread([this, intervalSeconds]() {
+    while (snapshotRunning_ && running_) {
+      for (int i = 0; i < intervalSeconds && snapshotRunning_; i++) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+      }
+      if (snapshotRunning_ && running_) {
+        saveStateSnapshot();
+      }
+    }
+  });
+}
+
+void Application::stopSnapshotting() {
+  snapshotRunning_ = false;
+  if (snapshotThread_.joinable()) {
+    snapshotThread_.join();
+  }
+}
+
 void Application::printWelcomeBanner() const {
   std::cout << R"(
 ╔══════════════════════════════════════════════════════╗
@@ -354,6 +524,99 @@ void Application::loadConfiguration() {
   runtimeConfig_.remotePollingIntervalSeconds =
       remoteConfig.pollingIntervalSeconds;
 
+  // Локальное хранилище временных рядов
+  auto storageConfig = configMgr.getStorageConfig();
+  runtimeConfig_.storageEnabled = storageConfig.enabled;
+  runtimeConfig_.storagePath = storageConfig.path;
+  runtimeConfig_.storageSegmentMaxPoints = storageConfig.segmentMaxPoints;
+  runtimeConfig_.storageSegmentMaxAgeSeconds =
+      storageConfig.segmentMaxAgeSeconds;
+  runtimeConfig_.storageCompactionIntervalSeconds =
+      storageConfig.compactionIntervalSeconds;
+
+  // Окно недавних показаний
+  auto hotWindowConfig = configMgr.getHotWindowConfig();
+  runtimeConfig_.hotWindowEnabled = hotWindowConfig.enabled;
+  runtimeConfig_.hotWindowMemoryBudgetMb = hotWindowConfig.memoryBudgetMb;
+  runtimeConfig_.hotWindowBlockPoints = hotWindowConfig.blockPoints;
+  runtimeConfig_.hotWindowMaxAgeMinutes = hotWindowConfig.maxAgeMinutes;
+
+  // Очередь уведомлений
+  auto notificationConfig = configMgr.getNotificationConfig();
+  runtimeConfig_.notificationWorkers = notificationConfig.workers;
+  runtimeConfig_.notificationQueueCapacity = notificationConfig.queueCapacity;
+  runtimeConfig_.notificationMaxAttempts = notificationConfig.maxAttempts;
+  runtimeConfig_.notificationBaseBackoffMs = notificationConfig.baseBackoffMs;
+  runtimeConfig_.notificationMaxBackoffMs = notificationConfig.maxBackoffMs;
+  runtimeConfig_.notificationCoalesceWindowMs =
+      std::max(0, notificationConfig.coalesceWindowMs);
+  runtimeConfig_.notificationCoalesceMaxAlerts =
+      std::max(1, notificationConfig.coalesceMaxAlerts);
+  runtimeConfig_.notificationEmailDigestWindowMs =
+      std::max(0, notificationConfig.emailDigestWindowMs);
+  runtimeConfig_.notificationSharedOutbox = notificationConfig.sharedOutbox;
+  runtimeConfig_.notificationNodeId = notificationConfig.nodeId;
+  runtimeConfig_.notificationOutboxPollMs =
+      std::max(10, notificationConfig.outboxPollMs);
+  runtimeConfig_.notificationOutboxBatchSize =
+      std::max(1, notificationConfig.outboxBatchSize);
+  runtimeConfig_.notificationOutboxLeaseSeconds =
+      std::max(1, notificationConfig.outboxLeaseSeconds);
+  runtimeConfig_.notificationOutboxRetentionHours =
+      std::max(1, notificationConfig.outboxRetentionHours);
+
+  // Оповещения
+  auto alertConfig = configMgr.getAlertConfig();
+  runtimeConfig_.alertCooldownSeconds =
+      std::max(0, alertConfig.cooldownSeconds);
+  runtimeConfig_.alertWorkerShards = std::max(0, alertConfig.workerShards);
+  runtimeConfig_.alertMaxPerHourPerChat =
+      std::max(0, alertConfig.maxAlertsPerHour);
+  runtimeConfig_.alertMaxPerHourPerDevice =
+      std::max(0, alertConfig.maxAlertsPerHourPerDevice);
+  runtimeConfig_.alertMaxPerHourGlobal =
+      std::max(0, alertConfig.maxAlertsPerHourGlobal);
+  runtimeConfig_.alertTemperatureHysteresis =
+      std::max(0.0, alertConfig.temperatureHysteresis);
+  runtimeConfig_.alertHumidityHysteresis =
+      std::max(0.0, alertConfig.humidityHysteresis);
+  runtimeConfig_.alertRecoveryDwellSeconds =
+      std::max(0, alertConfig.recoveryDwellSeconds);
+  runtimeConfig_.alertMinAlertSeconds =
+      std::max(0, alertConfig.minAlertSeconds);
+  runtimeConfig_.alertThresholdRefreshSeconds =
+      std::max(0, alertConfig.thresholdRefreshSeconds);
+
+  // Журнал приема
+  auto spoolConfig = configMgr.getSpoolConfig();
+  runtimeConfig_.spoolEnabled = spoolConfig.enabled;
+  runtimeConfig_.spoolPath = spoolConfig.path;
+  runtimeConfig_.spoolSegmentMaxMb = spoolConfig.segmentMaxMb;
+  runtimeConfig_.spoolMaxDiskMb = spoolConfig.maxDiskMb;
+  runtimeConfig_.spoolFlushIntervalMs = spoolConfig.flushIntervalMs;
+  runtimeConfig_.spoolReplayBatchSize = spoolConfig.replayBatchSize;
+  runtimeConfig_.spoolReplayRatePerSecond = spoolConfig.replayRatePerSecond;
+
+  // Снимок состояния
+  auto snapshotConfig = configMgr.getSnapshotConfig();
+  runtimeConfig_.snapshotEnabled = snapshotConfig.enabled;
+  runtimeConfig_.snapshotPath = snapshotConfig.path;
+  runtimeConfig_.snapshotIntervalSeconds =
+      std::max(1, snapshotConfig.intervalSeconds);
+
+  // Правила на языке выражений
+  auto rulesConfig = configMgr.getRulesConfig();
+  runtimeConfig_.ruleDefinitionsEnabled = rulesConfig.definitionsEnabled;
+  runtimeConfig_.ruleReloadIntervalSeconds =
+      std::max(0, rulesConfig.reloadIntervalSeconds);
+  runtimeConfig_.offlineTimeoutSeconds =
+      std::max(0, rulesConfig.offlineTimeoutSeconds);
+  runtimeConfig_.anomalyZScore = std::max(0.0, rulesConfig.anomalyZScore);
+  runtimeConfig_.anomalyAlpha =
+      std::min(1.0, std::max(0.001, rulesConfig.anomalyAlpha));
+  runtimeConfig_.anomalyWarmupSamples =
+      std::max(1, rulesConfig.anomalyWarmupSamples);
+
   // Флаг запуска миграций
   runtimeConfig_.runMigrations = configMgr.getBool("RUN_MIGRATIONS", true);
 
@@ -376,6 +639,24 @@ void Application::loadConfiguration() {
             << (runtimeConfig_.remoteDbEnabled ? "enabled" : "disabled")
             << " (интервал: " << runtimeConfig_.remotePollingIntervalSeconds
             << " сек)" << std::endl;
+  std::cout << "   • Локальное хранилище: "
+            << (runtimeConfig_.storageEnabled ? runtimeConfig_.storagePath
+                                              : "disabled")
+            << std::endl;
+  std::cout << "   • Окно недавних показаний: "
+            << (runtimeConfig_.hotWindowEnabled
+                    ? std::to_string(runtimeConfig_.hotWindowMemoryBudgetMb) +
+                          " MB"
+                    : "disabled")
+            << std::endl;
+  std::cout << "   • Журнал приема: "
+            << (runtimeConfig_.spoolEnabled ? runtimeConfig_.spoolPath
+                                            : "disabled")
+            << std::endl;
+  std::cout << "   • Снимок состояния: "
+            << (runtimeConfig_.snapshotEnabled ? runtimeConfig_.snapshotPath
+                                               : "disabled")
+            << std::endl;
 }
 
 void Application::initializeComponents() {
@@ -412,17 +693,20 @@ void Application::initializeComponents() {
   std::cout << "✅" << std::endl;
 }
 
-void Application::initializeDatabase() {
+std::string Application::databaseConnectionString() const {
   // Используем connection string если она есть, иначе строим из параметров
-  std::string connStr = runtimeConfig_.dbConnectionString;
-
-  if (connStr.empty()) {
-    connStr = "host=" + runtimeConfig_.dbHost +
-              " port=" + std::to_string(runtimeConfig_.dbPort) +
-              " dbname=" + runtimeConfig_.dbName +
-              " user=" + runtimeConfig_.dbUser +
-              " password=" + runtimeConfig_.dbPassword;
+  if (!runtimeConfig_.dbConnectionString.empty()) {
+    return runtimeConfig_.dbConnectionString;
   }
+  return "host=" + runtimeConfig_.dbHost +
+         " port=" + std::to_string(runtimeConfig_.dbPort) +
+         " dbname=" + runtimeConfig_.dbName +
+         " user=" + runtimeConfig_.dbUser +
+         " password=" + runtimeConfig_.dbPassword;
+}
+
+void Application::initializeDatabase() {
+  std::string connStr = databaseConnectionString();
 
   // Сначала запускаем миграции, если включено
   if (runtimeConfig_.runMigrations) {
@@ -444,11 +728,98 @@ void Application::initializeDatabase() {
   // Затем инициализируем репозиторий
   database_ = std::make_shared<DatabaseRepository>(connStr);
   database_->initialize();
+
+  // Сжатое окно недавних показаний в памяти
+  if (runtimeConfig_.hotWindowEnabled) {
+    storage::HotWindowCache::Options options;
+    options.memoryBudgetBytes =
+        static_cast<size_t>(std::max(1, runtimeConfig_.hotWindowMemoryBudgetMb))
+        << 20;
+    options.blockPoints =
+        static_cast<size_t>(std::max(1, runtimeConfig_.hotWindowBlockPoints));
+    options.maxAge = std::chrono::minutes(
+        std::max(1, runtimeConfig_.hotWindowMaxAgeMinutes));
+
+    hotWindow_ = std::make_shared<storage::HotWindowCache>(options);
+    database_->attachHotWindow(hotWindow_);
+  }
+
+  // Журнал приема: данные переживают недоступность БД
+  if (runtimeConfig_.spoolEnabled) {
+    storage::IngestSpool::Options options;
+    options.directory = runtimeConfig_.spoolPath;
+    options.segmentMaxBytes =
+        static_cast<size_t>(std::max(1, runtimeConfig_.spoolSegmentMaxMb))
+        << 20;
+    options.maxDiskBytes =
+        static_cast<uint64_t>(std::max(1, runtimeConfig_.spoolMaxDiskMb))
+        << 20;
+    options.flushInterval = std::chrono::milliseconds(
+        std::max(1, runtimeConfig_.spoolFlushIntervalMs));
+    options.replayBatchSize =
+        static_cast<size_t>(std::max(1, runtimeConfig_.spoolReplayBatchSize));
+    options.replayRatePerSecond = static_cast<size_t>(
+        std::max(0, runtimeConfig_.spoolReplayRatePerSecond));
+
+    ingestSpool_ = std::make_shared<storage::IngestSpool>(options);
+    if (ingestSpool_->open()) {
+      database_->attachIngestSpool(ingestSpool_);
+    } else {
+      std::cerr << "\n   ⚠️  Журнал приема недоступен, телеметрия "
+                   "обрабатывается синхронно"
+                << std::endl;
+      ingestSpool_.reset();
+    }
+  }
+
+  // Локальное колоночное хранилище телеметрии
+  if (runtimeConfig_.storageEnabled) {
+    storage::TimeSeriesStore::Options options;
+    options.directory = runtimeConfig_.storagePath;
+    options.segmentMaxPoints = static_cast<size_t>(
+        std::max(1, runtimeConfig_.storageSegmentMaxPoints));
+    options.segmentMaxAge =
+        std::chrono::seconds(runtimeConfig_.storageSegmentMaxAgeSeconds);
+    options.compactionInterval =
+        std::chrono::seconds(runtimeConfig_.storageCompactionIntervalSeconds);
+
+    timeSeriesStore_ = std::make_shared<storage::TimeSeriesStore>(options);
+    if (timeSeriesStore_->open()) {
+      database_->attachLocalStore(timeSeriesStore_);
+    } else {
+      std::cerr << "\n   ⚠️  Локальное хранилище недоступно, история "
+                   "читается из удаленной БД"
+                << std::endl;
+      timeSeriesStore_.reset();
+    }
+  }
 }
 
 void Application::initializeNotificationService() {
-  notifier_ =
-      std::make_shared<NotificationService>(runtimeConfig_.telegramToken);
+  NotificationOutbox::Options outboxOptions;
+  outboxOptions.workers =
+      static_cast<size_t>(std::max(1, runtimeConfig_.notificationWorkers));
+  outboxOptions.queueCapacity = static_cast<size_t>(
+      std::max(1, runtimeConfig_.notificationQueueCapacity));
+  outboxOptions.maxAttempts = runtimeConfig_.notificationMaxAttempts;
+  outboxOptions.baseBackoff = std::chrono::milliseconds(
+      std::max(1, runtimeConfig_.notificationBaseBackoffMs));
+  outboxOptions.maxBackoff = std::chrono::milliseconds(
+      std::max(1, runtimeConfig_.notificationMaxBackoffMs));
+
+  AlertCoalescer::Options coalesceOptions;
+  coalesceOptions.window =
+      std::chrono::milliseconds(runtimeConfig_.notificationCoalesceWindowMs);
+  coalesceOptions.maxBatch =
+      static_cast<size_t>(runtimeConfig_.notificationCoalesceMaxAlerts);
+
+  AlertCoalescer::Options emailDigestOptions = coalesceOptions;
+  emailDigestOptions.window =
+      std::chrono::milliseconds(runtimeConfig_.notificationEmailDigestWindowMs);
+
+  notifier_ = std::make_shared<NotificationService>(
+      runtimeConfig_.telegramToken, outboxOptions, coalesceOptions,
+      emailDigestOptions);
   if (notifier_->isEmailAvailable()) {
     std::cout << "   📧 Testing email connection..." << std::endl;
     bool emailOk = notifier_->testEmailConnection();
@@ -458,16 +829,86 @@ void Application::initializeNotificationService() {
 }
 
 void Application::initializeRuleEngine() {
+  services::AlertStateTracker::Options hysteresis;
+  hysteresis.temperatureHysteresis = runtimeConfig_.alertTemperatureHysteresis;
+  hysteresis.humidityHysteresis = runtimeConfig_.alertHumidityHysteresis;
+  hysteresis.recoveryDwell =
+      std::chrono::seconds(runtimeConfig_.alertRecoveryDwellSeconds);
+  hysteresis.minAlertDuration =
+      std::chrono::seconds(runtimeConfig_.alertMinAlertSeconds);
+
+  services::AlertRateLimiter::Options rateLimits;
+  rateLimits.maxPerHourPerChat = runtimeConfig_.alertMaxPerHourPerChat;
+  rateLimits.maxPerHourPerDevice = runtimeConfig_.alertMaxPerHourPerDevice;
+  rateLimits.maxPerHourGlobal = runtimeConfig_.alertMaxPerHourGlobal;
+
   alertService_ =
-      std::make_shared<services::AlertProcessingService>(database_, notifier_);
+      std::make_shared<services::AlertProcessingService>(
+          database_, notifier_,
+          std::chrono::seconds(runtimeConfig_.alertCooldownSeconds),
+          static_cast<size_t>(runtimeConfig_.alertWorkerShards), hysteresis,
+          rateLimits);
+
+  if (runtimeConfig_.notificationSharedOutbox) {
+    SharedNotificationOutbox::Options outboxOptions;
+    outboxOptions.nodeId = runtimeConfig_.notificationNodeId;
+    outboxOptions.pollInterval =
+        std::chrono::milliseconds(runtimeConfig_.notificationOutboxPollMs);
+    outboxOptions.batchSize =
+        static_cast<size_t>(runtimeConfig_.notificationOutboxBatchSize);
+    outboxOptions.lease =
+        std::chrono::seconds(runtimeConfig_.notificationOutboxLeaseSeconds);
+    outboxOptions.maxAttempts = runtimeConfig_.notificationMaxAttempts;
+    outboxOptions.baseBackoff = std::chrono::milliseconds(
+        std::max(1, runtimeConfig_.notificationBaseBackoffMs));
+    outboxOptions.maxBackoff = std::chrono::milliseconds(
+        std::max(1, runtimeConfig_.notificationMaxBackoffMs));
+    outboxOptions.retention =
+        std::chrono::hours(runtimeConfig_.notificationOutboxRetentionHours);
+
+    // Завершенные записи переживают окно подавления (cooldown), иначе
+    // то же событие вставится повторно
+    outboxOptions.retention = std::max(
+        outboxOptions.retention,
+        std::chrono::duration_cast<std::chrono::hours>(
+            std::chrono::seconds(runtimeConfig_.alertCooldownSeconds)) +
+            std::chrono::hours(1));
+
+    sharedOutbox_ =
+        std::make_shared<SharedNotificationOutbox>(database_, outboxOptions);
+    auto notifier = notifier_;
+    sharedOutbox_->start([notifier](const NotificationJob& job) {
+      return notifier->deliverNow(job);
+    });
+    alertService_->attachSharedOutbox(
+        sharedOutbox_,
+        std::chrono::seconds(runtimeConfig_.alertThresholdRefreshSeconds));
+  }
 
-  ruleEngine_ = std::make_shared<engine::RuleEngine>(database_, alertService_);
+  ruleEngine_ = std::make_shared<engine::RuleEngine>(
+      database_, alertService_,
+      std::chrono::seconds(runtimeConfig_.offlineTimeoutSeconds));
   ruleEngine_->setupDefaultRules();
+  if (runtimeConfig_.anomalyZScore > 0) {
+    engine::AnomalyDetector::Options anomalyOptions;
+    anomalyOptions.zScore = runtimeConfig_.anomalyZScore;
+    anomalyOptions.alpha = runtimeConfig_.anomalyAlpha;
+    anomalyOptions.warmupSamples =
+        static_cast<uint32_t>(runtimeConfig_.anomalyWarmupSamples);
+    ruleEngine_->enableAnomalyDetection(anomalyOptions);
+  }
+  if (runtimeConfig_.ruleDefinitionsEnabled) {
+    reloadRuleDefinitions();
+  }
+
+  if (runtimeConfig_.snapshotEnabled) {
+    restoreStateSnapshot();
+  }
 }
 
 void Application::initializeHttpServer() {
-  httpServer_ = std::make_unique<api::TelemetryServer>(database_, alertService_,
-                                                       notifier_);
+  httpServer_ = std::make_unique<api::TelemetryServer>(
+      database_, alertService_, notifier_, ruleEngine_);
 }
 
 void Application::initializeTelegramBot() {
@@ -505,9 +946,28 @@ void Application::setupSignalHandlers() {
   std::signal(SIGTERM, signalHandler);
 }
 
+void Application::reloadRuleDefinitions() {
+  // Состав групп - для правил с областью группы
+  std::vector<models::DeviceGroup> groups;
+  std::vector<models::GroupAlertRule> groupRules;
+  if (database_->loadDeviceGroups(groups, groupRules)) {
+    ruleEngine_->setDeviceGroups(groups);
+  }
+
+  std::vector<models::RuleDefinition> definitions;
+  if (!database_->getRuleDefinitions(definitions)) {
+    return;
+  }
+  // Новый набор публикуется атомарно - прием не приостанавливается
+  ruleEngine_->applyRuleDefinitions(definitions);
+}
+
 void Application::runMainLoop() {
   auto lastStatusTime = std::chrono::steady_clock::now();
+  auto lastRulesReload = lastStatusTime;
   const auto statusInterval = std::chrono::seconds(30);
+  const auto rulesReloadInterval =
+      std::chrono::seconds(runtimeConfig_.ruleReloadIntervalSeconds);
 
   while (running_) {
     std::this_thread::sleep_for(std::chrono::seconds(2));
@@ -523,8 +983,19 @@ void Application::runMainLoop() {
       }
     }
 
-    // Periodic status report
+    // Hot reload of rule definitions
     auto now = std::chrono::steady_clock::now();
+    if (runtimeConfig_.ruleDefinitionsEnabled &&
+        rulesReloadInterval.count() > 0 &&
+        now - lastRulesReload >= rulesReloadInterval) {
+      reloadRuleDefinitions();
+      lastRulesReload = now;
+    }
+
+    // Устройства, переставшие присылать данные
+    ruleEngine_->checkHeartbeats();
+
+    // Periodic status report
     if (now - lastStatusTime >= statusInterval) {
       printStatusReport();
       lastStatusTime = now;
@@ -605,6 +1076,99 @@ void Application::printStatusReport() const {
   if (ruleEngine_) {
     auto ruleStats = ruleEngine_->getStatistics();
     std::cout << "   • Rules Triggered: " << ruleStats.rulesTriggered << "\n";
+    auto heartbeats = ruleEngine_->getHeartbeatStatistics();
+    std::cout << "   • Devices Offline: " << heartbeats.offline << " of "
+              << heartbeats.tracked << "\n";
+    auto anomalies = ruleEngine_->getAnomalyStatistics();
+    std::cout << "   • Anomalies Detected: " << anomalies.anomalies << "\n";
+  }
+}
+
+int Application::runBacktest(int days) {
+  try {
+    loadConfiguration();
+    auto database =
+        std::make_shared<DatabaseRepository>(databaseConnectionString());
+    database->initialize();
+
+    // Текущее состояние: встроенные правила, поверх них - одноименные и
+    // новые из rule_definitions (как в RuleEngine)
+    engine::Backtester::Scenario scenario;
+    scenario.rules = engine::Backtester::defaultRules();
+    std::vector<models::RuleDefinition> definitions;
+    if (runtimeConfig_.ruleDefinitionsEnabled &&
+        database->getRuleDefinitions(definitions)) {
+      for (const auto& definition : definitions) {
+        auto existing = std::find_if(
+            scenario.rules.begin(), scenario.rules.end(),
+            [&definition](const models::RuleDefinition& rule) {
+              return rule.name == definition.name;
+            });
+        if (existing != scenario.rules.end()) {
+          *existing = definition;
+        } else {
+          scenario.rules.push_back(definition);
+        }
+      }
+    }
+    std::vector<models::GroupAlertRule> groupRules;
+    database->loadDeviceGroups(scenario.groups, groupRules);
+
+    scenario.hysteresis.temperatureHysteresis =
+        runtimeConfig_.alertTemperatureHysteresis;
+    scenario.hysteresis.humidityHysteresis =
+        runtimeConfig_.alertHumidityHysteresis;
+    scenario.hysteresis.recoveryDwell =
+        std::chrono::seconds(runtimeConfig_.alertRecoveryDwellSeconds);
+    scenario.hysteresis.minAlertDuration =
+        std::chrono::seconds(runtimeConfig_.alertMinAlertSeconds);
+    scenario.cooldown =
+        std::chrono::seconds(runtimeConfig_.alertCooldownSeconds);
+    scenario.anomalyDetection = runtimeConfig_.anomalyZScore > 0;
+    scenario.anomaly.zScore = runtimeConfig_.anomalyZScore;
+    scenario.anomaly.alpha = runtimeConfig_.anomalyAlpha;
+    scenario.anomaly.warmupSamples =
+        static_cast<uint32_t>(runtimeConfig_.anomalyWarmupSamples);
+
+    // Показания приходят в удаленную БД; в локальную попадает только
+    // журнал приема, поэтому она - запасной источник
+    std::string source;
+    if (runtimeConfig_.remoteDbEnabled &&
+        !runtimeConfig_.remoteDbConnectionString.empty()) {
+      source = runtimeConfig_.remoteDbConnectionString;
+      std::cout << "📼 Telemetry source: remote database" << std::endl;
+    } else {
+      std::cout << "📼 Telemetry source: local database (remote database "
+                   "not configured)"
+                << std::endl;
+    }
+
+    engine::Backtester backtester(
+        [database, source](int64_t fromUs, int64_t toUs,
+                           const engine::Backtester::Sink& sink) {
+          return database->streamTelemetry(fromUs, toUs, sink, source);
+        },
+        [database](
+            const std::string& deviceId,
+            std::vector<std::pair<long, models::UserAlert>>& subscribers) {
+          return database->getDeviceSubscriberAlerts(deviceId, subscribers);
+        });
+
+    int64_t toUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+    int64_t fromUs = toUs - static_cast<int64_t>(std::max(1, days)) *
+                                24 * 3600 * 1000000;
+    std::cout << "📼 Backtest: " << scenario.rules.size() << " rules, "
+              << std::max(1, days) << " days of telemetry..." << std::endl;
+
+    auto report = backtester.run(scenario, fromUs, toUs);
+    std::cout << engine::Backtester::formatReport(report) << std::endl;
+    return report.completed ? 0 : 1;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Backtest failed: " << e.what() << std::endl;
+    return 1;
   }
 }
 
@@ -12,6 +12,7 @@ namespace iot_core {
 namespace core {
 class DatabaseRepository;
 class NotificationService;
+class SharedNotificationOutbox;
 class ConfigManager;
 }  // namespace core
 
@@ -38,6 +39,12 @@ class RuleEngine;
 namespace models {
 struct UserAlert;
 }
+
+namespace storage {
+class HotWindowCache;
+class IngestSpool;
+class TimeSeriesStore;
+}
 }  // namespace iot_core
 
 namespace iot_core::core {
@@ -56,6 +63,11 @@ class Application {
   // Shutdown gracefully
   void shutdown();
 
+  // Прогон телеметрии за последние days дней через текущие правила и
+  // пороги пользователей (см. engine::Backtester): только локальная БД,
+  // без сервера, бота и уведомлений. Отчет - в stdout; код выхода
+  int runBacktest(int days);
+
   // Setup test user with default configuration
   void setupTestUser(long telegramId);
 
@@ -82,6 +94,7 @@ class Application {
   void loadConfiguration();
   void initializeComponents();
   void initializeDatabase();
+  std::string databaseConnectionString() const;
   void initializeNotificationService();
   void initializeRuleEngine();
   void initializeHttpServer();
@@ -98,6 +111,19 @@ class Application {
   void startRemotePolling(int intervalSeconds);
   void stopRemotePolling();
 
+  // Загрузка журнала приема в БД с последующей проверкой оповещений
+  void startSpoolReplay();
+
+  // Снимок состояния в памяти: восстановление при запуске,
+  // периодическая запись и финальная запись при остановке
+  void restoreStateSnapshot();
+  bool saveStateSnapshot();
+  void startSnapshotting(int intervalSeconds);
+  void stopSnapshotting();
+
+  // Перечитывает rule_definitions; при ошибке БД правила не меняются
+  void reloadRuleDefinitions();
+
   // Runtime configuration
   struct RuntimeConfig {
     // Database
@@ -122,15 +148,83 @@ class Application {
     int simulationDeviceCount;
     int simulationUpdateIntervalMs;
 
+    // Очередь уведомлений
+    int notificationWorkers = 4;
+    int notificationQueueCapacity = 10000;
+    int notificationMaxAttempts = 5;
+    int notificationBaseBackoffMs = 1000;
+    int notificationMaxBackoffMs = 60000;
+    int notificationCoalesceWindowMs = 3000;
+    int notificationCoalesceMaxAlerts = 50;
+    int notificationEmailDigestWindowMs = 10000;
+    bool notificationSharedOutbox = false;
+    std::string notificationNodeId;
+    int notificationOutboxPollMs = 500;
+    int notificationOutboxBatchSize = 100;
+    int notificationOutboxLeaseSeconds = 60;
+    int notificationOutboxRetentionHours = 24;
+
+    // Оповещения
+    int alertCooldownSeconds = 300;
+    int alertWorkerShards = 0;
+    int alertMaxPerHourPerChat = 60;
+    int alertMaxPerHourPerDevice = 120;
+    int alertMaxPerHourGlobal = 1000;
+    double alertTemperatureHysteresis = 0.5;
+    double alertHumidityHysteresis = 2.0;
+    int alertRecoveryDwellSeconds = 60;
+    int alertMinAlertSeconds = 0;
+    int alertThresholdRefreshSeconds = 30;
+
     // НОВОЕ: Конфигурация удаленной БД
     bool remoteDbEnabled = false;
     std::string remoteDbConnectionString;
     int remotePollingIntervalSeconds = 30;
+
+    // Локальное хранилище временных рядов
+    bool storageEnabled = false;
+    std::string storagePath;
+    int storageSegmentMaxPoints = 4096;
+    int storageSegmentMaxAgeSeconds = 3600;
+    int storageCompactionIntervalSeconds = 300;
+
+    // Окно недавних показаний в памяти
+    bool hotWindowEnabled = true;
+    int hotWindowMemoryBudgetMb = 32;
+    int hotWindowBlockPoints = 256;
+    int hotWindowMaxAgeMinutes = 1440;
+
+    // Журнал приема телеметрии
+    bool spoolEnabled = false;
+    std::string spoolPath;
+    int spoolSegmentMaxMb = 8;
+    int spoolMaxDiskMb = 512;
+    int spoolFlushIntervalMs = 20;
+    int spoolReplayBatchSize = 500;
+    int spoolReplayRatePerSecond = 2000;
+
+    // Снимок состояния
+    bool snapshotEnabled = true;
+    std::string snapshotPath;
+    int snapshotIntervalSeconds = 60;
+
+    // Правила из rule_definitions
+    bool ruleDefinitionsEnabled = true;
+    int ruleReloadIntervalSeconds = 30;
+    int offlineTimeoutSeconds = 300;
+    double anomalyZScore = 4.0;
+    double anomalyAlpha = 0.05;
+    int anomalyWarmupSamples = 30;
   } runtimeConfig_;
 
   // Application components
   std::shared_ptr<DatabaseRepository> database_;
+  std::shared_ptr<storage::TimeSeriesStore> timeSeriesStore_;
+  std::shared_ptr<storage::HotWindowCache> hotWindow_;
+  std::shared_ptr<storage::IngestSpool> ingestSpool_;
   std::shared_ptr<NotificationService> notifier_;
+  // Общая очередь уведомлений в БД (несколько экземпляров)
+  std::shared_ptr<SharedNotificationOutbox> sharedOutbox_;
   std::shared_ptr<services::AlertProcessingService> alertService_;
   std::shared_ptr<engine::RuleEngine> ruleEngine_;
   std::unique_ptr<api::TelemetryServer> httpServer_;
@@ -141,6 +235,10 @@ class Application {
   std::thread pollingThread_;
   std::atomic<bool> pollingRunning_{false};
 
+  // Поток периодической записи снимка состояния
+  std::thread snapshotThread_;
+  std::atomic<bool> snapshotRunning_{false};
+
   // State
   std::atomic<bool> running_{false};
   std::atomic<bool> initialized_{false};
@@ -264,10 +264,50 @@ ConfigManager::AlertConfig ConfigManager::getAlertConfig() const {
   AlertConfig alert;
   alert.cacheDurationMinutes = getInt("alerts.cache_duration_minutes", 5);
   alert.maxAlertsPerHour = getInt("alerts.max_alerts_per_hour", 60);
+  alert.maxAlertsPerHourPerDevice =
+      getInt("alerts.max_alerts_per_hour_per_device", 120);
+  alert.maxAlertsPerHourGlobal =
+      getInt("alerts.max_alerts_per_hour_global", 1000);
   alert.cooldownSeconds = getInt("alerts.cooldown_seconds", 300);
+  alert.workerShards = getInt("alerts.worker_shards", 0);
+  alert.temperatureHysteresis =
+      getDouble("alerts.temperature_hysteresis", 0.5);
+  alert.humidityHysteresis = getDouble("alerts.humidity_hysteresis", 2.0);
+  alert.recoveryDwellSeconds = getInt("alerts.recovery_dwell_seconds", 60);
+  alert.minAlertSeconds = getInt("alerts.min_alert_seconds", 0);
+  alert.thresholdRefreshSeconds =
+      getInt("alerts.threshold_refresh_seconds", 30);
   return alert;
 }
 
+ConfigManager::NotificationConfig ConfigManager::getNotificationConfig()
+    const {
+  NotificationConfig notifications;
+  notifications.workers = getInt("notifications.workers", 4);
+  notifications.queueCapacity = getInt("notifications.queue_capacity", 10000);
+  notifications.maxAttempts = getInt("notifications.max_attempts", 5);
+  notifications.baseBackoffMs = getInt("notifications.base_backoff_ms", 1000);
+  notifications.maxBackoffMs = getInt("notifications.max_backoff_ms", 60000);
+  notifications.coalesceWindowMs =
+      getInt("notifications.coalesce_window_ms", 3000);
+  notifications.coalesceMaxAlerts =
+      getInt("notifications.coalesce_max_alerts", 50);
+  notifications.emailDigestWindowMs =
+      getInt("notifications.email_digest_window_ms", 10000);
+  notifications.sharedOutbox = getBool(
+      "SHARED_OUTBOX", getBool("notifications.shared_outbox", false));
+  notifications.nodeId =
+      getString("NODE_ID", getString("notifications.node_id", ""));
+  notifications.outboxPollMs = getInt("notifications.outbox_poll_ms", 500);
+  notifications.outboxBatchSize =
+      getInt("notifications.outbox_batch_size", 100);
+  notifications.outboxLeaseSeconds =
+      getInt("notifications.outbox_lease_seconds", 60);
+  notifications.outboxRetentionHours =
+      getInt("notifications.outbox_retention_hours", 24);
+  return notifications;
+}
+
 // НОВЫЙ МЕТОД: Получение конфигурации удаленной БД
 ConfigManager::RemoteDatabaseConfig ConfigManager::getRemoteDatabaseConfig()
     const {
@@ -297,6 +337,62 @@ ConfigManager::RemoteDatabaseConfig ConfigManager::getRemoteDatabaseConfig()
   return remote;
 }
 
+ConfigManager::StorageConfig ConfigManager::getStorageConfig() const {
+  StorageConfig storage;
+  storage.enabled =
+      getBool("STORAGE_ENABLED", getBool("storage.enabled", false));
+  storage.path =
+      getString("STORAGE_PATH", getString("storage.path", "data/tsdb"));
+  storage.segmentMaxPoints = getInt("storage.segment_max_points", 4096);
+  storage.segmentMaxAgeSeconds =
+      getInt("storage.segment_max_age_seconds", 3600);
+  storage.compactionIntervalSeconds =
+      getInt("storage.compaction_interval_seconds", 300);
+  return storage;
+}
+
+ConfigManager::HotWindowConfig ConfigManager::getHotWindowConfig() const {
+  HotWindowConfig hotWindow;
+  hotWindow.enabled = getBool("hot_window.enabled", true);
+  hotWindow.memoryBudgetMb = getInt("HOT_WINDOW_MEMORY_MB",
+                                    getInt("hot_window.memory_budget_mb", 32));
+  hotWindow.blockPoints = getInt("hot_window.block_points", 256);
+  hotWindow.maxAgeMinutes = getInt("hot_window.max_age_minutes", 1440);
+  return hotWindow;
+}
+
+ConfigManager::SpoolConfig ConfigManager::getSpoolConfig() const {
+  SpoolConfig spool;
+  spool.enabled = getBool("SPOOL_ENABLED", getBool("spool.enabled", false));
+  spool.path = getString("SPOOL_PATH", getString("spool.path", "data/spool"));
+  spool.segmentMaxMb = getInt("spool.segment_max_mb", 8);
+  spool.maxDiskMb = getInt("spool.max_disk_mb", 512);
+  spool.flushIntervalMs = getInt("spool.flush_interval_ms", 20);
+  spool.replayBatchSize = getInt("spool.replay_batch_size", 500);
+  spool.replayRatePerSecond = getInt("spool.replay_rate_per_second", 2000);
+  return spool;
+}
+
+ConfigManager::SnapshotConfig ConfigManager::getSnapshotConfig() const {
+  SnapshotConfig snapshot;
+  snapshot.enabled = getBool("snapshot.enabled", true);
+  snapshot.path = getString("SNAPSHOT_PATH",
+                            getString("snapshot.path", "data/state.snap"));
+  snapshot.intervalSeconds = getInt("snapshot.interval_seconds", 60);
+  return snapshot;
+}
+
+ConfigManager::RulesConfig ConfigManager::getRulesConfig() const {
+  RulesConfig rules;
+  rules.definitionsEnabled = getBool("rules.definitions_enabled", true);
+  rules.reloadIntervalSeconds = getInt("rules.reload_interval_seconds", 30);
+  rules.offlineTimeoutSeconds = getInt("rules.offline_timeout_seconds", 300);
+  rules.anomalyZScore = getDouble("rules.anomaly_z_score", 4.0);
+  rules.anomalyAlpha = getDouble("rules.anomaly_alpha", 0.05);
+  rules.anomalyWarmupSamples = getInt("rules.anomaly_warmup_samples", 30);
+  return rules;
+}
+
 void ConfigManager::loadDefaults() {
   // Database
   config_["database.host"] = "localhost";
@@ -319,6 +415,22 @@ void ConfigManager::loadDefaults() {
   config_["telegram.token"] = "";
   config_["telegram.parse_mode"] = "Markdown";
 
+  // Notification outbox
+  config_["notifications.workers"] = "4";
+  config_["notifications.queue_capacity"] = "10000";
+  config_["notifications.max_attempts"] = "5";
+  config_["notifications.base_backoff_ms"] = "1000";
+  config_["notifications.max_backoff_ms"] = "60000";
+  config_["notifications.coalesce_window_ms"] = "3000";
+  config_["notifications.coalesce_max_alerts"] = "50";
+  config_["notifications.email_digest_window_ms"] = "10000";
+  config_["notifications.shared_outbox"] = "false";
+  config_["notifications.node_id"] = "";
+  config_["notifications.outbox_poll_ms"] = "500";
+  config_["notifications.outbox_batch_size"] = "100";
+  config_["notifications.outbox_lease_seconds"] = "60";
+  config_["notifications.outbox_retention_hours"] = "24";
+
   // Email
   config_["email.enabled"] = "false";
   config_["email.smtp_host"] = "smtp.gmail.com";
@@ -343,7 +455,50 @@ void ConfigManager::loadDefaults() {
   // Alerts
   config_["alerts.cache_duration_minutes"] = "5";
   config_["alerts.max_alerts_per_hour"] = "60";
+  config_["alerts.max_alerts_per_hour_per_device"] = "120";
+  config_["alerts.max_alerts_per_hour_global"] = "1000";
   config_["alerts.cooldown_seconds"] = "300";
+  config_["alerts.worker_shards"] = "0";
+  config_["alerts.temperature_hysteresis"] = "0.5";
+  config_["alerts.humidity_hysteresis"] = "2.0";
+  config_["alerts.recovery_dwell_seconds"] = "60";
+  config_["alerts.min_alert_seconds"] = "0";
+  config_["alerts.threshold_refresh_seconds"] = "30";
+
+  // Storage
+  config_["storage.enabled"] = "false";
+  config_["storage.path"] = "data/tsdb";
+  config_["storage.segment_max_points"] = "4096";
+  config_["storage.segment_max_age_seconds"] = "3600";
+  config_["storage.compaction_interval_seconds"] = "300";
+
+  // Hot window
+  config_["hot_window.enabled"] = "true";
+  config_["hot_window.memory_budget_mb"] = "32";
+  config_["hot_window.block_points"] = "256";
+  config_["hot_window.max_age_minutes"] = "1440";
+
+  // Ingest spool
+  config_["spool.enabled"] = "false";
+  config_["spool.path"] = "data/spool";
+  config_["spool.segment_max_mb"] = "8";
+  config_["spool.max_disk_mb"] = "512";
+  config_["spool.flush_interval_ms"] = "20";
+  config_["spool.replay_batch_size"] = "500";
+  config_["spool.replay_rate_per_second"] = "2000";
+
+  // State snapshot
+  config_["snapshot.enabled"] = "true";
+  config_["snapshot.path"] = "data/state.snap";
+  config_["snapshot.interval_seconds"] = "60";
+
+  // Rule definitions
+  config_["rules.definitions_enabled"] = "true";
+  config_["rules.reload_interval_seconds"] = "30";
+  config_["rules.offline_timeout_seconds"] = "300";
+  config_["rules.anomaly_z_score"] = "4.0";
+  config_["rules.anomaly_alpha"] = "0.05";
+  config_["rules.anomaly_warmup_samples"] = "30";
 
   // НОВЫЕ ДЕФОЛТЫ: Удаленная БД
   config_["REMOTE_DB_ENABLED"] = "false";
@@ -465,7 +620,9 @@ bool ConfigManager::loadFromEnvironment() {
       "LOG_LEVEL", "RUN_MIGRATIONS",
       // НОВЫЕ ПЕРЕМЕННЫЕ ДЛЯ УДАЛЕННОЙ БД
       "REMOTE_DB_ENABLED", "REMOTE_DB_HOST", "REMOTE_DB_PORT", "REMOTE_DB_NAME",
-      "REMOTE_DB_USER", "REMOTE_DB_PASSWORD", "REMOTE_POLLING_INTERVAL"};
+      "REMOTE_DB_USER", "REMOTE_DB_PASSWORD", "REMOTE_POLLING_INTERVAL",
+      "STORAGE_ENABLED", "STORAGE_PATH", "HOT_WINDOW_MEMORY_MB",
+      "SPOOL_ENABLED", "SPOOL_PATH", "SNAPSHOT_PATH"};
 
   for (const auto& var : envVars) {
     const char* value = std::getenv(var.c_str());
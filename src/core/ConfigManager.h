@@ -76,8 +76,18 @@ class ConfigManager {
 
   struct AlertConfig {
     int cacheDurationMinutes;
-    int maxAlertsPerHour;
+    int maxAlertsPerHour;  // на чат; 0 - без ограничения
+    int maxAlertsPerHourPerDevice;
+    int maxAlertsPerHourGlobal;
     int cooldownSeconds;
+    int workerShards;  // 0 - по числу ядер
+    // Гистерезис: запас возврата в норму и минимальные длительности
+    double temperatureHysteresis;
+    double humidityHysteresis;
+    int recoveryDwellSeconds;
+    int minAlertSeconds;
+    // Перечитывание порогов при общей очереди уведомлений; 0 - нет
+    int thresholdRefreshSeconds;
   };
 
   // НОВАЯ СТРУКТУРА: Конфигурация удаленной БД
@@ -92,6 +102,75 @@ class ConfigManager {
     bool enabled = false;
   };
 
+  // Очередь исходящих уведомлений
+  struct NotificationConfig {
+    int workers = 4;
+    int queueCapacity = 10000;
+    int maxAttempts = 5;
+    int baseBackoffMs = 1000;
+    int maxBackoffMs = 60000;
+    // Окно объединения оповещений чата в сводку; 0 - без объединения
+    int coalesceWindowMs = 3000;
+    int coalesceMaxAlerts = 50;
+    // Окно сводки email-оповещений; 0 - письмо на каждое оповещение
+    int emailDigestWindowMs = 10000;
+    // Общая очередь в PostgreSQL для нескольких экземпляров
+    bool sharedOutbox = false;
+    std::string nodeId;  // пусто - имя хоста и pid
+    int outboxPollMs = 500;
+    int outboxBatchSize = 100;
+    int outboxLeaseSeconds = 60;
+    int outboxRetentionHours = 24;
+  };
+
+  // Встроенное колоночное хранилище телеметрии
+  struct StorageConfig {
+    bool enabled = false;
+    std::string path = "data/tsdb";
+    int segmentMaxPoints = 4096;
+    int segmentMaxAgeSeconds = 3600;
+    int compactionIntervalSeconds = 300;
+  };
+
+  // Сжатое окно недавних показаний в памяти
+  struct HotWindowConfig {
+    bool enabled = true;
+    int memoryBudgetMb = 32;
+    int blockPoints = 256;
+    int maxAgeMinutes = 1440;
+  };
+
+  // Журнал приема телеметрии (буфер на случай недоступности БД)
+  struct SpoolConfig {
+    bool enabled = false;
+    std::string path = "data/spool";
+    int segmentMaxMb = 8;
+    int maxDiskMb = 512;
+    int flushIntervalMs = 20;
+    int replayBatchSize = 500;
+    int replayRatePerSecond = 2000;
+  };
+
+  // Снимок состояния в памяти для быстрого перезапуска
+  struct SnapshotConfig {
+    bool enabled = true;
+    std::string path = "data/state.snap";
+    int intervalSeconds = 60;
+  };
+
+  // Правила на языке выражений из таблицы rule_definitions
+  struct RulesConfig {
+    bool definitionsEnabled = true;
+    int reloadIntervalSeconds = 30;  // 0 - только при запуске
+    // Устройство без данных дольше этого - offline; 0 - не следить
+    int offlineTimeoutSeconds = 300;
+    // Аномалии по EWMA: порог z-оценки (0 - не искать), вес нового
+    // показания и число показаний на обучение
+    double anomalyZScore = 4.0;
+    double anomalyAlpha = 0.05;
+    int anomalyWarmupSamples = 30;
+  };
+
   // Get structured configs
   DatabaseConfig getDatabaseConfig() const;
   ServerConfig getServerConfig() const;
@@ -100,7 +179,13 @@ class ConfigManager {
   SimulationConfig getSimulationConfig() const;
   LoggingConfig getLoggingConfig() const;
   AlertConfig getAlertConfig() const;
+  NotificationConfig getNotificationConfig() const;
   RemoteDatabaseConfig getRemoteDatabaseConfig() const;  // НОВЫЙ МЕТОД
+  StorageConfig getStorageConfig() const;
+  HotWindowConfig getHotWindowConfig() const;
+  SpoolConfig getSpoolConfig() const;
+  SnapshotConfig getSnapshotConfig() const;
+  RulesConfig getRulesConfig() const;
 
   // Info
   bool isLoaded() const { return loaded_; }
@@ -1,10 +1,70 @@
 #include "Database.h"
 
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 
+#include "../storage/HotWindowCache.h"
+#include "../storage/IngestSpool.h"
+#include "../storage/TimeSeriesStore.h"
+#include "../utils/Formatter.h"
+
 namespace iot_core::core {
 
+namespace {
+
+std::vector<models::IoTData> toTelemetry(
+    const std::string& deviceId,
+    const std::vector<storage::DataPoint>& points) {
+  std::vector<models::IoTData> telemetry;
+  telemetry.reserve(points.size());
+  for (const auto& point : points) {
+    models::IoTData data;
+    data.deviceId = deviceId;
+    data.temperature = point.temperature;
+    data.humidity = point.humidity;
+    data.timestampUs = point.timestampUs;
+    telemetry.push_back(std::move(data));
+  }
+  return telemetry;
+}
+
+// Массив идентификаторов в виде литерала PostgreSQL: {1,2,3}
+std::string toArrayLiteral(const std::vector<int64_t>& ids) {
+  std::string literal = "{";
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (i > 0) {
+      literal += ',';
+    }
+    literal += std::to_string(ids[i]);
+  }
+  literal += '}';
+  return literal;
+}
+
+// Местное время БД (см. Formatter::fromLocalWallClock) в Unix-время.
+// Смещение зоны меняется только на границе часа, а строки идут по
+// времени, поэтому mktime вызывается раз на час показаний
+class WallClockConverter {
+ public:
+  int64_t toTimestamp(int64_t wallClockUs) {
+    int64_t hour = wallClockUs / kHourUs;
+    if (hour != hour_) {
+      hour_ = hour;
+      offsetUs_ = hour * kHourUs -
+                  utils::Formatter::fromLocalWallClock(hour * kHourUs);
+    }
+    return wallClockUs - offsetUs_;
+  }
+
+ private:
+  static constexpr int64_t kHourUs = int64_t{3600} * 1000000;
+  int64_t hour_ = INT64_MIN;
+  int64_t offsetUs_ = 0;
+};
+
+}  // namespace
+
 DatabaseRepository::DatabaseRepository(const std::string& connectionString)
     : connectionString_(connectionString) {
   std::cout << "🔧 Создание репозитория базы данных..." << std::endl;
@@ -68,13 +128,31 @@ bool DatabaseRepository::isRemoteConnected() const {
 }
 
 std::vector<models::IoTData> DatabaseRepository::getRemoteTelemetry(
-    const std::string& deviceId, int limit) {
+    const std::string& deviceId, int limit, int64_t sinceUs) {
   if (!isRemoteConnected()) {
     std::cerr << "❌ Нет подключения к удаленной БД" << std::endl;
     return {};
   }
 
-  return remoteConnection_->getTelemetryData(deviceId, limit);
+  auto telemetry =
+      remoteConnection_->getTelemetryData(deviceId, limit, sinceUs);
+
+  // Свежий срез удаленной БД дополняет окно недавних показаний
+  auto hotWindow = std::atomic_load(&hotWindow_);
+  if (hotWindow && !deviceId.empty() && !telemetry.empty()) {
+    std::vector<storage::DataPoint> points;
+    points.reserve(telemetry.size());
+    for (const auto& item : telemetry) {
+      storage::DataPoint point;
+      point.timestampUs = item.timestampUs;
+      point.temperature = item.temperature;
+      point.humidity = item.humidity;
+      points.push_back(point);
+    }
+    hotWindow->mergeSnapshot(deviceId, std::move(points));
+  }
+
+  return telemetry;
 }
 
 std::vector<models::IoTData>
@@ -115,7 +193,8 @@ std::vector<std::string> DatabaseRepository::getAllSubscribedDevices() {
   return devices;
 }
 
-// УДАЛЕН МЕТОД saveTelemetryData - больше не сохраняем телеметрию локально
+// УДАЛЕН МЕТОД saveTelemetryData - телеметрия попадает в локальную БД
+// только через журнал приема (saveTelemetryBatch)
 
 // ВСЕ ОСТАЛЬНЫЕ МЕТОДЫ ОСТАЮТСЯ БЕЗ ИЗМЕНЕНИЙ (копируем из существующего файла)
 
@@ -145,10 +224,248 @@ std::vector<models::IoTData> DatabaseRepository::getRecentTelemetry(int limit) {
 
 std::vector<models::IoTData> DatabaseRepository::getDeviceTelemetry(
     const std::string& deviceId, int limit) {
-  // Теперь этот метод возвращает данные из удаленной БД
+  auto hotWindow = std::atomic_load(&hotWindow_);
+  std::vector<storage::DataPoint> recent;
+  if (hotWindow && limit > 0 &&
+      hotWindow->latest(deviceId, static_cast<size_t>(limit), recent)) {
+    return toTelemetry(deviceId, recent);
+  }
+
+  auto store = std::atomic_load(&localStore_);
+  if (store && store->isOpen() && limit > 0) {
+    // Локальное хранилище отвечает, если в нем достаточно истории
+    // или удаленная БД недоступна
+    uint64_t available = store->pointCount(deviceId);
+    if (available >= static_cast<uint64_t>(limit) ||
+        (available > 0 && !isRemoteConnected())) {
+      return toTelemetry(deviceId,
+                         store->query(deviceId, INT64_MIN, INT64_MAX,
+                                      static_cast<size_t>(limit)));
+    }
+  }
+
+  // Иначе данные берутся из удаленной БД
   return getRemoteTelemetry(deviceId, limit);
 }
 
+void DatabaseRepository::attachLocalStore(
+    std::shared_ptr<storage::TimeSeriesStore> store) {
+  std::atomic_store(&localStore_, std::move(store));
+}
+
+std::shared_ptr<storage::TimeSeriesStore> DatabaseRepository::getLocalStore()
+    const {
+  return std::atomic_load(&localStore_);
+}
+
+void DatabaseRepository::recordTelemetry(const models::IoTData& data) {
+  auto store = std::atomic_load(&localStore_);
+  auto hotWindow = std::atomic_load(&hotWindow_);
+  if (data.deviceId.empty() || (!store && !hotWindow)) {
+    return;
+  }
+
+  storage::DataPoint point;
+  point.timestampUs = data.timestampUs;
+  if (point.timestampUs == 0) {
+    point.timestampUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+  }
+  point.temperature = data.temperature;
+  point.humidity = data.humidity;
+
+  if (hotWindow) {
+    hotWindow->append(data.deviceId, point);
+  }
+  if (store && store->isOpen()) {
+    store->append(data.deviceId, point);
+  }
+}
+
+void DatabaseRepository::attachHotWindow(
+    std::shared_ptr<storage::HotWindowCache> hotWindow) {
+  std::atomic_store(&hotWindow_, std::move(hotWindow));
+}
+
+std::shared_ptr<storage::HotWindowCache> DatabaseRepository::getHotWindow()
+    const {
+  return std::atomic_load(&hotWindow_);
+}
+
+void DatabaseRepository::attachIngestSpool(
+    std::shared_ptr<storage::IngestSpool> spool) {
+  std::atomic_store(&ingestSpool_, std::move(spool));
+}
+
+std::shared_ptr<storage::IngestSpool> DatabaseRepository::getIngestSpool()
+    const {
+  return std::atomic_load(&ingestSpool_);
+}
+
+bool DatabaseRepository::enqueueTelemetry(const models::IoTData& data) {
+  auto spool = std::atomic_load(&ingestSpool_);
+  if (!spool || !spool->isOpen()) {
+    return false;
+  }
+
+  storage::SpoolRecord record;
+  record.deviceId = data.deviceId;
+  record.timestampUs = data.timestampUs;
+  if (record.timestampUs == 0) {
+    record.timestampUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+  }
+  record.temperature = data.temperature;
+  record.humidity = data.humidity;
+  return spool->append(record);
+}
+
+bool DatabaseRepository::saveTelemetryBatch(
+    const std::vector<models::IoTData>& batch, std::vector<size_t>& rejected) {
+  rejected.clear();
+  std::lock_guard<std::mutex> lock(batchMutex_);
+
+  try {
+    // Переподключение и запись - без общей блокировки: запросы
+    // пользователей не ждут, пока БД недоступна
+    if (!batchConnection_ || !batchConnection_->is_open()) {
+      batchConnection_ = std::make_unique<pqxx::connection>(connectionString_);
+    }
+    insertTelemetry(batch, 0, batch.size(), rejected);
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка записи пачки телеметрии: " << e.what()
+              << std::endl;
+    batchConnection_.reset();
+    rejected.clear();
+    return false;
+  }
+}
+
+void DatabaseRepository::insertTelemetry(
+    const std::vector<models::IoTData>& batch, size_t begin, size_t end,
+    std::vector<size_t>& rejected) {
+  if (begin == end) {
+    return;
+  }
+
+  try {
+    pqxx::work transaction(*batchConnection_);
+    for (size_t i = begin; i < end; ++i) {
+      const auto& data = batch[i];
+      // Значения вне ограничений схемы не должны блокировать всю пачку
+      if (data.temperature < -50 || data.temperature > 100 ||
+          data.humidity < 0 || data.humidity > 100) {
+        continue;
+      }
+
+      transaction.exec_params(
+          "INSERT INTO telemetry_data (device_id, temperature, humidity, "
+          "timestamp) VALUES ($1, $2, $3, "
+          "to_timestamp($4::float8 / 1000000) AT TIME ZONE 'UTC')",
+          data.deviceId, data.temperature, data.humidity,
+          utils::Formatter::toLocalWallClock(data.timestampUs));
+    }
+    transaction.commit();
+
+  } catch (const pqxx::broken_connection&) {
+    throw;
+  } catch (const std::exception& e) {
+    // Иначе одна отвергнутая запись повторялась бы вечно вместе со
+    // всей пачкой
+    if (end - begin == 1) {
+      std::cerr << "⚠️  БД отвергла показание устройства "
+                << batch[begin].deviceId << ": " << e.what() << std::endl;
+      rejected.push_back(begin);
+      return;
+    }
+    size_t middle = begin + (end - begin) / 2;
+    insertTelemetry(batch, begin, middle, rejected);
+    insertTelemetry(batch, middle, end, rejected);
+    return;
+  }
+
+  // Некорректные значения не записываются, но и не теряются молча
+  for (size_t i = begin; i < end; ++i) {
+    const auto& data = batch[i];
+    if (data.temperature < -50 || data.temperature > 100 ||
+        data.humidity < 0 || data.humidity > 100) {
+      std::cerr << "⚠️  Пропущены некорректные данные устройства "
+                << data.deviceId << std::endl;
+      rejected.push_back(i);
+    }
+  }
+}
+
+std::vector<models::IoTData> DatabaseRepository::getDeviceTelemetrySince(
+    const std::string& deviceId, int64_t sinceUs, int limit) {
+  auto hotWindow = std::atomic_load(&hotWindow_);
+  std::vector<storage::DataPoint> points;
+  if (hotWindow && hotWindow->range(deviceId, sinceUs, INT64_MAX, points)) {
+    if (limit > 0 && points.size() > static_cast<size_t>(limit)) {
+      points.resize(static_cast<size_t>(limit));
+    }
+    return toTelemetry(deviceId, points);
+  }
+
+  if (isRemoteConnected()) {
+    return remoteConnection_->getTelemetryData(deviceId, limit, sinceUs);
+  }
+
+  // Удаленная БД недоступна - отдаем то, что есть в локальном хранилище
+  auto store = std::atomic_load(&localStore_);
+  if (store && store->isOpen()) {
+    return toTelemetry(deviceId,
+                       store->query(deviceId, sinceUs, INT64_MAX,
+                                    limit > 0 ? static_cast<size_t>(limit)
+                                              : 0));
+  }
+  return {};
+}
+
+bool DatabaseRepository::streamTelemetry(
+    int64_t fromUs, int64_t toUs, const TelemetrySink& sink,
+    const std::string& connectionString) {
+  try {
+    pqxx::connection connection(
+        connectionString.empty() ? connectionString_ : connectionString);
+    pqxx::work transaction(connection);
+
+    // COPY не принимает параметров - границы подставляются литералами
+    auto bound = [](int64_t timestampUs) {
+      return "to_timestamp(" +
+             std::to_string(utils::Formatter::toLocalWallClock(timestampUs)) +
+             "::float8 / 1000000) AT TIME ZONE 'UTC'";
+    };
+    std::string query =
+        "SELECT device_id, temperature, humidity, "
+        "(extract(epoch FROM \"timestamp\") * 1000000)::bigint "
+        "FROM telemetry_data WHERE \"timestamp\" >= " +
+        bound(fromUs) + " AND \"timestamp\" < " + bound(toUs) +
+        " ORDER BY \"timestamp\", id";
+
+    // stream() читает результат через COPY TO STDOUT построчно, без
+    // загрузки всего результата в память
+    WallClockConverter clock;
+    for (auto [deviceId, temperature, humidity, wallClockUs] :
+         transaction.stream<std::string, double, double, int64_t>(query)) {
+      sink(deviceId, temperature, humidity, clock.toTimestamp(wallClockUs));
+    }
+    transaction.commit();
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка чтения истории телеметрии: " << e.what()
+              << std::endl;
+    return false;
+  }
+}
+
 void DatabaseRepository::addUserDevice(long chatId,
                                        const std::string& deviceId) {
   std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
@@ -166,6 +483,10 @@ void DatabaseRepository::addUserDevice(long chatId,
     std::cout << "📱 Устройство " << deviceId << " привязано к пользователю "
               << chatId << std::endl;
 
+    for (const auto& handler : subscriptionChangedHandlers_) {
+      handler(chatId, deviceId);
+    }
+
   } catch (const std::exception& e) {
     std::cerr << "❌ Ошибка привязки устройства: " << e.what() << std::endl;
     throw;
@@ -188,6 +509,10 @@ void DatabaseRepository::removeUserDevice(long chatId,
     std::cout << "📱 Устройство " << deviceId << " отвязано от пользователя "
               << chatId << std::endl;
 
+    for (const auto& handler : subscriptionChangedHandlers_) {
+      handler(chatId, deviceId);
+    }
+
   } catch (const std::exception& e) {
     std::cerr << "❌ Ошибка отвязки устройства: " << e.what() << std::endl;
     throw;
@@ -245,6 +570,408 @@ std::vector<long> DatabaseRepository::getDeviceSubscribers(
   return subscribers;
 }
 
+bool DatabaseRepository::getDeviceSubscriberAlerts(
+    const std::string& deviceId,
+    std::vector<std::pair<long, models::UserAlert>>& out) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    auto result = transaction.exec_params(
+        "SELECT d.chat_id, a.temp_high_threshold, a.temp_low_threshold, "
+        "a.hum_high_threshold, a.hum_low_threshold "
+        "FROM user_devices d "
+        "LEFT JOIN user_alerts a ON a.chat_id = d.chat_id "
+        "WHERE d.device_id = $1",
+        deviceId);
+
+    out.clear();
+    out.reserve(result.size());
+    for (const auto& row : result) {
+      models::UserAlert alert;
+      if (!row["temp_high_threshold"].is_null()) {
+        alert.temperatureHighThreshold =
+            row["temp_high_threshold"].as<double>();
+      }
+      if (!row["temp_low_threshold"].is_null()) {
+        alert.temperatureLowThreshold = row["temp_low_threshold"].as<double>();
+      }
+      if (!row["hum_high_threshold"].is_null()) {
+        alert.humidityHighThreshold = row["hum_high_threshold"].as<double>();
+      }
+      if (!row["hum_low_threshold"].is_null()) {
+        alert.humidityLowThreshold = row["hum_low_threshold"].as<double>();
+      }
+      out.emplace_back(row["chat_id"].as<long>(), alert);
+    }
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка получения порогов подписчиков: " << e.what()
+              << std::endl;
+    return false;
+  }
+}
+
+void DatabaseRepository::onAlertChanged(AlertChangedHandler handler) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  alertChangedHandlers_.push_back(std::move(handler));
+}
+
+void DatabaseRepository::onSubscriptionChanged(
+    SubscriptionChangedHandler handler) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  subscriptionChangedHandlers_.push_back(std::move(handler));
+}
+
+void DatabaseRepository::onDeviceGroupsChanged(GroupsChangedHandler handler) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  groupsChangedHandlers_.push_back(std::move(handler));
+}
+
+void DatabaseRepository::notifyGroupsChanged() {
+  for (const auto& handler : groupsChangedHandlers_) {
+    handler();
+  }
+}
+
+int DatabaseRepository::createDeviceGroup(long chatId,
+                                          const std::string& name) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    // Повторное создание возвращает существующую группу
+    auto result = transaction.exec_params(
+        "INSERT INTO device_groups (chat_id, name) VALUES ($1, $2) "
+        "ON CONFLICT (chat_id, name) DO UPDATE SET name = EXCLUDED.name "
+        "RETURNING id",
+        chatId, name);
+
+    transaction.commit();
+    int groupId = result[0][0].as<int>();
+    std::cout << "🏢 Группа " << name << " (" << groupId
+              << ") создана для пользователя " << chatId << std::endl;
+
+    notifyGroupsChanged();
+    return groupId;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка создания группы: " << e.what() << std::endl;
+    throw;
+  }
+}
+
+bool DatabaseRepository::deleteDeviceGroup(long chatId,
+                                           const std::string& name) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    // Участники и правила удаляются каскадом
+    auto result = transaction.exec_params(
+        "DELETE FROM device_groups WHERE chat_id = $1 AND name = $2", chatId,
+        name);
+
+    transaction.commit();
+    if (result.affected_rows() == 0) {
+      return false;
+    }
+    std::cout << "🗑️  Группа " << name << " удалена у пользователя " << chatId
+              << std::endl;
+
+    notifyGroupsChanged();
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка удаления группы: " << e.what() << std::endl;
+    throw;
+  }
+}
+
+bool DatabaseRepository::addDeviceToGroup(long chatId,
+                                          const std::string& groupName,
+                                          const std::string& deviceId) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    auto result = transaction.exec_params(
+        "INSERT INTO device_group_members (group_id, device_id) "
+        "SELECT id, $3 FROM device_groups WHERE chat_id = $1 AND name = $2 "
+        "ON CONFLICT (group_id, device_id) DO NOTHING "
+        "RETURNING group_id",
+        chatId, groupName, deviceId);
+
+    // Пустой результат: группы нет или устройство уже в ней
+    bool exists = !result.empty() ||
+                  !transaction
+                       .exec_params(
+                           "SELECT 1 FROM device_groups "
+                           "WHERE chat_id = $1 AND name = $2",
+                           chatId, groupName)
+                       .empty();
+    transaction.commit();
+    if (!exists) {
+      return false;
+    }
+
+    if (!result.empty()) {
+      std::cout << "📱 Устройство " << deviceId << " добавлено в группу "
+                << groupName << std::endl;
+      notifyGroupsChanged();
+    }
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка добавления устройства в группу: " << e.what()
+              << std::endl;
+    throw;
+  }
+}
+
+bool DatabaseRepository::removeDeviceFromGroup(long chatId,
+                                               const std::string& groupName,
+                                               const std::string& deviceId) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    auto result = transaction.exec_params(
+        "DELETE FROM device_group_members m USING device_groups g "
+        "WHERE m.group_id = g.id AND g.chat_id = $1 AND g.name = $2 "
+        "AND m.device_id = $3",
+        chatId, groupName, deviceId);
+
+    transaction.commit();
+    if (result.affected_rows() == 0) {
+      return false;
+    }
+    std::cout << "📱 Устройство " << deviceId << " удалено из группы "
+              << groupName << std::endl;
+
+    notifyGroupsChanged();
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка удаления устройства из группы: " << e.what()
+              << std::endl;
+    throw;
+  }
+}
+
+std::vector<models::DeviceGroup> DatabaseRepository::getUserDeviceGroups(
+    long chatId) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+  std::vector<models::DeviceGroup> groups;
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    auto result = transaction.exec_params(
+        "SELECT g.id, g.name, m.device_id FROM device_groups g "
+        "LEFT JOIN device_group_members m ON m.group_id = g.id "
+        "WHERE g.chat_id = $1 ORDER BY g.name, m.device_id",
+        chatId);
+
+    for (const auto& row : result) {
+      int groupId = row["id"].as<int>();
+      if (groups.empty() || groups.back().id != groupId) {
+        auto& group = groups.emplace_back();
+        group.id = groupId;
+        group.chatId = chatId;
+        group.name = row["name"].as<std::string>();
+      }
+      if (!row["device_id"].is_null()) {
+        groups.back().deviceIds.push_back(row["device_id"].as<std::string>());
+      }
+    }
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка получения групп: " << e.what() << std::endl;
+  }
+
+  return groups;
+}
+
+bool DatabaseRepository::setGroupAlertRule(long chatId,
+                                           const std::string& groupName,
+                                           const models::GroupAlertRule& rule) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    auto group = transaction.exec_params(
+        "SELECT id FROM device_groups WHERE chat_id = $1 AND name = $2",
+        chatId, groupName);
+    if (group.empty()) {
+      return false;
+    }
+    int groupId = group[0][0].as<int>();
+
+    if (rule.threshold > 0) {
+      transaction.exec_params(
+          "INSERT INTO device_group_alerts (group_id, metric_type, "
+          "aggregate, direction, threshold) VALUES ($1, $2, $3, $4, $5) "
+          "ON CONFLICT (group_id, metric_type, aggregate, direction) "
+          "DO UPDATE SET threshold = EXCLUDED.threshold, "
+          "updated_at = CURRENT_TIMESTAMP",
+          groupId, rule.metricType, rule.aggregate, rule.direction,
+          rule.threshold);
+    } else {
+      transaction.exec_params(
+          "DELETE FROM device_group_alerts WHERE group_id = $1 "
+          "AND metric_type = $2 AND aggregate = $3 AND direction = $4",
+          groupId, rule.metricType, rule.aggregate, rule.direction);
+    }
+
+    transaction.commit();
+    std::cout << "⚙️  Правило группы " << groupName << " обновлено: "
+              << rule.metricType << " " << rule.aggregate << " "
+              << rule.direction << " " << rule.threshold << std::endl;
+
+    notifyGroupsChanged();
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка установки правила группы: " << e.what()
+              << std::endl;
+    throw;
+  }
+}
+
+std::vector<models::GroupAlertRule> DatabaseRepository::getGroupAlertRules(
+    int groupId) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  reconnectIfNeeded();
+  std::vector<models::GroupAlertRule> rules;
+
+  try {
+    pqxx::work transaction(getConnection());
+
+    auto result = transaction.exec_params(
+        "SELECT metric_type, aggregate, direction, threshold "
+        "FROM device_group_alerts WHERE group_id = $1 "
+        "ORDER BY metric_type, aggregate, direction",
+        groupId);
+
+    for (const auto& row : result) {
+      auto& rule = rules.emplace_back();
+      rule.groupId = groupId;
+      rule.metricType = row["metric_type"].as<std::string>();
+      rule.aggregate = row["aggregate"].as<std::string>();
+      rule.direction = row["direction"].as<std::string>();
+      rule.threshold = row["threshold"].as<double>();
+    }
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка получения правил группы: " << e.what()
+              << std::endl;
+  }
+
+  return rules;
+}
+
+bool DatabaseRepository::getRuleDefinitions(
+    std::vector<models::RuleDefinition>& out) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    auto result = transaction.exec(
+        "SELECT name, expression, priority, enabled, device_id, group_id "
+        "FROM rule_definitions ORDER BY name");
+    transaction.commit();
+
+    out.clear();
+    out.reserve(result.size());
+    for (const auto& row : result) {
+      auto& definition = out.emplace_back();
+      definition.name = row["name"].as<std::string>();
+      definition.expression = row["expression"].as<std::string>();
+      definition.priority = row["priority"].as<int>();
+      definition.enabled = row["enabled"].as<bool>();
+      if (!row["device_id"].is_null()) {
+        definition.deviceId = row["device_id"].as<std::string>();
+      }
+      if (!row["group_id"].is_null()) {
+        definition.groupId = row["group_id"].as<int>();
+      }
+    }
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка загрузки правил: " << e.what() << std::endl;
+    return false;
+  }
+}
+
+bool DatabaseRepository::loadDeviceGroups(
+    std::vector<models::DeviceGroup>& groups,
+    std::vector<models::GroupAlertRule>& rules) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    auto members = transaction.exec(
+        "SELECT g.id, g.chat_id, g.name, m.device_id FROM device_groups g "
+        "LEFT JOIN device_group_members m ON m.group_id = g.id "
+        "ORDER BY g.id");
+    auto ruleRows = transaction.exec(
+        "SELECT group_id, metric_type, aggregate, direction, threshold "
+        "FROM device_group_alerts");
+    transaction.commit();
+
+    groups.clear();
+    for (const auto& row : members) {
+      int groupId = row["id"].as<int>();
+      if (groups.empty() || groups.back().id != groupId) {
+        auto& group = groups.emplace_back();
+        group.id = groupId;
+        group.chatId = row["chat_id"].as<long>();
+        group.name = row["name"].as<std::string>();
+      }
+      if (!row["device_id"].is_null()) {
+        groups.back().deviceIds.push_back(row["device_id"].as<std::string>());
+      }
+    }
+
+    rules.clear();
+    rules.reserve(ruleRows.size());
+    for (const auto& row : ruleRows) {
+      auto& rule = rules.emplace_back();
+      rule.groupId = row["group_id"].as<int>();
+      rule.metricType = row["metric_type"].as<std::string>();
+      rule.aggregate = row["aggregate"].as<std::string>();
+      rule.direction = row["direction"].as<std::string>();
+      rule.threshold = row["threshold"].as<double>();
+    }
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка загрузки групп устройств: " << e.what()
+              << std::endl;
+    return false;
+  }
+}
+
 void DatabaseRepository::setUserAlert(long chatId,
                                       const models::UserAlert& alert) {
   std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
@@ -271,6 +998,10 @@ void DatabaseRepository::setUserAlert(long chatId,
     std::cout << "⚙️  Настройки оповещений обновлены для пользователя " << chatId
               << std::endl;
 
+    for (const auto& handler : alertChangedHandlers_) {
+      handler(chatId, alert);
+    }
+
   } catch (const std::exception& e) {
     std::cerr << "❌ Ошибка сохранения настроек оповещений: " << e.what()
               << std::endl;
@@ -336,6 +1067,10 @@ void DatabaseRepository::clearUserAlerts(long chatId) {
     std::cout << "🗑️  Настройки оповещений удалены для пользователя " << chatId
               << std::endl;
 
+    for (const auto& handler : alertChangedHandlers_) {
+      handler(chatId, models::UserAlert());
+    }
+
   } catch (const std::exception& e) {
     std::cerr << "❌ Ошибка удаления настроек оповещений: " << e.what()
               << std::endl;
@@ -392,6 +1127,206 @@ DatabaseRepository::getAllActiveAlerts() {
   return alerts;
 }
 
+bool DatabaseRepository::insertOutboxEntry(const models::OutboxEntry& entry,
+                                           bool& inserted) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  inserted = false;
+
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    // Дубликат от другого узла (или повтор на этом) молча пропускается
+    auto result = transaction.exec_params(
+        "INSERT INTO notification_outbox (dedup_key, channel, chat_id, "
+        "device_id, metric_type, direction, value, resolved, "
+        "suppressed_before, event_us) "
+        "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10) "
+        "ON CONFLICT (dedup_key) DO NOTHING",
+        entry.dedupKey, entry.channel, entry.chatId, entry.alert.deviceId,
+        entry.alert.metricType, entry.alert.direction, entry.alert.value,
+        entry.alert.resolved,
+        static_cast<int64_t>(entry.alert.suppressedBefore),
+        entry.alert.timestampUs);
+
+    transaction.commit();
+    inserted = result.affected_rows() > 0;
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка записи в очередь уведомлений: " << e.what()
+              << std::endl;
+    return false;
+  }
+}
+
+std::vector<models::OutboxEntry> DatabaseRepository::claimOutboxEntries(
+    const std::string& owner, size_t limit, std::chrono::seconds lease) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  std::vector<models::OutboxEntry> entries;
+
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    // Строки, которые сейчас выбирает другой узел, пропускаются без
+    // ожидания; истекшая аренда (узел упал) снова делает запись доступной
+    auto result = transaction.exec_params(
+        "WITH claimed AS ("
+        "  SELECT id FROM notification_outbox "
+        "  WHERE status = 'pending' AND available_at <= now() "
+        "    AND (locked_until IS NULL OR locked_until < now()) "
+        "  ORDER BY available_at "
+        "  LIMIT $2 "
+        "  FOR UPDATE SKIP LOCKED) "
+        "UPDATE notification_outbox o "
+        "SET locked_by = $1, "
+        "    locked_until = now() + make_interval(secs => $3), "
+        "    attempts = o.attempts + 1 "
+        "FROM claimed WHERE o.id = claimed.id "
+        "RETURNING o.id, o.dedup_key, o.channel, o.chat_id, o.device_id, "
+        "o.metric_type, o.direction, o.value, o.resolved, "
+        "o.suppressed_before, o.event_us, o.attempts",
+        owner, static_cast<int64_t>(limit),
+        static_cast<int64_t>(lease.count()));
+
+    transaction.commit();
+
+    entries.reserve(result.size());
+    for (const auto& row : result) {
+      models::OutboxEntry entry;
+      entry.id = row["id"].as<int64_t>();
+      entry.dedupKey = row["dedup_key"].as<std::string>();
+      entry.channel = row["channel"].as<std::string>();
+      entry.chatId = row["chat_id"].as<long>();
+      entry.alert.deviceId = row["device_id"].as<std::string>();
+      entry.alert.metricType = row["metric_type"].as<std::string>();
+      entry.alert.direction = row["direction"].as<std::string>();
+      entry.alert.value = row["value"].as<double>();
+      entry.alert.resolved = row["resolved"].as<bool>();
+      entry.alert.suppressedBefore =
+          static_cast<uint32_t>(row["suppressed_before"].as<int64_t>());
+      entry.alert.timestampUs = row["event_us"].as<int64_t>();
+      entry.attempts = row["attempts"].as<int>();
+      entries.push_back(std::move(entry));
+    }
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка выборки из очереди уведомлений: " << e.what()
+              << std::endl;
+    entries.clear();
+  }
+
+  return entries;
+}
+
+void DatabaseRepository::completeOutboxEntries(
+    const std::vector<int64_t>& ids) {
+  if (ids.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    // Владельца не проверяем: доставленное остается доставленным, даже
+    // если аренда успела истечь
+    transaction.exec_params(
+        "UPDATE notification_outbox "
+        "SET status = 'delivered', delivered_at = now(), "
+        "    locked_by = NULL, locked_until = NULL "
+        "WHERE id = ANY($1::bigint[])",
+        toArrayLiteral(ids));
+
+    transaction.commit();
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка подтверждения доставки: " << e.what()
+              << std::endl;
+  }
+}
+
+void DatabaseRepository::retryOutboxEntries(const std::vector<int64_t>& ids,
+                                            const std::string& owner,
+                                            std::chrono::milliseconds delay,
+                                            const std::string& error) {
+  if (ids.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    transaction.exec_params(
+        "UPDATE notification_outbox "
+        "SET available_at = now() + make_interval(secs => $3), "
+        "    locked_by = NULL, locked_until = NULL, last_error = $4 "
+        "WHERE id = ANY($1::bigint[]) AND locked_by = $2 "
+        "  AND status = 'pending'",
+        toArrayLiteral(ids), owner, delay.count() / 1000.0, error);
+
+    transaction.commit();
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка возврата уведомлений в очередь: " << e.what()
+              << std::endl;
+  }
+}
+
+void DatabaseRepository::failOutboxEntries(const std::vector<int64_t>& ids,
+                                           const std::string& owner,
+                                           const std::string& error) {
+  if (ids.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    transaction.exec_params(
+        "UPDATE notification_outbox "
+        "SET status = 'failed', locked_by = NULL, locked_until = NULL, "
+        "    last_error = $3 "
+        "WHERE id = ANY($1::bigint[]) AND locked_by = $2 "
+        "  AND status = 'pending'",
+        toArrayLiteral(ids), owner, error);
+
+    transaction.commit();
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка отметки недоставленных уведомлений: " << e.what()
+              << std::endl;
+  }
+}
+
+size_t DatabaseRepository::purgeOutbox(std::chrono::hours retention) {
+  std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
+  try {
+    reconnectIfNeeded();
+    pqxx::work transaction(getConnection());
+
+    auto result = transaction.exec_params(
+        "DELETE FROM notification_outbox "
+        "WHERE status <> 'pending' "
+        "  AND created_at < now() - make_interval(hours => $1)",
+        static_cast<int>(retention.count()));
+
+    transaction.commit();
+    return static_cast<size_t>(result.affected_rows());
+
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка очистки очереди уведомлений: " << e.what()
+              << std::endl;
+    return 0;
+  }
+}
+
 int DatabaseRepository::getTotalRecordsCount() {
   std::lock_guard<std::recursive_mutex> lock(connectionMutex_);
   reconnectIfNeeded();
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <pqxx/pqxx>
@@ -9,6 +12,12 @@
 #include "../models/IoTData.h"
 #include "RemoteDatabaseConnection.h"
 
+namespace iot_core::storage {
+class HotWindowCache;
+class IngestSpool;
+class TimeSeriesStore;
+}
+
 namespace iot_core::core {
 
 class DatabaseRepository {
@@ -23,8 +32,9 @@ class DatabaseRepository {
   // Подключение к удаленной БД
   void connectToRemoteDatabase(const std::string& connectionString);
   bool isRemoteConnected() const;
+  // sinceUs - только записи не старше (микросекунды), 0 - без ограничения
   std::vector<models::IoTData> getRemoteTelemetry(
-      const std::string& deviceId = "", int limit = 10);
+      const std::string& deviceId = "", int limit = 10, int64_t sinceUs = 0);
 
   std::vector<models::IoTData> getLatestRemoteTelemetryForAllDevices();
 
@@ -32,11 +42,59 @@ class DatabaseRepository {
   std::vector<models::IoTData> getDeviceTelemetry(const std::string& deviceId,
                                                   int limit = 10);
 
+  // Локальное колоночное хранилище (опционально). Если подключено,
+  // входящая телеметрия пишется в него, а история читается из него
+  // без обращения к удаленной БД.
+  void attachLocalStore(std::shared_ptr<storage::TimeSeriesStore> store);
+  std::shared_ptr<storage::TimeSeriesStore> getLocalStore() const;
+  void recordTelemetry(const models::IoTData& data);
+
+  // Сжатое окно недавних показаний в памяти. Наполняется приемом и
+  // опросом удаленной БД; отвечает на запросы истории, которые покрывает.
+  void attachHotWindow(std::shared_ptr<storage::HotWindowCache> hotWindow);
+  std::shared_ptr<storage::HotWindowCache> getHotWindow() const;
+
+  // Журнал приема: показание сначала пишется на диск, а в БД попадает
+  // при воспроизведении журнала. false - журнал не подключен или полон,
+  // вызывающий обрабатывает показание сам.
+  void attachIngestSpool(std::shared_ptr<storage::IngestSpool> spool);
+  std::shared_ptr<storage::IngestSpool> getIngestSpool() const;
+  bool enqueueTelemetry(const models::IoTData& data);
+
+  // Пакетная запись телеметрии в локальную БД. Идет по отдельному
+  // подключению и не держит общее. Пачку, которую БД отвергла, делит
+  // пополам; индексы показаний, отвергнутых поодиночке, - в rejected.
+  // false только если БД недоступна (ничего не записано)
+  bool saveTelemetryBatch(const std::vector<models::IoTData>& batch,
+                          std::vector<size_t>& rejected);
+
+  // История устройства начиная с sinceUs (микросекунды), от новых к старым
+  std::vector<models::IoTData> getDeviceTelemetrySince(
+      const std::string& deviceId, int64_t sinceUs, int limit = 1000);
+
+  // Вся телеметрия за [fromUs, toUs) по времени через COPY из таблицы
+  // telemetry_data БД по строке подключения connectionString (удаленная
+  // БД сокомандника); пустая строка - локальная БД. Время в таблице -
+  // местное, как у RemoteDatabaseConnection. Идет по отдельному
+  // подключению и не держит общее. false - ошибка (часть строк могла
+  // уже уйти в sink)
+  using TelemetrySink =
+      std::function<void(const std::string& deviceId, double temperature,
+                         double humidity, int64_t timestampUs)>;
+  bool streamTelemetry(int64_t fromUs, int64_t toUs,
+                       const TelemetrySink& sink,
+                       const std::string& connectionString = "");
+
   // Управление пользователями и устройствами
   void addUserDevice(long chatId, const std::string& deviceId);
   void removeUserDevice(long chatId, const std::string& deviceId);
   std::vector<std::string> getUserDevices(long chatId);
   std::vector<long> getDeviceSubscribers(const std::string& deviceId);
+  // Подписчики устройства вместе с их порогами одним запросом;
+  // false при ошибке БД
+  bool getDeviceSubscriberAlerts(
+      const std::string& deviceId,
+      std::vector<std::pair<long, models::UserAlert>>& out);
 
   // Новый метод: получение всех устройств с подписчиками
   std::vector<std::string> getAllSubscribedDevices();
@@ -47,6 +105,59 @@ class DatabaseRepository {
   void clearUserAlerts(long chatId);
   std::vector<std::pair<long, models::UserAlert>> getAllActiveAlerts();
 
+  // Уведомления об изменении порогов и подписок; вызываются после
+  // фиксации транзакции. Сброс порогов приходит как пустой UserAlert.
+  using AlertChangedHandler =
+      std::function<void(long chatId, const models::UserAlert& alert)>;
+  using SubscriptionChangedHandler =
+      std::function<void(long chatId, const std::string& deviceId)>;
+  void onAlertChanged(AlertChangedHandler handler);
+  void onSubscriptionChanged(SubscriptionChangedHandler handler);
+
+  // Группы устройств: имя уникально в пределах пользователя.
+  // Методы с bool возвращают false, если группы нет; ошибки БД -
+  // исключения, как у остальных методов управления.
+  int createDeviceGroup(long chatId, const std::string& name);
+  bool deleteDeviceGroup(long chatId, const std::string& name);
+  bool addDeviceToGroup(long chatId, const std::string& groupName,
+                        const std::string& deviceId);
+  bool removeDeviceFromGroup(long chatId, const std::string& groupName,
+                             const std::string& deviceId);
+  std::vector<models::DeviceGroup> getUserDeviceGroups(long chatId);
+  // Правило по агрегату группы; threshold <= 0 удаляет правило
+  bool setGroupAlertRule(long chatId, const std::string& groupName,
+                         const models::GroupAlertRule& rule);
+  std::vector<models::GroupAlertRule> getGroupAlertRules(int groupId);
+  // Все группы с участниками и все правила; false при ошибке БД
+  bool loadDeviceGroups(std::vector<models::DeviceGroup>& groups,
+                        std::vector<models::GroupAlertRule>& rules);
+
+  // Правила на языке выражений; false при ошибке БД
+  bool getRuleDefinitions(std::vector<models::RuleDefinition>& out);
+
+  // Любое изменение групп, участников или правил групп
+  using GroupsChangedHandler = std::function<void()>;
+  void onDeviceGroupsChanged(GroupsChangedHandler handler);
+
+  // Общая очередь уведомлений (notification_outbox) для нескольких
+  // экземпляров. Вставка: inserted = false, если запись с таким
+  // dedupKey уже есть; false при ошибке БД.
+  bool insertOutboxEntry(const models::OutboxEntry& entry, bool& inserted);
+  // Забирает до limit готовых записей на время lease; записи, занятые
+  // другими узлами, пропускаются (FOR UPDATE SKIP LOCKED)
+  std::vector<models::OutboxEntry> claimOutboxEntries(
+      const std::string& owner, size_t limit, std::chrono::seconds lease);
+  void completeOutboxEntries(const std::vector<int64_t>& ids);
+  // Возврат в очередь не раньше чем через delay
+  void retryOutboxEntries(const std::vector<int64_t>& ids,
+                          const std::string& owner,
+                          std::chrono::milliseconds delay,
+                          const std::string& error);
+  void failOutboxEntries(const std::vector<int64_t>& ids,
+                         const std::string& owner, const std::string& error);
+  // Удаляет завершенные записи старше retention; число удаленных
+  size_t purgeOutbox(std::chrono::hours retention);
+
   // Статистика
   int getTotalRecordsCount();
   int getActiveUsersCount();
@@ -58,12 +169,29 @@ class DatabaseRepository {
  private:
   pqxx::connection& getConnection();
   void reconnectIfNeeded();
+  // Вызывать под batchMutex_; pqxx::broken_connection пробрасывается
+  void insertTelemetry(const std::vector<models::IoTData>& batch,
+                       size_t begin, size_t end, std::vector<size_t>& rejected);
 
   std::string connectionString_;
   std::unique_ptr<pqxx::connection> connection_;
   std::recursive_mutex connectionMutex_;
+  // Подключение воспроизведения журнала приема
+  std::unique_ptr<pqxx::connection> batchConnection_;
+  std::mutex batchMutex_;
 
   std::unique_ptr<RemoteDatabaseConnection> remoteConnection_;
+
+  std::shared_ptr<storage::TimeSeriesStore> localStore_;
+  std::shared_ptr<storage::HotWindowCache> hotWindow_;
+  std::shared_ptr<storage::IngestSpool> ingestSpool_;
+
+  // Под connectionMutex_
+  std::vector<AlertChangedHandler> alertChangedHandlers_;
+  std::vector<SubscriptionChangedHandler> subscriptionChangedHandlers_;
+  std::vector<GroupsChangedHandler> groupsChangedHandlers_;
+
+  void notifyGroupsChanged();
 };
 
 }  // namespace iot_core::core
\ No newline at end of file
@@ -0,0 +1,161 @@
+// src/core/NotificationOutbox.cpp
+#include "NotificationOutbox.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace iot_core::core {
+
+NotificationOutbox::NotificationOutbox(Options options)
+    : options_(std::move(options)) {
+  options_.workers = std::max<size_t>(1, options_.workers);
+  options_.maxAttempts = std::max(1, options_.maxAttempts);
+}
+
+NotificationOutbox::~NotificationOutbox() { stop(); }
+
+void NotificationOutbox::start(Deliverer deliverer) {
+  if (running_) {
+    return;
+  }
+
+  deliverer_ = std::move(deliverer);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  running_ = true;
+
+  for (size_t i = 0; i < options_.workers; ++i) {
+    workers_.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+void NotificationOutbox::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    stopping_ = true;
+  }
+  cv_.notify_all();
+
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  workers_.clear();
+  running_ = false;
+}
+
+bool NotificationOutbox::enqueue(NotificationJob job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_ || stopping_ ||
+        queue_.size() + statistics_.inFlight >= options_.queueCapacity) {
+      ++statistics_.dropped;
+      return false;
+    }
+
+    auto now = Clock::now();
+    queue_.emplace(now, Pending{std::move(job), 0, now});
+    ++statistics_.enqueued;
+  }
+  cv_.notify_one();
+  return true;
+}
+
+NotificationOutbox::Statistics NotificationOutbox::getStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics stats = statistics_;
+  stats.queued = queue_.size();
+  if (stats.delivered > 0) {
+    stats.avgLatencyMs = totalLatencyMs_ / static_cast<double>(stats.delivered);
+  }
+  return stats;
+}
+
+std::chrono::milliseconds NotificationOutbox::backoffFor(int attempts) {
+  // Полный разброс в верхней половине интервала: повторы разных заданий
+  // не совпадают во времени после общего сбоя
+  auto delay = options_.baseBackoff;
+  for (int i = 1; i < attempts && delay < options_.maxBackoff; ++i) {
+    delay *= 2;
+  }
+  delay = std::min(delay, options_.maxBackoff);
+
+  std::uniform_int_distribution<long long> jitter(delay.count() / 2,
+                                                  delay.count());
+  return std::chrono::milliseconds(jitter(random_));
+}
+
+void NotificationOutbox::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    if (queue_.empty()) {
+      if (stopping_) {
+        break;
+      }
+      cv_.wait(lock);
+      continue;
+    }
+
+    // При остановке паузы не соблюдаются: последняя попытка сразу
+    auto next = queue_.begin();
+    if (!stopping_ && next->first > Clock::now()) {
+      // Копия: пока мьютекс отпущен, другой исполнитель может забрать
+      // это задание и удалить узел очереди вместе с ключом
+      auto deadline = next->first;
+      cv_.wait_until(lock, deadline);
+      continue;
+    }
+
+    Pending pending = std::move(next->second);
+    queue_.erase(next);
+    ++statistics_.inFlight;
+    lock.unlock();
+
+    ++pending.attempts;
+    DeliveryResult result;
+    try {
+      result = deliverer_(pending.job);
+    } catch (const std::exception& e) {
+      result = DeliveryResult::retry(e.what());
+    }
+
+    lock.lock();
+    --statistics_.inFlight;
+
+    if (result.status == DeliveryResult::Status::Delivered) {
+      double latencyMs = std::chrono::duration<double, std::milli>(
+                             Clock::now() - pending.enqueuedAt)
+                             .count();
+      ++statistics_.delivered;
+      totalLatencyMs_ += latencyMs;
+      statistics_.maxLatencyMs = std::max(statistics_.maxLatencyMs, latencyMs);
+      continue;
+    }
+
+    bool retry = result.status == DeliveryResult::Status::Retry &&
+                 pending.attempts < options_.maxAttempts && !stopping_;
+    if (!retry) {
+      ++statistics_.failed;
+      std::cerr << "❌ Уведомление не доставлено после " << pending.attempts
+                << " попыток: " << result.error << std::endl;
+      continue;
+    }
+
+    auto delay = result.retryAfter.count() > 0
+                     ? result.retryAfter
+                     : backoffFor(pending.attempts);
+    ++statistics_.retried;
+    queue_.emplace(Clock::now() + delay, std::move(pending));
+    // Новое задание может оказаться раньше того, которого ждут остальные
+    cv_.notify_one();
+  }
+}
+
+}  // namespace iot_core::core
@@ -0,0 +1,133 @@
+// src/core/NotificationOutbox.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../models/IoTData.h"
+
+namespace iot_core::core {
+
+// Одно уведомление, ожидающее доставки
+struct NotificationJob {
+  enum class Channel : uint8_t { Telegram, Email };
+
+  Channel channel = Channel::Telegram;
+  long chatId = 0;
+  std::string text;  // готовое сообщение Telegram; пусто - из alerts
+
+  // Параметры оповещения для email
+  std::string deviceId;
+  double value = 0.0;
+  std::string metricType;
+  std::string direction;
+  // Сводка: если не пусто, поля оповещения выше не используются
+  std::vector<models::AlertEvent> alerts;
+};
+
+// Итог одной попытки доставки
+struct DeliveryResult {
+  enum class Status { Delivered, Retry, Failed };
+
+  Status status = Status::Delivered;
+  // Пауза, которую просит сервер (429 retry_after); 0 - по расписанию
+  std::chrono::milliseconds retryAfter{0};
+  std::string error;
+
+  static DeliveryResult delivered() { return {}; }
+  static DeliveryResult retry(std::string error,
+                              std::chrono::milliseconds retryAfter =
+                                  std::chrono::milliseconds(0)) {
+    return {Status::Retry, retryAfter, std::move(error)};
+  }
+  static DeliveryResult failed(std::string error) {
+    return {Status::Failed, std::chrono::milliseconds(0), std::move(error)};
+  }
+};
+
+/**
+ * @brief Очередь исходящих уведомлений с пулом отправителей
+ *
+ * Проверка оповещений только ставит задание в очередь и не ждет сети.
+ * Пул потоков доставляет задания; неудачные попытки повторяются с
+ * экспоненциальной паузой со случайным разбросом (или через retry_after,
+ * если его вернул сервер) до maxAttempts. При остановке оставшиеся
+ * задания получают по одной последней попытке без повторов.
+ */
+class NotificationOutbox {
+ public:
+  struct Options {
+    size_t workers = 4;
+    size_t queueCapacity = 10000;
+    int maxAttempts = 5;
+    std::chrono::milliseconds baseBackoff{1000};
+    std::chrono::milliseconds maxBackoff{60000};
+  };
+
+  struct Statistics {
+    size_t queued = 0;
+    size_t inFlight = 0;
+    uint64_t enqueued = 0;
+    uint64_t delivered = 0;
+    uint64_t retried = 0;
+    uint64_t failed = 0;   // исчерпаны попытки или ошибка без повтора
+    uint64_t dropped = 0;  // очередь переполнена
+    double avgLatencyMs = 0.0;  // от постановки до доставки
+    double maxLatencyMs = 0.0;
+  };
+
+  using Deliverer = std::function<DeliveryResult(const NotificationJob&)>;
+
+  explicit NotificationOutbox(Options options);
+  ~NotificationOutbox();
+
+  NotificationOutbox(const NotificationOutbox&) = delete;
+  NotificationOutbox& operator=(const NotificationOutbox&) = delete;
+
+  void start(Deliverer deliverer);
+  void stop();
+  bool isRunning() const { return running_; }
+
+  // false если очередь переполнена или остановлена
+  bool enqueue(NotificationJob job);
+
+  Statistics getStatistics() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Pending {
+    NotificationJob job;
+    int attempts = 0;
+    Clock::time_point enqueuedAt;
+  };
+
+  void workerLoop();
+  std::chrono::milliseconds backoffFor(int attempts);
+
+  Options options_;
+  Deliverer deliverer_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  // Задания по времени, не раньше которого их можно отправлять
+  std::multimap<Clock::time_point, Pending> queue_;
+  std::atomic<bool> running_{false};
+  bool stopping_ = false;
+  std::mt19937 random_{std::random_device{}()};
+
+  Statistics statistics_;
+  double totalLatencyMs_ = 0.0;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace iot_core::core
@@ -1,13 +1,9 @@
 // src/core/NotificationService.cpp
 #include "NotificationService.h"
 
-#include <cpr/cpr.h>
-
-#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
-#include <nlohmann/json.hpp>
 #include <sstream>
 
 #include "../smtp/EmailService.h"
@@ -15,7 +11,28 @@
 
 namespace iot_core::core {
 
-NotificationService::NotificationService(const std::string& botToken)
+namespace {
+
+models::AlertEvent makeAlertEvent(const std::string& deviceId, double value,
+                                  const std::string& metricType,
+                                  const std::string& direction) {
+  models::AlertEvent alert;
+  alert.deviceId = deviceId;
+  alert.value = value;
+  alert.metricType = metricType;
+  alert.direction = direction;
+  alert.timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+  return alert;
+}
+
+}  // namespace
+
+NotificationService::NotificationService(
+    const std::string& botToken, NotificationOutbox::Options outboxOptions,
+    AlertCoalescer::Options coalesceOptions,
+    AlertCoalescer::Options emailDigestOptions)
     : botToken_(botToken) {
   telegramEnabled_ = !botToken.empty();
 
@@ -46,14 +63,67 @@ NotificationService::NotificationService(const std::string& botToken)
   }
 
   if (telegramEnabled_) {
+    // По сессии на каждый поток очереди и одна - для ответов бота
+    TelegramClient::Options clientOptions;
+    clientOptions.poolSize = outboxOptions.workers + 1;
+    telegram_ = std::make_shared<TelegramClient>(botToken, clientOptions);
     std::cout << "🤖 Telegram notifications enabled" << std::endl;
   } else {
     std::cout << "⚠️  Telegram notifications disabled (no token)" << std::endl;
   }
+
+  outbox_ = std::make_unique<NotificationOutbox>(outboxOptions);
+  outbox_->start([this](const NotificationJob& job) { return deliver(job); });
+
+  if (coalesceOptions.window.count() > 0) {
+    coalescer_ = std::make_unique<AlertCoalescer>(coalesceOptions);
+    coalescer_->start(
+        [this](long chatId, std::vector<models::AlertEvent> alerts) {
+          flushAlerts(chatId, std::move(alerts));
+        });
+  }
+
+  if (isEmailAvailable() && emailDigestOptions.window.count() > 0) {
+    emailDigest_ = std::make_unique<AlertCoalescer>(emailDigestOptions);
+    emailDigest_->start([this](long, std::vector<models::AlertEvent> alerts) {
+      enqueueEmailDigest(std::move(alerts));
+    });
+  }
 }
 
 NotificationService::~NotificationService() {
-  // Деструктор для cleanup
+  // Отправители обращаются к emailService_ - останавливаем их первыми
+  shutdown();
+}
+
+void NotificationService::shutdown() {
+  // Открытые сводки уходят в очередь до ее остановки
+  if (coalescer_) {
+    coalescer_->stop();
+  }
+  if (emailDigest_) {
+    emailDigest_->stop();
+  }
+  if (outbox_) {
+    outbox_->stop();
+  }
+}
+
+NotificationOutbox::Statistics NotificationService::getOutboxStatistics()
+    const {
+  return outbox_->getStatistics();
+}
+
+AlertCoalescer::Statistics NotificationService::getCoalescerStatistics()
+    const {
+  return coalescer_ ? coalescer_->getStatistics()
+                    : AlertCoalescer::Statistics();
+}
+
+AlertCoalescer::Statistics NotificationService::getEmailDigestStatistics()
+    const {
+  return emailDigest_ ? emailDigest_->getStatistics()
+                      : AlertCoalescer::Statistics();
 }
 
 bool NotificationService::isTelegramAvailable() const {
@@ -68,32 +138,20 @@ void NotificationService::sendTelegramAlert(long chatId,
                                             const std::string& deviceId,
                                             double value,
                                             const std::string& metricType,
-                                            const std::string& direction) {
+                                            const std::string& direction,
+                                            uint32_t suppressedBefore) {
   // Отправляем Telegram оповещение
   if (telegramEnabled_) {
-    std::cout << "🔔 Sending Telegram alert to " << chatId << " for "
+    std::cout << "🔔 Queueing Telegram alert to " << chatId << " for "
               << deviceId << std::endl;
-
-    std::string message = utils::Formatter::formatAlertMessage(
-        deviceId, value, metricType, direction);
-    sendTelegramMessage(chatId, message);
+    auto alert = makeAlertEvent(deviceId, value, metricType, direction);
+    alert.suppressedBefore = suppressedBefore;
+    queueTelegramAlert(chatId, std::move(alert));
   }
 
   // Отправляем email оповещение
   if (isEmailAvailable()) {
-    std::cout << "📧 Sending email alert for device " << deviceId << std::endl;
-
-    try {
-      bool emailSent =
-          emailService_->sendAlertEmail(deviceId, value, metricType, direction);
-      if (emailSent) {
-        std::cout << "✅ Email alert sent successfully" << std::endl;
-      } else {
-        std::cout << "⚠️  Email alert failed to send" << std::endl;
-      }
-    } catch (const std::exception& e) {
-      std::cerr << "❌ Error sending email alert: " << e.what() << std::endl;
-    }
+    enqueueEmailAlert(deviceId, value, metricType, direction);
   }
 }
 
@@ -103,27 +161,13 @@ void NotificationService::sendTelegramMessage(long chatId,
     return;
   }
 
-  try {
-    nlohmann::json payload;
-    payload["chat_id"] = chatId;
-    payload["text"] = message;
-    payload["parse_mode"] = "HTML";
-
-    std::string url =
-        "https://api.telegram.org/bot" + botToken_ + "/sendMessage";
-
-    cpr::Response response = cpr::Post(
-        cpr::Url{url}, cpr::Header{{"Content-Type", "application/json"}},
-        cpr::Body{payload.dump()}, cpr::Timeout{5000});
-
-    if (response.status_code == 200) {
-      std::cout << "✅ Telegram message sent successfully" << std::endl;
-    } else {
-      std::cerr << "❌ Failed to send Telegram: " << response.status_code
-                << " - " << response.text << std::endl;
-    }
-  } catch (const std::exception& e) {
-    std::cerr << "❌ Telegram send exception: " << e.what() << std::endl;
+  NotificationJob job;
+  job.channel = NotificationJob::Channel::Telegram;
+  job.chatId = chatId;
+  job.text = message;
+  if (!outbox_->enqueue(std::move(job))) {
+    std::cerr << "❌ Очередь уведомлений недоступна, сообщение для "
+              << chatId << " отброшено" << std::endl;
   }
 }
 
@@ -134,30 +178,223 @@ void NotificationService::broadcastAlert(const std::vector<long>& chatIds,
                                          const std::string& direction) {
   // Telegram broadcast
   if (telegramEnabled_) {
-    std::string message = utils::Formatter::formatAlertMessage(
-        deviceId, value, metricType, direction);
-
     for (long chatId : chatIds) {
-      sendTelegramMessage(chatId, message);
+      queueTelegramAlert(
+          chatId, makeAlertEvent(deviceId, value, metricType, direction));
     }
   }
 
   // Email broadcast (если доступен)
   if (isEmailAvailable()) {
-    std::cout << "📧 Sending broadcast email alert for device " << deviceId
+    enqueueEmailAlert(deviceId, value, metricType, direction);
+  }
+}
+
+void NotificationService::queueTelegramAlert(long chatId,
+                                             models::AlertEvent alert) {
+  if (!coalescer_) {
+    sendTelegramMessage(chatId, formatSingleAlert(alert));
+    return;
+  }
+
+  coalescer_->add(chatId, std::move(alert));
+}
+
+void NotificationService::sendResolvedAlert(long chatId,
+                                            const std::string& deviceId,
+                                            double value,
+                                            const std::string& metricType,
+                                            const std::string& direction) {
+  // Только Telegram: письмо на каждое восстановление - лишний шум
+  if (!telegramEnabled_) {
+    return;
+  }
+
+  auto alert = makeAlertEvent(deviceId, value, metricType, direction);
+  alert.resolved = true;
+  queueTelegramAlert(chatId, std::move(alert));
+}
+
+void NotificationService::sendDeviceStatusAlert(long chatId,
+                                                const std::string& deviceId,
+                                                bool online,
+                                                double silentSeconds,
+                                                uint32_t suppressedBefore) {
+  if (!telegramEnabled_) {
+    return;
+  }
+
+  auto alert = makeAlertEvent(deviceId, silentSeconds, "connectivity",
+                              online ? "online" : "offline");
+  alert.resolved = online;
+  alert.suppressedBefore = suppressedBefore;
+  queueTelegramAlert(chatId, std::move(alert));
+}
+
+void NotificationService::sendAnomalyAlert(long chatId,
+                                           const std::string& deviceId,
+                                           double value,
+                                           const std::string& metricType,
+                                           uint32_t suppressedBefore) {
+  if (!telegramEnabled_) {
+    return;
+  }
+
+  auto alert = makeAlertEvent(deviceId, value, metricType, "anomaly");
+  alert.suppressedBefore = suppressedBefore;
+  queueTelegramAlert(chatId, std::move(alert));
+}
+
+std::string NotificationService::formatSingleAlert(
+    const models::AlertEvent& alert) {
+  if (alert.metricType == "connectivity") {
+    return utils::Formatter::formatDeviceStatusMessage(
+               alert.deviceId, alert.resolved, alert.value) +
+           utils::Formatter::formatSuppressedNote(alert.suppressedBefore);
+  }
+  if (alert.direction == "anomaly") {
+    return utils::Formatter::formatAnomalyMessage(alert.deviceId, alert.value,
+                                                  alert.metricType) +
+           utils::Formatter::formatSuppressedNote(alert.suppressedBefore);
+  }
+  if (alert.resolved) {
+    return utils::Formatter::formatResolvedMessage(
+        alert.deviceId, alert.value, alert.metricType, alert.direction);
+  }
+  return utils::Formatter::formatAlertMessage(alert.deviceId, alert.value,
+                                              alert.metricType,
+                                              alert.direction) +
+         utils::Formatter::formatSuppressedNote(alert.suppressedBefore);
+}
+
+void NotificationService::flushAlerts(long chatId,
+                                      std::vector<models::AlertEvent> alerts) {
+  if (alerts.empty()) {
+    return;
+  }
+
+  if (alerts.size() > 1) {
+    std::cout << "🔔 Queueing alert digest (" << alerts.size() << ") to "
+              << chatId << std::endl;
+  }
+  sendTelegramMessage(chatId, formatAlerts(alerts));
+}
+
+std::string NotificationService::formatAlerts(
+    const std::vector<models::AlertEvent>& alerts) {
+  // Одиночное оповещение выглядит как раньше, несколько - одной сводкой
+  if (alerts.size() == 1) {
+    return formatSingleAlert(alerts.front());
+  }
+  return utils::Formatter::formatAlertDigest(alerts);
+}
+
+void NotificationService::enqueueEmailAlert(const std::string& deviceId,
+                                            double value,
+                                            const std::string& metricType,
+                                            const std::string& direction) {
+  if (emailDigest_) {
+    emailDigest_->add(0,
+                      makeAlertEvent(deviceId, value, metricType, direction));
+    return;
+  }
+
+  NotificationJob job;
+  job.channel = NotificationJob::Channel::Email;
+  job.deviceId = deviceId;
+  job.value = value;
+  job.metricType = metricType;
+  job.direction = direction;
+  if (!outbox_->enqueue(std::move(job))) {
+    std::cerr << "❌ Очередь уведомлений недоступна, email для " << deviceId
+              << " отброшен" << std::endl;
+  }
+}
+
+void NotificationService::enqueueEmailDigest(
+    std::vector<models::AlertEvent> alerts) {
+  if (alerts.empty()) {
+    return;
+  }
+
+  NotificationJob job;
+  job.channel = NotificationJob::Channel::Email;
+  job.deviceId = alerts.front().deviceId;
+  job.alerts = std::move(alerts);
+  if (!outbox_->enqueue(std::move(job))) {
+    std::cerr << "❌ Очередь уведомлений недоступна, сводка email отброшена"
               << std::endl;
+  }
+}
 
-    try {
-      bool emailSent =
-          emailService_->sendAlertEmail(deviceId, value, metricType, direction);
-      if (emailSent) {
-        std::cout << "✅ Broadcast email sent successfully" << std::endl;
+DeliveryResult NotificationService::deliverNow(const NotificationJob& job) {
+  return deliver(job);
+}
+
+DeliveryResult NotificationService::deliver(const NotificationJob& job) {
+  switch (job.channel) {
+    case NotificationJob::Channel::Telegram:
+      if (!telegramEnabled_) {
+        return DeliveryResult::failed("telegram not configured");
       }
-    } catch (const std::exception& e) {
-      std::cerr << "❌ Error sending broadcast email: " << e.what()
-                << std::endl;
-    }
+      if (job.text.empty() && !job.alerts.empty()) {
+        return deliverTelegram(job.chatId, formatAlerts(job.alerts));
+      }
+      return deliverTelegram(job.chatId, job.text);
+    case NotificationJob::Channel::Email:
+      return deliverEmail(job);
+  }
+  return DeliveryResult::failed("unknown channel");
+}
+
+DeliveryResult NotificationService::deliverTelegram(
+    long chatId, const std::string& message) {
+  TelegramResponse response = telegram_->sendMessage(chatId, message, "HTML");
+
+  if (response.ok()) {
+    std::cout << "✅ Telegram message sent to " << chatId << std::endl;
+    return DeliveryResult::delivered();
+  }
+
+  std::string error = "Telegram " + std::to_string(response.statusCode) +
+                      ": " + response.body;
+
+  if (response.statusCode == 429) {
+    return DeliveryResult::retry(error, response.retryAfter);
+  }
+
+  // Сеть (код 0) и ошибки сервера - временные; прочие 4xx - нет
+  if (response.statusCode == 0 || response.statusCode >= 500) {
+    return DeliveryResult::retry(error);
+  }
+
+  std::cerr << "❌ Failed to send Telegram: " << error << std::endl;
+  return DeliveryResult::failed(error);
+}
+
+DeliveryResult NotificationService::deliverEmail(const NotificationJob& job) {
+  if (!isEmailAvailable()) {
+    return DeliveryResult::failed("email service not configured");
   }
+
+  bool emailSent = false;
+  if (!job.alerts.empty()) {
+    std::cout << "📧 Sending email alert digest (" << job.alerts.size()
+              << ")" << std::endl;
+    emailSent = emailService_->sendAlertDigest(job.alerts);
+  } else {
+    std::cout << "📧 Sending email alert for device " << job.deviceId
+              << std::endl;
+    emailSent = emailService_->sendAlertEmail(job.deviceId, job.value,
+                                              job.metricType, job.direction);
+  }
+  if (!emailSent) {
+    std::cout << "⚠️  Email alert failed to send" << std::endl;
+    return DeliveryResult::retry("SMTP send failed");
+  }
+
+  std::cout << "✅ Email alert sent successfully" << std::endl;
+  return DeliveryResult::delivered();
 }
 
 std::string NotificationService::formatAlertMessage(
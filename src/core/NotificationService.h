@@ -4,6 +4,10 @@
 #include <string>
 #include <vector>
 
+#include "AlertCoalescer.h"
+#include "NotificationOutbox.h"
+#include "TelegramClient.h"
+
 namespace iot_core::smtp {
 class EmailService;  // Forward declaration
 }
@@ -12,16 +16,42 @@ namespace iot_core::core {
 
 class NotificationService {
  public:
-  explicit NotificationService(const std::string& botToken);
+  // window == 0 - каждое оповещение отдельным сообщением (письмом)
+  explicit NotificationService(
+      const std::string& botToken,
+      NotificationOutbox::Options outboxOptions = NotificationOutbox::Options(),
+      AlertCoalescer::Options coalesceOptions = AlertCoalescer::Options(),
+      AlertCoalescer::Options emailDigestOptions = AlertCoalescer::Options());
   ~NotificationService();
 
-  // Отправка уведомлений
+  // Отправка уведомлений: задания ставятся в очередь, доставка в фоне.
+  // Telegram-оповещения одного чата и email-оповещения в пределах окна
+  // объединяются в сводку
+  // suppressedBefore - сколько оповещений чата перед этим срезал лимит
   void sendTelegramAlert(long chatId, const std::string& deviceId, double value,
                          const std::string& metricType,
-                         const std::string& direction);
+                         const std::string& direction,
+                         uint32_t suppressedBefore = 0);
 
   void sendTelegramMessage(long chatId, const std::string& message);
 
+  // Значение, по которому было оповещение, вернулось в норму
+  void sendResolvedAlert(long chatId, const std::string& deviceId,
+                         double value, const std::string& metricType,
+                         const std::string& direction);
+
+  // Устройство перестало присылать данные или снова в сети (только
+  // Telegram); silentSeconds - сколько данных не было
+  void sendDeviceStatusAlert(long chatId, const std::string& deviceId,
+                             bool online, double silentSeconds,
+                             uint32_t suppressedBefore = 0);
+
+  // Показание резко отличается от обычных значений устройства (только
+  // Telegram)
+  void sendAnomalyAlert(long chatId, const std::string& deviceId,
+                        double value, const std::string& metricType,
+                        uint32_t suppressedBefore = 0);
+
   // Групповые уведомления
   void broadcastAlert(const std::vector<long>& chatIds,
                       const std::string& deviceId, double value,
@@ -35,6 +65,20 @@ class NotificationService {
   // Email тестирование
   bool testEmailConnection();
 
+  NotificationOutbox::Statistics getOutboxStatistics() const;
+  AlertCoalescer::Statistics getCoalescerStatistics() const;
+  AlertCoalescer::Statistics getEmailDigestStatistics() const;
+  // Общий клиент Bot API (nullptr без токена) - им же пользуется бот
+  std::shared_ptr<TelegramClient> getTelegramClient() const {
+    return telegram_;
+  }
+  // Доставляет оставшиеся задания и останавливает отправителей
+  void shutdown();
+
+  // Синхронная доставка задания в текущем потоке (общая очередь в БД);
+  // Telegram-задание без текста собирается из alerts
+  DeliveryResult deliverNow(const NotificationJob& job);
+
  private:
   // Методы форматирования
   std::string formatAlertMessage(const std::string& deviceId, double value,
@@ -48,9 +92,31 @@ class NotificationService {
   std::string getMetricUnit(const std::string& metricType) const;
   std::string getMetricName(const std::string& metricType) const;
 
+  // Доставка одного задания (в потоке очереди)
+  DeliveryResult deliver(const NotificationJob& job);
+  DeliveryResult deliverTelegram(long chatId, const std::string& message);
+  DeliveryResult deliverEmail(const NotificationJob& job);
+  // Постановка сообщения в Telegram для одного или нескольких оповещений
+  void flushAlerts(long chatId, std::vector<models::AlertEvent> alerts);
+  void queueTelegramAlert(long chatId, models::AlertEvent alert);
+  static std::string formatSingleAlert(const models::AlertEvent& alert);
+  // Одно оповещение - как раньше, несколько - сводкой
+  static std::string formatAlerts(
+      const std::vector<models::AlertEvent>& alerts);
+  void enqueueEmailAlert(const std::string& deviceId, double value,
+                         const std::string& metricType,
+                         const std::string& direction);
+  void enqueueEmailDigest(std::vector<models::AlertEvent> alerts);
+
   std::string botToken_;
   bool telegramEnabled_ = false;
+  std::shared_ptr<TelegramClient> telegram_;
   std::unique_ptr<smtp::EmailService> emailService_;
+  std::unique_ptr<NotificationOutbox> outbox_;
+  // nullptr - объединение отключено
+  std::unique_ptr<AlertCoalescer> coalescer_;
+  // Все письма уходят одному списку получателей - окно одно
+  std::unique_ptr<AlertCoalescer> emailDigest_;
 };
 
 }  // namespace iot_core::core
\ No newline at end of file
@@ -4,8 +4,22 @@
 #include <iostream>
 #include <sstream>
 
+#include "../utils/Formatter.h"
+
 namespace iot_core::core {
 
+namespace {
+
+// Граница по времени для timestamp без зоны (местное время, см.
+// Formatter::toLocalWallClock); число, поэтому подставляется в запрос
+std::string sinceBound(int64_t sinceUs) {
+  return "to_timestamp(" +
+         std::to_string(utils::Formatter::toLocalWallClock(sinceUs)) +
+         "::float8 / 1000000) AT TIME ZONE 'UTC'";
+}
+
+}  // namespace
+
 RemoteDatabaseConnection::RemoteDatabaseConnection(
     const std::string& connectionString)
     : connectionString_(connectionString) {
@@ -83,7 +97,7 @@ void RemoteDatabaseConnection::reconnectIfNeeded() {
 }
 
 std::vector<models::IoTData> RemoteDatabaseConnection::getTelemetryData(
-    const std::string& deviceId, int limit, const std::string& timeFrom) {
+    const std::string& deviceId, int limit, int64_t sinceUs) {
   reconnectIfNeeded();
   std::vector<models::IoTData> results;
 
@@ -97,11 +111,11 @@ std::vector<models::IoTData> RemoteDatabaseConnection::getTelemetryData(
       // Получаем данные для всех устройств
       query =
           "SELECT id, device_id, temperature, humidity, "
-          "to_char(timestamp, 'YYYY-MM-DD HH24:MI:SS') as ts "
+          "(extract(epoch FROM timestamp) * 1000000)::bigint AS ts_us "
           "FROM telemetry_data ";
 
-      if (!timeFrom.empty()) {
-        query += "WHERE timestamp >= '" + timeFrom + "' ";
+      if (sinceUs != 0) {
+        query += "WHERE timestamp >= " + sinceBound(sinceUs) + " ";
       }
 
       query += "ORDER BY timestamp DESC LIMIT " + std::to_string(limit);
@@ -111,11 +125,11 @@ std::vector<models::IoTData> RemoteDatabaseConnection::getTelemetryData(
       // Получаем данные для конкретного устройства
       query =
           "SELECT id, device_id, temperature, humidity, "
-          "to_char(timestamp, 'YYYY-MM-DD HH24:MI:SS') as ts "
+          "(extract(epoch FROM timestamp) * 1000000)::bigint AS ts_us "
           "FROM telemetry_data WHERE device_id = $1 ";
 
-      if (!timeFrom.empty()) {
-        query += "AND timestamp >= '" + timeFrom + "' ";
+      if (sinceUs != 0) {
+        query += "AND timestamp >= " + sinceBound(sinceUs) + " ";
       }
 
       query += "ORDER BY timestamp DESC LIMIT " + std::to_string(limit);
@@ -129,7 +143,8 @@ std::vector<models::IoTData> RemoteDatabaseConnection::getTelemetryData(
       data.deviceId = row["device_id"].as<std::string>();
       data.temperature = row["temperature"].as<double>();
       data.humidity = row["humidity"].as<double>();
-      data.timestamp = row["ts"].as<std::string>();
+      data.timestampUs =
+          utils::Formatter::fromLocalWallClock(row["ts_us"].as<int64_t>());
 
       results.push_back(data);
     }
@@ -161,7 +176,7 @@ RemoteDatabaseConnection::getLatestTelemetryForAllDevices() {
     // Используем DISTINCT ON для получения последней записи каждого устройства
     auto result = transaction.exec(
         "SELECT DISTINCT ON (device_id) id, device_id, temperature, humidity, "
-        "to_char(timestamp, 'YYYY-MM-DD HH24:MI:SS') as ts "
+        "(extract(epoch FROM timestamp) * 1000000)::bigint AS ts_us "
         "FROM telemetry_data "
         "ORDER BY device_id, timestamp DESC");
 
@@ -171,7 +186,8 @@ RemoteDatabaseConnection::getLatestTelemetryForAllDevices() {
       data.deviceId = row["device_id"].as<std::string>();
       data.temperature = row["temperature"].as<double>();
       data.humidity = row["humidity"].as<double>();
-      data.timestamp = row["ts"].as<std::string>();
+      data.timestampUs =
+          utils::Formatter::fromLocalWallClock(row["ts_us"].as<int64_t>());
 
       results.push_back(data);
     }
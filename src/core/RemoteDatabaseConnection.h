@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <pqxx/pqxx>
@@ -16,9 +17,9 @@ class RemoteDatabaseConnection {
   bool connect();
   bool isConnected() const;
   void disconnect();
+  // sinceUs - Unix-время в микросекундах, 0 - без ограничения
   std::vector<models::IoTData> getTelemetryData(
-      const std::string& deviceId = "", int limit = 10,
-      const std::string& timeFrom = "");
+      const std::string& deviceId = "", int limit = 10, int64_t sinceUs = 0);
   std::vector<models::IoTData> getLatestTelemetryForAllDevices();
   std::vector<models::IoTData> getDeviceTelemetry(const std::string& deviceId,
                                                   int limit = 10);
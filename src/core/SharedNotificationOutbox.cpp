@@ -0,0 +1,257 @@
+// src/core/SharedNotificationOutbox.cpp
+#include "SharedNotificationOutbox.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+#include "Database.h"
+
+namespace iot_core::core {
+
+namespace {
+
+constexpr const char* kTelegramChannel = "telegram";
+constexpr const char* kEmailChannel = "email";
+
+// Очистка завершенных записей - не чаще раза в час
+constexpr auto kPurgeInterval = std::chrono::hours(1);
+
+std::string defaultNodeId() {
+  char host[256] = {};
+  if (gethostname(host, sizeof(host) - 1) != 0) {
+    host[0] = '\0';
+  }
+  return std::string(host[0] ? host : "node") + ":" +
+         std::to_string(getpid());
+}
+
+std::vector<int64_t> idsOf(const std::vector<models::OutboxEntry>& entries) {
+  std::vector<int64_t> ids;
+  ids.reserve(entries.size());
+  for (const auto& entry : entries) {
+    ids.push_back(entry.id);
+  }
+  return ids;
+}
+
+}  // namespace
+
+SharedNotificationOutbox::SharedNotificationOutbox(
+    std::shared_ptr<DatabaseRepository> database, Options options)
+    : database_(std::move(database)), options_(std::move(options)) {
+  if (options_.nodeId.empty()) {
+    options_.nodeId = defaultNodeId();
+  }
+  options_.batchSize = std::max<size_t>(1, options_.batchSize);
+  options_.maxAttempts = std::max(1, options_.maxAttempts);
+}
+
+SharedNotificationOutbox::~SharedNotificationOutbox() { stop(); }
+
+void SharedNotificationOutbox::start(NotificationOutbox::Deliverer deliverer) {
+  if (running_) {
+    return;
+  }
+
+  deliverer_ = std::move(deliverer);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  running_ = true;
+  thread_ = std::thread([this]() { dispatchLoop(); });
+
+  std::cout << "📮 Shared notification outbox started (node "
+            << options_.nodeId << ")" << std::endl;
+}
+
+void SharedNotificationOutbox::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    stopping_ = true;
+  }
+  cv_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  running_ = false;
+}
+
+bool SharedNotificationOutbox::publishTelegram(
+    const std::string& dedupKey, long chatId,
+    const models::AlertEvent& alert) {
+  models::OutboxEntry entry;
+  entry.dedupKey = dedupKey;
+  entry.channel = kTelegramChannel;
+  entry.chatId = chatId;
+  entry.alert = alert;
+  return publish(std::move(entry));
+}
+
+bool SharedNotificationOutbox::publishEmail(const std::string& dedupKey,
+                                            const models::AlertEvent& alert) {
+  models::OutboxEntry entry;
+  entry.dedupKey = dedupKey;
+  entry.channel = kEmailChannel;
+  entry.alert = alert;
+  return publish(std::move(entry));
+}
+
+bool SharedNotificationOutbox::publish(models::OutboxEntry entry) {
+  bool inserted = false;
+  if (!database_->insertOutboxEntry(entry, inserted)) {
+    statistics_.publishErrors++;
+    return false;
+  }
+  if (!inserted) {
+    statistics_.duplicates++;
+    return false;
+  }
+
+  statistics_.published++;
+  // Отправитель этого узла не ждет конца паузы опроса
+  cv_.notify_one();
+  return true;
+}
+
+void SharedNotificationOutbox::dispatchLoop() {
+  auto lastPurge = std::chrono::steady_clock::now();
+
+  while (true) {
+    size_t claimed = dispatchOnce();
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPurge >= kPurgeInterval) {
+      lastPurge = now;
+      statistics_.purged += database_->purgeOutbox(options_.retention);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+      break;
+    }
+    // Полная пачка - вероятно, есть еще: забираем сразу
+    if (claimed < options_.batchSize) {
+      cv_.wait_for(lock, options_.pollInterval);
+    }
+    if (stopping_) {
+      break;
+    }
+  }
+}
+
+size_t SharedNotificationOutbox::dispatchOnce() {
+  auto entries = database_->claimOutboxEntries(
+      options_.nodeId, options_.batchSize, options_.lease);
+  if (entries.empty()) {
+    return 0;
+  }
+  statistics_.claimed += entries.size();
+
+  // Telegram - сводка на чат, email - одна сводка на пачку
+  std::map<long, std::vector<models::OutboxEntry>> telegram;
+  std::vector<models::OutboxEntry> email;
+  for (auto& entry : entries) {
+    if (entry.channel == kEmailChannel) {
+      email.push_back(std::move(entry));
+    } else {
+      telegram[entry.chatId].push_back(std::move(entry));
+    }
+  }
+
+  auto deliver = [this](NotificationJob job,
+                        const std::vector<models::OutboxEntry>& group) {
+    for (const auto& entry : group) {
+      job.alerts.push_back(entry.alert);
+    }
+    DeliveryResult result;
+    try {
+      result = deliverer_(job);
+    } catch (const std::exception& e) {
+      result = DeliveryResult::retry(e.what());
+    }
+    complete(group, result);
+  };
+
+  for (const auto& [chatId, group] : telegram) {
+    NotificationJob job;
+    job.channel = NotificationJob::Channel::Telegram;
+    job.chatId = chatId;
+    deliver(std::move(job), group);
+  }
+  if (!email.empty()) {
+    NotificationJob job;
+    job.channel = NotificationJob::Channel::Email;
+    job.deviceId = email.front().alert.deviceId;
+    deliver(std::move(job), email);
+  }
+
+  return entries.size();
+}
+
+void SharedNotificationOutbox::complete(
+    const std::vector<models::OutboxEntry>& entries,
+    const DeliveryResult& result) {
+  auto ids = idsOf(entries);
+
+  if (result.status == DeliveryResult::Status::Delivered) {
+    database_->completeOutboxEntries(ids);
+    statistics_.delivered += ids.size();
+    return;
+  }
+
+  int attempts = 0;
+  for (const auto& entry : entries) {
+    attempts = std::max(attempts, entry.attempts);
+  }
+
+  if (result.status == DeliveryResult::Status::Failed ||
+      attempts >= options_.maxAttempts) {
+    std::cerr << "❌ Уведомление не доставлено после " << attempts
+              << " попыток: " << result.error << std::endl;
+    database_->failOutboxEntries(ids, options_.nodeId, result.error);
+    statistics_.failed += ids.size();
+    return;
+  }
+
+  auto delay = result.retryAfter.count() > 0 ? result.retryAfter
+                                             : backoffFor(attempts);
+  database_->retryOutboxEntries(ids, options_.nodeId, delay, result.error);
+  statistics_.retried += ids.size();
+}
+
+std::chrono::milliseconds SharedNotificationOutbox::backoffFor(int attempts) {
+  // Та же схема, что у локальной очереди: экспонента с разбросом
+  auto delay = options_.baseBackoff;
+  for (int i = 1; i < attempts && delay < options_.maxBackoff; ++i) {
+    delay *= 2;
+  }
+  delay = std::min(delay, options_.maxBackoff);
+
+  std::uniform_int_distribution<long long> jitter(delay.count() / 2,
+                                                  delay.count());
+  return std::chrono::milliseconds(jitter(random_));
+}
+
+SharedNotificationOutbox::Statistics SharedNotificationOutbox::getStatistics()
+    const {
+  Statistics stats;
+  stats.published = statistics_.published.load();
+  stats.duplicates = statistics_.duplicates.load();
+  stats.publishErrors = statistics_.publishErrors.load();
+  stats.claimed = statistics_.claimed.load();
+  stats.delivered = statistics_.delivered.load();
+  stats.retried = statistics_.retried.load();
+  stats.failed = statistics_.failed.load();
+  stats.purged = statistics_.purged.load();
+  return stats;
+}
+
+}  // namespace iot_core::core
@@ -0,0 +1,115 @@
+// src/core/SharedNotificationOutbox.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../models/IoTData.h"
+#include "NotificationOutbox.h"
+
+namespace iot_core::core {
+
+class DatabaseRepository;
+
+/**
+ * @brief Общая для нескольких экземпляров очередь уведомлений в PostgreSQL
+ *
+ * Проверка оповещений вставляет событие в таблицу notification_outbox
+ * с ключом, одинаковым на всех узлах (чат, устройство, тип, окно
+ * подавления), через ON CONFLICT DO NOTHING - событие, которое
+ * обнаружили несколько узлов, попадает в очередь один раз. Отправители
+ * любого узла забирают пачки записей через FOR UPDATE SKIP LOCKED с
+ * арендой на lease, доставляют и отмечают результат.
+ *
+ * Доставка ровно один раз на ключ, кроме случая, когда узел упал между
+ * отправкой и подтверждением: по истечении аренды запись заберет другой
+ * узел. Записи одного чата из одной пачки уходят одной сводкой.
+ */
+class SharedNotificationOutbox {
+ public:
+  struct Options {
+    std::string nodeId;  // пусто - имя хоста и pid
+    std::chrono::milliseconds pollInterval{500};
+    size_t batchSize = 100;
+    std::chrono::seconds lease{60};
+    int maxAttempts = 5;
+    std::chrono::milliseconds baseBackoff{1000};
+    std::chrono::milliseconds maxBackoff{60000};
+    // Завершенные записи хранятся не меньше окна подавления повторов
+    std::chrono::hours retention{24};
+  };
+
+  struct Statistics {
+    uint64_t published = 0;
+    uint64_t duplicates = 0;  // событие уже вставил другой узел
+    uint64_t publishErrors = 0;
+    uint64_t claimed = 0;
+    uint64_t delivered = 0;
+    uint64_t retried = 0;
+    uint64_t failed = 0;
+    uint64_t purged = 0;
+  };
+
+  SharedNotificationOutbox(std::shared_ptr<DatabaseRepository> database,
+                           Options options);
+  ~SharedNotificationOutbox();
+
+  SharedNotificationOutbox(const SharedNotificationOutbox&) = delete;
+  SharedNotificationOutbox& operator=(const SharedNotificationOutbox&) =
+      delete;
+
+  // Доставка задания идет синхронно в потоке отправителя
+  void start(NotificationOutbox::Deliverer deliverer);
+  // Недоставленные записи остаются в таблице для других узлов
+  void stop();
+  bool isRunning() const { return running_; }
+
+  // false - событие с таким ключом уже в очереди или ошибка БД
+  bool publishTelegram(const std::string& dedupKey, long chatId,
+                       const models::AlertEvent& alert);
+  bool publishEmail(const std::string& dedupKey,
+                    const models::AlertEvent& alert);
+
+  const std::string& nodeId() const { return options_.nodeId; }
+  Statistics getStatistics() const;
+
+ private:
+  bool publish(models::OutboxEntry entry);
+  void dispatchLoop();
+  // Число забранных записей
+  size_t dispatchOnce();
+  void complete(const std::vector<models::OutboxEntry>& entries,
+                const DeliveryResult& result);
+  std::chrono::milliseconds backoffFor(int attempts);
+
+  std::shared_ptr<DatabaseRepository> database_;
+  Options options_;
+  NotificationOutbox::Deliverer deliverer_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<bool> running_{false};
+  bool stopping_ = false;
+  std::thread thread_;
+  std::mt19937 random_{std::random_device{}()};
+
+  struct {
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> duplicates{0};
+    std::atomic<uint64_t> publishErrors{0};
+    std::atomic<uint64_t> claimed{0};
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> retried{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> purged{0};
+  } statistics_;
+};
+
+}  // namespace iot_core::core
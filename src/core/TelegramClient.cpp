@@ -0,0 +1,203 @@
+// src/core/TelegramClient.cpp
+#include "TelegramClient.h"
+
+#include <cpr/cpr.h>
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+namespace iot_core::core {
+
+// Общие для всех сессий кэши curl (DNS, TLS-сессии, соединения)
+struct TelegramClient::Shared {
+  CURLSH* handle = nullptr;
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> locks;
+
+  Shared() {
+    handle = curl_share_init();
+    if (!handle) {
+      return;
+    }
+    curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, &Shared::lock);
+    curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, &Shared::unlock);
+    curl_share_setopt(handle, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+
+  ~Shared() {
+    if (handle) {
+      curl_share_cleanup(handle);
+    }
+  }
+
+  static void lock(CURL*, curl_lock_data data, curl_lock_access,
+                   void* userptr) {
+    static_cast<Shared*>(userptr)->locks[data].lock();
+  }
+
+  static void unlock(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<Shared*>(userptr)->locks[data].unlock();
+  }
+};
+
+TelegramClient::TelegramClient(std::string botToken)
+    : TelegramClient(std::move(botToken), Options()) {}
+
+TelegramClient::TelegramClient(std::string botToken, Options options)
+    : apiUrl_(options.baseUrl + "/bot" + botToken),
+      options_(std::move(options)),
+      limiter_(options_.rateLimits),
+      shared_(std::make_unique<Shared>()) {
+  options_.poolSize = std::max<size_t>(1, options_.poolSize);
+}
+
+// Сессии должны закрыться раньше общего кэша, на который они ссылаются
+TelegramClient::~TelegramClient() {
+  idle_.clear();
+  pollSession_.reset();
+}
+
+std::unique_ptr<cpr::Session> TelegramClient::createSession() {
+  auto session = std::make_unique<cpr::Session>();
+  session->SetHeader(cpr::Header{{"Content-Type", "application/json"}});
+  session->SetConnectTimeout(cpr::ConnectTimeout{options_.connectTimeout});
+
+  CURL* curl = session->GetCurlHolder()->handle;
+  if (curl) {
+    if (shared_->handle) {
+      curl_easy_setopt(curl, CURLOPT_SHARE, shared_->handle);
+    }
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  }
+  return session;
+}
+
+std::unique_ptr<cpr::Session> TelegramClient::acquire() {
+  std::unique_lock<std::mutex> lock(poolMutex_);
+  poolCv_.wait(lock, [this]() {
+    return !idle_.empty() || created_ < options_.poolSize;
+  });
+
+  if (!idle_.empty()) {
+    auto session = std::move(idle_.back());
+    idle_.pop_back();
+    return session;
+  }
+
+  ++created_;
+  lock.unlock();
+  return createSession();
+}
+
+void TelegramClient::release(std::unique_ptr<cpr::Session> session) {
+  {
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    idle_.push_back(std::move(session));
+  }
+  poolCv_.notify_one();
+}
+
+TelegramResponse TelegramClient::sendMessage(long chatId,
+                                             const std::string& text,
+                                             const std::string& parseMode) {
+  nlohmann::json payload;
+  payload["chat_id"] = chatId;
+  payload["text"] = text;
+  if (!parseMode.empty()) {
+    payload["parse_mode"] = parseMode;
+  }
+
+  std::this_thread::sleep_until(limiter_.reserve(chatId));
+
+  auto session = acquire();
+  session->SetUrl(cpr::Url{apiUrl_ + "/sendMessage"});
+  session->SetBody(cpr::Body{payload.dump()});
+  session->SetTimeout(cpr::Timeout{options_.timeout});
+  cpr::Response response = session->Post();
+  release(std::move(session));
+
+  auto result = finish(response.status_code, std::move(response.text),
+                       response.error.message, response.elapsed * 1000.0);
+  if (result.retryAfter.count() > 0) {
+    limiter_.pauseUntil(TelegramRateLimiter::Clock::now() + result.retryAfter);
+  }
+  return result;
+}
+
+TelegramResponse TelegramClient::getUpdates(long offset, int timeoutSeconds) {
+  std::lock_guard<std::mutex> lock(pollMutex_);
+  if (!pollSession_) {
+    pollSession_ = createSession();
+  }
+
+  pollSession_->SetUrl(cpr::Url{apiUrl_ + "/getUpdates"});
+  pollSession_->SetParameters(
+      cpr::Parameters{{"offset", std::to_string(offset)},
+                      {"timeout", std::to_string(timeoutSeconds)}});
+  // Сервер держит запрос до timeoutSeconds - запас сверху
+  pollSession_->SetTimeout(cpr::Timeout{
+      std::chrono::milliseconds((timeoutSeconds + 5) * 1000)});
+  cpr::Response response = pollSession_->Get();
+
+  return finish(response.status_code, std::move(response.text),
+                response.error.message, response.elapsed * 1000.0);
+}
+
+TelegramClient::Statistics TelegramClient::getStatistics() const {
+  Statistics stats;
+  {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats = statistics_;
+    if (stats.requests > 0) {
+      stats.avgLatencyMs =
+          totalLatencyMs_ / static_cast<double>(stats.requests);
+    }
+  }
+  std::lock_guard<std::mutex> lock(poolMutex_);
+  stats.sessions = created_;
+  return stats;
+}
+
+TelegramResponse TelegramClient::finish(long statusCode, std::string body,
+                                        std::string error, double elapsedMs) {
+  TelegramResponse result;
+  result.statusCode = statusCode;
+  result.body = std::move(body);
+  result.error = std::move(error);
+
+  if (statusCode == 429) {
+    // Превышен лимит: сервер сообщает, через сколько секунд повторить
+    auto json = nlohmann::json::parse(result.body, nullptr, false);
+    // Тело ответа не проверено: неожиданные типы полей не должны
+    // превращать ограничение в исключение
+    int retryAfter = 1;
+    if (json.is_object() && json.contains("parameters") &&
+        json["parameters"].is_object()) {
+      const auto& parameters = json["parameters"];
+      auto it = parameters.find("retry_after");
+      if (it != parameters.end() && it->is_number()) {
+        retryAfter = it->get<int>();
+      }
+    }
+    result.retryAfter =
+        std::chrono::milliseconds(std::max(1, retryAfter) * 1000);
+  }
+
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  ++statistics_.requests;
+  totalLatencyMs_ += elapsedMs;
+  if (statusCode != 200) {
+    ++statistics_.failures;
+  }
+  if (statusCode == 429) {
+    ++statistics_.rateLimited;
+  }
+  return result;
+}
+
+}  // namespace iot_core::core
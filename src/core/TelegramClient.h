@@ -0,0 +1,101 @@
+// src/core/TelegramClient.h
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "TelegramRateLimiter.h"
+
+namespace cpr {
+class Session;
+}
+
+namespace iot_core::core {
+
+// Ответ Bot API на один запрос
+struct TelegramResponse {
+  long statusCode = 0;  // 0 - сетевая ошибка
+  std::string body;
+  std::string error;
+  // Пауза из ответа 429 (parameters.retry_after)
+  std::chrono::milliseconds retryAfter{0};
+
+  bool ok() const { return statusCode == 200; }
+};
+
+/**
+ * @brief Общий HTTP-клиент Telegram Bot API
+ *
+ * Держит пул сессий cpr, каждая со своим постоянным соединением к
+ * api.telegram.org, так что сообщения не платят за новое TLS-рукопожатие.
+ * DNS-кэш и кэш TLS-сессий общие для всего пула. Параллельные отправители
+ * (потоки очереди уведомлений, бот) берут сессии из пула и проходят общий
+ * ограничитель частоты. Для long polling getUpdates выделена отдельная
+ * сессия, чтобы не занимать пул на время ожидания.
+ */
+class TelegramClient {
+ public:
+  struct Options {
+    size_t poolSize = 4;
+    std::chrono::milliseconds timeout{10000};
+    std::chrono::milliseconds connectTimeout{5000};
+    TelegramRateLimiter::Options rateLimits;
+    // Адрес API; меняется для тестового сервера
+    std::string baseUrl = "https://api.telegram.org";
+  };
+
+  struct Statistics {
+    uint64_t requests = 0;
+    uint64_t failures = 0;     // код ответа не 200
+    uint64_t rateLimited = 0;  // ответы 429
+    size_t sessions = 0;       // открыто сессий в пуле
+    double avgLatencyMs = 0.0;
+  };
+
+  explicit TelegramClient(std::string botToken);
+  TelegramClient(std::string botToken, Options options);
+  ~TelegramClient();
+
+  TelegramClient(const TelegramClient&) = delete;
+  TelegramClient& operator=(const TelegramClient&) = delete;
+
+  // Блокирует до свободного по лимитам момента и свободной сессии
+  TelegramResponse sendMessage(long chatId, const std::string& text,
+                               const std::string& parseMode);
+
+  TelegramResponse getUpdates(long offset, int timeoutSeconds);
+
+  Statistics getStatistics() const;
+
+ private:
+  struct Shared;
+
+  std::unique_ptr<cpr::Session> createSession();
+  std::unique_ptr<cpr::Session> acquire();
+  void release(std::unique_ptr<cpr::Session> session);
+  TelegramResponse finish(long statusCode, std::string body,
+                          std::string error, double elapsedMs);
+
+  std::string apiUrl_;
+  Options options_;
+  TelegramRateLimiter limiter_;
+  std::unique_ptr<Shared> shared_;
+
+  mutable std::mutex poolMutex_;
+  std::condition_variable poolCv_;
+  std::vector<std::unique_ptr<cpr::Session>> idle_;
+  size_t created_ = 0;
+
+  std::mutex pollMutex_;
+  std::unique_ptr<cpr::Session> pollSession_;
+
+  mutable std::mutex statsMutex_;
+  Statistics statistics_;
+  double totalLatencyMs_ = 0.0;
+};
+
+}  // namespace iot_core::core
@@ -0,0 +1,93 @@
+// src/core/TelegramRateLimiter.cpp
+#include "TelegramRateLimiter.h"
+
+#include <algorithm>
+
+namespace iot_core::core {
+
+namespace {
+
+// Размер таблицы чатов, после которого из нее убираются прошедшие записи
+constexpr size_t kPruneThreshold = 4096;
+
+}  // namespace
+
+TelegramRateLimiter::TelegramRateLimiter(Options options)
+    : options_(std::move(options)) {
+  double rate = std::max(0.1, options_.messagesPerSecond);
+  globalInterval_ = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / rate));
+}
+
+TelegramRateLimiter::Clock::time_point TelegramRateLimiter::reserve(
+    long chatId, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!started_) {
+    origin_ = now;
+    started_ = true;
+  }
+
+  // Номер первого слота сетки не раньше момента (с округлением вверх)
+  auto slotAtOrAfter = [this](Clock::time_point time) {
+    auto offset = std::max(time - origin_, Clock::duration::zero());
+    return static_cast<int64_t>((offset + globalInterval_ -
+                                 Clock::duration(1)) /
+                                globalInterval_);
+  };
+
+  // Прошедшие слоты больше не нужны
+  int64_t current = slotAtOrAfter(now);
+  if (current > nextSlot_) {
+    nextSlot_ = current;
+    reservedSlots_.erase(reservedSlots_.begin(),
+                         reservedSlots_.lower_bound(nextSlot_));
+  }
+
+  auto earliest = std::max(now, pausedUntil_);
+  auto chat = nextByChat_.find(chatId);
+  if (chat != nextByChat_.end()) {
+    earliest = std::max(earliest, chat->second);
+  }
+
+  int64_t index = std::max(nextSlot_, slotAtOrAfter(earliest));
+  for (auto it = reservedSlots_.lower_bound(index);
+       it != reservedSlots_.end() && *it == index; ++it) {
+    ++index;
+  }
+  if (index == nextSlot_) {
+    ++nextSlot_;
+    while (!reservedSlots_.empty() && *reservedSlots_.begin() == nextSlot_) {
+      reservedSlots_.erase(reservedSlots_.begin());
+      ++nextSlot_;
+    }
+  } else {
+    reservedSlots_.insert(index);
+  }
+  auto slot = origin_ + index * globalInterval_;
+
+  auto chatInterval = chatId < 0 ? options_.groupChatInterval
+                                 : options_.privateChatInterval;
+  nextByChat_[chatId] = slot + chatInterval;
+
+  if (nextByChat_.size() > kPruneThreshold) {
+    pruneLocked(now);
+  }
+  return slot;
+}
+
+void TelegramRateLimiter::pauseUntil(Clock::time_point until) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pausedUntil_ = std::max(pausedUntil_, until);
+}
+
+void TelegramRateLimiter::pruneLocked(Clock::time_point now) {
+  for (auto it = nextByChat_.begin(); it != nextByChat_.end();) {
+    if (it->second <= now) {
+      it = nextByChat_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace iot_core::core
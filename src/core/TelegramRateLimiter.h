@@ -0,0 +1,60 @@
+// src/core/TelegramRateLimiter.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace iot_core::core {
+
+/**
+ * @brief Расписание отправки с учетом лимитов Telegram Bot API
+ *
+ * Бот может отправлять порядка 30 сообщений в секунду в целом, не чаще
+ * одного в секунду в личный чат и около 20 в минуту в группу (у групп
+ * отрицательный chat_id). Каждая отправка резервирует ближайший момент,
+ * свободный по обоим лимитам; вызывающий ждет его сам, не держа
+ * блокировку, так что параллельные отправители выстраиваются в очередь
+ * без лишних 429.
+ *
+ * Общий лимит - сетка слотов шириной 1/messagesPerSecond: каждое
+ * сообщение занимает свой слот. Сообщение, ждущее свой чат, занимает
+ * первый свободный слот после этого момента, не сдвигая общую очередь,
+ * так что частый чат не задерживает остальных.
+ */
+class TelegramRateLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    double messagesPerSecond = 30.0;
+    std::chrono::milliseconds privateChatInterval{1000};
+    std::chrono::milliseconds groupChatInterval{3000};
+  };
+
+  explicit TelegramRateLimiter(Options options);
+
+  // Момент, не раньше которого можно отправить сообщение в chatId
+  Clock::time_point reserve(long chatId, Clock::time_point now = Clock::now());
+
+  // Сервер ответил 429: не отправлять никуда до указанного момента
+  void pauseUntil(Clock::time_point until);
+
+ private:
+  // Чаты, в которые давно не писали, не нужны для расписания
+  void pruneLocked(Clock::time_point now);
+
+  Options options_;
+  Clock::duration globalInterval_;
+
+  std::mutex mutex_;
+  bool started_ = false;
+  Clock::time_point origin_{};  // начало сетки общих слотов
+  int64_t nextSlot_ = 0;        // слоты до него заняты или прошли
+  std::set<int64_t> reservedSlots_;  // занятые слоты после nextSlot_
+  Clock::time_point pausedUntil_{};
+  std::unordered_map<long, Clock::time_point> nextByChat_;
+};
+
+}  // namespace iot_core::core
@@ -0,0 +1,135 @@
+#include "AnomalyDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace iot_core::engine {
+
+namespace {
+
+constexpr uint32_t kMaxSamples = std::numeric_limits<uint16_t>::max();
+
+}  // namespace
+
+AnomalyDetector::AnomalyDetector(
+    Options options, std::shared_ptr<services::DeviceRegistry> devices)
+    : options_(options), devices_(std::move(devices)) {
+  options_.alpha = std::clamp(options_.alpha, 1e-4, 1.0);
+  warmup_ =
+      static_cast<uint16_t>(std::min(options_.warmupSamples, kMaxSamples));
+  // Вес 1/n сменяется на alpha после 1/alpha показаний
+  auto settle = static_cast<uint32_t>(std::ceil(1.0 / options_.alpha));
+  saturation_ = static_cast<uint16_t>(
+      std::min(std::max<uint32_t>(warmup_, settle), kMaxSamples));
+}
+
+const char* AnomalyDetector::metricName(Metric metric) {
+  return metric == Metric::Temperature ? "temperature" : "humidity";
+}
+
+bool AnomalyDetector::observe(const models::IoTData& data, Result& result) {
+  uint32_t device = devices_->intern(data.deviceId);
+  const double values[kMetrics] = {data.temperature, data.humidity};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  reserveLocked(device);
+
+  uint16_t& samples = samples_[device];
+  if (samples == 0) {
+    ++tracked_;
+  }
+  ++observed_;
+
+  const bool warmedUp = samples >= warmup_;
+  const double alpha = std::max(options_.alpha, 1.0 / (samples + 1.0));
+  bool anomalous = false;
+  for (size_t m = 0; m < kMetrics; ++m) {
+    Estimate& estimate = estimates_[device * kMetrics + m];
+    const double mean = estimate.mean;
+    const double variance = estimate.variance;
+    const double diff = values[m] - mean;
+
+    // Сравнение с оценками до учета показания
+    if (warmedUp) {
+      double stdDev = std::max(std::sqrt(variance), options_.minStdDev);
+      double z = diff / stdDev;
+      if (std::abs(z) > options_.zScore &&
+          (!anomalous || std::abs(z) > std::abs(result.zScore))) {
+        result = Result{static_cast<Metric>(m), values[m], mean, stdDev, z};
+        anomalous = true;
+      }
+    }
+
+    const double increment = alpha * diff;
+    estimate.mean = static_cast<float>(mean + increment);
+    estimate.variance =
+        static_cast<float>((1.0 - alpha) * (variance + diff * increment));
+  }
+
+  if (samples < saturation_) {
+    ++samples;
+  }
+  if (anomalous) {
+    ++anomalies_;
+  }
+  return anomalous;
+}
+
+std::vector<AnomalyDetector::Entry> AnomalyDetector::entries() const {
+  std::vector<Entry> result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (uint32_t device = 0; device < samples_.size(); ++device) {
+    if (samples_[device] == 0) {
+      continue;
+    }
+    Entry entry;
+    entry.deviceId = devices_->name(device);
+    entry.samples = samples_[device];
+    for (size_t m = 0; m < kMetrics; ++m) {
+      entry.mean[m] = estimates_[device * kMetrics + m].mean;
+      entry.variance[m] = estimates_[device * kMetrics + m].variance;
+    }
+    result.push_back(std::move(entry));
+  }
+  return result;
+}
+
+void AnomalyDetector::restore(const Entry& entry) {
+  if (entry.samples == 0) {
+    return;
+  }
+  uint32_t device = devices_->intern(entry.deviceId);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  reserveLocked(device);
+  if (samples_[device] == 0) {
+    ++tracked_;
+  }
+  samples_[device] = static_cast<uint16_t>(
+      std::min<uint32_t>(entry.samples, saturation_));
+  for (size_t m = 0; m < kMetrics; ++m) {
+    estimates_[device * kMetrics + m] = {entry.mean[m], entry.variance[m]};
+  }
+}
+
+void AnomalyDetector::reserveLocked(uint32_t device) {
+  if (device >= samples_.size()) {
+    samples_.resize(device + 1, 0);
+    estimates_.resize((device + 1) * kMetrics);
+  }
+}
+
+AnomalyDetector::Statistics AnomalyDetector::getStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics stats;
+  stats.devices = tracked_;
+  stats.observed = observed_;
+  stats.anomalies = anomalies_;
+  stats.memoryBytes = estimates_.capacity() * sizeof(Estimate) +
+                      samples_.capacity() * sizeof(uint16_t);
+  return stats;
+}
+
+}  // namespace iot_core::engine
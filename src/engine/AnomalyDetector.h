@@ -0,0 +1,113 @@
+// src/engine/AnomalyDetector.h
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../models/IoTData.h"
+#include "../services/DeviceRegistry.h"
+
+namespace iot_core::engine {
+
+/**
+ * @brief Поиск аномалий по экспоненциально взвешенным среднему и
+ *        дисперсии каждой метрики устройства
+ *
+ * Показание сравнивается с оценками до его учета: отклонение от
+ * среднего в стандартных отклонениях (z-оценка) больше порога - аномалия.
+ * Затем оценки обновляются за O(1):
+ *   diff = x - mean; mean += a * diff; var = (1 - a) * (var + a * diff^2)
+ * Первые warmupSamples показаний устройства только обучают модель; пока
+ * их меньше 1/alpha, вес берется 1/n, то есть оценки - обычные среднее
+ * и дисперсия уже полученных показаний, а не сдвинуты к первому.
+ *
+ * Состояние - плотные массивы по интернированному индексу устройства:
+ * float среднего и дисперсии на метрику и счетчик показаний, 18 байт на
+ * устройство. Точности float хватает: это оценки, а не суммы.
+ */
+class AnomalyDetector {
+ public:
+  enum class Metric : uint8_t { Temperature = 0, Humidity = 1 };
+  static constexpr size_t kMetrics = 2;
+
+  struct Options {
+    double alpha = 0.05;          // вес нового показания
+    double zScore = 4.0;          // порог отклонения
+    uint32_t warmupSamples = 30;  // до 65535
+    // Нижняя граница отклонения: у постоянного сигнала дисперсия 0, и
+    // любой шум дал бы бесконечную z-оценку
+    double minStdDev = 0.1;
+  };
+
+  struct Result {
+    Metric metric = Metric::Temperature;
+    double value = 0.0;
+    double mean = 0.0;
+    double stdDev = 0.0;
+    double zScore = 0.0;  // со знаком: выше или ниже среднего
+  };
+
+  // Оценки устройства для снимка
+  struct Entry {
+    std::string deviceId;
+    uint32_t samples = 0;
+    std::array<float, kMetrics> mean{};
+    std::array<float, kMetrics> variance{};
+  };
+
+  struct Statistics {
+    size_t devices = 0;  // устройств с показаниями
+    uint64_t observed = 0;
+    uint64_t anomalies = 0;
+    size_t memoryBytes = 0;
+  };
+
+  explicit AnomalyDetector(Options options,
+                           std::shared_ptr<services::DeviceRegistry> devices =
+                               std::make_shared<services::DeviceRegistry>());
+
+  AnomalyDetector(const AnomalyDetector&) = delete;
+  AnomalyDetector& operator=(const AnomalyDetector&) = delete;
+
+  // Учитывает показание; true и result (метрика с наибольшим
+  // отклонением) - если оно аномально
+  bool observe(const models::IoTData& data, Result& result);
+
+  // Устройства с показаниями (для снимка); оценки имеют смысл только
+  // при том же alpha
+  std::vector<Entry> entries() const;
+  void restore(const Entry& entry);
+
+  Statistics getStatistics() const;
+  const Options& options() const { return options_; }
+
+  static const char* metricName(Metric metric);
+
+ private:
+  struct Estimate {
+    float mean = 0.0f;
+    float variance = 0.0f;
+  };
+
+  // Под mutex_: массивы покрывают устройство
+  void reserveLocked(uint32_t device);
+
+  Options options_;
+  uint16_t warmup_;
+  uint16_t saturation_;  // дальше счетчик показаний не нужен
+  std::shared_ptr<services::DeviceRegistry> devices_;
+
+  mutable std::mutex mutex_;
+  // По индексу устройства: kMetrics оценок подряд и число показаний
+  // (насыщается на warmup_ и 1/alpha)
+  std::vector<Estimate> estimates_;
+  std::vector<uint16_t> samples_;
+  size_t tracked_ = 0;
+  uint64_t observed_ = 0;
+  uint64_t anomalies_ = 0;
+};
+
+}  // namespace iot_core::engine
@@ -0,0 +1,411 @@
+#include "Backtester.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+#include "../services/DeviceRegistry.h"
+#include "../services/ShardedExecutor.h"
+#include "../utils/Formatter.h"
+#include "ExpressionCondition.h"
+
+namespace iot_core::engine {
+
+namespace {
+
+using services::AlertKind;
+using services::AlertStateTracker;
+using services::ThresholdIndex;
+
+constexpr AlertKind kUserAlertKinds[] = {
+    AlertKind::TemperatureHigh, AlertKind::TemperatureLow,
+    AlertKind::HumidityHigh, AlertKind::HumidityLow};
+
+constexpr const char* kAnomalyRule = "anomaly_detection";
+
+struct Reading {
+  std::string deviceId;
+  double temperature;
+  double humidity;
+  int64_t timestampUs;
+};
+
+// Правило сценария после компиляции: выражение проверено, область
+// развернута в множество устройств
+struct RulePlan {
+  std::string name;
+  RuleProgram program;
+  std::string deviceId;  // область - одно устройство
+  // Область - группа; nullptr и пустой deviceId - все устройства
+  std::shared_ptr<const std::unordered_set<std::string>> members;
+
+  bool applies(const std::string& device) const {
+    if (!deviceId.empty()) {
+      return device == deviceId;
+    }
+    return !members || members->count(device) > 0;
+  }
+};
+
+// Повторное оповещение не раньше cooldown по (пользователь, устройство,
+// тип), по времени показаний
+struct CooldownKey {
+  long user;
+  uint64_t deviceAndKind;
+
+  bool operator==(const CooldownKey& other) const {
+    return user == other.user && deviceAndKind == other.deviceAndKind;
+  }
+};
+
+struct CooldownKeyHash {
+  size_t operator()(const CooldownKey& key) const {
+    return std::hash<uint64_t>()(static_cast<uint64_t>(key.user) *
+                                     0x9E3779B97F4A7C15ULL ^
+                                 key.deviceAndKind);
+  }
+};
+
+// Состояние шарда: меняется только его потоком
+class Worker {
+ public:
+  Worker(const std::vector<RulePlan>& rules,
+         const Backtester::Scenario& scenario,
+         std::shared_ptr<ThresholdIndex> thresholds)
+      : rules_(rules),
+        devices_(std::make_shared<services::DeviceRegistry>()),
+        thresholds_(std::move(thresholds)),
+        alertStates_(scenario.hysteresis, devices_),
+        cooldownUs_(std::chrono::duration_cast<std::chrono::microseconds>(
+                        scenario.cooldown)
+                        .count()),
+        ruleTriggers_(rules.size(), 0) {
+    conditions_.reserve(rules.size());
+    for (const auto& rule : rules) {
+      conditions_.push_back(
+          std::make_unique<ExpressionCondition>(rule.program, devices_));
+    }
+    if (scenario.anomalyDetection) {
+      anomalies_ =
+          std::make_unique<AnomalyDetector>(scenario.anomaly, devices_);
+    }
+  }
+
+  void process(const Reading& reading) {
+    models::IoTData data;
+    data.deviceId = reading.deviceId;
+    data.temperature = reading.temperature;
+    data.humidity = reading.humidity;
+    data.timestampUs = reading.timestampUs;
+    if (!data.isValid()) {
+      return;
+    }
+
+    ++readings_;
+    firstUs_ = std::min(firstUs_, reading.timestampUs);
+    lastUs_ = std::max(lastUs_, reading.timestampUs);
+
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      if (rules_[i].applies(data.deviceId) &&
+          conditions_[i]->evaluate(data, reading.timestampUs)) {
+        ++ruleTriggers_[i];
+      }
+    }
+    AnomalyDetector::Result anomaly;
+    if (anomalies_ && anomalies_->observe(data, anomaly)) {
+      ++anomalyTriggers_;
+    }
+
+    checkUserAlerts(data, reading.timestampUs);
+  }
+
+  void mergeInto(Backtester::Report& report) const {
+    report.readings += readings_;
+    report.devices += devices_->size();
+    if (readings_ > 0) {
+      report.firstUs = std::min(report.firstUs, firstUs_);
+      report.lastUs = std::max(report.lastUs, lastUs_);
+    }
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      report.ruleTriggers[rules_[i].name] += ruleTriggers_[i];
+    }
+    if (anomalies_) {
+      report.ruleTriggers[kAnomalyRule] += anomalyTriggers_;
+    }
+    for (const auto& [userId, counts] : users_) {
+      auto& total = report.users[userId];
+      total.alerts += counts.alerts;
+      total.suppressed += counts.suppressed;
+      total.resolved += counts.resolved;
+    }
+  }
+
+ private:
+  // Как AlertProcessingService::checkDeviceAlerts, но вместо
+  // уведомлений - счетчики
+  void checkUserAlerts(const models::IoTData& data, int64_t timestampUs) {
+    auto thresholds = thresholds_->get(data.deviceId);
+    if (!thresholds || thresholds->subscribers() == 0) {
+      return;
+    }
+
+    for (AlertKind kind : kUserAlertKinds) {
+      double value = kind == AlertKind::TemperatureHigh ||
+                             kind == AlertKind::TemperatureLow
+                         ? data.temperature
+                         : data.humidity;
+      thresholds->forEachTriggered(
+          kind, value, [&](long userId, double threshold) {
+            checkThreshold(userId, data.deviceId, kind, value, threshold,
+                           timestampUs);
+          });
+      for (long userId : alertStates_.activeUsers(data.deviceId, kind)) {
+        double threshold = thresholds->threshold(userId, kind);
+        if (ThresholdIndex::DeviceThresholds::exceeds(kind, value,
+                                                      threshold)) {
+          continue;
+        }
+        checkThreshold(userId, data.deviceId, kind, value, threshold,
+                       timestampUs);
+      }
+    }
+  }
+
+  void checkThreshold(long userId, const std::string& deviceId,
+                      AlertKind kind, double value, double threshold,
+                      int64_t timestampUs) {
+    auto transition = alertStates_.update(userId, deviceId, kind, value,
+                                          threshold, timestampUs);
+    if (transition == AlertStateTracker::Transition::None) {
+      return;
+    }
+
+    auto& counts = users_[userId];
+    if (transition == AlertStateTracker::Transition::Resolved) {
+      ++counts.resolved;
+      return;
+    }
+
+    CooldownKey key{userId,
+                    static_cast<uint64_t>(devices_->intern(deviceId)) << 8 |
+                        static_cast<uint64_t>(kind)};
+    auto [it, first] = lastAlertUs_.emplace(key, timestampUs);
+    if (!first && timestampUs - it->second < cooldownUs_) {
+      ++counts.suppressed;
+      return;
+    }
+    it->second = timestampUs;
+    ++counts.alerts;
+    // Как в AlertService: восстановление только для отправленных
+    alertStates_.markNotified(userId, deviceId, kind);
+  }
+
+  const std::vector<RulePlan>& rules_;
+  std::shared_ptr<services::DeviceRegistry> devices_;
+  std::shared_ptr<ThresholdIndex> thresholds_;
+  std::vector<std::unique_ptr<ExpressionCondition>> conditions_;
+  std::unique_ptr<AnomalyDetector> anomalies_;
+  AlertStateTracker alertStates_;
+  int64_t cooldownUs_;
+  std::unordered_map<CooldownKey, int64_t, CooldownKeyHash> lastAlertUs_;
+
+  uint64_t readings_ = 0;
+  int64_t firstUs_ = std::numeric_limits<int64_t>::max();
+  int64_t lastUs_ = std::numeric_limits<int64_t>::min();
+  std::vector<uint64_t> ruleTriggers_;
+  uint64_t anomalyTriggers_ = 0;
+  std::unordered_map<long, Backtester::UserCounts> users_;
+};
+
+}  // namespace
+
+Backtester::Backtester(Source source,
+                       services::ThresholdIndex::Loader subscribers)
+    : Backtester(std::move(source), std::move(subscribers), Options()) {}
+
+Backtester::Backtester(Source source,
+                       services::ThresholdIndex::Loader subscribers,
+                       Options options)
+    : source_(std::move(source)),
+      subscribers_(std::move(subscribers)),
+      options_(options) {}
+
+std::vector<models::RuleDefinition> Backtester::defaultRules() {
+  // Пороги как в RuleEngine::setupDefaultRules
+  auto rule = [](const char* name, const char* expression, int priority) {
+    models::RuleDefinition definition;
+    definition.name = name;
+    definition.expression = expression;
+    definition.priority = priority;
+    return definition;
+  };
+  return {rule("temperature_high_alert", "temperature > 28", 10),
+          rule("temperature_low_alert", "temperature < 15", 10),
+          rule("humidity_high_alert", "humidity > 70", 5),
+          rule("humidity_low_alert", "humidity < 30", 5)};
+}
+
+Backtester::Report Backtester::run(const Scenario& scenario, int64_t fromUs,
+                                   int64_t toUs) const {
+  auto started = std::chrono::steady_clock::now();
+  Report report;
+
+  // Группы - множества устройств, общие для правил с одной группой
+  std::unordered_map<int, std::shared_ptr<std::unordered_set<std::string>>>
+      groups;
+  for (const auto& group : scenario.groups) {
+    groups[group.id] = std::make_shared<std::unordered_set<std::string>>(
+        group.deviceIds.begin(), group.deviceIds.end());
+  }
+  auto noDevices = std::make_shared<std::unordered_set<std::string>>();
+
+  std::vector<RulePlan> rules;
+  for (const auto& definition : scenario.rules) {
+    if (!definition.enabled) {
+      continue;
+    }
+    try {
+      RulePlan plan{definition.name,
+                    RuleProgram::compile(definition.expression),
+                    definition.deviceId, nullptr};
+      if (definition.deviceId.empty() && definition.groupId != 0) {
+        auto group = groups.find(definition.groupId);
+        plan.members = group != groups.end() ? group->second : noDevices;
+      }
+      report.ruleTriggers[definition.name] = 0;
+      rules.push_back(std::move(plan));
+    } catch (const std::exception& e) {
+      report.ruleErrors.push_back(definition.name + ": " + e.what());
+    }
+  }
+
+  // Пороги читаются из БД один раз на устройство для всех шардов;
+  // замены сценария накладываются при загрузке
+  auto overrides = scenario.alertOverrides;
+  auto loader = subscribers_;
+  auto thresholds = std::make_shared<ThresholdIndex>(
+      [loader, overrides](
+          const std::string& deviceId,
+          std::vector<std::pair<long, models::UserAlert>>& subscribers) {
+        if (!loader(deviceId, subscribers)) {
+          return false;
+        }
+        for (auto& [userId, alert] : subscribers) {
+          auto it = overrides.find(userId);
+          if (it != overrides.end()) {
+            alert = it->second;
+          }
+        }
+        return true;
+      });
+
+  size_t workerCount = options_.workers;
+  if (workerCount == 0) {
+    workerCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const size_t batchSize = std::max<size_t>(1, options_.batchSize);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (size_t i = 0; i < workerCount; ++i) {
+    workers.push_back(std::make_unique<Worker>(rules, scenario, thresholds));
+  }
+
+  {
+    // Очередь шарда - несколько пачек: чтение источника не убегает
+    // далеко вперед обработки
+    services::ShardedExecutor executor(workerCount, 4);
+    std::vector<std::vector<Reading>> pending(workerCount);
+    auto flush = [&](size_t shard) {
+      if (pending[shard].empty()) {
+        return;
+      }
+      auto batch = std::make_shared<std::vector<Reading>>(
+          std::move(pending[shard]));
+      pending[shard].clear();
+      pending[shard].reserve(batchSize);
+      Worker* worker = workers[shard].get();
+      executor.submit(shard, [worker, batch]() {
+        for (const auto& reading : *batch) {
+          worker->process(reading);
+        }
+      });
+    };
+
+    report.completed = source_(
+        fromUs, toUs,
+        [&](const std::string& deviceId, double temperature, double humidity,
+            int64_t timestampUs) {
+          size_t shard = executor.shardFor(deviceId);
+          pending[shard].push_back(
+              Reading{deviceId, temperature, humidity, timestampUs});
+          if (pending[shard].size() >= batchSize) {
+            flush(shard);
+          }
+        });
+    for (size_t shard = 0; shard < workerCount; ++shard) {
+      flush(shard);
+    }
+    executor.drain();
+  }
+
+  report.firstUs = std::numeric_limits<int64_t>::max();
+  report.lastUs = std::numeric_limits<int64_t>::min();
+  for (const auto& worker : workers) {
+    worker->mergeInto(report);
+  }
+  if (report.readings == 0) {
+    report.firstUs = 0;
+    report.lastUs = 0;
+  }
+
+  report.elapsedSeconds = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - started)
+                              .count();
+  if (report.readings > 0 && report.elapsedSeconds > 0) {
+    double spanSeconds =
+        static_cast<double>(report.lastUs - report.firstUs) / 1000000.0;
+    report.speedup = spanSeconds / report.elapsedSeconds;
+  }
+  return report;
+}
+
+std::string Backtester::formatReport(const Report& report) {
+  std::ostringstream out;
+  out << "📼 Backtest: " << report.readings << " readings from "
+      << report.devices << " devices";
+  if (report.readings > 0) {
+    out << ", " << utils::Formatter::formatTimestamp(report.firstUs) << " - "
+        << utils::Formatter::formatTimestamp(report.lastUs);
+  }
+  out << "\n⏱️  " << std::fixed << std::setprecision(1)
+      << report.elapsedSeconds << " s (x" << std::setprecision(0)
+      << report.speedup << " real time)";
+  if (!report.completed) {
+    out << "\n⚠️  History stream failed, results are partial";
+  }
+
+  out << "\n📋 Rule triggers:";
+  for (const auto& [name, count] : report.ruleTriggers) {
+    out << "\n   • " << name << ": " << count;
+  }
+  for (const auto& error : report.ruleErrors) {
+    out << "\n   ❌ " << error;
+  }
+
+  out << "\n👤 User alerts (sent / suppressed by cooldown / resolved):";
+  if (report.users.empty()) {
+    out << "\n   • none";
+  }
+  for (const auto& [userId, counts] : report.users) {
+    out << "\n   • " << userId << ": " << counts.alerts << " / "
+        << counts.suppressed << " / " << counts.resolved;
+  }
+  return out.str();
+}
+
+}  // namespace iot_core::engine
@@ -0,0 +1,101 @@
+// src/engine/Backtester.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../models/IoTData.h"
+#include "../services/AlertStateTracker.h"
+#include "../services/ThresholdIndex.h"
+#include "AnomalyDetector.h"
+
+namespace iot_core::engine {
+
+/**
+ * @brief Прогон истории телеметрии через копию правил и порогов без
+ *        побочных эффектов
+ *
+ * Отвечает на вопрос "сколько оповещений дало бы изменение за прошлый
+ * период": правила движка (выражения, см. RuleProgram) и пороги
+ * пользователей проверяются на сохраненных показаниях так же, как при
+ * приеме, но с новым состоянием и без уведомлений, записи в БД и
+ * действий правил. Время берется из показаний, поэтому "for", окна,
+ * гистерезис и cooldown ведут себя как в реальном времени.
+ *
+ * Источник отдает показания по времени; они раскладываются по
+ * устройствам в шарды ShardedExecutor пачками. У шарда свое состояние
+ * (условия, трекер тревог, cooldown), поэтому показания одного
+ * устройства проверяются по порядку, разных - параллельно, без общих
+ * блокировок на горячем пути.
+ */
+class Backtester {
+ public:
+  using Sink = std::function<void(const std::string& deviceId,
+                                  double temperature, double humidity,
+                                  int64_t timestampUs)>;
+  // Показания за [fromUs, toUs) по возрастанию времени; false - ошибка
+  using Source =
+      std::function<bool(int64_t fromUs, int64_t toUs, const Sink& sink)>;
+
+  struct Options {
+    size_t workers = 0;       // 0 - по числу ядер
+    size_t batchSize = 4096;  // показаний в задаче шарда
+  };
+
+  // Что проверять. Правило с ошибкой в выражении пропускается и
+  // попадает в Report::ruleErrors
+  struct Scenario {
+    std::vector<models::RuleDefinition> rules;
+    // Состав групп для правил с groupId
+    std::vector<models::DeviceGroup> groups;
+    // Пороги пользователей вместо сохраненных (по chat_id)
+    std::unordered_map<long, models::UserAlert> alertOverrides;
+    services::AlertStateTracker::Options hysteresis;
+    std::chrono::seconds cooldown{300};
+    bool anomalyDetection = false;
+    AnomalyDetector::Options anomaly;
+  };
+
+  struct UserCounts {
+    uint64_t alerts = 0;      // ушло бы оповещений
+    uint64_t suppressed = 0;  // подавлено cooldown
+    uint64_t resolved = 0;    // сообщений о восстановлении
+  };
+
+  struct Report {
+    bool completed = false;  // источник дочитан без ошибок
+    uint64_t readings = 0;
+    size_t devices = 0;
+    int64_t firstUs = 0;  // время первого и последнего показания
+    int64_t lastUs = 0;
+    double elapsedSeconds = 0.0;
+    // Во сколько раз быстрее реального времени
+    double speedup = 0.0;
+    std::map<std::string, uint64_t> ruleTriggers;
+    std::map<long, UserCounts> users;
+    std::vector<std::string> ruleErrors;
+  };
+
+  Backtester(Source source, services::ThresholdIndex::Loader subscribers);
+  Backtester(Source source, services::ThresholdIndex::Loader subscribers,
+             Options options);
+
+  Report run(const Scenario& scenario, int64_t fromUs, int64_t toUs) const;
+
+  // Встроенные пороговые правила RuleEngine в виде выражений: сценарий
+  // "как сейчас" - они плюс rule_definitions
+  static std::vector<models::RuleDefinition> defaultRules();
+
+  static std::string formatReport(const Report& report);
+
+ private:
+  Source source_;
+  services::ThresholdIndex::Loader subscribers_;
+  Options options_;
+};
+
+}  // namespace iot_core::engine
@@ -0,0 +1,146 @@
+#include "BatchKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IOT_BATCH_X86 1
+#endif
+
+namespace iot_core::engine {
+
+namespace {
+
+using Kernel = uint64_t (*)(const double*, size_t, Comparison, double);
+
+template <Comparison C>
+inline bool compare(double lhs, double rhs) {
+  if constexpr (C == Comparison::Less) {
+    return lhs < rhs;
+  } else if constexpr (C == Comparison::LessEqual) {
+    return lhs <= rhs;
+  } else if constexpr (C == Comparison::Greater) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+template <Comparison C>
+uint64_t scalarTail(const double* column, size_t begin, size_t count,
+                    double value) {
+  uint64_t mask = 0;
+  for (size_t i = begin; i < count; ++i) {
+    mask |= static_cast<uint64_t>(compare<C>(column[i], value)) << i;
+  }
+  return mask;
+}
+
+// Ветвление по сравнению - один раз на колонку, цикл без ветвлений
+template <template <Comparison> class Impl>
+uint64_t dispatch(const double* column, size_t count, Comparison comparison,
+                  double value) {
+  switch (comparison) {
+    case Comparison::Less:
+      return Impl<Comparison::Less>::run(column, count, value);
+    case Comparison::LessEqual:
+      return Impl<Comparison::LessEqual>::run(column, count, value);
+    case Comparison::Greater:
+      return Impl<Comparison::Greater>::run(column, count, value);
+    case Comparison::GreaterEqual:
+      return Impl<Comparison::GreaterEqual>::run(column, count, value);
+  }
+  return 0;
+}
+
+template <Comparison C>
+struct Scalar {
+  static uint64_t run(const double* column, size_t count, double value) {
+    return scalarTail<C>(column, 0, count, value);
+  }
+};
+
+#ifdef IOT_BATCH_X86
+
+// Упорядоченные сравнения: NaN не проходит ни одно, как и в скалярном коде
+template <Comparison C>
+struct Sse2 {
+  __attribute__((target("sse2"))) static uint64_t run(const double* column,
+                                                      size_t count,
+                                                      double value) {
+    const __m128d threshold = _mm_set1_pd(value);
+    uint64_t mask = 0;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+      __m128d lanes = _mm_loadu_pd(column + i);
+      __m128d result;
+      if constexpr (C == Comparison::Less) {
+        result = _mm_cmplt_pd(lanes, threshold);
+      } else if constexpr (C == Comparison::LessEqual) {
+        result = _mm_cmple_pd(lanes, threshold);
+      } else if constexpr (C == Comparison::Greater) {
+        result = _mm_cmpgt_pd(lanes, threshold);
+      } else {
+        result = _mm_cmpge_pd(lanes, threshold);
+      }
+      mask |= static_cast<uint64_t>(_mm_movemask_pd(result)) << i;
+    }
+    return mask | scalarTail<C>(column, i, count, value);
+  }
+};
+
+template <Comparison C>
+struct Avx2 {
+  static constexpr int kPredicate = C == Comparison::Less        ? _CMP_LT_OQ
+                                    : C == Comparison::LessEqual ? _CMP_LE_OQ
+                                    : C == Comparison::Greater   ? _CMP_GT_OQ
+                                                                 : _CMP_GE_OQ;
+
+  __attribute__((target("avx2"))) static uint64_t run(const double* column,
+                                                      size_t count,
+                                                      double value) {
+    const __m256d threshold = _mm256_set1_pd(value);
+    uint64_t mask = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m256d lanes = _mm256_loadu_pd(column + i);
+      __m256d result = _mm256_cmp_pd(lanes, threshold, kPredicate);
+      mask |= static_cast<uint64_t>(_mm256_movemask_pd(result)) << i;
+    }
+    return mask | scalarTail<C>(column, i, count, value);
+  }
+};
+
+#endif
+
+struct Selected {
+  Kernel kernel;
+  const char* name;
+};
+
+Selected select() {
+#ifdef IOT_BATCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {&dispatch<Avx2>, "avx2"};
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return {&dispatch<Sse2>, "sse2"};
+  }
+#endif
+  return {&dispatch<Scalar>, "scalar"};
+}
+
+const Selected& selected() {
+  static const Selected kSelected = select();
+  return kSelected;
+}
+
+}  // namespace
+
+uint64_t compareColumn(const double* column, size_t count,
+                       Comparison comparison, double value) {
+  return selected().kernel(column, count, comparison, value);
+}
+
+const char* batchKernelName() { return selected().name; }
+
+}  // namespace iot_core::engine
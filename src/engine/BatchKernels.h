@@ -0,0 +1,22 @@
+// src/engine/BatchKernels.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace iot_core::engine {
+
+// Размер блока пакетной обработки: одна маска uint64_t на правило
+constexpr size_t kBatchBlock = 64;
+
+enum class Comparison : uint8_t { Less, LessEqual, Greater, GreaterEqual };
+
+// Бит i маски - column[i] <comparison> value; count <= kBatchBlock.
+// Реализация (AVX2, SSE2 или скалярная) выбирается при первом вызове
+// по возможностям процессора
+uint64_t compareColumn(const double* column, size_t count,
+                       Comparison comparison, double value);
+
+// "avx2", "sse2" или "scalar"
+const char* batchKernelName();
+
+}  // namespace iot_core::engine
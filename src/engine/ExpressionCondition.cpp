@@ -0,0 +1,125 @@
+#include "ExpressionCondition.h"
+
+#include <chrono>
+#include <iterator>
+#include <utility>
+
+namespace iot_core::engine {
+
+ExpressionCondition::ExpressionCondition(
+    RuleProgram program, std::shared_ptr<services::DeviceRegistry> devices)
+    : program_(std::move(program)),
+      devices_(std::move(devices)),
+      windowCount_(program_.windows().size()),
+      holdUs_(std::chrono::duration_cast<std::chrono::microseconds>(
+                  program_.holdFor())
+                  .count()) {}
+
+bool ExpressionCondition::operator()(const models::IoTData& data) {
+  if (stateless()) {
+    return program_.evaluate(data);
+  }
+
+  int64_t nowUs = data.timestampUs;
+  if (nowUs == 0) {
+    nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count();
+  }
+  return evaluate(data, nowUs);
+}
+
+bool ExpressionCondition::evaluate(const models::IoTData& data,
+                                   int64_t nowUs) {
+  if (stateless()) {
+    return program_.evaluate(data);
+  }
+
+  uint32_t device = devices_->intern(data.deviceId);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  reserveLocked(device);
+
+  bool holds = program_.evaluate(
+      data, nowUs,
+      windowCount_ > 0 ? &windows_[device * windowCount_] : nullptr);
+  if (holdUs_ == 0) {
+    return holds;
+  }
+  int64_t& since = holdSinceUs_[device];
+  if (!holds) {
+    since = kNotHolding;
+    return false;
+  }
+  if (since == kNotHolding) {
+    since = nowUs;
+    return false;
+  }
+  return nowUs - since >= holdUs_;
+}
+
+std::vector<ExpressionCondition::DeviceState> ExpressionCondition::state()
+    const {
+  std::vector<DeviceState> result;
+  if (stateless()) {
+    return result;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (uint32_t device = 0; device < holdSinceUs_.size(); ++device) {
+    DeviceState state;
+    state.holding = holdSinceUs_[device] != kNotHolding;
+    state.holdSinceUs = state.holding ? holdSinceUs_[device] : 0;
+
+    bool empty = !state.holding;
+    state.windows.resize(windowCount_);
+    for (size_t w = 0; w < windowCount_; ++w) {
+      const SlidingWindow& window = windows_[device * windowCount_ + w];
+      for (size_t i = 0; i < window.size(); ++i) {
+        state.windows[w].push_back(window.sample(i));
+      }
+      empty = empty && window.empty();
+    }
+
+    if (!empty) {
+      state.deviceId = devices_->name(device);
+      result.push_back(std::move(state));
+    }
+  }
+  return result;
+}
+
+void ExpressionCondition::restore(const std::vector<DeviceState>& devices) {
+  if (stateless()) {
+    return;
+  }
+
+  for (const auto& state : devices) {
+    if (state.windows.size() != windowCount_) {
+      continue;
+    }
+    uint32_t device = devices_->intern(state.deviceId);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    reserveLocked(device);
+    holdSinceUs_[device] = state.holding ? state.holdSinceUs : kNotHolding;
+
+    auto windows = program_.makeWindows();
+    for (size_t w = 0; w < windowCount_; ++w) {
+      for (const auto& sample : state.windows[w]) {
+        windows[w].add(sample.timestampUs, sample.value);
+      }
+      windows_[device * windowCount_ + w] = std::move(windows[w]);
+    }
+  }
+}
+
+void ExpressionCondition::reserveLocked(uint32_t device) {
+  while (holdSinceUs_.size() <= device) {
+    holdSinceUs_.push_back(kNotHolding);
+    auto windows = program_.makeWindows();
+    std::move(windows.begin(), windows.end(), std::back_inserter(windows_));
+  }
+}
+
+}  // namespace iot_core::engine
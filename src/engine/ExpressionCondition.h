@@ -0,0 +1,72 @@
+// src/engine/ExpressionCondition.h
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../models/IoTData.h"
+#include "../services/DeviceRegistry.h"
+#include "RuleProgram.h"
+#include "SlidingWindow.h"
+
+namespace iot_core::engine {
+
+/**
+ * @brief Условие правила из выражения (см. RuleProgram) с состоянием
+ *        устройств
+ *
+ * С суффиксом "for" срабатывает, только если выражение верно для
+ * устройства непрерывно holdFor; оконные функции считаются по показаниям
+ * своего устройства. Состояние устройств лежит в плотных массивах по
+ * интернированному индексу, окна устройства - подряд.
+ */
+class ExpressionCondition {
+ public:
+  // Состояние устройства для снимка
+  struct DeviceState {
+    std::string deviceId;
+    bool holding = false;  // условие выполняется с holdSinceUs
+    int64_t holdSinceUs = 0;
+    // Показания каждого окна программы, от старых к новым
+    std::vector<std::vector<SlidingWindow::Sample>> windows;
+  };
+
+  ExpressionCondition(RuleProgram program,
+                      std::shared_ptr<services::DeviceRegistry> devices);
+
+  // Время показания - из data.timestampUs, без него - текущее
+  bool operator()(const models::IoTData& data);
+  // Время показания задано (воспроизведение истории)
+  bool evaluate(const models::IoTData& data, int64_t nowUs);
+
+  // Без "for" и окон: результат зависит только от показания
+  bool stateless() const { return holdUs_ == 0 && windowCount_ == 0; }
+  const RuleProgram& program() const { return program_; }
+
+  // Устройства с непустыми окнами или начатым "for"
+  std::vector<DeviceState> state() const;
+  // Состояние из снимка того же выражения; записи с другим числом окон
+  // пропускаются
+  void restore(const std::vector<DeviceState>& devices);
+
+ private:
+  static constexpr int64_t kNotHolding = std::numeric_limits<int64_t>::min();
+
+  // Под mutex_: массивы покрывают устройство
+  void reserveLocked(uint32_t device);
+
+  RuleProgram program_;
+  std::shared_ptr<services::DeviceRegistry> devices_;
+  size_t windowCount_;
+  int64_t holdUs_;
+  mutable std::mutex mutex_;
+  // По индексу устройства: начало непрерывного выполнения условия
+  std::vector<int64_t> holdSinceUs_;
+  // windowCount_ окон на устройство
+  std::vector<SlidingWindow> windows_;
+};
+
+}  // namespace iot_core::engine
@@ -8,14 +8,68 @@
 
 #include "../core/Database.h"
 #include "../services/AlertService.h"
+#include "../services/DeviceRegistry.h"
+#include "../storage/StateSnapshot.h"
 #include "../utils/Formatter.h"
+#include "ExpressionCondition.h"
+#include "RuleProgram.h"
 
 namespace iot_core::engine {
 
+namespace {
+
+constexpr uint32_t kRulesSection = storage::snapshotTag('R', 'U', 'L', 'E');
+// Окна и "for" правил из выражений по имени правила; с версии 2 -
+// также оценки детектора аномалий
+constexpr uint32_t kRuleStateSection =
+    storage::snapshotTag('R', 'S', 'T', 'A');
+constexpr uint32_t kRuleStateVersion = 2;
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t elapsedNanos(Clock::time_point start) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           start)
+          .count());
+}
+
+int64_t nowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+RuleScope scopeOf(const models::RuleDefinition& definition) {
+  RuleScope scope;
+  scope.deviceId = definition.deviceId;
+  scope.groupId = definition.groupId;
+  return scope;
+}
+
+// Событие "снова в сети" от условия правила device_offline к его
+// действию: оно выполняется сразу после условия для того же показания
+struct ResumedDevices {
+  std::mutex mutex;
+  std::unordered_map<std::string, services::HeartbeatMonitor::Event> events;
+};
+
+// Результат детектора от условия правила anomaly_detection к действию
+struct AnomalousReadings {
+  std::mutex mutex;
+  std::unordered_map<std::string, AnomalyDetector::Result> results;
+};
+
+}  // namespace
+
 RuleEngine::RuleEngine(
     std::shared_ptr<core::DatabaseRepository> database,
-    std::shared_ptr<services::AlertProcessingService> alertService)
-    : database_(std::move(database)), alertService_(std::move(alertService)) {
+    std::shared_ptr<services::AlertProcessingService> alertService,
+    std::chrono::seconds offlineTimeout)
+    : rules_(std::make_shared<const RuleSet>()),
+      database_(std::move(database)),
+      alertService_(std::move(alertService)),
+      devices_(std::make_shared<services::DeviceRegistry>()) {
   if (!database_) {
     throw std::invalid_argument("Database repository cannot be null");
   }
@@ -24,26 +78,82 @@ RuleEngine::RuleEngine(
     throw std::invalid_argument("Alert service cannot be null");
   }
 
+  if (offlineTimeout.count() > 0) {
+    services::HeartbeatMonitor::Options options;
+    options.timeout = offlineTimeout;
+    heartbeats_ =
+        std::make_shared<services::HeartbeatMonitor>(options, devices_);
+    alertService_->attachHeartbeatMonitor(heartbeats_);
+  }
+
   std::cout << "⚙️  Rule Engine initialized" << std::endl;
 }
 
+std::shared_ptr<const RuleSet> RuleEngine::currentRules() const {
+  return std::atomic_load(&rules_);
+}
+
+RuleCounters* RuleEngine::counterLocked(const std::string& name) {
+  auto [it, inserted] =
+      slots_.emplace(name, static_cast<uint32_t>(counters_.size()));
+  if (inserted) {
+    counters_.emplace_back();
+    slotNames_.push_back(name);
+  }
+  return &counters_[it->second];
+}
+
+void RuleEngine::publishLocked(std::shared_ptr<RuleSet> rules) {
+  // stable_sort: правила одного приоритета сохраняют порядок добавления
+  std::stable_sort(rules->rules.begin(), rules->rules.end(),
+                   [](const RuleSet::Entry& a, const RuleSet::Entry& b) {
+                     return a.rule.priority > b.rule.priority;
+                   });
+
+  // Номера добавляются по возрастанию, списки сразу отсортированы
+  rules->global.clear();
+  rules->scoped.clear();
+  for (uint32_t i = 0; i < rules->rules.size(); ++i) {
+    const Rule& rule = rules->rules[i].rule;
+    if (!rule.enabled) continue;
+
+    if (rule.scope.global()) {
+      rules->global.push_back(i);
+    } else if (!rule.scope.deviceId.empty()) {
+      rules->scoped[rule.scope.deviceId].push_back(i);
+    } else {
+      auto group = groupMembers_.find(rule.scope.groupId);
+      if (group == groupMembers_.end()) continue;
+      for (const auto& deviceId : group->second) {
+        rules->scoped[deviceId].push_back(i);
+      }
+    }
+  }
+  std::atomic_store(&rules_,
+                    std::shared_ptr<const RuleSet>(std::move(rules)));
+}
+
 void RuleEngine::addRule(const Rule& rule) {
   std::lock_guard<std::mutex> lock(rulesMutex_);
 
+  auto updated = std::make_shared<RuleSet>(*currentRules());
+
   // Check if rule with this name already exists
-  auto it = std::find_if(rules_.begin(), rules_.end(), [&rule](const Rule& r) {
-    return r.name == rule.name;
-  });
+  auto it = std::find_if(
+      updated->rules.begin(), updated->rules.end(),
+      [&rule](const RuleSet::Entry& entry) {
+        return entry.rule.name == rule.name;
+      });
 
-  if (it != rules_.end()) {
+  if (it != updated->rules.end()) {
     std::cerr << "⚠️  Rule '" << rule.name << "' already exists, replacing"
               << std::endl;
-    *it = rule;
+    it->rule = rule;
   } else {
-    rules_.push_back(rule);
+    updated->rules.push_back(RuleSet::Entry{rule, counterLocked(rule.name)});
   }
 
-  sortRulesByPriority();
+  publishLocked(std::move(updated));
   std::cout << "➕ Rule added: " << rule.name << " (priority: " << rule.priority
             << ")" << std::endl;
 }
@@ -51,12 +161,17 @@ void RuleEngine::addRule(const Rule& rule) {
 void RuleEngine::removeRule(const std::string& ruleName) {
   std::lock_guard<std::mutex> lock(rulesMutex_);
 
-  auto it =
-      std::remove_if(rules_.begin(), rules_.end(),
-                     [&ruleName](const Rule& r) { return r.name == ruleName; });
+  auto current = currentRules();
+  auto updated = std::make_shared<RuleSet>();
+  for (const auto& entry : current->rules) {
+    if (entry.rule.name != ruleName) {
+      updated->rules.push_back(entry);
+    }
+  }
+  shadowedBuiltins_.erase(ruleName);
 
-  if (it != rules_.end()) {
-    rules_.erase(it, rules_.end());
+  if (updated->rules.size() != current->rules.size()) {
+    publishLocked(std::move(updated));
     std::cout << "➖ Rule removed: " << ruleName << std::endl;
   } else {
     std::cerr << "⚠️  Rule '" << ruleName << "' not found" << std::endl;
@@ -66,9 +181,11 @@ void RuleEngine::removeRule(const std::string& ruleName) {
 void RuleEngine::enableRule(const std::string& ruleName) {
   std::lock_guard<std::mutex> lock(rulesMutex_);
 
-  for (auto& rule : rules_) {
-    if (rule.name == ruleName) {
-      rule.enabled = true;
+  auto updated = std::make_shared<RuleSet>(*currentRules());
+  for (auto& entry : updated->rules) {
+    if (entry.rule.name == ruleName) {
+      entry.rule.enabled = true;
+      publishLocked(std::move(updated));
       std::cout << "✅ Rule enabled: " << ruleName << std::endl;
       return;
     }
@@ -80,9 +197,11 @@ void RuleEngine::enableRule(const std::string& ruleName) {
 void RuleEngine::disableRule(const std::string& ruleName) {
   std::lock_guard<std::mutex> lock(rulesMutex_);
 
-  for (auto& rule : rules_) {
-    if (rule.name == ruleName) {
-      rule.enabled = false;
+  auto updated = std::make_shared<RuleSet>(*currentRules());
+  for (auto& entry : updated->rules) {
+    if (entry.rule.name == ruleName) {
+      entry.rule.enabled = false;
+      publishLocked(std::move(updated));
       std::cout << "⛔ Rule disabled: " << ruleName << std::endl;
       return;
     }
@@ -98,39 +217,27 @@ void RuleEngine::processData(const models::IoTData& data) {
   }
 
   // Update statistics
-  {
-    std::lock_guard<std::mutex> lock(statisticsMutex_);
-    statistics_.totalProcessed++;
-  }
+  totalProcessed_.fetch_add(1, std::memory_order_relaxed);
   std::cout << "📊 Data received: " << data.deviceId << " T=" << std::fixed
             << std::setprecision(1) << data.temperature << "°C"
             << " H=" << data.humidity << "%" << std::endl;
 
-  // Get rules to apply (thread-safe copy)
-  std::vector<Rule> rulesToApply;
-  {
-    std::lock_guard<std::mutex> lock(rulesMutex_);
-    rulesToApply = rules_;
-  }
+  // Снимок набора правил: без блокировки и копирования, изменения
+  // правил во время обработки его не затрагивают
+  auto rules = currentRules();
 
-  // Apply rules in priority order
+  // Apply rules in priority order (только правила этого устройства)
   int triggered = 0;
-  for (const auto& rule : rulesToApply) {
-    if (!rule.enabled) continue;
-
-    if (rule.condition(data)) {
-      executeRule(rule, data);
+  rules->forEachRule(data.deviceId, [&](uint32_t index) {
+    const auto& entry = rules->rules[index];
+    if (evaluateRule(entry, data)) {
+      executeRule(entry, data);
       triggered++;
-
-      {
-        std::lock_guard<std::mutex> lock(statisticsMutex_);
-        statistics_.rulesTriggered++;
-        statistics_.ruleTriggerCount[rule.name]++;
-      }
     }
-  }
+  });
 
   if (triggered > 0) {
+    rulesTriggered_.fetch_add(triggered, std::memory_order_relaxed);
     std::cout << "🔔 " << triggered << " rules triggered for device "
               << data.deviceId << std::endl;
   }
@@ -143,18 +250,20 @@ void RuleEngine::processDeviceData(const std::string& deviceId,
   data.temperature = temperature;
   data.humidity = humidity;
 
-  // Генерируем временную метку
-  auto now = std::chrono::system_clock::now();
-  auto time = std::chrono::system_clock::to_time_t(now);
-  std::stringstream ss;
-  ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-  data.timestamp = ss.str();
+  data.timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
 
   // Логируем для отладки (но НЕ сохраняем в локальную БД)
   std::cout << "📊 Обработка данных устройства: " << deviceId
             << " T=" << temperature << "°C"
             << " H=" << humidity << "%" << std::endl;
 
+  // Локальное хранилище временных рядов (если включено)
+  if (database_) {
+    database_->recordTelemetry(data);
+  }
+
   // Проверяем правила
   processData(data);
 }
@@ -165,7 +274,7 @@ void RuleEngine::setupDefaultRules() {
   // Clear existing rules
   {
     std::lock_guard<std::mutex> lock(rulesMutex_);
-    rules_.clear();
+    publishLocked(std::make_shared<RuleSet>());
   }
 
   // Add default rules (in order of priority)
@@ -174,8 +283,15 @@ void RuleEngine::setupDefaultRules() {
   addRule(createTemperatureLowRule(15.0));   // High priority
   addRule(createHumidityHighRule(70.0));     // Medium priority
   addRule(createHumidityLowRule(30.0));      // Medium priority
+  if (heartbeats_) {
+    addRule(createDeviceOfflineRule());
+  }
+  if (anomalies_) {
+    addRule(createAnomalyRule());
+  }
 
-  std::cout << "✅ " << rules_.size() << " default rules configured"
+  std::cout << "✅ " << currentRules()->rules.size()
+            << " default rules configured"
             << std::endl;
 
   // Выводим информацию о правилах
@@ -185,36 +301,426 @@ void RuleEngine::setupDefaultRules() {
   std::cout << "   3. temperature_low_alert - Temp < 15.0°C" << std::endl;
   std::cout << "   4. humidity_high_alert - Humidity > 70.0%" << std::endl;
   std::cout << "   5. humidity_low_alert - Humidity < 30.0%" << std::endl;
+  if (heartbeats_) {
+    std::cout << "   6. device_offline - No data for "
+              << heartbeats_->timeout().count() << " s" << std::endl;
+  }
+  if (anomalies_) {
+    std::cout << "   7. anomaly_detection - |z| > "
+              << anomalies_->options().zScore << std::endl;
+  }
+}
+
+void RuleEngine::checkHeartbeats() {
+  if (!heartbeats_) {
+    return;
+  }
+
+  auto events = heartbeats_->advance(nowMicros());
+  for (const auto& event : events) {
+    std::cout << "📴 Device offline: " << event.deviceId << std::endl;
+    alertService_->processDeviceStatus(event.deviceId, false,
+                                       event.lastSeenUs, event.timestampUs);
+  }
+}
+
+services::HeartbeatMonitor::Statistics RuleEngine::getHeartbeatStatistics()
+    const {
+  return heartbeats_ ? heartbeats_->getStatistics()
+                     : services::HeartbeatMonitor::Statistics();
+}
+
+void RuleEngine::enableAnomalyDetection(
+    const AnomalyDetector::Options& options) {
+  // Новый детектор учится заново: прежние оценки считались с другими
+  // параметрами
+  {
+    std::lock_guard<std::mutex> lock(rulesMutex_);
+    anomalies_ = std::make_shared<AnomalyDetector>(options, devices_);
+  }
+  addRule(createAnomalyRule());
+}
+
+AnomalyDetector::Statistics RuleEngine::getAnomalyStatistics() const {
+  std::shared_ptr<AnomalyDetector> anomalies;
+  {
+    std::lock_guard<std::mutex> lock(rulesMutex_);
+    anomalies = anomalies_;
+  }
+  return anomalies ? anomalies->getStatistics()
+                   : AnomalyDetector::Statistics();
+}
+
+size_t RuleEngine::applyRuleDefinitions(
+    const std::vector<models::RuleDefinition>& definitions) {
+  std::lock_guard<std::mutex> lock(rulesMutex_);
+
+  if (definitions == appliedDefinitions_) {
+    return expressionRules_.size();
+  }
+
+  auto current = currentRules();
+  std::unordered_map<std::string, RuleSet::Entry> previous;
+  auto updated = std::make_shared<RuleSet>();
+  for (const auto& entry : current->rules) {
+    if (expressionRules_.count(entry.rule.name) > 0) {
+      previous.emplace(entry.rule.name, entry);
+    } else {
+      updated->rules.push_back(entry);
+    }
+  }
+  // Замененные встроенные правила снова в наборе; ниже их заменят
+  // только определения, которые остались и включены
+  for (auto& [name, entry] : shadowedBuiltins_) {
+    updated->rules.push_back(std::move(entry));
+  }
+  shadowedBuiltins_.clear();
+
+  // loaded - уже добавленные правила определений, не встроенные
+  std::unordered_set<std::string> loaded;
+  auto shadowBuiltin = [this, &updated, &loaded](const std::string& name) {
+    if (loaded.count(name) > 0) {
+      return;
+    }
+    auto builtin = std::find_if(
+        updated->rules.begin(), updated->rules.end(),
+        [&name](const RuleSet::Entry& entry) {
+          return entry.rule.name == name;
+        });
+    if (builtin != updated->rules.end()) {
+      shadowedBuiltins_.emplace(name, std::move(*builtin));
+      updated->rules.erase(builtin);
+    }
+  };
+  auto hasBuiltin = [&updated, &loaded](const std::string& name) {
+    return loaded.count(name) == 0 &&
+           std::any_of(updated->rules.begin(), updated->rules.end(),
+                       [&name](const RuleSet::Entry& entry) {
+                         return entry.rule.name == name;
+                       });
+  };
+
+  for (const auto& definition : definitions) {
+    // Выключенное определение не отменяет одноименное встроенное правило
+    if (!definition.enabled && hasBuiltin(definition.name)) {
+      continue;
+    }
+
+    // Неизмененное правило переносится как есть - вместе с состоянием
+    // условия "for"
+    auto old = previous.find(definition.name);
+    if (old != previous.end() &&
+        old->second.rule.description == definition.expression &&
+        old->second.rule.scope == scopeOf(definition) &&
+        old->second.rule.priority == definition.priority &&
+        old->second.rule.enabled == definition.enabled) {
+      shadowBuiltin(definition.name);
+      updated->rules.push_back(old->second);
+      loaded.insert(definition.name);
+      continue;
+    }
+
+    try {
+      Rule rule = createExpressionRule(definition);
+      // Одноименное встроенное правило заменяется до удаления или
+      // выключения определения
+      shadowBuiltin(definition.name);
+      updated->rules.push_back(
+          RuleSet::Entry{std::move(rule), counterLocked(definition.name)});
+      loaded.insert(definition.name);
+    } catch (const std::exception& e) {
+      std::cerr << "❌ Rule '" << definition.name << "': " << e.what()
+                << std::endl;
+      if (old != previous.end()) {
+        shadowBuiltin(definition.name);
+        updated->rules.push_back(old->second);
+        loaded.insert(definition.name);
+      }
+    }
+  }
+
+  publishLocked(std::move(updated));
+  expressionRules_ = std::move(loaded);
+  appliedDefinitions_ = definitions;
+
+  std::cout << "📋 Rule definitions applied: " << expressionRules_.size()
+            << " of " << definitions.size() << std::endl;
+  return expressionRules_.size();
+}
+
+void RuleEngine::setDeviceGroups(
+    const std::vector<models::DeviceGroup>& groups) {
+  std::unordered_map<int, std::vector<std::string>> members;
+  for (const auto& group : groups) {
+    members[group.id] = group.deviceIds;
+  }
+
+  std::lock_guard<std::mutex> lock(rulesMutex_);
+  if (members == groupMembers_) {
+    return;
+  }
+  groupMembers_ = std::move(members);
+  publishLocked(std::make_shared<RuleSet>(*currentRules()));
 }
 
 RuleEngine::Statistics RuleEngine::getStatistics() const {
-  std::lock_guard<std::mutex> lock(statisticsMutex_);
-  return statistics_;
+  Statistics stats;
+  stats.totalProcessed = static_cast<int>(totalProcessed_.load());
+  stats.rulesTriggered = static_cast<int>(rulesTriggered_.load());
+
+  // Блокировка только против добавления слотов: обработка показаний
+  // пишет в счетчики без нее
+  std::lock_guard<std::mutex> lock(rulesMutex_);
+  stats.rules.reserve(counters_.size());
+  for (size_t slot = 0; slot < counters_.size(); ++slot) {
+    const RuleCounters& counters = counters_[slot];
+    RuleMetrics metrics;
+    metrics.name = slotNames_[slot];
+    metrics.evaluations = counters.evaluations.load(std::memory_order_relaxed);
+    metrics.triggers = counters.triggers.load(std::memory_order_relaxed);
+    metrics.errors = counters.errors.load(std::memory_order_relaxed);
+    metrics.condition = counters.condition.snapshot();
+    metrics.action = counters.action.snapshot();
+    if (metrics.triggers > 0) {
+      stats.ruleTriggerCount[metrics.name] =
+          static_cast<int>(metrics.triggers);
+    }
+    stats.rules.push_back(std::move(metrics));
+  }
+  return stats;
 }
 
 void RuleEngine::resetStatistics() {
-  std::lock_guard<std::mutex> lock(statisticsMutex_);
-  statistics_ = Statistics{};
+  totalProcessed_ = 0;
+  rulesTriggered_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(rulesMutex_);
+    for (auto& counters : counters_) {
+      counters.evaluations = 0;
+      counters.triggers = 0;
+      counters.errors = 0;
+      counters.condition.reset();
+      counters.action.reset();
+    }
+  }
   std::cout << "📊 Rule Engine statistics reset" << std::endl;
 }
 
-std::vector<std::string> RuleEngine::getRuleNames() const {
-  std::lock_guard<std::mutex> lock(rulesMutex_);
+void RuleEngine::saveState(storage::SnapshotWriter& snapshot) const {
+  auto stats = getStatistics();
+
+  auto& section = snapshot.section(kRulesSection);
+  section.putU64(static_cast<uint64_t>(stats.totalProcessed));
+  section.putU64(static_cast<uint64_t>(stats.rulesTriggered));
+  section.putU32(static_cast<uint32_t>(stats.ruleTriggerCount.size()));
+  for (const auto& [name, count] : stats.ruleTriggerCount) {
+    section.putString(name);
+    section.putU64(static_cast<uint64_t>(count));
+  }
+
+  // Выражение пишется вместе с состоянием: после смены выражения
+  // правила его окна уже ничего не значат
+  using DeviceStates = std::vector<ExpressionCondition::DeviceState>;
+  std::vector<std::pair<const Rule*, DeviceStates>> states;
+  auto rules = currentRules();
+  for (const auto& entry : rules->rules) {
+    if (entry.rule.expression) {
+      auto devices = entry.rule.expression->state();
+      if (!devices.empty()) {
+        states.emplace_back(&entry.rule, std::move(devices));
+      }
+    }
+  }
+
+  auto& state = snapshot.section(kRuleStateSection);
+  state.putU32(kRuleStateVersion);
+  state.putU32(static_cast<uint32_t>(states.size()));
+  for (const auto& [rule, devices] : states) {
+    state.putString(rule->name);
+    state.putString(rule->description);
+    state.putU32(static_cast<uint32_t>(devices.size()));
+    for (const auto& device : devices) {
+      state.putString(device.deviceId);
+      state.putU8(device.holding ? 1 : 0);
+      state.putI64(device.holdSinceUs);
+      state.putU32(static_cast<uint32_t>(device.windows.size()));
+      for (const auto& window : device.windows) {
+        state.putU32(static_cast<uint32_t>(window.size()));
+        for (const auto& sample : window) {
+          state.putI64(sample.timestampUs);
+          state.putDouble(sample.value);
+        }
+      }
+    }
+  }
+
+  std::shared_ptr<AnomalyDetector> anomalies;
+  {
+    std::lock_guard<std::mutex> lock(rulesMutex_);
+    anomalies = anomalies_;
+  }
+  auto estimates =
+      anomalies ? anomalies->entries() : std::vector<AnomalyDetector::Entry>();
+  state.putDouble(anomalies ? anomalies->options().alpha : 0.0);
+  state.putU32(static_cast<uint32_t>(estimates.size()));
+  for (const auto& entry : estimates) {
+    state.putString(entry.deviceId);
+    state.putU32(entry.samples);
+    for (size_t m = 0; m < AnomalyDetector::kMetrics; ++m) {
+      state.putDouble(entry.mean[m]);
+      state.putDouble(entry.variance[m]);
+    }
+  }
+}
+
+bool RuleEngine::restoreState(const storage::SnapshotReader& snapshot) {
+  auto section = snapshot.section(kRulesSection);
+  if (section.atEnd()) {
+    return false;
+  }
+
+  try {
+    Statistics restored;
+    restored.totalProcessed = static_cast<int>(section.getU64());
+    restored.rulesTriggered = static_cast<int>(section.getU64());
+    uint32_t count = section.getU32();
+    for (uint32_t i = 0; i < count; ++i) {
+      std::string name = section.getString();
+      restored.ruleTriggerCount[name] = static_cast<int>(section.getU64());
+    }
+
+    totalProcessed_ = static_cast<uint64_t>(restored.totalProcessed);
+    rulesTriggered_ = static_cast<uint64_t>(restored.rulesTriggered);
+    std::lock_guard<std::mutex> lock(rulesMutex_);
+    for (auto& counters : counters_) {
+      counters.triggers = 0;
+    }
+    for (const auto& [name, count] : restored.ruleTriggerCount) {
+      counterLocked(name)->triggers = static_cast<uint64_t>(count);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка восстановления состояния правил: " << e.what()
+              << std::endl;
+    return false;
+  }
+
+  restoreConditionState(snapshot);
+  return true;
+}
+
+void RuleEngine::restoreConditionState(
+    const storage::SnapshotReader& snapshot) {
+  auto section = snapshot.section(kRuleStateSection);
+  if (section.atEnd()) {
+    return;
+  }
+
+  struct RuleState {
+    std::string name;
+    std::string expression;
+    std::vector<ExpressionCondition::DeviceState> devices;
+  };
+
+  std::vector<RuleState> states;
+  double alpha = 0.0;
+  std::vector<AnomalyDetector::Entry> estimates;
+  try {
+    uint32_t version = section.getU32();
+    if (version == 0 || version > kRuleStateVersion) {
+      std::cerr << "⚠️ Состояние правил версии " << version
+                << " не поддерживается, окна начнутся заново" << std::endl;
+      return;
+    }
+
+    uint32_t count = section.getU32();
+    for (uint32_t i = 0; i < count; ++i) {
+      RuleState state;
+      state.name = section.getString();
+      state.expression = section.getString();
+      uint32_t devices = section.getU32();
+      for (uint32_t d = 0; d < devices; ++d) {
+        ExpressionCondition::DeviceState device;
+        device.deviceId = section.getString();
+        device.holding = section.getU8() != 0;
+        device.holdSinceUs = section.getI64();
+        device.windows.resize(section.getU32());
+        for (auto& window : device.windows) {
+          uint32_t samples = section.getU32();
+          for (uint32_t s = 0; s < samples; ++s) {
+            SlidingWindow::Sample sample;
+            sample.timestampUs = section.getI64();
+            sample.value = section.getDouble();
+            window.push_back(sample);
+          }
+        }
+        state.devices.push_back(std::move(device));
+      }
+      states.push_back(std::move(state));
+    }
+
+    if (version >= 2) {
+      alpha = section.getDouble();
+      uint32_t devices = section.getU32();
+      for (uint32_t i = 0; i < devices; ++i) {
+        AnomalyDetector::Entry entry;
+        entry.deviceId = section.getString();
+        entry.samples = section.getU32();
+        for (size_t m = 0; m < AnomalyDetector::kMetrics; ++m) {
+          entry.mean[m] = static_cast<float>(section.getDouble());
+          entry.variance[m] = static_cast<float>(section.getDouble());
+        }
+        estimates.push_back(std::move(entry));
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка восстановления окон правил: " << e.what()
+              << std::endl;
+    return;
+  }
 
+  // Правило, которого больше нет или выражение которого изменилось,
+  // начинает окна заново
+  auto rules = currentRules();
+  for (const auto& state : states) {
+    for (const auto& entry : rules->rules) {
+      if (entry.rule.name == state.name && entry.rule.expression &&
+          entry.rule.description == state.expression) {
+        entry.rule.expression->restore(state.devices);
+        break;
+      }
+    }
+  }
+
+  // Оценки с другим alpha детектор бы только исказили
+  std::shared_ptr<AnomalyDetector> anomalies;
+  {
+    std::lock_guard<std::mutex> lock(rulesMutex_);
+    anomalies = anomalies_;
+  }
+  if (anomalies && anomalies->options().alpha == alpha) {
+    for (const auto& entry : estimates) {
+      anomalies->restore(entry);
+    }
+  }
+}
+
+std::vector<std::string> RuleEngine::getRuleNames() const {
   std::vector<std::string> names;
-  for (const auto& rule : rules_) {
-    names.push_back(rule.name);
+  for (const auto& entry : currentRules()->rules) {
+    names.push_back(entry.rule.name);
   }
 
   return names;
 }
 
-const Rule* RuleEngine::getRule(const std::string& name) const {
-  std::lock_guard<std::mutex> lock(rulesMutex_);
-
-  for (const auto& rule : rules_) {
-    if (rule.name == name) {
-      return &rule;
+std::shared_ptr<const Rule> RuleEngine::getRule(
+    const std::string& name) const {
+  auto rules = currentRules();
+  for (const auto& entry : rules->rules) {
+    if (entry.rule.name == name) {
+      // Указатель держит весь снимок: правило не меняется и не
+      // освобождается, пока он жив
+      return std::shared_ptr<const Rule>(rules, &entry.rule);
     }
   }
 
@@ -225,13 +731,32 @@ bool RuleEngine::ruleExists(const std::string& name) const {
   return getRule(name) != nullptr;
 }
 
-void RuleEngine::sortRulesByPriority() {
-  std::sort(rules_.begin(), rules_.end(), [](const Rule& a, const Rule& b) {
-    return a.priority > b.priority;  // Higher priority first
-  });
+bool RuleEngine::evaluateRule(const RuleSet::Entry& entry,
+                              const models::IoTData& data) {
+  RuleCounters& counters = *entry.counters;
+  counters.evaluations.fetch_add(1, std::memory_order_relaxed);
+
+  auto start = Clock::now();
+  try {
+    bool fires = entry.rule.condition(data);
+    counters.condition.record(elapsedNanos(start));
+    return fires;
+  } catch (const std::exception& e) {
+    counters.condition.record(elapsedNanos(start));
+    counters.errors.fetch_add(1, std::memory_order_relaxed);
+    std::cerr << "❌ Error evaluating rule '" << entry.rule.name
+              << "': " << e.what() << std::endl;
+    return false;
+  }
 }
 
-void RuleEngine::executeRule(const Rule& rule, const models::IoTData& data) {
+void RuleEngine::executeRule(const RuleSet::Entry& entry,
+                             const models::IoTData& data) {
+  const Rule& rule = entry.rule;
+  RuleCounters& counters = *entry.counters;
+  counters.triggers.fetch_add(1, std::memory_order_relaxed);
+
+  auto start = Clock::now();
   try {
     std::cout << "⚡ Rule triggered: " << rule.name << " for device "
               << data.deviceId << std::endl;
@@ -243,9 +768,11 @@ void RuleEngine::executeRule(const Rule& rule, const models::IoTData& data) {
     rule.action(data);
 
   } catch (const std::exception& e) {
+    counters.errors.fetch_add(1, std::memory_order_relaxed);
     std::cerr << "❌ Error executing rule '" << rule.name << "': " << e.what()
               << std::endl;
   }
+  counters.action.record(elapsedNanos(start));
 }
 
 Rule RuleEngine::createTemperatureHighRule(double threshold) {
@@ -335,6 +862,92 @@ Rule RuleEngine::createHumidityLowRule(double threshold) {
       true);
 }
 
+Rule RuleEngine::createDeviceOfflineRule() {
+  // Каждое показание движка - контакт с устройством (показания из
+  // удаленной БД и приема отмечает сервис оповещений); правило
+  // срабатывает на первом показании после offline. Само offline
+  // обнаруживает checkHeartbeats по сроку в колесе таймеров
+  auto resumed = std::make_shared<ResumedDevices>();
+  auto heartbeats = heartbeats_;
+
+  return Rule(
+      "device_offline", "Device stopped reporting / back online",
+      [heartbeats, resumed](const models::IoTData& data) {
+        services::HeartbeatMonitor::Event event;
+        if (!heartbeats->heartbeat(data.deviceId, nowMicros(), event)) {
+          return false;
+        }
+        std::lock_guard<std::mutex> lock(resumed->mutex);
+        resumed->events[data.deviceId] = std::move(event);
+        return true;
+      },
+      [this, resumed](const models::IoTData& data) {
+        services::HeartbeatMonitor::Event event;
+        {
+          std::lock_guard<std::mutex> lock(resumed->mutex);
+          auto it = resumed->events.find(data.deviceId);
+          if (it == resumed->events.end()) {
+            return;
+          }
+          event = std::move(it->second);
+          resumed->events.erase(it);
+        }
+        std::cout << "   📶 Device back online: " << data.deviceId
+                  << std::endl;
+        alertService_->processDeviceStatus(event.deviceId, true,
+                                           event.lastSeenUs,
+                                           event.timestampUs);
+      },
+      90,  // Перед проверками значений
+      true);
+}
+
+Rule RuleEngine::createAnomalyRule() {
+  auto detector = anomalies_;
+  auto anomalous = std::make_shared<AnomalousReadings>();
+  std::ostringstream description;
+  description << "EWMA z-score above " << detector->options().zScore
+              << " after " << detector->options().warmupSamples
+              << " readings";
+
+  return Rule(
+      "anomaly_detection", description.str(),
+      [detector, anomalous](const models::IoTData& data) {
+        AnomalyDetector::Result result;
+        if (!detector->observe(data, result)) {
+          return false;
+        }
+        std::cout << "   📈 Anomaly: "
+                  << AnomalyDetector::metricName(result.metric) << " "
+                  << result.value << " vs mean " << result.mean << " ± "
+                  << result.stdDev << " (z=" << result.zScore << ")"
+                  << std::endl;
+        std::lock_guard<std::mutex> lock(anomalous->mutex);
+        anomalous->results[data.deviceId] = result;
+        return true;
+      },
+      [this, anomalous](const models::IoTData& data) {
+        AnomalyDetector::Result result;
+        {
+          std::lock_guard<std::mutex> lock(anomalous->mutex);
+          auto it = anomalous->results.find(data.deviceId);
+          if (it == anomalous->results.end()) {
+            return;
+          }
+          result = it->second;
+          anomalous->results.erase(it);
+        }
+        std::cout << "   📤 Sending anomaly alert for " << data.deviceId
+                  << std::endl;
+        alertService_->processAnomaly(
+            data.deviceId, AnomalyDetector::metricName(result.metric),
+            result.value,
+            data.timestampUs != 0 ? data.timestampUs : nowMicros());
+      },
+      8,  // После порогов температуры, перед влажностью
+      true);
+}
+
 Rule RuleEngine::createDataValidationRule() {
   return Rule(
       "data_validation", "Validate incoming telemetry data",
@@ -355,4 +968,24 @@ Rule RuleEngine::createDataValidationRule() {
       true);
 }
 
+Rule RuleEngine::createExpressionRule(
+    const models::RuleDefinition& definition) {
+  // Условие разделяется копиями правила в снимках: состояние "for" и
+  // окна переживают изменения других правил
+  auto condition = std::make_shared<ExpressionCondition>(
+      RuleProgram::compile(definition.expression), devices_);
+
+  Rule rule(
+      definition.name, definition.expression,
+      [condition](const models::IoTData& data) { return (*condition)(data); },
+      [this](const models::IoTData& data) {
+        alertService_->processTelemetryData(data.deviceId, data.temperature,
+                                            data.humidity);
+      },
+      definition.priority, definition.enabled);
+  rule.scope = scopeOf(definition);
+  rule.expression = std::move(condition);
+  return rule;
+}
+
 }  // namespace iot_core::engine
\ No newline at end of file
@@ -1,13 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../models/IoTData.h"
+#include "../services/HeartbeatMonitor.h"
+#include "../utils/LatencyHistogram.h"
+#include "AnomalyDetector.h"
 
 // Forward declarations
 namespace iot_core {
@@ -17,10 +25,28 @@ class DatabaseRepository;
 namespace services {
 class AlertProcessingService;
 }
+namespace storage {
+class SnapshotWriter;
+class SnapshotReader;
+}  // namespace storage
 }  // namespace iot_core
 
 namespace iot_core::engine {
 
+class ExpressionCondition;
+
+// Область действия правила: одно устройство или группа устройств;
+// пустая - все устройства
+struct RuleScope {
+  std::string deviceId;
+  int groupId = 0;
+
+  bool global() const { return deviceId.empty() && groupId == 0; }
+  bool operator==(const RuleScope& other) const {
+    return deviceId == other.deviceId && groupId == other.groupId;
+  }
+};
+
 struct Rule {
   std::string name;
   std::string description;
@@ -28,6 +54,10 @@ struct Rule {
   std::function<void(const models::IoTData&)> action;
   int priority = 0;
   bool enabled = true;
+  RuleScope scope;
+  // Условие правила из выражения - для снимка его состояния; nullptr у
+  // встроенных правил
+  std::shared_ptr<ExpressionCondition> expression;
 
   Rule(std::string n, std::string desc,
        std::function<bool(const models::IoTData&)> cond,
@@ -41,10 +71,79 @@ struct Rule {
         enabled(en) {}
 };
 
+// Счетчики правила: слот на имя правила в RuleEngine, общий для всех
+// наборов, где есть правило с этим именем. Слот занимает свои
+// кэш-линии, поэтому потоки, обновляющие счетчики разных правил, не
+// мешают друг другу.
+struct alignas(64) RuleCounters {
+  std::atomic<uint64_t> evaluations{0};
+  std::atomic<uint64_t> triggers{0};
+  std::atomic<uint64_t> errors{0};  // исключения условия или действия
+  utils::LatencyHistogram condition;
+  utils::LatencyHistogram action;
+};
+
+// Неизменяемый набор правил, упорядоченный по приоритету.
+//
+// Индекс маршрутизации - номера включенных правил в rules по
+// возрастанию (то есть по приоритету): правила без области в global,
+// правила устройства и его групп - в scoped по deviceId. Показание
+// проходит только по слиянию двух списков, поэтому правила других
+// устройств его не замедляют.
+struct RuleSet {
+  struct Entry {
+    Rule rule;
+    RuleCounters* counters;  // слот в RuleEngine, живет с движком
+  };
+
+  std::vector<Entry> rules;
+  std::vector<uint32_t> global;
+  std::unordered_map<std::string, std::vector<uint32_t>> scoped;
+
+  // visit(номер правила) для правил устройства в порядке приоритета
+  template <typename Visit>
+  void forEachRule(const std::string& deviceId, Visit&& visit) const {
+    const std::vector<uint32_t>* own = nullptr;
+    if (!scoped.empty()) {
+      auto it = scoped.find(deviceId);
+      if (it != scoped.end()) {
+        own = &it->second;
+      }
+    }
+    if (own == nullptr) {
+      for (uint32_t index : global) {
+        visit(index);
+      }
+      return;
+    }
+
+    size_t g = 0;
+    size_t s = 0;
+    while (g < global.size() || s < own->size()) {
+      if (s == own->size() ||
+          (g < global.size() && global[g] < (*own)[s])) {
+        visit(global[g++]);
+      } else {
+        visit((*own)[s++]);
+      }
+    }
+  }
+};
+
+/**
+ * @brief Применение правил к показаниям
+ *
+ * Правила публикуются снимками: изменение (добавление, удаление,
+ * включение) собирает новый RuleSet под rulesMutex_ и атомарно
+ * подменяет указатель. Обработка показания берет текущий снимок без
+ * блокировок и копирования правил, а счетчики срабатываний - атомарные.
+ */
 class RuleEngine {
  public:
+  // offlineTimeout = 0 - без правила device_offline
   RuleEngine(std::shared_ptr<core::DatabaseRepository> database,
-             std::shared_ptr<services::AlertProcessingService> alertService);
+             std::shared_ptr<services::AlertProcessingService> alertService,
+             std::chrono::seconds offlineTimeout = std::chrono::seconds(300));
 
   // Rule management
   void addRule(const Rule& rule);
@@ -60,32 +159,102 @@ class RuleEngine {
   // Default rules setup
   void setupDefaultRules();
 
+  // Правила на языке выражений (см. RuleProgram): заменяют прежний
+  // набор таких правил одной публикацией, не останавливая обработку.
+  // Правило с ошибкой пропускается, его прежняя версия остается.
+  // Возвращает число действующих правил из определений.
+  size_t applyRuleDefinitions(
+      const std::vector<models::RuleDefinition>& definitions);
+  // Состав групп для правил с областью groupId; при изменении
+  // перестраивает индекс маршрутизации
+  void setDeviceGroups(const std::vector<models::DeviceGroup>& groups);
+
+  // Устройства без данных дольше offlineTimeout -> оповещения offline.
+  // Вызывать периодически (главный цикл)
+  void checkHeartbeats();
+  services::HeartbeatMonitor::Statistics getHeartbeatStatistics() const;
+
+  // Правило anomaly_detection: z-оценка показания относительно
+  // EWMA-оценок своего устройства (см. AnomalyDetector)
+  void enableAnomalyDetection(const AnomalyDetector::Options& options);
+  // Пустая статистика, если обнаружение аномалий не включено
+  AnomalyDetector::Statistics getAnomalyStatistics() const;
+
   // Statistics
+  struct RuleMetrics {
+    std::string name;
+    uint64_t evaluations = 0;
+    uint64_t triggers = 0;
+    uint64_t errors = 0;
+    utils::LatencyHistogram::Snapshot condition;
+    utils::LatencyHistogram::Snapshot action;
+  };
+
   struct Statistics {
     int totalProcessed = 0;
     int rulesTriggered = 0;
     std::unordered_map<std::string, int> ruleTriggerCount;
+    // По слотам, включая удаленные правила
+    std::vector<RuleMetrics> rules;
   };
 
   Statistics getStatistics() const;
   void resetStatistics();
 
+  // Состояние движка в снимке для быстрого перезапуска: счетчики,
+  // окна и начатые "for" правил из выражений, оценки детектора
+  // аномалий. Восстанавливать после загрузки правил и включения
+  // детектора
+  void saveState(storage::SnapshotWriter& snapshot) const;
+  bool restoreState(const storage::SnapshotReader& snapshot);
+
   // Information
   std::vector<std::string> getRuleNames() const;
-  const Rule* getRule(const std::string& name) const;
+  // Правило из текущего снимка; остается валидным после изменений
+  std::shared_ptr<const Rule> getRule(const std::string& name) const;
   bool ruleExists(const std::string& name) const;
 
  private:
-  std::vector<Rule> rules_;
+  std::shared_ptr<const RuleSet> rules_;
   std::shared_ptr<core::DatabaseRepository> database_;
   std::shared_ptr<services::AlertProcessingService> alertService_;
+  // Индексы устройств для состояния правил из выражений
+  std::shared_ptr<services::DeviceRegistry> devices_;
+  // nullptr - отслеживание отключено
+  // Общий с сервисом оповещений (контакты из его пути приема)
+  std::shared_ptr<services::HeartbeatMonitor> heartbeats_;
+  // Общий с условием правила; nullptr - не включено
+  std::shared_ptr<AnomalyDetector> anomalies_;
 
-  mutable Statistics statistics_;
-  mutable std::mutex statisticsMutex_;
+  std::atomic<uint64_t> totalProcessed_{0};
+  std::atomic<uint64_t> rulesTriggered_{0};
+  // Слоты счетчиков по имени правила, включая удаленные (для
+  // статистики); deque не перемещает слоты при добавлении
+  std::deque<RuleCounters> counters_;
+  std::vector<std::string> slotNames_;
+  std::unordered_map<std::string, uint32_t> slots_;
+  // Сериализует изменения набора правил и слотов счетчиков
   mutable std::mutex rulesMutex_;
+  // Правила из определений и определения последней загрузки
+  std::unordered_set<std::string> expressionRules_;
+  std::vector<models::RuleDefinition> appliedDefinitions_;
+  // Встроенные правила, замененные одноименными определениями:
+  // возвращаются, когда определение удалено или выключено
+  std::unordered_map<std::string, RuleSet::Entry> shadowedBuiltins_;
+  // Группа -> устройства (для индекса маршрутизации)
+  std::unordered_map<int, std::vector<std::string>> groupMembers_;
 
-  void sortRulesByPriority();
-  void executeRule(const Rule& rule, const models::IoTData& data);
+  std::shared_ptr<const RuleSet> currentRules() const;
+  // Вызывать под rulesMutex_: сортирует, строит индекс маршрутизации и
+  // публикует новый набор
+  void publishLocked(std::shared_ptr<RuleSet> rules);
+  RuleCounters* counterLocked(const std::string& name);
+  // Окна и "for" правил и оценки аномалий из снимка (см. saveState)
+  void restoreConditionState(const storage::SnapshotReader& snapshot);
+  // Условие и действие с замером времени; исключение считается ошибкой
+  // правила и не прерывает обработку показания
+  bool evaluateRule(const RuleSet::Entry& entry, const models::IoTData& data);
+  void executeRule(const RuleSet::Entry& entry, const models::IoTData& data);
 
   // Default rule factories
   Rule createTemperatureHighRule(double threshold = 30.0);
@@ -93,7 +262,9 @@ class RuleEngine {
   Rule createHumidityHighRule(double threshold = 70.0);
   Rule createHumidityLowRule(double threshold = 30.0);
   Rule createDataValidationRule();
+  Rule createExpressionRule(const models::RuleDefinition& definition);
   Rule createDeviceOfflineRule();
+  Rule createAnomalyRule();
   Rule createBatteryLowRule(double threshold = 20.0);
 };
 
@@ -0,0 +1,541 @@
+#include "RuleProgram.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "BatchKernels.h"
+
+namespace iot_core::engine {
+
+class RuleProgram::Compiler {
+ public:
+  explicit Compiler(const std::string& source) : source_(source) {}
+
+  RuleProgram run() {
+    RuleProgram program;
+    program.source_ = source_;
+
+    parseOr();
+    if (acceptWord("for")) {
+      program.holdFor_ = parseDuration();
+    }
+    skipSpaces();
+    if (pos_ < source_.size()) {
+      fail("лишний текст");
+    }
+
+    program.code_ = std::move(code_);
+    program.windows_ = std::move(windows_);
+    program.columnar_ = std::all_of(
+        program.code_.begin(), program.code_.end(),
+        [](const Instruction& instruction) {
+          switch (instruction.op) {
+            case Op::LtField:
+            case Op::LeField:
+            case Op::GtField:
+            case Op::GeField:
+            case Op::And:
+            case Op::Or:
+            case Op::Not:
+              return true;
+            default:
+              return false;
+          }
+        });
+    return program;
+  }
+
+ private:
+  [[noreturn]] void fail(const std::string& message) const {
+    throw std::invalid_argument("Ошибка в выражении правила (позиция " +
+                                std::to_string(pos_ + 1) + "): " + message);
+  }
+
+  void skipSpaces() {
+    while (pos_ < source_.size() &&
+           std::isspace(static_cast<unsigned char>(source_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  bool accept(const char* token) {
+    skipSpaces();
+    size_t length = std::char_traits<char>::length(token);
+    if (source_.compare(pos_, length, token) != 0) {
+      return false;
+    }
+    pos_ += length;
+    return true;
+  }
+
+  std::string peekWord() {
+    skipSpaces();
+    size_t end = pos_;
+    while (end < source_.size() &&
+           (std::isalpha(static_cast<unsigned char>(source_[end])) ||
+            source_[end] == '_')) {
+      ++end;
+    }
+    return source_.substr(pos_, end - pos_);
+  }
+
+  bool acceptWord(const char* word) {
+    if (peekWord() != word) {
+      return false;
+    }
+    pos_ += std::char_traits<char>::length(word);
+    return true;
+  }
+
+  double parseNumber() {
+    skipSpaces();
+    const char* begin = source_.c_str() + pos_;
+    char* end = nullptr;
+    double value = std::strtod(begin, &end);
+    if (end == begin) {
+      fail("ожидалось число");
+    }
+    pos_ += static_cast<size_t>(end - begin);
+    return value;
+  }
+
+  std::chrono::seconds parseDuration() {
+    double amount = parseNumber();
+    if (amount < 0) {
+      fail("отрицательная длительность");
+    }
+    double scale = 0;
+    if (accept("s")) {
+      scale = 1;
+    } else if (accept("m")) {
+      scale = 60;
+    } else if (accept("h")) {
+      scale = 3600;
+    } else {
+      fail("ожидалась единица длительности s, m или h");
+    }
+    return std::chrono::seconds(static_cast<int64_t>(amount * scale));
+  }
+
+  void emit(Op op, double value = 0.0, Field field = Field::Temperature) {
+    switch (op) {
+      case Op::Push:
+      case Op::Load:
+        ++depth_;
+        break;
+      case Op::Neg:
+      case Op::Not:
+      case Op::Window:
+        break;
+      default:
+        --depth_;
+        break;
+    }
+    if (depth_ > kMaxStack) {
+      fail("выражение слишком глубокое");
+    }
+    code_.push_back(Instruction{op, field, value});
+  }
+
+  // Load поля, Push константы, сравнение -> одна инструкция
+  void emitComparison(Op op) {
+    size_t n = code_.size();
+    if (n >= 2 && code_[n - 2].op == Op::Load && code_[n - 1].op == Op::Push) {
+      Op fused = op == Op::Lt   ? Op::LtField
+                 : op == Op::Le ? Op::LeField
+                 : op == Op::Gt ? Op::GtField
+                 : op == Op::Ge ? Op::GeField
+                                : op;
+      if (fused != op) {
+        Instruction instruction{fused, code_[n - 2].field,
+                                code_[n - 1].value};
+        code_.resize(n - 2);
+        code_.push_back(instruction);
+        --depth_;
+        return;
+      }
+    }
+    emit(op);
+  }
+
+  void parseOr() {
+    parseAnd();
+    while (accept("||") || acceptWord("or")) {
+      parseAnd();
+      emit(Op::Or);
+    }
+  }
+
+  void parseAnd() {
+    parseNot();
+    while (accept("&&") || acceptWord("and")) {
+      parseNot();
+      emit(Op::And);
+    }
+  }
+
+  void parseNot() {
+    skipSpaces();
+    if (source_.compare(pos_, 2, "!=") != 0 &&
+        (accept("!") || acceptWord("not"))) {
+      parseNot();
+      emit(Op::Not);
+      return;
+    }
+    parseComparison();
+  }
+
+  void parseComparison() {
+    parseSum();
+    Op op;
+    if (accept("<=")) {
+      op = Op::Le;
+    } else if (accept(">=")) {
+      op = Op::Ge;
+    } else if (accept("==")) {
+      op = Op::Eq;
+    } else if (accept("!=")) {
+      op = Op::Ne;
+    } else if (accept("<")) {
+      op = Op::Lt;
+    } else if (accept(">")) {
+      op = Op::Gt;
+    } else {
+      return;
+    }
+    parseSum();
+    emitComparison(op);
+  }
+
+  void parseSum() {
+    parseProduct();
+    while (true) {
+      if (accept("+")) {
+        parseProduct();
+        emit(Op::Add);
+      } else if (accept("-")) {
+        parseProduct();
+        emit(Op::Sub);
+      } else {
+        return;
+      }
+    }
+  }
+
+  void parseProduct() {
+    parseUnary();
+    while (true) {
+      if (accept("*")) {
+        parseUnary();
+        emit(Op::Mul);
+      } else if (accept("/")) {
+        parseUnary();
+        emit(Op::Div);
+      } else {
+        return;
+      }
+    }
+  }
+
+  void parseUnary() {
+    if (accept("-")) {
+      parseUnary();
+      // Отрицательная константа остается константой
+      if (!code_.empty() && code_.back().op == Op::Push) {
+        code_.back().value = -code_.back().value;
+      } else {
+        emit(Op::Neg);
+      }
+      return;
+    }
+    parsePrimary();
+  }
+
+  void parsePrimary() {
+    skipSpaces();
+    if (accept("(")) {
+      parseOr();
+      if (!accept(")")) {
+        fail("ожидалась ')'");
+      }
+      return;
+    }
+
+    std::string word = peekWord();
+    if (!word.empty()) {
+      Aggregate aggregate;
+      if (windowFunction(word, aggregate)) {
+        pos_ += word.size();
+        parseWindow(aggregate);
+      } else if (word == "temperature") {
+        pos_ += word.size();
+        emit(Op::Load, 0.0, Field::Temperature);
+      } else if (word == "humidity") {
+        pos_ += word.size();
+        emit(Op::Load, 0.0, Field::Humidity);
+      } else {
+        fail("неизвестное поле '" + word + "'");
+      }
+      return;
+    }
+
+    emit(Op::Push, parseNumber());
+  }
+
+  static bool windowFunction(const std::string& word, Aggregate& aggregate) {
+    static const std::pair<const char*, Aggregate> kFunctions[] = {
+        {"avg", Aggregate::Mean},    {"min", Aggregate::Min},
+        {"max", Aggregate::Max},     {"delta", Aggregate::Delta},
+        {"count", Aggregate::Count},
+    };
+    for (const auto& [name, value] : kFunctions) {
+      if (word == name) {
+        aggregate = value;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // <функция>(<выражение>, <длительность>|<число показаний>)
+  void parseWindow(Aggregate aggregate) {
+    if (!accept("(")) {
+      fail("ожидалась '('");
+    }
+    parseOr();
+    if (!accept(",")) {
+      fail("ожидалась ',' перед размером окна");
+    }
+
+    Window window;
+    window.aggregate = aggregate;
+    double amount = parseNumber();
+    if (accept("s")) {
+      window.spanUs = static_cast<int64_t>(amount * 1e6);
+    } else if (accept("m")) {
+      window.spanUs = static_cast<int64_t>(amount * 60e6);
+    } else if (accept("h")) {
+      window.spanUs = static_cast<int64_t>(amount * 3600e6);
+    } else if (amount >= 1 && amount <= kMaxWindowSamples &&
+               amount == static_cast<double>(static_cast<size_t>(amount))) {
+      window.samples = static_cast<size_t>(amount);
+    } else {
+      fail("размер окна - длительность s, m, h или целое число от 1 до " +
+           std::to_string(kMaxWindowSamples));
+    }
+    if (window.samples == 0 && window.spanUs <= 0) {
+      fail("пустое окно");
+    }
+    if (!accept(")")) {
+      fail("ожидалась ')'");
+    }
+
+    if (windows_.size() >= kMaxWindows) {
+      fail("слишком много оконных функций");
+    }
+    windows_.push_back(window);
+    emit(Op::Window);
+    code_.back().window = static_cast<uint16_t>(windows_.size() - 1);
+  }
+
+  const std::string& source_;
+  size_t pos_ = 0;
+  size_t depth_ = 0;
+  std::vector<Instruction> code_;
+  std::vector<Window> windows_;
+};
+
+namespace {
+
+double aggregateOf(const SlidingWindow& window,
+                   RuleProgram::Aggregate aggregate) {
+  switch (aggregate) {
+    case RuleProgram::Aggregate::Mean:
+      return window.mean();
+    case RuleProgram::Aggregate::Min:
+      return window.min();
+    case RuleProgram::Aggregate::Max:
+      return window.max();
+    case RuleProgram::Aggregate::Delta:
+      return window.latest() - window.oldest();
+    case RuleProgram::Aggregate::Count:
+      return window.sum();
+  }
+  return 0.0;
+}
+
+}  // namespace
+
+RuleProgram RuleProgram::compile(const std::string& source) {
+  return Compiler(source).run();
+}
+
+bool RuleProgram::evaluate(const models::IoTData& data) const {
+  return evaluate(data, 0, nullptr);
+}
+
+uint64_t RuleProgram::evaluateColumns(const double* const columns[],
+                                      size_t count) const {
+  if (!columnar_ || count == 0) {
+    return 0;
+  }
+
+  uint64_t stack[kMaxStack];
+  size_t top = 0;
+  const uint64_t all =
+      count >= kBatchBlock ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+
+  auto compare = [&](const Instruction& instruction, Comparison comparison) {
+    return compareColumn(columns[static_cast<size_t>(instruction.field)],
+                         count, comparison, instruction.value);
+  };
+
+  for (const auto& instruction : code_) {
+    switch (instruction.op) {
+      case Op::LtField:
+        stack[top++] = compare(instruction, Comparison::Less);
+        break;
+      case Op::LeField:
+        stack[top++] = compare(instruction, Comparison::LessEqual);
+        break;
+      case Op::GtField:
+        stack[top++] = compare(instruction, Comparison::Greater);
+        break;
+      case Op::GeField:
+        stack[top++] = compare(instruction, Comparison::GreaterEqual);
+        break;
+      case Op::And:
+        --top;
+        stack[top - 1] &= stack[top];
+        break;
+      case Op::Or:
+        --top;
+        stack[top - 1] |= stack[top];
+        break;
+      case Op::Not:
+        stack[top - 1] = ~stack[top - 1] & all;
+        break;
+      default:
+        return 0;
+    }
+  }
+
+  return top > 0 ? stack[top - 1] & all : 0;
+}
+
+std::vector<SlidingWindow> RuleProgram::makeWindows() const {
+  std::vector<SlidingWindow> windows;
+  windows.reserve(windows_.size());
+  for (const auto& window : windows_) {
+    windows.emplace_back(window.samples, window.spanUs);
+  }
+  return windows;
+}
+
+bool RuleProgram::evaluate(const models::IoTData& data, int64_t timestampUs,
+                           SlidingWindow* windows) const {
+  double stack[kMaxStack];
+  size_t top = 0;
+
+  // Поле выбирается индексом, без ветвления
+  const double fields[] = {data.temperature, data.humidity};
+  auto field = [&fields](Field f) { return fields[static_cast<size_t>(f)]; };
+
+  for (const auto& instruction : code_) {
+    switch (instruction.op) {
+      case Op::Push:
+        stack[top++] = instruction.value;
+        break;
+      case Op::Load:
+        stack[top++] = field(instruction.field);
+        break;
+      case Op::Add:
+        --top;
+        stack[top - 1] += stack[top];
+        break;
+      case Op::Sub:
+        --top;
+        stack[top - 1] -= stack[top];
+        break;
+      case Op::Mul:
+        --top;
+        stack[top - 1] *= stack[top];
+        break;
+      case Op::Div:
+        --top;
+        stack[top - 1] /= stack[top];
+        break;
+      case Op::Neg:
+        stack[top - 1] = -stack[top - 1];
+        break;
+      case Op::Lt:
+        --top;
+        stack[top - 1] = stack[top - 1] < stack[top];
+        break;
+      case Op::Le:
+        --top;
+        stack[top - 1] = stack[top - 1] <= stack[top];
+        break;
+      case Op::Gt:
+        --top;
+        stack[top - 1] = stack[top - 1] > stack[top];
+        break;
+      case Op::Ge:
+        --top;
+        stack[top - 1] = stack[top - 1] >= stack[top];
+        break;
+      case Op::Eq:
+        --top;
+        stack[top - 1] = stack[top - 1] == stack[top];
+        break;
+      case Op::Ne:
+        --top;
+        stack[top - 1] = stack[top - 1] != stack[top];
+        break;
+      case Op::And:
+        --top;
+        stack[top - 1] = stack[top - 1] != 0.0 && stack[top] != 0.0;
+        break;
+      case Op::Or:
+        --top;
+        stack[top - 1] = stack[top - 1] != 0.0 || stack[top] != 0.0;
+        break;
+      case Op::Not:
+        stack[top - 1] = stack[top - 1] == 0.0;
+        break;
+      case Op::LtField:
+        stack[top++] = field(instruction.field) < instruction.value;
+        break;
+      case Op::LeField:
+        stack[top++] = field(instruction.field) <= instruction.value;
+        break;
+      case Op::GtField:
+        stack[top++] = field(instruction.field) > instruction.value;
+        break;
+      case Op::GeField:
+        stack[top++] = field(instruction.field) >= instruction.value;
+        break;
+      case Op::Window: {
+        const auto& spec = windows_[instruction.window];
+        double value = stack[top - 1];
+        if (spec.aggregate == Aggregate::Count) {
+          value = value != 0.0 ? 1.0 : 0.0;
+        }
+        if (windows == nullptr) {
+          stack[top - 1] = spec.aggregate == Aggregate::Delta ? 0.0 : value;
+          break;
+        }
+        auto& window = windows[instruction.window];
+        window.add(timestampUs, value);
+        stack[top - 1] = aggregateOf(window, spec.aggregate);
+        break;
+      }
+    }
+  }
+
+  return top > 0 && stack[top - 1] != 0.0;
+}
+
+}  // namespace iot_core::engine
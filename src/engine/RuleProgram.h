@@ -0,0 +1,120 @@
+// src/engine/RuleProgram.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../models/IoTData.h"
+#include "SlidingWindow.h"
+
+namespace iot_core::engine {
+
+/**
+ * @brief Условие правила на языке выражений, скомпилированное в байткод
+ *
+ * Синтаксис: `temperature > 28 && humidity > 60 for 5m`. Поля -
+ * temperature и humidity; числа, + - * /, сравнения < <= > >= == !=,
+ * && (and), || (or), ! (not), скобки. Необязательный суффикс
+ * `for <число>s|m|h` - условие должно держаться это время (его
+ * проверяет RuleEngine по устройству, сама программа его не знает).
+ *
+ * Оконные функции: avg, min, max, delta (последнее значение минус самое
+ * старое в окне) и count (сколько раз условие было верно) -
+ * `avg(temperature, 10m) > 30`, `delta(temperature, 10m) >= 5`,
+ * `count(humidity > 80, 3) == 3`. Окно - длительность (по времени) или
+ * целое число (последние N показаний). Состояние окон хранит вызывающий
+ * по устройству (makeWindows), программа только обновляет его.
+ *
+ * Выражение компилируется в плоский массив инструкций стековой машины;
+ * сравнение поля с константой сворачивается в одну инструкцию.
+ * Вычисление - один проход по массиву со стеком фиксированного размера
+ * на стеке вызова: без аллокаций и виртуальных вызовов. Программа только
+ * из сравнений полей с константами и логики (columnar) вычисляется и над
+ * блоком показаний сразу: сравнения дают битовые маски (BatchKernels).
+ */
+class RuleProgram {
+ public:
+  enum class Op : uint8_t {
+    Push,
+    Load,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Neg,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    Eq,
+    Ne,
+    And,
+    Or,
+    Not,
+    // Поле field сравнивается с value
+    LtField,
+    LeField,
+    GtField,
+    GeField,
+    // Значение на вершине стека -> окно window -> его агрегат
+    Window,
+  };
+
+  enum class Field : uint8_t { Temperature, Humidity };
+
+  struct Instruction {
+    Op op = Op::Push;
+    Field field = Field::Temperature;
+    double value = 0.0;
+    uint16_t window = 0;
+  };
+
+  enum class Aggregate : uint8_t { Mean, Min, Max, Delta, Count };
+
+  struct Window {
+    Aggregate aggregate = Aggregate::Mean;
+    size_t samples = 0;  // > 0 - окно по числу показаний
+    int64_t spanUs = 0;  // иначе - по времени
+  };
+
+  static constexpr size_t kMaxStack = 16;
+  static constexpr size_t kMaxWindows = 16;
+  static constexpr size_t kMaxWindowSamples = 10000;
+
+  // Бросает std::invalid_argument с позицией ошибки
+  static RuleProgram compile(const std::string& source);
+
+  // Без состояния окон: каждое окно видит только текущее показание
+  bool evaluate(const models::IoTData& data) const;
+  // windows - makeWindows() этого устройства; обновляются показанием
+  bool evaluate(const models::IoTData& data, int64_t timestampUs,
+                SlidingWindow* windows) const;
+
+  // Маска блока: бит i - условие верно для показания i. columns -
+  // колонки полей по индексу Field, count <= kBatchBlock. Только для
+  // columnar-программ, для остальных 0
+  uint64_t evaluateColumns(const double* const columns[],
+                           size_t count) const;
+  bool columnar() const { return columnar_; }
+
+  // Пустое состояние окон для одного устройства
+  std::vector<SlidingWindow> makeWindows() const;
+
+  // 0 - условие срабатывает сразу
+  std::chrono::seconds holdFor() const { return holdFor_; }
+  const std::string& source() const { return source_; }
+  const std::vector<Instruction>& code() const { return code_; }
+  const std::vector<Window>& windows() const { return windows_; }
+
+ private:
+  class Compiler;
+
+  std::string source_;
+  std::vector<Instruction> code_;
+  std::vector<Window> windows_;
+  std::chrono::seconds holdFor_{0};
+  bool columnar_ = false;
+};
+
+}  // namespace iot_core::engine
@@ -0,0 +1,87 @@
+#include "SlidingWindow.h"
+
+#include <algorithm>
+
+namespace iot_core::engine {
+
+namespace {
+
+// Сумма пересчитывается заново не реже чем раз в столько вытеснений
+// (или размер окна, если он больше): ошибка округления нарастающего
+// итога не копится, а затраты остаются O(1) на показание
+constexpr size_t kMinResumInterval = 64;
+
+}  // namespace
+
+SlidingWindow::SlidingWindow(size_t maxSamples, int64_t spanUs)
+    : maxSamples_(maxSamples), spanUs_(spanUs) {}
+
+void SlidingWindow::add(int64_t timestampUs, double value) {
+  uint64_t sequence = nextSequence_++;
+  samples_.push_back(Sample{timestampUs, value});
+  sum_ += value;
+
+  while (!minimums_.empty() && minimums_.back().value >= value) {
+    minimums_.pop_back();
+  }
+  minimums_.push_back(Candidate{sequence, value});
+  while (!maximums_.empty() && maximums_.back().value <= value) {
+    maximums_.pop_back();
+  }
+  maximums_.push_back(Candidate{sequence, value});
+
+  if (maxSamples_ > 0) {
+    while (samples_.size() > maxSamples_) {
+      evictOldest();
+    }
+  } else {
+    while (samples_.front().timestampUs < timestampUs - spanUs_) {
+      evictOldest();
+    }
+  }
+
+  if (evictions_ >= std::max(kMinResumInterval, samples_.size())) {
+    sum_ = 0.0;
+    for (size_t i = 0; i < samples_.size(); ++i) {
+      sum_ += samples_.at(i).value;
+    }
+    evictions_ = 0;
+  }
+}
+
+void SlidingWindow::evictOldest() {
+  sum_ -= samples_.front().value;
+  samples_.pop_front();
+  ++firstSequence_;
+  ++evictions_;
+
+  if (!minimums_.empty() && minimums_.front().sequence < firstSequence_) {
+    minimums_.pop_front();
+  }
+  if (!maximums_.empty() && maximums_.front().sequence < firstSequence_) {
+    maximums_.pop_front();
+  }
+}
+
+double SlidingWindow::mean() const {
+  return samples_.empty() ? 0.0
+                          : sum_ / static_cast<double>(samples_.size());
+}
+
+double SlidingWindow::min() const {
+  return minimums_.empty() ? 0.0 : minimums_.front().value;
+}
+
+double SlidingWindow::max() const {
+  return maximums_.empty() ? 0.0 : maximums_.front().value;
+}
+
+double SlidingWindow::oldest() const {
+  return samples_.empty() ? 0.0 : samples_.front().value;
+}
+
+double SlidingWindow::latest() const {
+  return samples_.empty() ? 0.0 : samples_.back().value;
+}
+
+}  // namespace iot_core::engine
@@ -0,0 +1,108 @@
+// src/engine/SlidingWindow.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace iot_core::engine {
+
+/**
+ * @brief Скользящее окно значений с агрегатами за O(1)
+ *
+ * Окно по числу показаний (последние maxSamples) или по времени
+ * (показания не старше span от последнего). Значения лежат в кольцевом
+ * буфере; сумма ведется нарастающим итогом, минимум и максимум - через
+ * монотонные очереди, поэтому добавление показания и любой агрегат -
+ * амортизированное O(1). Буферы растут только до максимального числа
+ * показаний в окне и дальше не перевыделяются.
+ */
+class SlidingWindow {
+ public:
+  struct Sample {
+    int64_t timestampUs = 0;
+    double value = 0.0;
+  };
+
+  // maxSamples > 0 - окно по числу показаний, иначе по времени spanUs
+  SlidingWindow(size_t maxSamples, int64_t spanUs);
+
+  void add(int64_t timestampUs, double value);
+
+  size_t size() const { return samples_.size(); }
+  bool empty() const { return samples_.empty(); }
+  double sum() const { return sum_; }
+  double mean() const;
+  double min() const;
+  double max() const;
+  // Первое и последнее значения в окне
+  double oldest() const;
+  double latest() const;
+  // i-е показание окна от старых к новым (для снимка: повторное add
+  // тех же показаний в пустое окно восстанавливает его)
+  const Sample& sample(size_t i) const { return samples_.at(i); }
+
+ private:
+  // Кольцевой буфер с удвоением при заполнении
+  template <typename T>
+  class Ring {
+   public:
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    T& front() { return items_[head_]; }
+    const T& front() const { return items_[head_]; }
+    T& back() { return items_[index(size_ - 1)]; }
+    const T& back() const { return items_[index(size_ - 1)]; }
+    const T& at(size_t i) const { return items_[index(i)]; }
+
+    void push_back(const T& item) {
+      if (size_ == items_.size()) {
+        grow();
+      }
+      items_[index(size_)] = item;
+      ++size_;
+    }
+    void pop_front() {
+      head_ = (head_ + 1) % items_.size();
+      --size_;
+    }
+    void pop_back() { --size_; }
+
+   private:
+    size_t index(size_t i) const { return (head_ + i) % items_.size(); }
+
+    void grow() {
+      std::vector<T> grown(items_.empty() ? 8 : items_.size() * 2);
+      for (size_t i = 0; i < size_; ++i) {
+        grown[i] = at(i);
+      }
+      items_.swap(grown);
+      head_ = 0;
+    }
+
+    std::vector<T> items_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+  };
+
+  // Кандидат в экстремумы: порядковый номер показания и значение
+  struct Candidate {
+    uint64_t sequence = 0;
+    double value = 0.0;
+  };
+
+  void evictOldest();
+
+  size_t maxSamples_;
+  int64_t spanUs_;
+
+  Ring<Sample> samples_;
+  Ring<Candidate> minimums_;  // значения по возрастанию
+  Ring<Candidate> maximums_;  // значения по убыванию
+  uint64_t firstSequence_ = 0;  // номер самого старого показания в окне
+  uint64_t nextSequence_ = 0;
+  double sum_ = 0.0;
+  // Вытеснений с последнего пересчета суммы
+  size_t evictions_ = 0;
+};
+
+}  // namespace iot_core::engine
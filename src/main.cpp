@@ -1,4 +1,6 @@
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
 
@@ -19,6 +21,13 @@ int main(int argc, char* argv[]) {
   std::signal(SIGINT, signalHandler);
   std::signal(SIGTERM, signalHandler);
 
+  // iot_core --backtest [дней]: отчет по истории вместо запуска сервиса
+  if (argc > 1 && std::strcmp(argv[1], "--backtest") == 0) {
+    int days = argc > 2 ? std::atoi(argv[2]) : 30;
+    Application application;
+    return application.runBacktest(days);
+  }
+
   try {
     g_application = std::make_unique<Application>();
     std::cout << "🚀 Starting IoT Core Platform..." << std::endl;
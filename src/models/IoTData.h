@@ -1,5 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace iot_core::models {
 
@@ -8,9 +10,9 @@ struct IoTData {
     std::string deviceId;
     double temperature;
     double humidity;
-    std::string timestamp;
+    int64_t timestampUs;  // Unix-время в микросекундах
     
-    IoTData() : id(0), temperature(0.0), humidity(0.0) {}
+    IoTData() : id(0), temperature(0.0), humidity(0.0), timestampUs(0) {}
     
     bool isValid() const {
         return !deviceId.empty() && 
@@ -33,6 +35,94 @@ struct UserAlert {
     }
 };
 
+// Сработавшее оповещение (для сводок)
+struct AlertEvent {
+    std::string deviceId;
+    double value = 0.0;
+    // "temperature" / "humidity"; "connectivity" - устройство не в сети
+    // (value - секунды без данных, direction "offline" / "online")
+    std::string metricType;
+    // "above" / "below"; "anomaly" - резкое отклонение от обычных
+    // значений устройства (см. AnomalyDetector)
+    std::string direction;
+    int64_t timestampUs = 0;
+    bool resolved = false;    // значение вернулось в норму
+    uint32_t suppressedBefore = 0;  // подавлено лимитом до этого оповещения
+};
+
+// Запись общей очереди уведомлений (таблица notification_outbox)
+struct OutboxEntry {
+    int64_t id = 0;
+    std::string dedupKey;     // одинаков у всех узлов для одного события
+    std::string channel;      // "telegram" / "email"
+    long chatId = 0;          // для email не используется
+    AlertEvent alert;
+    int attempts = 0;         // с учетом текущей выборки
+};
+
+// Группа устройств пользователя (комната, здание)
+struct DeviceGroup {
+    int id = 0;
+    long chatId = 0;
+    std::string name;
+    std::vector<std::string> deviceIds;
+};
+
+// Правило по агрегату группы: aggregate "mean" / "min" / "max"
+struct GroupAlertRule {
+    int groupId = 0;
+    std::string metricType;   // "temperature" / "humidity"
+    std::string aggregate;
+    std::string direction;    // "above" / "below"
+    double threshold = 0.0;
+};
+
+// Текущие агрегаты группы по последним показаниям участников
+struct GroupAggregate {
+    size_t members = 0;
+    size_t reporting = 0;     // участники со свежими показаниями
+    double temperatureMean = 0.0;
+    double temperatureMin = 0.0;
+    double temperatureMax = 0.0;
+    double humidityMean = 0.0;
+    double humidityMin = 0.0;
+    double humidityMax = 0.0;
+    int64_t updatedAtUs = 0;
+
+    // 0 для неизвестной метрики или агрегата
+    double value(const std::string& metricType,
+                 const std::string& aggregate) const {
+        bool temperature = metricType == "temperature";
+        if (aggregate == "min") {
+            return temperature ? temperatureMin : humidityMin;
+        }
+        if (aggregate == "max") {
+            return temperature ? temperatureMax : humidityMax;
+        }
+        if (aggregate == "mean") {
+            return temperature ? temperatureMean : humidityMean;
+        }
+        return 0.0;
+    }
+};
+
+// Правило на языке выражений (таблица rule_definitions)
+struct RuleDefinition {
+    std::string name;
+    std::string expression;   // "temperature > 28 && humidity > 60 for 5m"
+    int priority = 0;
+    bool enabled = true;
+    // Область действия: устройство или группа; обе пустые - все
+    std::string deviceId;
+    int groupId = 0;
+
+    bool operator==(const RuleDefinition& other) const {
+        return name == other.name && expression == other.expression &&
+               priority == other.priority && enabled == other.enabled &&
+               deviceId == other.deviceId && groupId == other.groupId;
+    }
+};
+
 struct Device {
     std::string id;
     std::string name;
@@ -0,0 +1,273 @@
+#include "AlertDeduplicator.h"
+
+#include <algorithm>
+
+namespace iot_core::services {
+
+namespace {
+
+// Разрешение колеса таймеров: cooldown задается в секундах
+constexpr int64_t kTickMs = 1000;
+// Доля заполнения (с учетом удаленных слотов), после которой шард растет
+constexpr size_t kMaxLoadPercent = 70;
+
+uint64_t tickFor(int64_t timeMs) {
+  // Округление вверх: срабатывание не раньше срока
+  return static_cast<uint64_t>((std::max<int64_t>(timeMs, 0) + kTickMs - 1) /
+                               kTickMs);
+}
+
+size_t roundUpPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+AlertKind alertKindFromString(const std::string& alertType) {
+  if (alertType == "temp_high") return AlertKind::TemperatureHigh;
+  if (alertType == "temp_low") return AlertKind::TemperatureLow;
+  if (alertType == "hum_high") return AlertKind::HumidityHigh;
+  if (alertType == "hum_low") return AlertKind::HumidityLow;
+  if (alertType == "offline") return AlertKind::Offline;
+  if (alertType == "anomaly") return AlertKind::Anomaly;
+  return AlertKind::Other;
+}
+
+const char* alertKindToString(AlertKind kind) {
+  switch (kind) {
+    case AlertKind::TemperatureHigh:
+      return "temp_high";
+    case AlertKind::TemperatureLow:
+      return "temp_low";
+    case AlertKind::HumidityHigh:
+      return "hum_high";
+    case AlertKind::HumidityLow:
+      return "hum_low";
+    case AlertKind::Offline:
+      return "offline";
+    case AlertKind::Anomaly:
+      return "anomaly";
+    case AlertKind::Other:
+      break;
+  }
+  return "other";
+}
+
+AlertDeduplicator::AlertDeduplicator(Options options,
+                                     std::shared_ptr<DeviceRegistry> devices)
+    : options_(std::move(options)), devices_(std::move(devices)) {
+  size_t shardCount = roundUpPowerOfTwo(std::max<size_t>(1, options_.shards));
+  size_t capacity =
+      roundUpPowerOfTwo(std::max<size_t>(8, options_.initialCapacity));
+
+  shards_.reserve(shardCount);
+  for (size_t i = 0; i < shardCount; ++i) {
+    auto shard = std::make_unique<Shard>();
+    shard->slots.resize(capacity);
+    shards_.push_back(std::move(shard));
+  }
+}
+
+int64_t AlertDeduplicator::toMillis(Clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+uint64_t AlertDeduplicator::hashKey(const Key& key) {
+  // Перемешивание splitmix64 по обоим словам
+  uint64_t x = key.user * 0x9E3779B97F4A7C15ull ^ key.deviceAndKind;
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return x;
+}
+
+AlertDeduplicator::Key AlertDeduplicator::makeKey(long userId,
+                                                  uint32_t deviceIndex,
+                                                  AlertKind kind) const {
+  return Key{static_cast<uint64_t>(userId),
+             static_cast<uint64_t>(deviceIndex) << 8 |
+                 static_cast<uint64_t>(kind)};
+}
+
+AlertDeduplicator::Shard& AlertDeduplicator::shardFor(uint64_t hash) {
+  // Старшие биты - на выбор шарда, младшие - на слот внутри шарда
+  return *shards_[(hash >> 48) & (shards_.size() - 1)];
+}
+
+bool AlertDeduplicator::tryAcquire(long userId, const std::string& deviceId,
+                                   AlertKind kind, Clock::time_point now) {
+  Key key = makeKey(userId, devices_->intern(deviceId), kind);
+  uint64_t hash = hashKey(key);
+  int64_t nowMs = toMillis(now);
+
+  Shard& shard = shardFor(hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  expireLocked(shard, nowMs);
+
+  Slot* slot = findLocked(shard, key, hash);
+  if (slot && slot->expiresAtMs > nowMs) {
+    ++shard.suppressed;
+    return false;
+  }
+
+  int64_t expiresAtMs =
+      nowMs + std::chrono::duration_cast<std::chrono::milliseconds>(
+                  options_.cooldown)
+                  .count();
+  if (slot) {
+    // Запись истекла, но колесо до нее еще не дошло
+    slot->expiresAtMs = expiresAtMs;
+  } else {
+    insertLocked(shard, key, hash, expiresAtMs);
+  }
+  shard.wheel.schedule(tickFor(expiresAtMs), key);
+  return true;
+}
+
+void AlertDeduplicator::restore(const Entry& entry, Clock::time_point now) {
+  int64_t nowMs = toMillis(now);
+  int64_t expiresAtMs = toMillis(entry.expiresAt);
+  if (expiresAtMs <= nowMs) {
+    return;
+  }
+
+  Key key = makeKey(entry.userId, devices_->intern(entry.deviceId), entry.kind);
+  uint64_t hash = hashKey(key);
+
+  Shard& shard = shardFor(hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  expireLocked(shard, nowMs);
+
+  Slot* slot = findLocked(shard, key, hash);
+  if (slot) {
+    slot->expiresAtMs = std::max(slot->expiresAtMs, expiresAtMs);
+  } else {
+    insertLocked(shard, key, hash, expiresAtMs);
+  }
+  shard.wheel.schedule(tickFor(expiresAtMs), key);
+}
+
+std::vector<AlertDeduplicator::Entry> AlertDeduplicator::entries(
+    Clock::time_point now) const {
+  int64_t nowMs = toMillis(now);
+  std::vector<Entry> result;
+
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (const auto& slot : shard->slots) {
+      if (slot.state != SlotState::Full || slot.expiresAtMs <= nowMs) {
+        continue;
+      }
+      Entry entry;
+      entry.userId = static_cast<long>(slot.key.user);
+      entry.deviceId =
+          devices_->name(static_cast<uint32_t>(slot.key.deviceAndKind >> 8));
+      entry.kind = static_cast<AlertKind>(slot.key.deviceAndKind & 0xFF);
+      entry.expiresAt =
+          Clock::time_point(std::chrono::milliseconds(slot.expiresAtMs));
+      result.push_back(std::move(entry));
+    }
+  }
+
+  return result;
+}
+
+AlertDeduplicator::Statistics AlertDeduplicator::getStatistics() const {
+  Statistics stats;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->size;
+    stats.suppressed += shard->suppressed;
+    stats.expired += shard->expired;
+  }
+  return stats;
+}
+
+void AlertDeduplicator::expireLocked(Shard& shard, int64_t nowMs) {
+  auto onExpired = [&](const Key& key) {
+    Slot* slot = findLocked(shard, key, hashKey(key));
+    // Запись могла быть продлена после постановки таймера
+    if (slot && slot->expiresAtMs <= nowMs) {
+      slot->state = SlotState::Deleted;
+      --shard.size;
+      ++shard.expired;
+    }
+  };
+
+  // Колесо срабатывает по целым тикам: запись, чей срок еще в пределах
+  // текущего тика, будет удалена при следующем продвижении
+  uint64_t tick = static_cast<uint64_t>(std::max<int64_t>(nowMs, 0)) / kTickMs;
+  shard.wheel.advance(tick, onExpired);
+}
+
+AlertDeduplicator::Slot* AlertDeduplicator::findLocked(Shard& shard,
+                                                       const Key& key,
+                                                       uint64_t hash) {
+  size_t mask = shard.slots.size() - 1;
+  for (size_t i = hash & mask, probes = 0; probes < shard.slots.size();
+       i = (i + 1) & mask, ++probes) {
+    Slot& slot = shard.slots[i];
+    if (slot.state == SlotState::Empty) {
+      return nullptr;
+    }
+    if (slot.state == SlotState::Full && slot.key == key) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void AlertDeduplicator::insertLocked(Shard& shard, const Key& key,
+                                     uint64_t hash, int64_t expiresAtMs) {
+  if ((shard.used + 1) * 100 > shard.slots.size() * kMaxLoadPercent) {
+    // Много удаленных слотов - чистим на месте, иначе растем
+    size_t capacity = shard.slots.size();
+    if ((shard.size + 1) * 100 > capacity * kMaxLoadPercent / 2) {
+      capacity *= 2;
+    }
+    rehashLocked(shard, capacity);
+  }
+
+  size_t mask = shard.slots.size() - 1;
+  size_t i = hash & mask;
+  while (shard.slots[i].state == SlotState::Full) {
+    i = (i + 1) & mask;
+  }
+
+  Slot& slot = shard.slots[i];
+  if (slot.state == SlotState::Empty) {
+    ++shard.used;
+  }
+  slot.key = key;
+  slot.expiresAtMs = expiresAtMs;
+  slot.state = SlotState::Full;
+  ++shard.size;
+}
+
+void AlertDeduplicator::rehashLocked(Shard& shard, size_t capacity) {
+  std::vector<Slot> old(capacity);
+  old.swap(shard.slots);
+
+  size_t mask = capacity - 1;
+  for (const auto& slot : old) {
+    if (slot.state != SlotState::Full) {
+      continue;
+    }
+    size_t i = hashKey(slot.key) & mask;
+    while (shard.slots[i].state != SlotState::Empty) {
+      i = (i + 1) & mask;
+    }
+    shard.slots[i] = slot;
+  }
+  shard.used = shard.size;
+}
+
+}  // namespace iot_core::services
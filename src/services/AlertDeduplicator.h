@@ -0,0 +1,130 @@
+// src/services/AlertDeduplicator.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../utils/TimingWheel.h"
+#include "DeviceRegistry.h"
+
+namespace iot_core::services {
+
+// Тип оповещения (бывшие строковые метки "temp_high" и т.п.)
+enum class AlertKind : uint8_t {
+  TemperatureHigh = 0,
+  TemperatureLow = 1,
+  HumidityHigh = 2,
+  HumidityLow = 3,
+  Offline = 4,  // устройство перестало присылать данные
+  Anomaly = 5,  // показание резко отличается от обычных для устройства
+  Other = 255,
+};
+
+AlertKind alertKindFromString(const std::string& alertType);
+const char* alertKindToString(AlertKind kind);
+
+/**
+ * @brief Подавление повторных оповещений на время cooldown
+ *
+ * Ключ (userId, индекс устройства, тип) упакован в два 64-битных слова и
+ * хранится в шардированной хеш-таблице с открытой адресацией; шард
+ * выбирается по хешу ключа, у каждого шарда своя блокировка. Истечение
+ * записей ведет иерархическое колесо таймеров шарда, поэтому проверка и
+ * очистка стоят O(1) амортизированно вместо обхода всего кэша.
+ */
+class AlertDeduplicator {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  struct Options {
+    std::chrono::seconds cooldown{300};
+    size_t shards = 16;
+    size_t initialCapacity = 64;  // слотов на шард, степень двойки
+  };
+
+  struct Statistics {
+    size_t entries = 0;
+    uint64_t suppressed = 0;
+    uint64_t expired = 0;
+  };
+
+  // Запись для снимка состояния
+  struct Entry {
+    long userId = 0;
+    std::string deviceId;
+    AlertKind kind = AlertKind::Other;
+    Clock::time_point expiresAt;
+  };
+
+  explicit AlertDeduplicator(Options options,
+                             std::shared_ptr<DeviceRegistry> devices =
+                                 std::make_shared<DeviceRegistry>());
+
+  AlertDeduplicator(const AlertDeduplicator&) = delete;
+  AlertDeduplicator& operator=(const AlertDeduplicator&) = delete;
+
+  // true - оповещение можно отправить (и оно запоминается на cooldown);
+  // false - такое же оповещение уже было недавно
+  bool tryAcquire(long userId, const std::string& deviceId, AlertKind kind,
+                  Clock::time_point now = Clock::now());
+
+  // Восстановление записи со сроком; истекшие игнорируются
+  void restore(const Entry& entry, Clock::time_point now = Clock::now());
+
+  // Все действующие записи (для снимка)
+  std::vector<Entry> entries(Clock::time_point now = Clock::now()) const;
+
+  std::chrono::seconds cooldown() const { return options_.cooldown; }
+  Statistics getStatistics() const;
+
+ private:
+  struct Key {
+    uint64_t user;
+    uint64_t deviceAndKind;  // индекс устройства << 8 | тип
+
+    bool operator==(const Key& other) const {
+      return user == other.user && deviceAndKind == other.deviceAndKind;
+    }
+  };
+
+  enum class SlotState : uint8_t { Empty, Full, Deleted };
+
+  struct Slot {
+    Key key{};
+    int64_t expiresAtMs = 0;
+    SlotState state = SlotState::Empty;
+  };
+
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::vector<Slot> slots;
+    size_t size = 0;
+    size_t used = 0;  // заполненные + удаленные
+    utils::TimingWheel<Key> wheel;
+    uint64_t suppressed = 0;
+    uint64_t expired = 0;
+  };
+
+  static uint64_t hashKey(const Key& key);
+  static int64_t toMillis(Clock::time_point time);
+
+  Key makeKey(long userId, uint32_t deviceIndex, AlertKind kind) const;
+  Shard& shardFor(uint64_t hash);
+
+  // Вызывать под mutex шарда
+  void expireLocked(Shard& shard, int64_t nowMs);
+  Slot* findLocked(Shard& shard, const Key& key, uint64_t hash);
+  void insertLocked(Shard& shard, const Key& key, uint64_t hash,
+                    int64_t expiresAtMs);
+  void rehashLocked(Shard& shard, size_t capacity);
+
+  Options options_;
+  std::shared_ptr<DeviceRegistry> devices_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace iot_core::services
@@ -0,0 +1,159 @@
+#include "AlertRateLimiter.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace iot_core::services {
+
+namespace {
+
+constexpr double kSecondsPerHour = 3600.0;
+// Размер шарда, после которого из него убираются полные корзины
+constexpr size_t kPruneThreshold = 4096;
+
+}  // namespace
+
+AlertRateLimiter::AlertRateLimiter(Options options)
+    : options_(std::move(options)) {
+  size_t shards = std::max<size_t>(1, options_.shards);
+  for (size_t i = 0; i < shards; ++i) {
+    chatShards_.push_back(std::make_unique<Shard<long>>());
+    deviceShards_.push_back(std::make_unique<Shard<std::string>>());
+  }
+  if (options_.maxPerHourGlobal > 0) {
+    globalIntervalTicks_ =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::hours(1))
+            .count() /
+        options_.maxPerHourGlobal;
+  }
+}
+
+void AlertRateLimiter::refill(Bucket& bucket, double capacity,
+                              Clock::time_point now, bool created) {
+  if (created) {
+    bucket.tokens = capacity;
+    bucket.updatedAt = now;
+    return;
+  }
+
+  double elapsed =
+      std::chrono::duration<double>(now - bucket.updatedAt).count();
+  if (elapsed > 0) {
+    double refilled = elapsed * capacity / kSecondsPerHour;
+    bucket.tokens = std::min(capacity, bucket.tokens + refilled);
+    bucket.updatedAt = now;
+  }
+}
+
+bool AlertRateLimiter::tryTakeGlobal(Clock::time_point now) {
+  int64_t nowTicks = now.time_since_epoch().count();
+  int64_t burstTicks =
+      std::chrono::duration_cast<Clock::duration>(std::chrono::hours(1))
+          .count();
+
+  int64_t fullAt = globalFullAt_.load(std::memory_order_relaxed);
+  while (true) {
+    // Полная корзина "полна" с любого момента в прошлом
+    int64_t next = std::max(fullAt, nowTicks) + globalIntervalTicks_;
+    if (next - nowTicks > burstTicks) {
+      return false;
+    }
+    if (globalFullAt_.compare_exchange_weak(fullAt, next,
+                                            std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+template <typename Key>
+void AlertRateLimiter::pruneLocked(Shard<Key>& shard, double capacity,
+                                   Clock::time_point now) {
+  // Полная корзина без подавленных ничем не отличается от новой
+  for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+    refill(it->second, capacity, now, false);
+    if (it->second.tokens >= capacity && it->second.suppressed == 0) {
+      it = shard.buckets.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+AlertRateLimiter::Decision AlertRateLimiter::tryAcquire(
+    long chatId, const std::string& deviceId, Clock::time_point now) {
+  double chatCapacity = options_.maxPerHourPerChat;
+  double deviceCapacity = options_.maxPerHourPerDevice;
+
+  auto& chatShard =
+      *chatShards_[std::hash<long>{}(chatId) % chatShards_.size()];
+  auto& deviceShard =
+      *deviceShards_[std::hash<std::string>{}(deviceId) %
+                     deviceShards_.size()];
+
+  std::lock_guard<std::mutex> chatLock(chatShard.mutex);
+  std::lock_guard<std::mutex> deviceLock(deviceShard.mutex);
+
+  Bucket* chat = nullptr;
+  if (chatCapacity > 0) {
+    auto [it, created] = chatShard.buckets.try_emplace(chatId);
+    chat = &it->second;
+    refill(*chat, chatCapacity, now, created);
+  }
+
+  Bucket* device = nullptr;
+  if (deviceCapacity > 0) {
+    auto [it, created] = deviceShard.buckets.try_emplace(deviceId);
+    device = &it->second;
+    refill(*device, deviceCapacity, now, created);
+  }
+
+  // Общий токен берется последним: он нужен, только если пропускают
+  // корзины чата и устройства, и возвращать его не приходится
+  Decision decision;
+  if (chat && chat->tokens < 1.0) {
+    suppressedByChat_.fetch_add(1, std::memory_order_relaxed);
+  } else if (device && device->tokens < 1.0) {
+    suppressedByDevice_.fetch_add(1, std::memory_order_relaxed);
+  } else if (globalIntervalTicks_ > 0 && !tryTakeGlobal(now)) {
+    suppressedGlobal_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    decision.allowed = true;
+  }
+
+  if (!decision.allowed) {
+    if (chat) {
+      ++chat->suppressed;
+    }
+    return decision;
+  }
+
+  allowed_.fetch_add(1, std::memory_order_relaxed);
+  if (chat) {
+    chat->tokens -= 1.0;
+    decision.suppressedBefore = chat->suppressed;
+    chat->suppressed = 0;
+  }
+  if (device) {
+    device->tokens -= 1.0;
+  }
+
+  if (chatShard.buckets.size() > kPruneThreshold) {
+    pruneLocked(chatShard, chatCapacity, now);
+  }
+  if (deviceShard.buckets.size() > kPruneThreshold) {
+    pruneLocked(deviceShard, deviceCapacity, now);
+  }
+  return decision;
+}
+
+AlertRateLimiter::Statistics AlertRateLimiter::getStatistics() const {
+  Statistics stats;
+  stats.allowed = allowed_.load(std::memory_order_relaxed);
+  stats.suppressedByChat = suppressedByChat_.load(std::memory_order_relaxed);
+  stats.suppressedByDevice =
+      suppressedByDevice_.load(std::memory_order_relaxed);
+  stats.suppressedGlobal = suppressedGlobal_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace iot_core::services
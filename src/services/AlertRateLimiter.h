@@ -0,0 +1,102 @@
+// src/services/AlertRateLimiter.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace iot_core::services {
+
+/**
+ * @brief Ограничение частоты оповещений корзинами токенов
+ *
+ * Три уровня: чат получателя (maxAlertsPerHour), устройство и весь
+ * сервис. Корзина вмещает часовой лимит и пополняется равномерно, так что
+ * короткий всплеск проходит, а устойчивый поток режется до лимита.
+ * Оповещение проходит, только если токен есть во всех трех корзинах.
+ *
+ * Корзины чатов и устройств разложены по шардам со своими блокировками;
+ * блокировки берутся всегда в порядке чат -> устройство. Корзину всего
+ * сервиса задевает каждое оповещение, поэтому она обходится без
+ * блокировки: токен из нее берется CAS (см. tryTakeGlobal).
+ * Подавленные для чата оповещения считаются и отдаются со следующим
+ * пропущенным, чтобы получатель знал о пропуске.
+ */
+class AlertRateLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // 0 - без ограничения на этом уровне
+  struct Options {
+    int maxPerHourPerChat = 60;
+    int maxPerHourPerDevice = 120;
+    int maxPerHourGlobal = 1000;
+    size_t shards = 16;
+  };
+
+  struct Decision {
+    bool allowed = false;
+    // Сколько оповещений этого чата было подавлено до разрешенного
+    uint32_t suppressedBefore = 0;
+  };
+
+  struct Statistics {
+    uint64_t allowed = 0;
+    uint64_t suppressedByChat = 0;
+    uint64_t suppressedByDevice = 0;
+    uint64_t suppressedGlobal = 0;
+  };
+
+  explicit AlertRateLimiter(Options options);
+
+  AlertRateLimiter(const AlertRateLimiter&) = delete;
+  AlertRateLimiter& operator=(const AlertRateLimiter&) = delete;
+
+  Decision tryAcquire(long chatId, const std::string& deviceId,
+                      Clock::time_point now = Clock::now());
+
+  Statistics getStatistics() const;
+
+ private:
+  struct Bucket {
+    double tokens = 0.0;
+    Clock::time_point updatedAt;
+    uint32_t suppressed = 0;
+  };
+
+  template <typename Key>
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::unordered_map<Key, Bucket> buckets;
+  };
+
+  // Пополняет корзину к моменту now; новая корзина создается полной
+  static void refill(Bucket& bucket, double capacity, Clock::time_point now,
+                     bool created);
+  // Токен общей корзины; false - корзина пуста
+  bool tryTakeGlobal(Clock::time_point now);
+  template <typename Key>
+  static void pruneLocked(Shard<Key>& shard, double capacity,
+                          Clock::time_point now);
+
+  Options options_;
+  std::vector<std::unique_ptr<Shard<long>>> chatShards_;
+  std::vector<std::unique_ptr<Shard<std::string>>> deviceShards_;
+
+  // Общая корзина в виде GCRA: момент (тики Clock), к которому корзина
+  // снова станет полной. Токен - сдвиг этого момента на интервал
+  // пополнения, пока он не ушел дальше часа вперед
+  std::atomic<int64_t> globalFullAt_{0};
+  int64_t globalIntervalTicks_ = 0;
+
+  std::atomic<uint64_t> allowed_{0};
+  std::atomic<uint64_t> suppressedByChat_{0};
+  std::atomic<uint64_t> suppressedByDevice_{0};
+  std::atomic<uint64_t> suppressedGlobal_{0};
+};
+
+}  // namespace iot_core::services
@@ -2,18 +2,163 @@
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <mutex>
+#include <thread>
 
+#include "../storage/StateSnapshot.h"
 #include "../utils/Formatter.h"
 
 namespace iot_core::services {
 
+namespace {
+
+// Опрос забирает записи начиная с последнего проверенного показания
+// включительно: срез перекрывается с предыдущим, и окно недавних
+// показаний остается непрерывным. Больше kRemotePollWindow записей за
+// опрос не берется - тогда окно начинается заново с нового среза.
+// Для проверки порогов используется только самая свежая.
+constexpr int kRemotePollWindow = 64;
+
+constexpr uint32_t kDedupSection = storage::snapshotTag('D', 'D', 'U', 'P');
+constexpr uint32_t kReadingsSection = storage::snapshotTag('L', 'A', 'S', 'T');
+// Состояния правил; HYST - прежний формат без признака оповещения
+constexpr uint32_t kStatesSection = storage::snapshotTag('H', 'Y', 'S', '2');
+constexpr uint32_t kLegacyStatesSection =
+    storage::snapshotTag('H', 'Y', 'S', 'T');
+
+constexpr size_t kMaxWorkerShards = 8;
+
+// Правило группы: "group:<id>:<метрика>:<агрегат>"; шард выбирается по
+// "group:<id>", общему для всех правил группы
+const std::string kGroupKeyPrefix = "group:";
+
+std::string groupShardKey(int groupId) {
+  return kGroupKeyPrefix + std::to_string(groupId);
+}
+
+bool isGroupKey(const std::string& key) {
+  return key.compare(0, kGroupKeyPrefix.size(), kGroupKeyPrefix) == 0;
+}
+
+constexpr AlertKind kUserAlertKinds[] = {
+    AlertKind::TemperatureHigh, AlertKind::TemperatureLow,
+    AlertKind::HumidityHigh, AlertKind::HumidityLow};
+
+int64_t toMicros(std::chrono::system_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+// Ожидание завершения группы задач, разложенных по шардам
+class Countdown {
+ public:
+  explicit Countdown(size_t count) : count_(count) {}
+
+  void done() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ > 0 && --count_ == 0) {
+      cv_.notify_all();
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return count_ == 0; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t count_;
+};
+
+}  // namespace
+
 AlertProcessingService::AlertProcessingService(
     std::shared_ptr<core::DatabaseRepository> database,
-    std::shared_ptr<core::NotificationService> notifier)
-    : database_(std::move(database)), notifier_(std::move(notifier)) {
-  std::cout << "🔔 Alert Service initialized" << std::endl;
+    std::shared_ptr<core::NotificationService> notifier,
+    std::chrono::seconds cooldown, size_t workerShards,
+    AlertStateTracker::Options hysteresis,
+    AlertRateLimiter::Options rateLimits)
+    : database_(std::move(database)),
+      notifier_(std::move(notifier)),
+      devices_(std::make_shared<DeviceRegistry>()),
+      groupKeys_(std::make_shared<DeviceRegistry>()),
+      cooldown_(cooldown) {
+  if (workerShards == 0) {
+    workerShards = std::clamp<size_t>(std::thread::hardware_concurrency(), 1,
+                                      kMaxWorkerShards);
+  }
+
+  // Устройство принадлежит одному шарду - внутреннее шардирование
+  // таблицы подавления повторов не нужно
+  AlertDeduplicator::Options dedupOptions;
+  dedupOptions.cooldown = cooldown;
+  dedupOptions.shards = 1;
+  for (size_t i = 0; i < workerShards; ++i) {
+    shards_.push_back(std::make_unique<ShardState>(dedupOptions, hysteresis,
+                                                   devices_, groupKeys_));
+  }
+  rateLimiter_ = std::make_unique<AlertRateLimiter>(rateLimits);
+
+  thresholds_ = std::make_shared<ThresholdIndex>(
+      [database = database_](
+          const std::string& deviceId,
+          std::vector<std::pair<long, models::UserAlert>>& subscribers) {
+        return database->getDeviceSubscriberAlerts(deviceId, subscribers);
+      });
+  if (database_) {
+    std::weak_ptr<ThresholdIndex> index = thresholds_;
+    database_->onAlertChanged(
+        [index](long chatId, const models::UserAlert& alert) {
+          if (auto thresholds = index.lock()) {
+            thresholds->onAlertChanged(chatId, alert);
+          }
+        });
+    database_->onSubscriptionChanged(
+        [index](long chatId, const std::string& deviceId) {
+          if (auto thresholds = index.lock()) {
+            thresholds->onSubscriptionChanged(chatId, deviceId);
+          }
+        });
+  }
+
+  groups_ = std::make_shared<GroupAggregator>(
+      [database = database_](std::vector<models::DeviceGroup>& groups,
+                             std::vector<models::GroupAlertRule>& rules) {
+        return database && database->loadDeviceGroups(groups, rules);
+      });
+  if (database_) {
+    std::weak_ptr<GroupAggregator> aggregator = groups_;
+    database_->onDeviceGroupsChanged([aggregator]() {
+      if (auto groups = aggregator.lock()) {
+        groups->invalidate();
+      }
+    });
+  }
+
+  executor_ = std::make_unique<ShardedExecutor>(workerShards);
+
+  std::cout << "🔔 Alert Service initialized (" << workerShards << " shards)"
+            << std::endl;
+}
+
+AlertProcessingService::~AlertProcessingService() { stop(); }
+
+AlertProcessingService::ShardState& AlertProcessingService::stateFor(
+    const std::string& deviceId) const {
+  return *shards_[executor_->shardFor(deviceId)];
+}
+
+AlertProcessingService::ShardState& AlertProcessingService::groupStateFor(
+    const std::string& key) const {
+  return *shards_[executor_->shardFor(
+      key.substr(0, key.find(':', kGroupKeyPrefix.size())))];
 }
 
 void AlertProcessingService::processTelemetryData(const std::string& deviceId,
@@ -21,18 +166,165 @@ void AlertProcessingService::processTelemetryData(const std::string& deviceId,
                                                   double humidity) {
   // Этот метод ОСТАВЛЯЕМ для обратной совместимости
   // Но теперь он НЕ сохраняет данные в локальную БД
+  processTelemetryData(deviceId, temperature, humidity,
+                       toMicros(std::chrono::system_clock::now()));
+}
 
-  std::cout << "📊 Processing data for " << deviceId << " (T=" << temperature
-            << ", H=" << humidity << ")" << std::endl;
+void AlertProcessingService::processTelemetryData(const std::string& deviceId,
+                                                  double temperature,
+                                                  double humidity,
+                                                  int64_t timestampUs) {
+  bool queued = executor_->submit(
+      executor_->shardFor(deviceId),
+      [this, deviceId, temperature, humidity, timestampUs]() {
+        evaluateReading(deviceId, temperature, humidity, timestampUs);
+      });
+
+  // Шарды уже остановлены (завершение работы) - проверяем на месте
+  if (!queued) {
+    evaluateReading(deviceId, temperature, humidity, timestampUs);
+  }
+}
+
+void AlertProcessingService::processDeviceStatus(const std::string& deviceId,
+                                                 bool online,
+                                                 int64_t lastSeenUs,
+                                                 int64_t timestampUs) {
+  bool queued = executor_->submit(
+      executor_->shardFor(deviceId),
+      [this, deviceId, online, lastSeenUs, timestampUs]() {
+        notifyDeviceStatus(deviceId, online, lastSeenUs, timestampUs);
+      });
+
+  if (!queued) {
+    notifyDeviceStatus(deviceId, online, lastSeenUs, timestampUs);
+  }
+}
+
+void AlertProcessingService::recordContact(const std::string& deviceId,
+                                           int64_t timestampUs) {
+  if (!heartbeats_) {
+    return;
+  }
+
+  // Уже в шарде устройства: оповещение идет по порядку с показаниями
+  HeartbeatMonitor::Event event;
+  if (heartbeats_->heartbeat(deviceId, timestampUs, event)) {
+    std::cout << "📶 Device back online: " << deviceId << std::endl;
+    notifyDeviceStatus(deviceId, true, event.lastSeenUs, event.timestampUs);
+  }
+}
 
-  // Получаем всех подписчиков устройства
+void AlertProcessingService::notifyDeviceStatus(const std::string& deviceId,
+                                                bool online,
+                                                int64_t lastSeenUs,
+                                                int64_t timestampUs) {
   auto subscribers = database_->getDeviceSubscribers(deviceId);
+  double silentSeconds =
+      static_cast<double>(timestampUs - lastSeenUs) / 1000000.0;
 
-  // Проверяем для каждого подписчика
   for (long userId : subscribers) {
-    checkUserAlerts(userId, deviceId, temperature, humidity);
+    // "Снова в сети" - как восстановление, без лимита частоты
+    uint32_t suppressedBefore = 0;
+    if (!online) {
+      auto decision = rateLimiter_->tryAcquire(userId, deviceId);
+      if (!decision.allowed) {
+        std::cout << "🔕 Rate limit: offline alert for user " << userId
+                  << " on " << deviceId << " suppressed" << std::endl;
+        continue;
+      }
+      suppressedBefore = decision.suppressedBefore;
+    }
+
+    if (sharedOutbox_) {
+      models::AlertEvent alert{deviceId,
+                               silentSeconds,
+                               "connectivity",
+                               online ? "online" : "offline",
+                               timestampUs,
+                               online,
+                               suppressedBefore};
+      publishShared(userId, deviceId, AlertKind::Offline, std::move(alert));
+    } else {
+      notifier_->sendDeviceStatusAlert(userId, deviceId, online,
+                                       silentSeconds, suppressedBefore);
+    }
   }
 
+  if (online) {
+    statistics_.onlineAlerts++;
+  } else {
+    statistics_.offlineAlerts++;
+  }
+}
+
+void AlertProcessingService::processAnomaly(const std::string& deviceId,
+                                            const std::string& metricType,
+                                            double value,
+                                            int64_t timestampUs) {
+  bool queued = executor_->submit(
+      executor_->shardFor(deviceId),
+      [this, deviceId, metricType, value, timestampUs]() {
+        notifyAnomaly(deviceId, metricType, value, timestampUs);
+      });
+
+  if (!queued) {
+    notifyAnomaly(deviceId, metricType, value, timestampUs);
+  }
+}
+
+void AlertProcessingService::notifyAnomaly(const std::string& deviceId,
+                                           const std::string& metricType,
+                                           double value,
+                                           int64_t timestampUs) {
+  auto& state = stateFor(deviceId);
+  auto subscribers = database_->getDeviceSubscribers(deviceId);
+
+  for (long userId : subscribers) {
+    // Серия аномальных показаний - одно оповещение за cooldown
+    if (!state.deduplicator.tryAcquire(userId, deviceId,
+                                       AlertKind::Anomaly)) {
+      continue;
+    }
+
+    auto decision = rateLimiter_->tryAcquire(userId, deviceId);
+    if (!decision.allowed) {
+      std::cout << "🔕 Rate limit: anomaly alert for user " << userId
+                << " on " << deviceId << " suppressed" << std::endl;
+      continue;
+    }
+
+    if (sharedOutbox_) {
+      models::AlertEvent alert{deviceId,
+                               value,
+                               metricType,
+                               "anomaly",
+                               timestampUs,
+                               false,
+                               decision.suppressedBefore};
+      publishShared(userId, deviceId, AlertKind::Anomaly, std::move(alert));
+    } else {
+      notifier_->sendAnomalyAlert(userId, deviceId, value, metricType,
+                                  decision.suppressedBefore);
+    }
+    statistics_.anomalyAlerts++;
+  }
+}
+
+void AlertProcessingService::evaluateReading(const std::string& deviceId,
+                                             double temperature,
+                                             double humidity,
+                                             int64_t timestampUs) {
+  std::cout << "📊 Processing data for " << deviceId << " (T=" << temperature
+            << ", H=" << humidity << ")" << std::endl;
+
+  rememberReading(deviceId, temperature, humidity, timestampUs);
+  recordContact(deviceId, timestampUs);
+
+  // Сработавшие правила подписчиков устройства
+  checkDeviceAlerts(deviceId, temperature, humidity, timestampUs);
+  checkGroupAlerts(deviceId, temperature, humidity, timestampUs);
+
   // Также проверяем общие правила
   checkGlobalAlerts(deviceId, temperature, humidity);
 }
@@ -56,47 +348,76 @@ void AlertProcessingService::checkAllSubscribedDevices() {
   std::cout << "🔍 Проверка " << devices.size()
             << " устройств из удаленной БД..." << std::endl;
 
+  // Каждое устройство проверяется в своем шарде - по порядку с
+  // показаниями, пришедшими другими путями
+  Countdown pending(devices.size());
   for (const auto& deviceId : devices) {
-    try {
-      // Получаем последние данные из удаленной БД
-      auto telemetryData = database_->getRemoteTelemetry(deviceId, 1);
+    auto task = [this, deviceId, &pending]() {
+      checkRemoteDevice(deviceId);
+      pending.done();
+    };
+    if (!executor_->submit(executor_->shardFor(deviceId), task)) {
+      task();
+    }
+  }
+  pending.wait();
+}
 
-      if (telemetryData.empty()) {
-        std::cout << "   📭 Нет данных для устройства " << deviceId
-                  << std::endl;
-        continue;
-      }
+void AlertProcessingService::checkRemoteDevice(const std::string& deviceId) {
+  try {
+    // Получаем из удаленной БД только новые данные; при первом опросе -
+    // одну последнюю запись
+    LatestReading latest;
+    auto telemetryData =
+        getLatestReading(deviceId, latest) && latest.timestampUs != 0
+            ? database_->getRemoteTelemetry(deviceId, kRemotePollWindow,
+                                            latest.timestampUs)
+            : database_->getRemoteTelemetry(deviceId, 1);
+
+    if (telemetryData.empty()) {
+      std::cout << "   📭 Нет данных для устройства " << deviceId << std::endl;
+      return;
+    }
 
-      const auto& data = telemetryData[0];
+    const auto& data = telemetryData[0];
 
-      // Логируем полученные данные
-      std::cout << "   📊 Устройство " << deviceId << ": "
-                << "T=" << std::fixed << std::setprecision(1)
-                << data.temperature << "°C, "
-                << "H=" << data.humidity << "%, "
-                << "время: " << data.timestamp << std::endl;
+    // Это показание уже проверено (в том числе до перезапуска)
+    int64_t timestampUs = data.timestampUs;
+    if (timestampUs == 0) {
+      timestampUs = toMicros(std::chrono::system_clock::now());
+    } else if (!rememberReading(deviceId, data.temperature, data.humidity,
+                                timestampUs)) {
+      return;
+    }
+    // Новая строка в удаленной БД - контакт в момент показания
+    recordContact(deviceId, timestampUs);
+
+    // Логируем полученные данные
+    std::cout << "   📊 Устройство " << deviceId << ": "
+              << "T=" << std::fixed << std::setprecision(1) << data.temperature
+              << "°C, "
+              << "H=" << data.humidity << "%, "
+              << "время: " << utils::Formatter::formatTimestamp(timestampUs)
+              << std::endl;
 
-      // Получаем подписчиков устройства
-      auto subscribers = database_->getDeviceSubscribers(deviceId);
+    // Проверяем оповещения подписчиков устройства
+    checkDeviceAlerts(deviceId, data.temperature, data.humidity,
+                      timestampUs);
+    checkGroupAlerts(deviceId, data.temperature, data.humidity, timestampUs);
 
-      if (subscribers.empty()) {
-        std::cout << "   👤 Нет подписчиков для устройства " << deviceId
-                  << std::endl;
-        continue;
-      }
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка при проверке устройства " << deviceId << ": "
+              << e.what() << std::endl;
+  }
+}
 
-      std::cout << "   👥 Подписчиков: " << subscribers.size() << std::endl;
+void AlertProcessingService::drain() { executor_->drain(); }
 
-      // Проверяем оповещения для каждого подписчика
-      for (long userId : subscribers) {
-        checkUserAlerts(userId, deviceId, data.temperature, data.humidity);
-      }
+void AlertProcessingService::stop() { executor_->stop(); }
 
-    } catch (const std::exception& e) {
-      std::cerr << "❌ Ошибка при проверке устройства " << deviceId << ": "
-                << e.what() << std::endl;
-    }
-  }
+ShardedExecutor::Statistics AlertProcessingService::getExecutorStatistics()
+    const {
+  return executor_->getStatistics();
 }
 
 // НОВЫЙ МЕТОД: Получение всех устройств с подписчиками
@@ -104,70 +425,233 @@ std::vector<std::string> AlertProcessingService::getAllSubscribedDevices() {
   return database_->getAllSubscribedDevices();
 }
 
-void AlertProcessingService::checkUserAlerts(long userId,
-                                             const std::string& deviceId,
-                                             double temperature,
-                                             double humidity) {
-  // Получаем настройки пользователя
-  auto alert = database_->getUserAlert(userId);
-
-  if (!alert.hasAnyAlert()) {
-    return;  // Нет настроек
+bool AlertProcessingService::checkDeviceAlerts(const std::string& deviceId,
+                                               double temperature,
+                                               double humidity,
+                                               int64_t timestampUs) {
+  auto thresholds = thresholds_->get(deviceId);
+  if (!thresholds) {
+    // Без порогов нельзя отличить снятое правило от недоступной БД -
+    // состояние правил не трогаем
+    return false;
+  }
+  if (thresholds->subscribers() == 0) {
+    std::cout << "   👤 Нет подписчиков для устройства " << deviceId
+              << std::endl;
+    return true;
   }
 
-  // Проверяем температуру
-  if (alert.temperatureHighThreshold > 0 &&
-      temperature > alert.temperatureHighThreshold) {
-    if (shouldNotify(userId, deviceId, "temp_high", temperature)) {
-      std::cout << "🔥 Temperature alert for user " << userId << ": "
-                << temperature << " > " << alert.temperatureHighThreshold
-                << " (sending Telegram + Email)" << std::endl;
+  auto& state = stateFor(deviceId);
+  AlertSubject subject{deviceId, deviceId, state.deduplicator,
+                       state.alertStates};
+  for (AlertKind kind : kUserAlertKinds) {
+    double value = kind == AlertKind::TemperatureHigh ||
+                           kind == AlertKind::TemperatureLow
+                       ? temperature
+                       : humidity;
+
+    // Правила, за порог которых вышло значение: непрерывный участок
+    // отсортированного массива
+    thresholds->forEachTriggered(
+        kind, value, [&](long userId, double threshold) {
+          checkThreshold(subject, userId, kind, value, threshold,
+                         timestampUs);
+        });
+
+    // Активные правила, которые сейчас не сработали, идут к
+    // восстановлению; снятый порог (или отписка) сбрасывает тревогу
+    for (long userId : state.alertStates.activeUsers(deviceId, kind)) {
+      double threshold = thresholds->threshold(userId, kind);
+      if (ThresholdIndex::DeviceThresholds::exceeds(kind, value, threshold)) {
+        continue;
+      }
+      checkThreshold(subject, userId, kind, value, threshold, timestampUs);
+    }
+  }
+  return true;
+}
 
-      notifier_->sendTelegramAlert(userId, deviceId, temperature, "temperature",
-                                   "above");
+void AlertProcessingService::checkGroupAlerts(const std::string& deviceId,
+                                              double temperature,
+                                              double humidity,
+                                              int64_t timestampUs) {
+  groups_->update(
+      deviceId, temperature, humidity, timestampUs,
+      [&](const GroupAggregator::GroupView& view) {
+        if (view.aggregate.reporting == 0 || view.rules.empty()) {
+          return;
+        }
+        // Вызывается под блокировкой группы: продолжения попадают в шард
+        // группы в порядке обновления агрегатов
+        std::vector<double> values;
+        values.reserve(view.rules.size());
+        for (const auto& rule : view.rules) {
+          values.push_back(
+              view.aggregate.value(rule.metricType, rule.aggregate));
+        }
+        auto task = [this, chatId = view.group.chatId, groupId = view.group.id,
+                     name = view.group.name, rules = view.rules,
+                     values = std::move(values), timestampUs]() {
+          checkGroupRules(chatId, groupId, name, rules, values, timestampUs);
+        };
+        if (!executor_->post(
+                executor_->shardFor(groupShardKey(view.group.id)), task)) {
+          task();
+        }
+      });
+}
 
-      updateStatistics("temperature");
-    }
+void AlertProcessingService::checkGroupRules(
+    long chatId, int groupId, const std::string& name,
+    const std::vector<models::GroupAlertRule>& rules,
+    const std::vector<double>& values, int64_t timestampUs) {
+  std::string shardKey = groupShardKey(groupId);
+  auto& state = groupStateFor(shardKey);
+  for (size_t i = 0; i < rules.size(); ++i) {
+    const auto& rule = rules[i];
+    bool temperatureRule = rule.metricType == "temperature";
+    bool above = rule.direction == "above";
+    AlertKind kind =
+        temperatureRule
+            ? (above ? AlertKind::TemperatureHigh : AlertKind::TemperatureLow)
+            : (above ? AlertKind::HumidityHigh : AlertKind::HumidityLow);
+
+    std::string key = shardKey + ":" + rule.metricType + ":" + rule.aggregate;
+    std::string label = "группа " + name + " (" + rule.aggregate + ")";
+    AlertSubject subject{key, label, state.groupDeduplicator,
+                         state.groupAlertStates};
+    checkThreshold(subject, chatId, kind, values[i], rule.threshold,
+                   timestampUs);
   }
+}
 
-  if (alert.temperatureLowThreshold > 0 &&
-      temperature < alert.temperatureLowThreshold) {
-    if (shouldNotify(userId, deviceId, "temp_low", temperature)) {
-      std::cout << "❄️ Temperature alert for user " << userId << ": "
-                << temperature << " < " << alert.temperatureLowThreshold
-                << std::endl;
+bool AlertProcessingService::getGroupAggregate(
+    int groupId, models::GroupAggregate& out) const {
+  return groups_->getAggregate(groupId, out);
+}
 
-      notifier_->sendTelegramAlert(userId, deviceId, temperature, "temperature",
-                                   "below");
+void AlertProcessingService::checkThreshold(const AlertSubject& subject,
+                                            long userId, AlertKind kind,
+                                            double value, double threshold,
+                                            int64_t timestampUs) {
+  const std::string& key = subject.key;
+  const std::string& label = subject.label;
+  auto transition = subject.alertStates.update(userId, key, kind, value,
+                                               threshold, timestampUs);
+  if (transition == AlertStateTracker::Transition::None) {
+    return;
+  }
 
-      updateStatistics("temperature");
+  bool temperature = kind == AlertKind::TemperatureHigh ||
+                     kind == AlertKind::TemperatureLow;
+  bool above =
+      kind == AlertKind::TemperatureHigh || kind == AlertKind::HumidityHigh;
+  const char* metric = temperature ? "temperature" : "humidity";
+  const char* direction = above ? "above" : "below";
+
+  if (transition == AlertStateTracker::Transition::Resolved) {
+    std::cout << "✅ Alert resolved for user " << userId << ": " << label
+              << " " << metric << "=" << value << std::endl;
+    if (sharedOutbox_) {
+      models::AlertEvent alert{label, value, metric, direction,
+                               timestampUs, true, 0};
+      publishShared(userId, key, kind, std::move(alert));
+    } else {
+      notifier_->sendResolvedAlert(userId, label, value, metric, direction);
     }
+    statistics_.resolvedAlerts++;
+    return;
   }
 
-  // Проверяем влажность
-  if (alert.humidityHighThreshold > 0 &&
-      humidity > alert.humidityHighThreshold) {
-    if (shouldNotify(userId, deviceId, "hum_high", humidity)) {
-      std::cout << "💦 Humidity alert for user " << userId << ": " << humidity
-                << " > " << alert.humidityHighThreshold << std::endl;
+  // Повторный вход в тревогу вскоре после восстановления все еще
+  // ограничен cooldown
+  std::string alertType = alertKindToString(kind);
+  if (!shouldNotify(subject, userId, alertType)) {
+    return;
+  }
 
-      notifier_->sendTelegramAlert(userId, deviceId, humidity, "humidity",
-                                   "above");
+  auto decision = rateLimiter_->tryAcquire(userId, key);
+  if (!decision.allowed) {
+    std::cout << "🔕 Rate limit: alert " << alertType << " for user " << userId
+              << " on " << label << " suppressed" << std::endl;
+    return;
+  }
 
-      updateStatistics("humidity");
-    }
+  std::cout << (temperature ? (above ? "🔥" : "❄️") : (above ? "💦" : "🏜️"))
+            << " " << (temperature ? "Temperature" : "Humidity")
+            << " alert for user " << userId << ": " << value
+            << (above ? " > " : " < ") << threshold << std::endl;
+
+  if (sharedOutbox_) {
+    models::AlertEvent alert{label, value, metric, direction,
+                             timestampUs, false, decision.suppressedBefore};
+    publishShared(userId, key, kind, std::move(alert));
+  } else {
+    notifier_->sendTelegramAlert(userId, label, value, metric, direction,
+                                 decision.suppressedBefore);
   }
+  subject.alertStates.markNotified(userId, key, kind);
+  updateStatistics(metric);
+}
+
+void AlertProcessingService::attachSharedOutbox(
+    std::shared_ptr<core::SharedNotificationOutbox> outbox,
+    std::chrono::seconds thresholdMaxAge) {
+  sharedOutbox_ = std::move(outbox);
+  thresholds_->setMaxAge(thresholdMaxAge);
+}
 
-  if (alert.humidityLowThreshold > 0 && humidity < alert.humidityLowThreshold) {
-    if (shouldNotify(userId, deviceId, "hum_low", humidity)) {
-      std::cout << "🏜️ Humidity alert for user " << userId << ": " << humidity
-                << " < " << alert.humidityLowThreshold << std::endl;
+void AlertProcessingService::attachHeartbeatMonitor(
+    std::shared_ptr<HeartbeatMonitor> heartbeats) {
+  heartbeats_ = std::move(heartbeats);
+}
 
-      notifier_->sendTelegramAlert(userId, deviceId, humidity, "humidity",
-                                   "below");
+std::string AlertProcessingService::sharedDedupKey(
+    const char* channel, long userId, const std::string& deviceId,
+    AlertKind kind, bool resolved, int64_t timestampUs) const {
+  // Окно - cooldown: узлы, проверившие одно показание, получают один
+  // ключ, а повторная тревога после cooldown - новый
+  int64_t windowUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(cooldown_)
+          .count();
+  int64_t window = windowUs > 0 ? timestampUs / windowUs : timestampUs;
+
+  std::string key = channel;
+  key += ':';
+  if (userId != 0) {
+    key += std::to_string(userId);
+    key += ':';
+  }
+  key += deviceId;
+  key += ':';
+  key += alertKindToString(kind);
+  if (resolved) {
+    key += ":resolved";
+  }
+  key += ':';
+  key += std::to_string(window);
+  return key;
+}
 
-      updateStatistics("humidity");
-    }
+void AlertProcessingService::publishShared(long userId,
+                                           const std::string& deviceId,
+                                           AlertKind kind,
+                                           models::AlertEvent alert) {
+  if (notifier_->isTelegramAvailable()) {
+    sharedOutbox_->publishTelegram(
+        sharedDedupKey("tg", userId, deviceId, kind, alert.resolved,
+                       alert.timestampUs),
+        userId, alert);
+  }
+
+  // Письмо уходит общему списку получателей: одно на событие
+  // устройства, сколько бы подписчиков ни сработало. Восстановления,
+  // связь с устройством и аномалии по почте не рассылаются.
+  if (!alert.resolved && kind != AlertKind::Offline &&
+      kind != AlertKind::Anomaly && notifier_->isEmailAvailable()) {
+    sharedOutbox_->publishEmail(sharedDedupKey("email", 0, deviceId, kind,
+                                               false, alert.timestampUs),
+                                alert);
   }
 }
 
@@ -199,37 +683,208 @@ bool AlertProcessingService::shouldNotify(long userId,
                                           const std::string& deviceId,
                                           const std::string& alertType,
                                           double value) {
-  // Простая защита от спама - проверяем кэш
-  std::lock_guard<std::mutex> lock(cacheMutex_);
-
-  auto now = std::chrono::system_clock::now();
-  std::string cacheKey =
-      std::to_string(userId) + "_" + deviceId + "_" + alertType;
-
-  // Удаляем старые записи
-  auto it = alertCache_.begin();
-  while (it != alertCache_.end()) {
-    if (now - it->second > cacheDuration_) {
-      it = alertCache_.erase(it);
-    } else {
-      ++it;
-    }
+  (void)value;
+
+  auto& state = stateFor(deviceId);
+  return shouldNotify(AlertSubject{deviceId, deviceId, state.deduplicator,
+                                   state.alertStates},
+                      userId, alertType);
+}
+
+bool AlertProcessingService::shouldNotify(const AlertSubject& subject,
+                                          long userId,
+                                          const std::string& alertType) {
+  if (!subject.deduplicator.tryAcquire(userId, subject.key,
+                                       alertKindFromString(alertType))) {
+    std::cout << "⚠️ Skipping duplicate alert: " << userId << "_"
+              << subject.label
+              << "_" << alertType << std::endl;
+    return false;
   }
+  return true;
+}
+
+bool AlertProcessingService::rememberReading(const std::string& deviceId,
+                                             double temperature,
+                                             double humidity,
+                                             int64_t timestampUs) {
+  auto& state = stateFor(deviceId);
+  std::lock_guard<std::mutex> lock(state.readingsMutex);
 
-  // Проверяем, было ли недавно такое оповещение
-  if (alertCache_.find(cacheKey) != alertCache_.end()) {
-    std::cout << "⚠️ Skipping duplicate alert: " << cacheKey << std::endl;
+  auto& reading = state.latestReadings[deviceId];
+  if (reading.timestampUs != 0 && timestampUs <= reading.timestampUs) {
     return false;
   }
 
-  // Добавляем в кэш
-  alertCache_[cacheKey] = now;
+  reading.temperature = temperature;
+  reading.humidity = humidity;
+  reading.timestampUs = timestampUs;
   return true;
 }
 
-void AlertProcessingService::updateStatistics(const std::string& alertType) {
-  std::lock_guard<std::mutex> lock(statisticsMutex_);
+bool AlertProcessingService::getLatestReading(const std::string& deviceId,
+                                              LatestReading& out) const {
+  const auto& state = stateFor(deviceId);
+  std::lock_guard<std::mutex> lock(state.readingsMutex);
+
+  auto it = state.latestReadings.find(deviceId);
+  if (it == state.latestReadings.end()) {
+    return false;
+  }
+  out = it->second;
+  return true;
+}
+
+void AlertProcessingService::saveState(
+    storage::SnapshotWriter& snapshot) const {
+  // Храним момент истечения, а не отправки: при восстановлении
+  // оповещение остается подавленным ровно до того же времени
+  std::vector<AlertDeduplicator::Entry> entries;
+  for (const auto& state : shards_) {
+    for (const auto* deduplicator :
+         {&state->deduplicator, &state->groupDeduplicator}) {
+      auto shardEntries = deduplicator->entries();
+      std::move(shardEntries.begin(), shardEntries.end(),
+                std::back_inserter(entries));
+    }
+  }
+
+  auto& dedup = snapshot.section(kDedupSection);
+  dedup.putU32(static_cast<uint32_t>(entries.size()));
+  for (const auto& entry : entries) {
+    dedup.putI64(entry.userId);
+    dedup.putString(entry.deviceId);
+    dedup.putU8(static_cast<uint8_t>(entry.kind));
+    dedup.putI64(toMicros(entry.expiresAt));
+  }
+
+  auto& states = snapshot.section(kStatesSection);
+  std::vector<AlertStateTracker::Entry> active;
+  for (const auto& state : shards_) {
+    for (const auto* tracker :
+         {&state->alertStates, &state->groupAlertStates}) {
+      auto shardStates = tracker->entries();
+      std::move(shardStates.begin(), shardStates.end(),
+                std::back_inserter(active));
+    }
+  }
+  states.putU32(static_cast<uint32_t>(active.size()));
+  for (const auto& entry : active) {
+    states.putI64(entry.userId);
+    states.putString(entry.deviceId);
+    states.putU8(static_cast<uint8_t>(entry.kind));
+    states.putU8(static_cast<uint8_t>(entry.phase));
+    states.putI64(entry.alertedAtUs);
+    states.putI64(entry.recoveryAtUs);
+    states.putU8(entry.notified ? 1 : 0);
+  }
+
+  std::vector<std::pair<std::string, LatestReading>> readings;
+  for (const auto& state : shards_) {
+    std::lock_guard<std::mutex> lock(state->readingsMutex);
+    readings.insert(readings.end(), state->latestReadings.begin(),
+                    state->latestReadings.end());
+  }
 
+  auto& section = snapshot.section(kReadingsSection);
+  section.putU32(static_cast<uint32_t>(readings.size()));
+  for (const auto& [deviceId, reading] : readings) {
+    section.putString(deviceId);
+    section.putI64(reading.timestampUs);
+    section.putDouble(reading.temperature);
+    section.putDouble(reading.humidity);
+  }
+}
+
+size_t AlertProcessingService::restoreState(
+    const storage::SnapshotReader& snapshot) {
+  size_t restored = 0;
+
+  try {
+    auto dedup = snapshot.section(kDedupSection);
+    if (!dedup.atEnd()) {
+      // Сначала разбираем секцию целиком, чтобы поврежденный снимок
+      // не применился частично
+      std::vector<AlertDeduplicator::Entry> entries;
+      uint32_t count = dedup.getU32();
+      for (uint32_t i = 0; i < count; ++i) {
+        auto& entry = entries.emplace_back();
+        entry.userId = static_cast<long>(dedup.getI64());
+        entry.deviceId = dedup.getString();
+        entry.kind = static_cast<AlertKind>(dedup.getU8());
+        entry.expiresAt = std::chrono::system_clock::time_point(
+            std::chrono::microseconds(dedup.getI64()));
+      }
+
+      auto now = std::chrono::system_clock::now();
+      for (const auto& entry : entries) {
+        if (entry.expiresAt > now) {
+          if (isGroupKey(entry.deviceId)) {
+            groupStateFor(entry.deviceId).groupDeduplicator.restore(entry,
+                                                                    now);
+          } else {
+            stateFor(entry.deviceId).deduplicator.restore(entry, now);
+          }
+          ++restored;
+        }
+      }
+    }
+
+    bool legacyStates = !snapshot.has(kStatesSection);
+    auto states = snapshot.section(legacyStates ? kLegacyStatesSection
+                                                : kStatesSection);
+    if (!states.atEnd()) {
+      std::vector<AlertStateTracker::Entry> entries;
+      uint32_t count = states.getU32();
+      for (uint32_t i = 0; i < count; ++i) {
+        auto& entry = entries.emplace_back();
+        entry.userId = static_cast<long>(states.getI64());
+        entry.deviceId = states.getString();
+        entry.kind = static_cast<AlertKind>(states.getU8());
+        entry.phase = static_cast<AlertStateTracker::Phase>(states.getU8());
+        entry.alertedAtUs = states.getI64();
+        entry.recoveryAtUs = states.getI64();
+        entry.notified = legacyStates || states.getU8() != 0;
+      }
+
+      for (const auto& entry : entries) {
+        if (isGroupKey(entry.deviceId)) {
+          groupStateFor(entry.deviceId).groupAlertStates.restore(entry);
+        } else {
+          stateFor(entry.deviceId).alertStates.restore(entry);
+        }
+        ++restored;
+      }
+    }
+
+    auto readings = snapshot.section(kReadingsSection);
+    if (!readings.atEnd()) {
+      uint32_t count = readings.getU32();
+      for (uint32_t i = 0; i < count; ++i) {
+        std::string deviceId = readings.getString();
+        LatestReading reading;
+        reading.timestampUs = readings.getI64();
+        reading.temperature = readings.getDouble();
+        reading.humidity = readings.getDouble();
+
+        auto& state = stateFor(deviceId);
+        std::lock_guard<std::mutex> lock(state.readingsMutex);
+        auto& current = state.latestReadings[deviceId];
+        if (reading.timestampUs > current.timestampUs) {
+          current = reading;
+        }
+        ++restored;
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "❌ Ошибка восстановления состояния оповещений: " << e.what()
+              << std::endl;
+  }
+
+  return restored;
+}
+
+void AlertProcessingService::updateStatistics(const std::string& alertType) {
   statistics_.totalAlerts++;
   statistics_.usersNotified++;
 
@@ -242,13 +897,34 @@ void AlertProcessingService::updateStatistics(const std::string& alertType) {
 
 AlertProcessingService::AlertStatistics AlertProcessingService::getStatistics()
     const {
-  std::lock_guard<std::mutex> lock(statisticsMutex_);
-  return statistics_;
+  AlertStatistics stats;
+  stats.totalAlerts = statistics_.totalAlerts.load();
+  stats.temperatureAlerts = statistics_.temperatureAlerts.load();
+  stats.humidityAlerts = statistics_.humidityAlerts.load();
+  stats.usersNotified = statistics_.usersNotified.load();
+  stats.resolvedAlerts = statistics_.resolvedAlerts.load();
+  stats.offlineAlerts = statistics_.offlineAlerts.load();
+  stats.onlineAlerts = statistics_.onlineAlerts.load();
+  stats.anomalyAlerts = statistics_.anomalyAlerts.load();
+  stats.rateLimits = rateLimiter_->getStatistics();
+  stats.thresholdIndex = thresholds_->getStatistics();
+  stats.groupAggregates = groups_->getStatistics();
+  for (const auto& state : shards_) {
+    stats.activeAlerts += state->alertStates.activeCount() +
+                          state->groupAlertStates.activeCount();
+  }
+  return stats;
 }
 
 void AlertProcessingService::resetStatistics() {
-  std::lock_guard<std::mutex> lock(statisticsMutex_);
-  statistics_ = AlertStatistics{};
+  statistics_.totalAlerts = 0;
+  statistics_.temperatureAlerts = 0;
+  statistics_.humidityAlerts = 0;
+  statistics_.usersNotified = 0;
+  statistics_.resolvedAlerts = 0;
+  statistics_.offlineAlerts = 0;
+  statistics_.onlineAlerts = 0;
+  statistics_.anomalyAlerts = 0;
 }
 
 }  // namespace iot_core::services
\ No newline at end of file
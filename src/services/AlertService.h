@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -9,56 +11,260 @@
 
 #include "../core/Database.h"
 #include "../core/NotificationService.h"
+#include "../core/SharedNotificationOutbox.h"
+#include "AlertDeduplicator.h"
+#include "AlertRateLimiter.h"
+#include "AlertStateTracker.h"
+#include "GroupAggregator.h"
+#include "HeartbeatMonitor.h"
+#include "ShardedExecutor.h"
+#include "ThresholdIndex.h"
+
+namespace iot_core::storage {
+class SnapshotWriter;
+class SnapshotReader;
+}  // namespace iot_core::storage
 
 namespace iot_core::services {
 
+/**
+ * @brief Проверка показаний по порогам пользователей и рассылка оповещений
+ *
+ * Проверка выполняется в пуле шардов: устройство всегда попадает в один
+ * и тот же шард, поэтому его показания обрабатываются по порядку, а
+ * разные устройства - параллельно. Таблица подавления повторов,
+ * состояния правил и последние показания принадлежат шарду.
+ *
+ * Оповещение уходит при переходе правила в тревогу, а не на каждое
+ * показание за порогом; при возврате в норму - сообщение о
+ * восстановлении (см. AlertStateTracker).
+ *
+ * Сработавшие правила подписчиков ищутся в отсортированном индексе
+ * порогов устройства (см. ThresholdIndex), а не проверкой каждого
+ * подписчика; индекс обновляется по изменениям порогов и подписок в БД.
+ *
+ * Показание также обновляет агрегаты групп, в которые входит устройство
+ * (см. GroupAggregator). Правила групп проверяются в шарде группы:
+ * обновление агрегата ставит продолжение в него, поэтому правила одной
+ * группы идут по порядку независимо от шарда участника. Их состояние -
+ * отдельные таблицы шарда с ключами "group:<id>:<метрика>:<агрегат>",
+ * не связанные с реестром устройств.
+ */
 class AlertProcessingService {
  public:
+  // workerShards = 0 - по числу ядер (не больше 8)
   AlertProcessingService(std::shared_ptr<core::DatabaseRepository> database,
-                         std::shared_ptr<core::NotificationService> notifier);
+                         std::shared_ptr<core::NotificationService> notifier,
+                         std::chrono::seconds cooldown = std::chrono::seconds(
+                             300),
+                         size_t workerShards = 0,
+                         AlertStateTracker::Options hysteresis =
+                             AlertStateTracker::Options(),
+                         AlertRateLimiter::Options rateLimits =
+                             AlertRateLimiter::Options());
+  ~AlertProcessingService();
 
+  // Ставит показание в очередь шарда устройства и сразу возвращается
   void processTelemetryData(const std::string& deviceId, double temperature,
                             double humidity);
+  // То же с временем показания (микросекунды), а не моментом вызова
+  void processTelemetryData(const std::string& deviceId, double temperature,
+                            double humidity, int64_t timestampUs);
+
+  // Устройство перестало присылать данные (online = false) или снова в
+  // сети: оповещение подписчиков, в порядке с показаниями устройства
+  void processDeviceStatus(const std::string& deviceId, bool online,
+                           int64_t lastSeenUs, int64_t timestampUs);
 
+  // Аномальное показание (см. engine::AnomalyDetector): оповещение
+  // подписчиков не чаще раза в cooldown, в порядке с показаниями
+  void processAnomaly(const std::string& deviceId,
+                      const std::string& metricType, double value,
+                      int64_t timestampUs);
+
+  // Опрос удаленной БД; возвращается после проверки всех устройств
   void checkAllSubscribedDevices();
 
+  // Дожидается обработки всех поставленных показаний
+  void drain();
+  // Останавливает шарды, дорабатывая очереди
+  void stop();
+
+  ShardedExecutor::Statistics getExecutorStatistics() const;
+
+  // Несколько экземпляров: оповещения идут в общую таблицу
+  // notification_outbox вместо локальной очереди. Пороги, измененные
+  // другими узлами, подхватываются перечитыванием снимков порогов раз в
+  // thresholdMaxAge (0 - не перечитывать). Подключать до начала
+  // обработки показаний.
+  void attachSharedOutbox(
+      std::shared_ptr<core::SharedNotificationOutbox> outbox,
+      std::chrono::seconds thresholdMaxAge);
+  std::shared_ptr<core::SharedNotificationOutbox> getSharedOutbox() const {
+    return sharedOutbox_;
+  }
+
+  // Обнаружение offline (см. HeartbeatMonitor): каждое проверенное
+  // показание, в том числе из удаленной БД, - контакт с устройством,
+  // первое после offline дает оповещение "снова в сети". Подключать до
+  // начала обработки показаний.
+  void attachHeartbeatMonitor(std::shared_ptr<HeartbeatMonitor> heartbeats);
+
   // Получение статистики
   struct AlertStatistics {
     int totalAlerts = 0;
     int temperatureAlerts = 0;
     int humidityAlerts = 0;
     int usersNotified = 0;
+    int resolvedAlerts = 0;
+    int offlineAlerts = 0;  // устройство перестало присылать данные
+    int onlineAlerts = 0;   // и снова в сети
+    int anomalyAlerts = 0;
+    size_t activeAlerts = 0;  // правил в тревоге сейчас
+    AlertRateLimiter::Statistics rateLimits;
+    ThresholdIndex::Statistics thresholdIndex;
+    GroupAggregator::Statistics groupAggregates;
   };
 
   AlertStatistics getStatistics() const;
   void resetStatistics();
 
+  // Последнее проверенное показание устройства
+  struct LatestReading {
+    double temperature = 0.0;
+    double humidity = 0.0;
+    int64_t timestampUs = 0;
+  };
+
+  bool getLatestReading(const std::string& deviceId,
+                        LatestReading& out) const;
+
+  // Агрегаты группы по последним показаниям участников
+  bool getGroupAggregate(int groupId, models::GroupAggregate& out) const;
+
+  // Снимок кэша оповещений и последних показаний для быстрого перезапуска
+  void saveState(storage::SnapshotWriter& snapshot) const;
+  // Возвращает число восстановленных записей
+  size_t restoreState(const storage::SnapshotReader& snapshot);
+
  private:
+  // Состояние одного шарда; обращения из чужих потоков (снимок, запросы)
+  // редки, поэтому блокировка шарда практически не конкурентна
+  struct alignas(64) ShardState {
+    ShardState(AlertDeduplicator::Options options,
+               AlertStateTracker::Options hysteresis,
+               std::shared_ptr<DeviceRegistry> devices,
+               std::shared_ptr<DeviceRegistry> groupKeys)
+        : deduplicator(options, devices),
+          alertStates(hysteresis, std::move(devices)),
+          groupDeduplicator(std::move(options), groupKeys),
+          groupAlertStates(std::move(hysteresis), std::move(groupKeys)) {}
+
+    AlertDeduplicator deduplicator;
+    AlertStateTracker alertStates;
+    // Правила групп, назначенных шарду
+    AlertDeduplicator groupDeduplicator;
+    AlertStateTracker groupAlertStates;
+    std::unordered_map<std::string, LatestReading> latestReadings;
+    mutable std::mutex readingsMutex;
+  };
+
+  ShardState& stateFor(const std::string& deviceId) const;
+  // Шард группы; key - "group:<id>" или ключ правила группы
+  ShardState& groupStateFor(const std::string& key) const;
+
+  // Чье правило проверяется: устройство или агрегат группы
+  struct AlertSubject {
+    const std::string& key;    // состояние, дедупликация, лимит частоты
+    const std::string& label;  // в сообщениях и журнале
+    AlertDeduplicator& deduplicator;
+    AlertStateTracker& alertStates;
+  };
+
+  // Выполняются в потоке шарда устройства
+  void evaluateReading(const std::string& deviceId, double temperature,
+                       double humidity, int64_t timestampUs);
+  void checkRemoteDevice(const std::string& deviceId);
+  void recordContact(const std::string& deviceId, int64_t timestampUs);
+  void notifyDeviceStatus(const std::string& deviceId, bool online,
+                          int64_t lastSeenUs, int64_t timestampUs);
+  void notifyAnomaly(const std::string& deviceId, const std::string& metricType,
+                     double value, int64_t timestampUs);
+
   // Вспомогательные методы
-  void checkUserAlerts(long userId, const std::string& deviceId,
-                       double temperature, double humidity);
+  // false если пороги подписчиков недоступны (ошибка БД)
+  bool checkDeviceAlerts(const std::string& deviceId, double temperature,
+                         double humidity, int64_t timestampUs);
+  // Одно правило пользователя: переход состояния -> уведомление
+  void checkThreshold(const AlertSubject& subject, long userId,
+                      AlertKind kind, double value, double threshold,
+                      int64_t timestampUs);
+
+  // Агрегаты групп устройства; правила групп уходят в шард группы
+  void checkGroupAlerts(const std::string& deviceId, double temperature,
+                        double humidity, int64_t timestampUs);
+  // Выполняется в потоке шарда группы; values - по правилам
+  void checkGroupRules(long chatId, int groupId, const std::string& name,
+                       const std::vector<models::GroupAlertRule>& rules,
+                       const std::vector<double>& values,
+                       int64_t timestampUs);
 
   void checkGlobalAlerts(const std::string& deviceId, double temperature,
                          double humidity);
 
+  // Ключ события для общей очереди: одинаков на всех узлах, которые
+  // увидели одно и то же показание
+  std::string sharedDedupKey(const char* channel, long userId,
+                             const std::string& deviceId, AlertKind kind,
+                             bool resolved, int64_t timestampUs) const;
+  void publishShared(long userId, const std::string& deviceId,
+                     AlertKind kind, models::AlertEvent alert);
+
   bool shouldNotify(long userId, const std::string& deviceId,
                     const std::string& alertType, double value);
+  bool shouldNotify(const AlertSubject& subject, long userId,
+                    const std::string& alertType);
 
   void updateStatistics(const std::string& alertType);
 
+  // false если это показание уже проверялось
+  bool rememberReading(const std::string& deviceId, double temperature,
+                       double humidity, int64_t timestampUs);
+
   std::vector<std::string> getAllSubscribedDevices();
 
   std::shared_ptr<core::DatabaseRepository> database_;
   std::shared_ptr<core::NotificationService> notifier_;
 
-  AlertStatistics statistics_;
-  mutable std::mutex statisticsMutex_;
+  // Счетчики обновляются из всех шардов
+  struct {
+    std::atomic<int> totalAlerts{0};
+    std::atomic<int> temperatureAlerts{0};
+    std::atomic<int> humidityAlerts{0};
+    std::atomic<int> usersNotified{0};
+    std::atomic<int> resolvedAlerts{0};
+    std::atomic<int> offlineAlerts{0};
+    std::atomic<int> onlineAlerts{0};
+    std::atomic<int> anomalyAlerts{0};
+  } statistics_;
+
+  // Защита от спама: повторное оповещение не раньше чем через cooldown
+  std::shared_ptr<DeviceRegistry> devices_;
+  // Ключи правил групп: отдельно от устройств
+  std::shared_ptr<DeviceRegistry> groupKeys_;
+  std::vector<std::unique_ptr<ShardState>> shards_;
+  // Общий для всех шардов: лимиты по чатам и глобальный
+  std::unique_ptr<AlertRateLimiter> rateLimiter_;
+  // Обработчики изменений в БД держат слабую ссылку
+  std::shared_ptr<ThresholdIndex> thresholds_;
+  std::shared_ptr<GroupAggregator> groups_;
+  std::shared_ptr<core::SharedNotificationOutbox> sharedOutbox_;
+  // nullptr - отслеживание отключено
+  std::shared_ptr<HeartbeatMonitor> heartbeats_;
+  std::chrono::seconds cooldown_;
 
-  // Кэш для предотвращения спама
-  std::unordered_map<std::string, std::chrono::system_clock::time_point>
-      alertCache_;
-  std::chrono::seconds cacheDuration_ = std::chrono::seconds(300);
-  mutable std::mutex cacheMutex_;
+  // Объявлен последним: останавливается раньше, чем разрушается состояние
+  std::unique_ptr<ShardedExecutor> executor_;
 };
 
 }  // namespace iot_core::services
\ No newline at end of file
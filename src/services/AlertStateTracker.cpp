@@ -0,0 +1,234 @@
+#include "AlertStateTracker.h"
+
+#include <algorithm>
+
+namespace iot_core::services {
+
+namespace {
+
+bool isHighKind(AlertKind kind) {
+  return kind == AlertKind::TemperatureHigh || kind == AlertKind::HumidityHigh;
+}
+
+bool isTemperatureKind(AlertKind kind) {
+  return kind == AlertKind::TemperatureHigh ||
+         kind == AlertKind::TemperatureLow;
+}
+
+int64_t toMicros(std::chrono::seconds duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+
+}  // namespace
+
+size_t AlertStateTracker::KeyHash::operator()(const Key& key) const {
+  uint64_t x = key.user * 0x9E3779B97F4A7C15ull ^ key.deviceAndKind;
+  x ^= x >> 31;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 29;
+  return static_cast<size_t>(x);
+}
+
+AlertStateTracker::AlertStateTracker(Options options,
+                                     std::shared_ptr<DeviceRegistry> devices)
+    : options_(std::move(options)), devices_(std::move(devices)) {}
+
+AlertStateTracker::Key AlertStateTracker::makeKey(long userId,
+                                                  uint32_t deviceIndex,
+                                                  AlertKind kind) const {
+  return Key{static_cast<uint64_t>(userId),
+             static_cast<uint64_t>(deviceIndex) << 8 |
+                 static_cast<uint64_t>(kind)};
+}
+
+uint32_t AlertStateTracker::slotLocked(const Key& key) {
+  auto [it, inserted] =
+      slots_.try_emplace(key, static_cast<uint32_t>(keys_.size()));
+  if (inserted) {
+    keys_.push_back(key);
+    phases_.push_back(Phase::Normal);
+    alertedAtUs_.push_back(0);
+    recoveryAtUs_.push_back(0);
+    notified_.push_back(0);
+  }
+  return it->second;
+}
+
+void AlertStateTracker::setPhaseLocked(uint32_t slot, Phase phase) {
+  bool wasActive = phases_[slot] != Phase::Normal;
+  bool active = phase != Phase::Normal;
+  phases_[slot] = phase;
+  if (wasActive == active) {
+    return;
+  }
+
+  auto& slots = activeSlots_[keys_[slot].deviceAndKind];
+  if (active) {
+    slots.push_back(slot);
+    ++active_;
+    return;
+  }
+  auto it = std::find(slots.begin(), slots.end(), slot);
+  if (it != slots.end()) {
+    *it = slots.back();
+    slots.pop_back();
+  }
+  --active_;
+}
+
+double AlertStateTracker::hysteresisFor(AlertKind kind) const {
+  return isTemperatureKind(kind) ? options_.temperatureHysteresis
+                                 : options_.humidityHysteresis;
+}
+
+AlertStateTracker::Transition AlertStateTracker::update(
+    long userId, const std::string& deviceId, AlertKind kind, double value,
+    double threshold, int64_t timestampUs) {
+  Key key = makeKey(userId, devices_->intern(deviceId), kind);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (threshold <= 0) {
+    // Правило выключено: состояние не нужно, если его и не было
+    auto it = slots_.find(key);
+    if (it != slots_.end()) {
+      setPhaseLocked(it->second, Phase::Normal);
+    }
+    return Transition::None;
+  }
+
+  uint32_t slot = slotLocked(key);
+  bool high = isHighKind(kind);
+  double band = hysteresisFor(kind);
+  bool beyond = high ? value > threshold : value < threshold;
+  bool clear = high ? value < threshold - band : value > threshold + band;
+
+  switch (phases_[slot]) {
+    case Phase::Normal:
+      if (beyond) {
+        setPhaseLocked(slot, Phase::Alerting);
+        alertedAtUs_[slot] = timestampUs;
+        notified_[slot] = 0;
+        return Transition::Triggered;
+      }
+      break;
+
+    case Phase::Alerting:
+      if (clear) {
+        setPhaseLocked(slot, Phase::Recovering);
+        recoveryAtUs_[slot] = timestampUs;
+      }
+      break;
+
+    case Phase::Recovering:
+      if (!clear) {
+        // Снова за порогом или в полосе гистерезиса - тревога продолжается
+        setPhaseLocked(slot, Phase::Alerting);
+        break;
+      }
+      if (timestampUs - recoveryAtUs_[slot] >=
+              toMicros(options_.recoveryDwell) &&
+          timestampUs - alertedAtUs_[slot] >=
+              toMicros(options_.minAlertDuration)) {
+        setPhaseLocked(slot, Phase::Normal);
+        // Пользователь не знал о тревоге - не о чем и сообщать
+        return notified_[slot] != 0 ? Transition::Resolved
+                                    : Transition::None;
+      }
+      break;
+  }
+
+  return Transition::None;
+}
+
+void AlertStateTracker::markNotified(long userId, const std::string& deviceId,
+                                     AlertKind kind) {
+  uint32_t deviceIndex = 0;
+  if (!devices_->find(deviceId, deviceIndex)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = slots_.find(makeKey(userId, deviceIndex, kind));
+  if (it != slots_.end() && phases_[it->second] != Phase::Normal) {
+    notified_[it->second] = 1;
+  }
+}
+
+AlertStateTracker::Phase AlertStateTracker::phase(long userId,
+                                                  const std::string& deviceId,
+                                                  AlertKind kind) const {
+  uint32_t deviceIndex = 0;
+  if (!devices_->find(deviceId, deviceIndex)) {
+    return Phase::Normal;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = slots_.find(makeKey(userId, deviceIndex, kind));
+  return it == slots_.end() ? Phase::Normal : phases_[it->second];
+}
+
+std::vector<AlertStateTracker::Entry> AlertStateTracker::entries() const {
+  std::vector<Entry> result;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    if (phases_[i] == Phase::Normal) {
+      continue;
+    }
+    Entry entry;
+    entry.userId = static_cast<long>(keys_[i].user);
+    entry.deviceId =
+        devices_->name(static_cast<uint32_t>(keys_[i].deviceAndKind >> 8));
+    entry.kind = static_cast<AlertKind>(keys_[i].deviceAndKind & 0xFF);
+    entry.phase = phases_[i];
+    entry.alertedAtUs = alertedAtUs_[i];
+    entry.recoveryAtUs = recoveryAtUs_[i];
+    entry.notified = notified_[i] != 0;
+    result.push_back(std::move(entry));
+  }
+  return result;
+}
+
+void AlertStateTracker::restore(const Entry& entry) {
+  if (entry.phase == Phase::Normal) {
+    return;
+  }
+
+  Key key = makeKey(entry.userId, devices_->intern(entry.deviceId), entry.kind);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t slot = slotLocked(key);
+  setPhaseLocked(slot, entry.phase);
+  alertedAtUs_[slot] = entry.alertedAtUs;
+  recoveryAtUs_[slot] = entry.recoveryAtUs;
+  notified_[slot] = entry.notified ? 1 : 0;
+}
+
+size_t AlertStateTracker::activeCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_;
+}
+
+std::vector<long> AlertStateTracker::activeUsers(const std::string& deviceId,
+                                                 AlertKind kind) const {
+  std::vector<long> result;
+  uint32_t deviceIndex = 0;
+  if (!devices_->find(deviceId, deviceIndex)) {
+    return result;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = activeSlots_.find(makeKey(0, deviceIndex, kind).deviceAndKind);
+  if (it == activeSlots_.end()) {
+    return result;
+  }
+  result.reserve(it->second.size());
+  for (uint32_t slot : it->second) {
+    result.push_back(static_cast<long>(keys_[slot].user));
+  }
+  return result;
+}
+
+}  // namespace iot_core::services
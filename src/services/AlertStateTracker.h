@@ -0,0 +1,127 @@
+// src/services/AlertStateTracker.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AlertDeduplicator.h"
+#include "DeviceRegistry.h"
+
+namespace iot_core::services {
+
+/**
+ * @brief Состояние каждого правила (пользователь, устройство, тип) с
+ * гистерезисом
+ *
+ * NORMAL -> ALERTING при выходе значения за порог (оповещение).
+ * ALERTING -> RECOVERING, когда значение вернулось за порог с запасом
+ * hysteresis. RECOVERING -> NORMAL, если значение продержалось в норме
+ * recoveryDwell, а тревога длилась не меньше minAlertDuration
+ * (сообщение "норма восстановлена"); любое значение без запаса
+ * возвращает правило в ALERTING без повторного оповещения. Так датчик,
+ * колеблющийся около порога, дает одно оповещение, а не по одному на
+ * каждый cooldown.
+ *
+ * Переход в ALERTING еще не значит, что пользователь узнал о тревоге:
+ * оповещение может подавить cooldown или лимит частоты. Вызывающий
+ * отмечает отправленное оповещение (markNotified); восстановление
+ * тревоги, о которой не сообщалось, проходит молча.
+ *
+ * Состояния лежат в плотных массивах, индекс - по ключу из
+ * интернированного устройства; записи не удаляются. Для каждой пары
+ * (устройство, тип) ведется список активных правил, чтобы показание
+ * доводило до восстановления только их, не перебирая всех подписчиков.
+ */
+class AlertStateTracker {
+ public:
+  enum class Phase : uint8_t { Normal = 0, Alerting = 1, Recovering = 2 };
+  enum class Transition : uint8_t { None, Triggered, Resolved };
+
+  struct Options {
+    double temperatureHysteresis = 0.5;  // °C
+    double humidityHysteresis = 2.0;     // %
+    std::chrono::seconds recoveryDwell{60};
+    std::chrono::seconds minAlertDuration{0};
+  };
+
+  // Запись для снимка состояния
+  struct Entry {
+    long userId = 0;
+    std::string deviceId;
+    AlertKind kind = AlertKind::Other;
+    Phase phase = Phase::Normal;
+    int64_t alertedAtUs = 0;   // начало тревоги
+    int64_t recoveryAtUs = 0;  // начало восстановления
+    bool notified = true;      // оповещение о тревоге отправлено
+  };
+
+  explicit AlertStateTracker(Options options,
+                             std::shared_ptr<DeviceRegistry> devices =
+                                 std::make_shared<DeviceRegistry>());
+
+  AlertStateTracker(const AlertStateTracker&) = delete;
+  AlertStateTracker& operator=(const AlertStateTracker&) = delete;
+
+  // Очередное значение для правила; threshold <= 0 - правило выключено
+  // (состояние сбрасывается без уведомления)
+  Transition update(long userId, const std::string& deviceId, AlertKind kind,
+                    double value, double threshold, int64_t timestampUs);
+
+  // Оповещение о текущей тревоге правила отправлено: ее восстановление
+  // даст Transition::Resolved
+  void markNotified(long userId, const std::string& deviceId, AlertKind kind);
+
+  Phase phase(long userId, const std::string& deviceId, AlertKind kind) const;
+
+  // Правила не в состоянии NORMAL (для снимка)
+  std::vector<Entry> entries() const;
+  void restore(const Entry& entry);
+
+  // Число правил в тревоге или восстановлении
+  size_t activeCount() const;
+  // Пользователи, чьи правила данного типа на устройстве не в NORMAL
+  std::vector<long> activeUsers(const std::string& deviceId,
+                                AlertKind kind) const;
+
+ private:
+  struct Key {
+    uint64_t user;
+    uint64_t deviceAndKind;  // индекс устройства << 8 | тип
+
+    bool operator==(const Key& other) const {
+      return user == other.user && deviceAndKind == other.deviceAndKind;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  Key makeKey(long userId, uint32_t deviceIndex, AlertKind kind) const;
+  // Индекс состояния; создает NORMAL-запись при первом обращении
+  uint32_t slotLocked(const Key& key);
+  // Смена фазы с учетом счетчика и списка активных правил
+  void setPhaseLocked(uint32_t slot, Phase phase);
+  double hysteresisFor(AlertKind kind) const;
+
+  Options options_;
+  std::shared_ptr<DeviceRegistry> devices_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, uint32_t, KeyHash> slots_;
+  // Параллельные массивы по индексу слота
+  std::vector<Key> keys_;
+  std::vector<Phase> phases_;
+  std::vector<int64_t> alertedAtUs_;
+  std::vector<int64_t> recoveryAtUs_;
+  std::vector<uint8_t> notified_;
+  size_t active_ = 0;
+  // Слоты не в NORMAL по (индекс устройства << 8 | тип)
+  std::unordered_map<uint64_t, std::vector<uint32_t>> activeSlots_;
+};
+
+}  // namespace iot_core::services
@@ -0,0 +1,45 @@
+#include "DeviceRegistry.h"
+
+#include <mutex>
+
+namespace iot_core::services {
+
+uint32_t DeviceRegistry::intern(const std::string& deviceId) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = indices_.find(deviceId);
+    if (it != indices_.end()) {
+      return it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto [it, inserted] =
+      indices_.emplace(deviceId, static_cast<uint32_t>(names_.size()));
+  if (inserted) {
+    names_.push_back(deviceId);
+  }
+  return it->second;
+}
+
+bool DeviceRegistry::find(const std::string& deviceId, uint32_t& index) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = indices_.find(deviceId);
+  if (it == indices_.end()) {
+    return false;
+  }
+  index = it->second;
+  return true;
+}
+
+std::string DeviceRegistry::name(uint32_t index) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return index < names_.size() ? names_[index] : std::string();
+}
+
+size_t DeviceRegistry::size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return names_.size();
+}
+
+}  // namespace iot_core::services
@@ -0,0 +1,35 @@
+// src/services/DeviceRegistry.h
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace iot_core::services {
+
+/**
+ * @brief Таблица интернирования идентификаторов устройств
+ *
+ * Сопоставляет строковому deviceId плотный числовой индекс, чтобы горячие
+ * таблицы хранили и сравнивали 32-битные ключи вместо строк. Индексы не
+ * переиспользуются; чтение идет под разделяемой блокировкой.
+ */
+class DeviceRegistry {
+ public:
+  // Индекс устройства; регистрирует новое при первом обращении
+  uint32_t intern(const std::string& deviceId);
+  // false если устройство еще не регистрировалось
+  bool find(const std::string& deviceId, uint32_t& index) const;
+  // Пустая строка для неизвестного индекса
+  std::string name(uint32_t index) const;
+
+  size_t size() const;
+
+ private:
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, uint32_t> indices_;
+  std::deque<std::string> names_;
+};
+
+}  // namespace iot_core::services
@@ -0,0 +1,249 @@
+#include "GroupAggregator.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace iot_core::services {
+
+GroupAggregator::GroupAggregator(Loader loader)
+    : GroupAggregator(std::move(loader), Options()) {}
+
+GroupAggregator::GroupAggregator(Loader loader, Options options)
+    : loader_(std::move(loader)),
+      options_(options),
+      staleUs_(std::chrono::duration_cast<std::chrono::microseconds>(
+                   options.staleAfter)
+                   .count()),
+      snapshot_(std::make_shared<const Snapshot>()) {}
+
+std::shared_ptr<const GroupAggregator::Snapshot> GroupAggregator::snapshot() {
+  reloadIfNeeded();
+  return std::atomic_load(&snapshot_);
+}
+
+void GroupAggregator::reloadIfNeeded() {
+  if (!dirty_) {
+    return;
+  }
+  // Загружает один шард, остальные продолжают со старым составом
+  std::unique_lock<std::mutex> lock(reloadMutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  if (failed_ && now - lastFailure_ < options_.reloadRetry) {
+    return;
+  }
+
+  // Флаг снимается до запроса: изменение во время загрузки вызовет
+  // следующую
+  dirty_ = false;
+  std::vector<models::DeviceGroup> groups;
+  std::vector<models::GroupAlertRule> rules;
+  if (!loader_(groups, rules)) {
+    dirty_ = true;
+    failed_ = true;
+    lastFailure_ = now;
+    return;
+  }
+  failed_ = false;
+
+  auto previous = std::atomic_load(&snapshot_);
+  auto next = std::make_shared<Snapshot>();
+  for (auto& info : groups) {
+    auto group = std::make_shared<Group>();
+    group->info = std::move(info);
+    group->members.reserve(group->info.deviceIds.size());
+    for (const auto& deviceId : group->info.deviceIds) {
+      Member member;
+      member.deviceId = deviceId;
+      group->members.push_back(std::move(member));
+    }
+
+    // Последние показания оставшихся участников сохраняются
+    auto old = previous->byId.find(group->info.id);
+    if (old != previous->byId.end()) {
+      std::lock_guard<std::mutex> oldLock(old->second->mutex);
+      for (auto& member : group->members) {
+        for (const auto& known : old->second->members) {
+          if (known.deviceId == member.deviceId) {
+            member = known;
+            break;
+          }
+        }
+      }
+    }
+
+    int64_t latestUs = 0;
+    for (const auto& member : group->members) {
+      latestUs = std::max(latestUs, member.timestampUs);
+    }
+    rescan(*group, latestUs);
+
+    for (size_t i = 0; i < group->members.size(); ++i) {
+      next->byDevice[group->members[i].deviceId].emplace_back(group, i);
+    }
+    next->byId[group->info.id] = std::move(group);
+  }
+
+  for (auto& rule : rules) {
+    auto it = next->byId.find(rule.groupId);
+    if (it != next->byId.end()) {
+      it->second->rules.push_back(std::move(rule));
+    }
+  }
+
+  std::atomic_store(&snapshot_,
+                    std::shared_ptr<const Snapshot>(std::move(next)));
+  reloads_++;
+
+  std::cout << "🏢 Загружено групп устройств: " << groups.size()
+            << ", правил: " << rules.size() << std::endl;
+}
+
+void GroupAggregator::update(const std::string& deviceId, double temperature,
+                             double humidity, int64_t timestampUs,
+                             const Callback& fn) {
+  auto current = snapshot();
+  auto it = current->byDevice.find(deviceId);
+  if (it == current->byDevice.end()) {
+    return;
+  }
+
+  for (const auto& [group, index] : it->second) {
+    std::lock_guard<std::mutex> lock(group->mutex);
+    // Показание старее уже учтенного (опрос отстал от потока) не
+    // откатывает агрегаты назад
+    if (timestampUs <= group->members[index].timestampUs) {
+      continue;
+    }
+    apply(*group, index, temperature, humidity, timestampUs);
+    updates_++;
+    if (fn) {
+      fn(GroupView{group->info, group->aggregate, group->rules});
+    }
+  }
+}
+
+void GroupAggregator::apply(Group& group, size_t index, double temperature,
+                            double humidity, int64_t timestampUs) {
+  auto& member = group.members[index];
+  auto& aggregate = group.aggregate;
+  bool rescanNeeded = false;
+
+  if (!member.reporting) {
+    // Участник вошел в агрегаты: экстремумы только расширяются
+    if (aggregate.reporting == 0) {
+      aggregate.temperatureMin = aggregate.temperatureMax = temperature;
+      aggregate.humidityMin = aggregate.humidityMax = humidity;
+      group.oldestUs = timestampUs;
+    }
+    aggregate.reporting++;
+    group.temperatureSum += temperature;
+    group.humiditySum += humidity;
+  } else {
+    group.temperatureSum += temperature - member.temperature;
+    group.humiditySum += humidity - member.humidity;
+    // Значение, на котором держался экстремум, отступило внутрь -
+    // новый экстремум неизвестен без обхода участников
+    rescanNeeded =
+        (member.temperature == aggregate.temperatureMin &&
+         temperature > member.temperature) ||
+        (member.temperature == aggregate.temperatureMax &&
+         temperature < member.temperature) ||
+        (member.humidity == aggregate.humidityMin &&
+         humidity > member.humidity) ||
+        (member.humidity == aggregate.humidityMax &&
+         humidity < member.humidity);
+  }
+
+  member.temperature = temperature;
+  member.humidity = humidity;
+  member.timestampUs = timestampUs;
+  member.reporting = true;
+  aggregate.updatedAtUs = timestampUs;
+
+  // oldestUs - нижняя граница: устаревших участников быть не может,
+  // пока она в пределах staleAfter
+  if (rescanNeeded || timestampUs - group.oldestUs > staleUs_) {
+    rescan(group, timestampUs);
+    return;
+  }
+
+  aggregate.temperatureMin = std::min(aggregate.temperatureMin, temperature);
+  aggregate.temperatureMax = std::max(aggregate.temperatureMax, temperature);
+  aggregate.humidityMin = std::min(aggregate.humidityMin, humidity);
+  aggregate.humidityMax = std::max(aggregate.humidityMax, humidity);
+  aggregate.temperatureMean =
+      group.temperatureSum / static_cast<double>(aggregate.reporting);
+  aggregate.humidityMean =
+      group.humiditySum / static_cast<double>(aggregate.reporting);
+}
+
+void GroupAggregator::rescan(Group& group, int64_t nowUs) {
+  auto& aggregate = group.aggregate;
+  int64_t updatedAtUs = aggregate.updatedAtUs;
+  aggregate = models::GroupAggregate();
+  aggregate.members = group.members.size();
+  aggregate.updatedAtUs = updatedAtUs;
+  group.temperatureSum = 0.0;
+  group.humiditySum = 0.0;
+  group.oldestUs = std::numeric_limits<int64_t>::max();
+
+  for (auto& member : group.members) {
+    member.reporting =
+        member.timestampUs > 0 && nowUs - member.timestampUs <= staleUs_;
+    if (!member.reporting) {
+      continue;
+    }
+    if (aggregate.reporting == 0) {
+      aggregate.temperatureMin = aggregate.temperatureMax = member.temperature;
+      aggregate.humidityMin = aggregate.humidityMax = member.humidity;
+    }
+    aggregate.reporting++;
+    // Суммы пересчитываются заново: накопленная погрешность сбрасывается
+    group.temperatureSum += member.temperature;
+    group.humiditySum += member.humidity;
+    aggregate.temperatureMin =
+        std::min(aggregate.temperatureMin, member.temperature);
+    aggregate.temperatureMax =
+        std::max(aggregate.temperatureMax, member.temperature);
+    aggregate.humidityMin = std::min(aggregate.humidityMin, member.humidity);
+    aggregate.humidityMax = std::max(aggregate.humidityMax, member.humidity);
+    group.oldestUs = std::min(group.oldestUs, member.timestampUs);
+  }
+
+  if (aggregate.reporting > 0) {
+    aggregate.temperatureMean =
+        group.temperatureSum / static_cast<double>(aggregate.reporting);
+    aggregate.humidityMean =
+        group.humiditySum / static_cast<double>(aggregate.reporting);
+  } else {
+    group.oldestUs = nowUs;
+  }
+  rescans_++;
+}
+
+bool GroupAggregator::getAggregate(int groupId,
+                                   models::GroupAggregate& out) const {
+  auto current = std::atomic_load(&snapshot_);
+  auto it = current->byId.find(groupId);
+  if (it == current->byId.end()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(it->second->mutex);
+  out = it->second->aggregate;
+  return true;
+}
+
+GroupAggregator::Statistics GroupAggregator::getStatistics() const {
+  Statistics stats;
+  stats.groups = std::atomic_load(&snapshot_)->byId.size();
+  stats.updates = updates_.load();
+  stats.rescans = rescans_.load();
+  stats.reloads = reloads_.load();
+  return stats;
+}
+
+}  // namespace iot_core::services
@@ -0,0 +1,137 @@
+// src/services/GroupAggregator.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../models/IoTData.h"
+
+namespace iot_core::services {
+
+/**
+ * @brief Текущие агрегаты групп устройств, обновляемые по каждому показанию
+ *
+ * Для группы хранятся последние показания участников, суммы и минимум/
+ * максимум по тем, кто отчитывался не позже staleAfter назад. Показание
+ * участника меняет сумму на разницу со своим прошлым значением и
+ * сдвигает экстремумы - O(1). Полный пересчет по участникам группы
+ * нужен, только если отступил текущий экстремум или кто-то из
+ * участников перестал отчитываться (его показание старше staleAfter
+ * относительно свежего показания группы).
+ *
+ * Состав групп - неизменяемый снимок, который подменяется целиком;
+ * изменения в БД только помечают его устаревшим, перезагрузка идет при
+ * следующем показании. Показания участников переносятся в новый снимок.
+ */
+class GroupAggregator {
+ public:
+  struct Options {
+    // Участник без показаний дольше этого не входит в агрегаты
+    std::chrono::seconds staleAfter{900};
+    // Пауза между попытками загрузки после ошибки БД
+    std::chrono::seconds reloadRetry{5};
+  };
+
+  // Группа, ее агрегаты после показания и правила
+  struct GroupView {
+    const models::DeviceGroup& group;
+    const models::GroupAggregate& aggregate;
+    const std::vector<models::GroupAlertRule>& rules;
+  };
+
+  using Callback = std::function<void(const GroupView&)>;
+
+  // Все группы с участниками и все правила; false - ошибка
+  using Loader =
+      std::function<bool(std::vector<models::DeviceGroup>& groups,
+                         std::vector<models::GroupAlertRule>& rules)>;
+
+  struct Statistics {
+    size_t groups = 0;
+    uint64_t updates = 0;
+    uint64_t rescans = 0;
+    uint64_t reloads = 0;
+  };
+
+  explicit GroupAggregator(Loader loader);
+  GroupAggregator(Loader loader, Options options);
+
+  GroupAggregator(const GroupAggregator&) = delete;
+  GroupAggregator& operator=(const GroupAggregator&) = delete;
+
+  // Показание устройства: обновляет все его группы и для каждой
+  // вызывает fn под блокировкой группы - оценки одной группы из разных
+  // шардов идут по очереди
+  void update(const std::string& deviceId, double temperature,
+              double humidity, int64_t timestampUs, const Callback& fn);
+
+  // false - группы нет (или состав еще не загружен)
+  bool getAggregate(int groupId, models::GroupAggregate& out) const;
+
+  // Состав групп или правила изменились в БД
+  void invalidate() { dirty_ = true; }
+
+  Statistics getStatistics() const;
+
+ private:
+  struct Member {
+    std::string deviceId;
+    double temperature = 0.0;
+    double humidity = 0.0;
+    int64_t timestampUs = 0;
+    bool reporting = false;
+  };
+
+  struct Group {
+    models::DeviceGroup info;
+    std::vector<models::GroupAlertRule> rules;
+
+    mutable std::mutex mutex;
+    std::vector<Member> members;
+    double temperatureSum = 0.0;
+    double humiditySum = 0.0;
+    models::GroupAggregate aggregate;
+    // Нижняя граница времени показаний отчитывающихся участников
+    int64_t oldestUs = 0;
+  };
+
+  struct Snapshot {
+    // Устройство -> (группа, индекс участника)
+    std::unordered_map<std::string,
+                       std::vector<std::pair<std::shared_ptr<Group>, size_t>>>
+        byDevice;
+    std::unordered_map<int, std::shared_ptr<Group>> byId;
+  };
+
+  std::shared_ptr<const Snapshot> snapshot();
+  // Загрузка нового состава, если он помечен устаревшим
+  void reloadIfNeeded();
+
+  // Вызывать под mutex группы
+  void apply(Group& group, size_t index, double temperature, double humidity,
+             int64_t timestampUs);
+  void rescan(Group& group, int64_t nowUs);
+
+  Loader loader_;
+  Options options_;
+  int64_t staleUs_;
+
+  std::shared_ptr<const Snapshot> snapshot_;
+  std::atomic<bool> dirty_{true};
+  std::mutex reloadMutex_;
+  std::chrono::steady_clock::time_point lastFailure_;
+  bool failed_ = false;
+
+  std::atomic<uint64_t> updates_{0};
+  std::atomic<uint64_t> rescans_{0};
+  std::atomic<uint64_t> reloads_{0};
+};
+
+}  // namespace iot_core::services
@@ -0,0 +1,107 @@
+#include "HeartbeatMonitor.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace iot_core::services {
+
+HeartbeatMonitor::HeartbeatMonitor(Options options,
+                                   std::shared_ptr<DeviceRegistry> devices)
+    : options_(options),
+      timeoutUs_(std::chrono::duration_cast<std::chrono::microseconds>(
+                     options.timeout)
+                     .count()),
+      tickUs_(std::max<int64_t>(
+          1, std::chrono::duration_cast<std::chrono::microseconds>(
+                 options.tick)
+                 .count())),
+      devices_(std::move(devices)) {}
+
+uint64_t HeartbeatMonitor::tickFor(int64_t timeUs) const {
+  // Округление вверх: срабатывание не раньше срока
+  return static_cast<uint64_t>((std::max<int64_t>(timeUs, 0) + tickUs_ - 1) /
+                               tickUs_);
+}
+
+void HeartbeatMonitor::arm(uint32_t device) {
+  wheel_.schedule(tickFor(lastSeenUs_[device] + timeoutUs_), device);
+  flags_[device] |= kArmed;
+}
+
+bool HeartbeatMonitor::heartbeat(const std::string& deviceId, int64_t nowUs,
+                                 Event& event) {
+  uint32_t device = devices_->intern(deviceId);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (device >= lastSeenUs_.size()) {
+    lastSeenUs_.resize(device + 1, 0);
+    flags_.resize(device + 1, 0);
+  }
+  // Пустое колесо начинает с текущего времени, а не с нулевого тика
+  if (wheel_.size() == 0) {
+    wheel_.advance(tickFor(nowUs), [](uint32_t) {});
+  }
+
+  int64_t previous = lastSeenUs_[device];
+  if ((flags_[device] & kSeen) == 0) {
+    flags_[device] |= kSeen;
+    ++tracked_;
+  }
+  lastSeenUs_[device] = std::max(previous, nowUs);
+
+  bool cameOnline = (flags_[device] & kOffline) != 0;
+  if (cameOnline) {
+    flags_[device] &= ~kOffline;
+    --offline_;
+    ++onlineEvents_;
+    event = Event{deviceId, true, previous, nowUs};
+  }
+  // Срок проверяется при срабатывании записи, перестановка не нужна
+  if ((flags_[device] & kArmed) == 0) {
+    arm(device);
+  }
+  return cameOnline;
+}
+
+std::vector<HeartbeatMonitor::Event> HeartbeatMonitor::advance(
+    int64_t nowUs) {
+  // Устройство и его последний контакт
+  std::vector<std::pair<uint32_t, int64_t>> silent;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wheel_.advance(tickFor(nowUs), [this, &silent](uint32_t device) {
+      int64_t expiredAtUs =
+          static_cast<int64_t>(wheel_.currentTick()) * tickUs_;
+      if (lastSeenUs_[device] + timeoutUs_ > expiredAtUs) {
+        // Контакт был после постановки - новый срок
+        arm(device);
+        return;
+      }
+      flags_[device] = kSeen | kOffline;
+      ++offline_;
+      ++offlineEvents_;
+      silent.emplace_back(device, lastSeenUs_[device]);
+    });
+  }
+
+  // Имена - вне блокировки, у реестра своя
+  std::vector<Event> events;
+  events.reserve(silent.size());
+  for (const auto& [device, lastSeenUs] : silent) {
+    events.push_back(Event{devices_->name(device), false, lastSeenUs, nowUs});
+  }
+  return events;
+}
+
+HeartbeatMonitor::Statistics HeartbeatMonitor::getStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics stats;
+  stats.tracked = tracked_;
+  stats.offline = offline_;
+  stats.timers = wheel_.size();
+  stats.offlineEvents = offlineEvents_;
+  stats.onlineEvents = onlineEvents_;
+  return stats;
+}
+
+}  // namespace iot_core::services
@@ -0,0 +1,90 @@
+// src/services/HeartbeatMonitor.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../utils/TimingWheel.h"
+#include "DeviceRegistry.h"
+
+namespace iot_core::services {
+
+/**
+ * @brief Обнаружение устройств, переставших присылать данные
+ *
+ * Показание обновляет время последнего контакта устройства - O(1), без
+ * перестановки таймера. На устройство в колесе таймеров (см.
+ * utils::TimingWheel) лежит не больше одной записи: при срабатывании
+ * она сверяется с последним контактом и либо переносится на новый срок,
+ * либо переводит устройство в offline. Следующее показание такого
+ * устройства дает событие "снова в сети".
+ *
+ * Состояние - плотные массивы по интернированному индексу устройства:
+ * 8 байт времени, байт флагов и запись колеса (16 байт), то есть на
+ * миллион устройств - десятки мегабайт независимо от частоты показаний.
+ */
+class HeartbeatMonitor {
+ public:
+  struct Options {
+    std::chrono::seconds timeout{300};
+    std::chrono::milliseconds tick{1000};
+  };
+
+  struct Event {
+    std::string deviceId;
+    bool online = false;      // false - устройство пропало
+    int64_t lastSeenUs = 0;   // последний контакт до события
+    int64_t timestampUs = 0;  // момент обнаружения
+  };
+
+  struct Statistics {
+    size_t tracked = 0;  // устройств с хотя бы одним показанием
+    size_t offline = 0;  // сейчас не в сети
+    size_t timers = 0;   // записей в колесе
+    uint64_t offlineEvents = 0;
+    uint64_t onlineEvents = 0;
+  };
+
+  explicit HeartbeatMonitor(Options options,
+                            std::shared_ptr<DeviceRegistry> devices =
+                                std::make_shared<DeviceRegistry>());
+
+  HeartbeatMonitor(const HeartbeatMonitor&) = delete;
+  HeartbeatMonitor& operator=(const HeartbeatMonitor&) = delete;
+
+  // Контакт с устройством; true и event - если оно считалось offline
+  bool heartbeat(const std::string& deviceId, int64_t nowUs, Event& event);
+
+  // Продвигает время до nowUs; устройства без контакта дольше timeout
+  std::vector<Event> advance(int64_t nowUs);
+
+  Statistics getStatistics() const;
+  std::chrono::seconds timeout() const { return options_.timeout; }
+
+ private:
+  enum Flags : uint8_t { kSeen = 1, kArmed = 2, kOffline = 4 };
+
+  uint64_t tickFor(int64_t timeUs) const;
+  // Вызывать под mutex_
+  void arm(uint32_t device);
+
+  Options options_;
+  int64_t timeoutUs_;
+  int64_t tickUs_;
+  std::shared_ptr<DeviceRegistry> devices_;
+
+  mutable std::mutex mutex_;
+  // По индексу устройства
+  std::vector<int64_t> lastSeenUs_;
+  std::vector<uint8_t> flags_;
+  utils::TimingWheel<uint32_t> wheel_;
+  size_t tracked_ = 0;
+  size_t offline_ = 0;
+  uint64_t offlineEvents_ = 0;
+  uint64_t onlineEvents_ = 0;
+};
+
+}  // namespace iot_core::services
@@ -0,0 +1,147 @@
+#include "ShardedExecutor.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace iot_core::services {
+
+ShardedExecutor::ShardedExecutor(size_t shards, size_t queueCapacity)
+    : queueCapacity_(std::max<size_t>(1, queueCapacity)) {
+  shards = std::max<size_t>(1, shards);
+  shards_.reserve(shards);
+  for (size_t i = 0; i < shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+  for (auto& shard : shards_) {
+    Shard* raw = shard.get();
+    raw->worker = std::thread([this, raw]() { workerLoop(*raw); });
+  }
+}
+
+ShardedExecutor::~ShardedExecutor() { stop(); }
+
+size_t ShardedExecutor::shardFor(const std::string& key) const {
+  return std::hash<std::string>{}(key) % shards_.size();
+}
+
+bool ShardedExecutor::submit(size_t shardIndex, Task task) {
+  return enqueue(*shards_[shardIndex % shards_.size()], std::move(task),
+                 true);
+}
+
+bool ShardedExecutor::post(size_t shardIndex, Task task) {
+  if (!enqueue(*shards_[shardIndex % shards_.size()], std::move(task),
+               false)) {
+    return false;
+  }
+  ++posted_;
+  return true;
+}
+
+bool ShardedExecutor::enqueue(Shard& shard, Task task, bool wait) {
+  {
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    if (wait) {
+      shard.notFull.wait(lock, [&]() {
+        return shard.stopping || shard.queue.size() < queueCapacity_;
+      });
+    }
+    if (shard.stopping) {
+      return false;
+    }
+
+    shard.queue.push_back(std::move(task));
+    ++shard.submitted;
+    shard.maxQueueDepth = std::max(shard.maxQueueDepth, shard.queue.size());
+  }
+  shard.notEmpty.notify_one();
+  return true;
+}
+
+void ShardedExecutor::drain() {
+  // Продолжение может попасть в уже пройденный шард - тогда проход
+  // повторяется
+  uint64_t posted = 0;
+  do {
+    posted = posted_.load();
+    for (auto& shard : shards_) {
+      std::unique_lock<std::mutex> lock(shard->mutex);
+      uint64_t target = shard->submitted;
+      shard->idle.wait(lock, [&]() { return shard->executed >= target; });
+    }
+  } while (posted_.load() != posted);
+}
+
+void ShardedExecutor::stop() {
+  for (auto& shard : shards_) {
+    {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      shard->stopping = true;
+    }
+    shard->notEmpty.notify_all();
+    shard->notFull.notify_all();
+  }
+
+  for (auto& shard : shards_) {
+    if (shard->worker.joinable() &&
+        shard->worker.get_id() != std::this_thread::get_id()) {
+      shard->worker.join();
+    }
+  }
+}
+
+ShardedExecutor::Statistics ShardedExecutor::getStatistics() const {
+  Statistics stats;
+  stats.shards = shards_.size();
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.submitted += shard->submitted;
+    stats.executed += shard->executed;
+    stats.failed += shard->failed;
+    stats.queued += shard->queue.size();
+    stats.maxQueueDepth = std::max(stats.maxQueueDepth, shard->maxQueueDepth);
+  }
+  return stats;
+}
+
+void ShardedExecutor::workerLoop(Shard& shard) {
+  std::unique_lock<std::mutex> lock(shard.mutex);
+
+  while (true) {
+    shard.notEmpty.wait(
+        lock, [&]() { return shard.stopping || !shard.queue.empty(); });
+    // При остановке очередь дорабатывается до конца
+    if (shard.queue.empty()) {
+      break;
+    }
+
+    Task task = std::move(shard.queue.front());
+    shard.queue.pop_front();
+    lock.unlock();
+    shard.notFull.notify_one();
+
+    bool ok = true;
+    try {
+      task();
+    } catch (const std::exception& e) {
+      ok = false;
+      std::cerr << "❌ Ошибка в задаче обработчика оповещений: " << e.what()
+                << std::endl;
+    } catch (...) {
+      ok = false;
+      std::cerr << "❌ Неизвестная ошибка в задаче обработчика оповещений"
+                << std::endl;
+    }
+
+    lock.lock();
+    ++shard.executed;
+    if (!ok) {
+      ++shard.failed;
+    }
+    shard.idle.notify_all();
+  }
+
+  shard.idle.notify_all();
+}
+
+}  // namespace iot_core::services
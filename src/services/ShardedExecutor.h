@@ -0,0 +1,84 @@
+// src/services/ShardedExecutor.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace iot_core::services {
+
+/**
+ * @brief Пул потоков с привязкой задач к шардам
+ *
+ * Каждый шард - своя очередь и единственный поток-обработчик, поэтому
+ * задачи одного шарда (одного устройства) выполняются строго по порядку
+ * постановки, а разные шарды работают параллельно. При заполненной
+ * очереди submit блокируется - это естественное противодавление на
+ * источники данных.
+ */
+class ShardedExecutor {
+ public:
+  using Task = std::function<void()>;
+
+  struct Statistics {
+    size_t shards = 0;
+    uint64_t submitted = 0;
+    uint64_t executed = 0;
+    uint64_t failed = 0;  // задачи, завершившиеся исключением
+    size_t queued = 0;
+    size_t maxQueueDepth = 0;
+  };
+
+  explicit ShardedExecutor(size_t shards, size_t queueCapacity = 10000);
+  ~ShardedExecutor();
+
+  ShardedExecutor(const ShardedExecutor&) = delete;
+  ShardedExecutor& operator=(const ShardedExecutor&) = delete;
+
+  size_t shardCount() const { return shards_.size(); }
+  size_t shardFor(const std::string& key) const;
+
+  // false если исполнитель остановлен (задача не принята)
+  bool submit(size_t shard, Task task);
+  // Продолжение из задачи другого шарда: не ждет места в очереди, иначе
+  // два шарда с полными очередями ждали бы друг друга
+  bool post(size_t shard, Task task);
+  // Ждет, пока все поставленные до вызова задачи и их продолжения
+  // будут выполнены; нельзя вызывать из задачи
+  void drain();
+  // Выполняет оставшиеся задачи и останавливает потоки
+  void stop();
+
+  Statistics getStatistics() const;
+
+ private:
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::condition_variable idle;
+    std::deque<Task> queue;
+    bool stopping = false;
+    uint64_t submitted = 0;
+    uint64_t executed = 0;
+    uint64_t failed = 0;
+    size_t maxQueueDepth = 0;
+    std::thread worker;
+  };
+
+  void workerLoop(Shard& shard);
+
+  bool enqueue(Shard& shard, Task task, bool wait);
+
+  size_t queueCapacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<uint64_t> posted_{0};
+};
+
+}  // namespace iot_core::services
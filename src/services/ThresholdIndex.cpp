@@ -0,0 +1,219 @@
+#include "ThresholdIndex.h"
+
+#include <mutex>
+
+namespace iot_core::services {
+
+namespace {
+
+constexpr AlertKind kKinds[] = {AlertKind::TemperatureHigh,
+                                AlertKind::TemperatureLow,
+                                AlertKind::HumidityHigh,
+                                AlertKind::HumidityLow};
+
+double thresholdOf(const models::UserAlert& alert, AlertKind kind) {
+  switch (kind) {
+    case AlertKind::TemperatureHigh:
+      return alert.temperatureHighThreshold;
+    case AlertKind::TemperatureLow:
+      return alert.temperatureLowThreshold;
+    case AlertKind::HumidityHigh:
+      return alert.humidityHighThreshold;
+    case AlertKind::HumidityLow:
+      return alert.humidityLowThreshold;
+    case AlertKind::Offline:
+    case AlertKind::Anomaly:
+    case AlertKind::Other:
+      break;
+  }
+  return 0.0;
+}
+
+bool byThresholdThenUser(const ThresholdIndex::Subscriber& a,
+                         const ThresholdIndex::Subscriber& b) {
+  return a.threshold < b.threshold ||
+         (a.threshold == b.threshold && a.userId < b.userId);
+}
+
+}  // namespace
+
+bool ThresholdIndex::DeviceThresholds::exceeds(AlertKind kind, double value,
+                                               double threshold) {
+  if (threshold <= 0) {
+    return false;
+  }
+  if (kind == AlertKind::TemperatureHigh || kind == AlertKind::HumidityHigh) {
+    return value > threshold;
+  }
+  return value < threshold;
+}
+
+double ThresholdIndex::DeviceThresholds::threshold(long userId,
+                                                   AlertKind kind) const {
+  auto it = alerts_.find(userId);
+  return it == alerts_.end() ? 0.0 : thresholdOf(it->second, kind);
+}
+
+bool ThresholdIndex::DeviceThresholds::hasSubscriber(long userId) const {
+  return alerts_.count(userId) > 0;
+}
+
+void ThresholdIndex::DeviceThresholds::insert(long userId,
+                                              const models::UserAlert& alert) {
+  alerts_[userId] = alert;
+  for (AlertKind kind : kKinds) {
+    double threshold = thresholdOf(alert, kind);
+    if (threshold > 0) {
+      byKind_[static_cast<size_t>(kind)].push_back(
+          Subscriber{threshold, userId});
+    }
+  }
+}
+
+void ThresholdIndex::DeviceThresholds::update(long userId,
+                                              const models::UserAlert& alert) {
+  auto it = alerts_.find(userId);
+  if (it == alerts_.end()) {
+    return;
+  }
+
+  for (AlertKind kind : kKinds) {
+    double before = thresholdOf(it->second, kind);
+    double after = thresholdOf(alert, kind);
+    if (before == after) {
+      continue;
+    }
+
+    // Массив уже отсортирован: удаление и вставка на место - O(n)
+    // без полной пересортировки
+    auto& sorted = byKind_[static_cast<size_t>(kind)];
+    if (before > 0) {
+      auto old = std::lower_bound(sorted.begin(), sorted.end(),
+                                  Subscriber{before, userId},
+                                  byThresholdThenUser);
+      if (old != sorted.end() && old->userId == userId) {
+        sorted.erase(old);
+      }
+    }
+    if (after > 0) {
+      Subscriber subscriber{after, userId};
+      sorted.insert(std::lower_bound(sorted.begin(), sorted.end(), subscriber,
+                                     byThresholdThenUser),
+                    subscriber);
+    }
+  }
+  it->second = alert;
+}
+
+ThresholdIndex::ThresholdIndex(Loader loader) : loader_(std::move(loader)) {}
+
+bool ThresholdIndex::expired(const Cached& cached,
+                             Clock::time_point now) const {
+  return maxAge_ > Clock::duration::zero() && now - cached.loadedAt >= maxAge_;
+}
+
+void ThresholdIndex::setMaxAge(std::chrono::seconds maxAge) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  maxAge_ = maxAge;
+}
+
+std::shared_ptr<const ThresholdIndex::DeviceThresholds> ThresholdIndex::get(
+    const std::string& deviceId, Clock::time_point now) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = devices_.find(deviceId);
+    if (it != devices_.end() && !expired(it->second, now)) {
+      return it->second.thresholds;
+    }
+  }
+
+  uint64_t generation = 0;
+  std::shared_ptr<const DeviceThresholds> stale;
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = devices_.find(deviceId);
+    if (it != devices_.end()) {
+      // Перезагрузку начинает один читатель: остальные до ее конца
+      // получают прежний снимок
+      if (!expired(it->second, now)) {
+        return it->second.thresholds;
+      }
+      it->second.loadedAt = now;
+      stale = it->second.thresholds;
+      ++refreshes_;
+    }
+    generation = generation_;
+  }
+
+  auto thresholds = load(deviceId);
+  if (!thresholds) {
+    // Старый снимок лучше никакого; повтор - через maxAge
+    return stale;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  ++loads_;
+  if (generation == generation_) {
+    devices_[deviceId] = Cached{thresholds, now};
+  }
+  return thresholds;
+}
+
+std::shared_ptr<const ThresholdIndex::DeviceThresholds> ThresholdIndex::load(
+    const std::string& deviceId) {
+  // Запрос к БД - без блокировки индекса: обработчики изменений
+  // вызываются под блокировкой соединения и сами берут блокировку индекса
+  std::vector<std::pair<long, models::UserAlert>> subscribers;
+  if (!loader_(deviceId, subscribers)) {
+    return nullptr;
+  }
+
+  auto thresholds = std::make_shared<DeviceThresholds>();
+  for (const auto& [userId, alert] : subscribers) {
+    thresholds->insert(userId, alert);
+  }
+  for (auto& sorted : thresholds->byKind_) {
+    std::sort(sorted.begin(), sorted.end(), byThresholdThenUser);
+  }
+  return thresholds;
+}
+
+void ThresholdIndex::onAlertChanged(long userId,
+                                    const models::UserAlert& alert) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  ++generation_;
+
+  // Пороги меняются командами пользователей - редко, поэтому обход
+  // загруженных устройств дешевле обратного индекса пользователь ->
+  // устройства
+  for (auto& [deviceId, cached] : devices_) {
+    if (!cached.thresholds->hasSubscriber(userId)) {
+      continue;
+    }
+    auto updated = std::make_shared<DeviceThresholds>(*cached.thresholds);
+    updated->update(userId, alert);
+    cached.thresholds = std::move(updated);
+    ++updates_;
+  }
+}
+
+void ThresholdIndex::onSubscriptionChanged(long userId,
+                                           const std::string& deviceId) {
+  (void)userId;
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  ++generation_;
+  devices_.erase(deviceId);
+}
+
+ThresholdIndex::Statistics ThresholdIndex::getStatistics() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  Statistics stats;
+  stats.devices = devices_.size();
+  stats.loads = loads_;
+  stats.updates = updates_;
+  stats.refreshes = refreshes_;
+  return stats;
+}
+
+}  // namespace iot_core::services
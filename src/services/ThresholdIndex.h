@@ -0,0 +1,151 @@
+// src/services/ThresholdIndex.h
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../models/IoTData.h"
+#include "AlertDeduplicator.h"
+
+namespace iot_core::services {
+
+/**
+ * @brief Пороги подписчиков устройства, отсортированные по значению
+ *
+ * Для каждого из четырех типов правил - массив (порог, пользователь) по
+ * возрастанию порога. Правила "выше" срабатывают у префикса массива до
+ * значения показания, правила "ниже" - у суффикса после него, поэтому
+ * одно показание находит всех сработавших подписчиков за O(log n + k)
+ * вместо проверки каждого.
+ *
+ * Индекс хранит по устройству неизменяемый снимок порогов: читатели
+ * работают со снимком без блокировок, изменение порогов собирает новый
+ * снимок и подменяет его (копирование при записи). Снимок загружается
+ * при первом показании устройства; изменение подписки его сбрасывает,
+ * изменение порогов правит точечно.
+ *
+ * Точечные правки видят только изменения, сделанные этим узлом. Когда
+ * узлов несколько (общая очередь уведомлений), снимок живет не дольше
+ * maxAge и перечитывается из БД: первый читатель устаревшего снимка
+ * загружает новый, остальные до замены работают со старым.
+ */
+class ThresholdIndex {
+ public:
+  struct Subscriber {
+    double threshold = 0.0;
+    long userId = 0;
+  };
+
+  class DeviceThresholds {
+   public:
+    // true - значение за порогом правила данного типа
+    static bool exceeds(AlertKind kind, double value, double threshold);
+
+    // fn(userId, threshold) для каждого правила, за порог которого
+    // вышло значение
+    template <typename Fn>
+    void forEachTriggered(AlertKind kind, double value, Fn&& fn) const {
+      const auto& sorted = byKind_[static_cast<size_t>(kind)];
+      auto byThreshold = [](const Subscriber& subscriber, double v) {
+        return subscriber.threshold < v;
+      };
+      if (kind == AlertKind::TemperatureHigh ||
+          kind == AlertKind::HumidityHigh) {
+        auto end = std::lower_bound(sorted.begin(), sorted.end(), value,
+                                    byThreshold);
+        for (auto it = sorted.begin(); it != end; ++it) {
+          fn(it->userId, it->threshold);
+        }
+      } else {
+        auto begin = std::upper_bound(
+            sorted.begin(), sorted.end(), value,
+            [](double v, const Subscriber& subscriber) {
+              return v < subscriber.threshold;
+            });
+        for (auto it = begin; it != sorted.end(); ++it) {
+          fn(it->userId, it->threshold);
+        }
+      }
+    }
+
+    // Порог правила пользователя; 0 - правила нет или он не подписан
+    double threshold(long userId, AlertKind kind) const;
+    bool hasSubscriber(long userId) const;
+    size_t subscribers() const { return alerts_.size(); }
+
+   private:
+    friend class ThresholdIndex;
+
+    // Перестраивает массивы типов, в которых порог пользователя изменился
+    void update(long userId, const models::UserAlert& alert);
+    void insert(long userId, const models::UserAlert& alert);
+
+    std::array<std::vector<Subscriber>, 4> byKind_;
+    std::unordered_map<long, models::UserAlert> alerts_;
+  };
+
+  // Загрузка подписчиков устройства с порогами; false - ошибка
+  using Loader = std::function<bool(
+      const std::string& deviceId,
+      std::vector<std::pair<long, models::UserAlert>>& subscribers)>;
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Statistics {
+    size_t devices = 0;
+    uint64_t loads = 0;
+    uint64_t updates = 0;
+    uint64_t refreshes = 0;
+  };
+
+  explicit ThresholdIndex(Loader loader);
+
+  ThresholdIndex(const ThresholdIndex&) = delete;
+  ThresholdIndex& operator=(const ThresholdIndex&) = delete;
+
+  // Снимок порогов устройства; nullptr если загрузить не удалось
+  std::shared_ptr<const DeviceThresholds> get(
+      const std::string& deviceId, Clock::time_point now = Clock::now());
+
+  // Срок жизни снимка; 0 - снимок живет до локального изменения
+  void setMaxAge(std::chrono::seconds maxAge);
+
+  // Пороги пользователя изменились (нули - сброшены)
+  void onAlertChanged(long userId, const models::UserAlert& alert);
+  // Пользователь подписался на устройство или отписался
+  void onSubscriptionChanged(long userId, const std::string& deviceId);
+
+  Statistics getStatistics() const;
+
+ private:
+  struct Cached {
+    std::shared_ptr<const DeviceThresholds> thresholds;
+    // Загрузка или начало перезагрузки снимка
+    Clock::time_point loadedAt;
+  };
+
+  bool expired(const Cached& cached, Clock::time_point now) const;
+  std::shared_ptr<const DeviceThresholds> load(const std::string& deviceId);
+
+  Loader loader_;
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, Cached> devices_;
+  Clock::duration maxAge_{0};
+  // Меняется при каждом изменении: загрузка, которую обогнало
+  // изменение, используется один раз и не кэшируется
+  uint64_t generation_ = 0;
+  uint64_t loads_ = 0;
+  uint64_t updates_ = 0;
+  uint64_t refreshes_ = 0;
+};
+
+}  // namespace iot_core::services
@@ -84,6 +84,12 @@ EmailConfig EmailConfig::loadFromEnv() {
     config.password = get("SMTP_PASSWORD");
     config.fromEmail = get("SMTP_FROM", config.username);
 
+    try {
+      config.idleTimeoutSeconds = std::stoi(get("SMTP_IDLE_TIMEOUT", "60"));
+    } catch (...) {
+      config.idleTimeoutSeconds = 60;
+    }
+
     // Добавляем получателей из файла (можно указать через запятую)
     std::string recipientsStr = get("ALERT_RECIPIENTS", "");
     if (!recipientsStr.empty()) {
@@ -113,6 +119,7 @@ EmailConfig EmailConfig::loadFromEnv() {
     const char* username = std::getenv("SMTP_USERNAME");
     const char* password = std::getenv("SMTP_PASSWORD");
     const char* fromEmail = std::getenv("SMTP_FROM_EMAIL");
+    const char* idleTimeout = std::getenv("SMTP_IDLE_TIMEOUT");
 
     // Получатели оповещений из переменных окружения
     const char* alertEmail1 = std::getenv("ALERT_EMAIL_1");
@@ -139,6 +146,14 @@ EmailConfig EmailConfig::loadFromEnv() {
     if (password && password[0] != '\0') config.password = password;
     if (fromEmail && fromEmail[0] != '\0') config.fromEmail = fromEmail;
 
+    if (idleTimeout) {
+      try {
+        config.idleTimeoutSeconds = std::stoi(idleTimeout);
+      } catch (...) {
+        // Оставляем текущее значение
+      }
+    }
+
     // Добавляем получателей из переменных окружения
     if (alertEmail1 && alertEmail1[0] != '\0') {
       config.alertRecipients.push_back(alertEmail1);
@@ -178,6 +193,8 @@ EmailConfig EmailConfig::loadFromEnv() {
   std::cout << "   • Пользователь: " << config.username << std::endl;
   std::cout << "   • Пароль: ***" << std::endl;
   std::cout << "   • От: " << config.fromEmail << std::endl;
+  std::cout << "   • Таймаут простоя соединения: " << config.idleTimeoutSeconds
+            << " с" << std::endl;
   std::cout << "   • Получателей: " << config.alertRecipients.size()
             << std::endl;
 
@@ -12,6 +12,8 @@ struct EmailConfig {
   std::string password;
   std::string fromEmail;
   std::vector<std::string> alertRecipients;
+  // Простаивающее дольше SMTP-соединение открывается заново
+  int idleTimeoutSeconds = 60;
 
   // Загрузка конфигурации из файла smtp.conf и переменных окружения
   static EmailConfig loadFromEnv();
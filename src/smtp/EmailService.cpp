@@ -24,7 +24,85 @@ EmailService::EmailService() {
 }
 
 EmailService::~EmailService() {
-  // Освобождение ресурсов CURL
+  std::lock_guard<std::mutex> lock(sessionMutex_);
+  closeSessionLocked();
+}
+
+void* EmailService::acquireSessionLocked() {
+  auto now = std::chrono::steady_clock::now();
+  if (session_ &&
+      now - lastUsed_ > std::chrono::seconds(config_.idleTimeoutSeconds)) {
+    // Сервер, скорее всего, уже закрыл соединение со своей стороны
+    closeSessionLocked();
+  }
+
+  if (session_) {
+    return session_;
+  }
+
+  CURL* curl = curl_easy_init();
+  if (!curl) {
+    return nullptr;
+  }
+
+  // Параметры соединения задаются один раз на сессию
+  std::string url =
+      "smtp://" + config_.server + ":" + std::to_string(config_.port);
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_MAIL_FROM, config_.fromEmail.c_str());
+  curl_easy_setopt(curl, CURLOPT_USERNAME, config_.username.c_str());
+  curl_easy_setopt(curl, CURLOPT_PASSWORD, config_.password.c_str());
+  curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER,
+                   0L);  // Отключаем проверку SSL для тестов
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN,
+                   static_cast<long>(config_.idleTimeoutSeconds));
+
+  // Таймауты
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+
+  // Отладка (раскомментируйте для диагностики)
+  curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+
+  curl_easy_setopt(curl, CURLOPT_READFUNCTION, payloadSource);
+  curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+
+  session_ = curl;
+  ++sessionsOpened_;
+  std::cout << "🔌 Открыто SMTP-соединение с " << config_.server << ":"
+            << config_.port << std::endl;
+  return session_;
+}
+
+void EmailService::closeSessionLocked() {
+  if (session_) {
+    curl_easy_cleanup(static_cast<CURL*>(session_));
+    session_ = nullptr;
+  }
+}
+
+uint64_t EmailService::getSessionsOpened() const {
+  std::lock_guard<std::mutex> lock(sessionMutex_);
+  return sessionsOpened_;
+}
+
+std::string EmailService::buildMessage(
+    const std::string& from, const std::vector<std::string>& recipients,
+    const std::string& subject, const std::string& body, bool isHtml) {
+  std::string to;
+  for (const auto& recipient : recipients) {
+    if (!to.empty()) {
+      to += ", ";
+    }
+    to += recipient;
+  }
+
+  return "From: " + from + "\r\n" + "To: " + to + "\r\n" +
+         "Subject: " + subject + "\r\n" + "MIME-Version: 1.0\r\n" +
+         (isHtml ? "Content-Type: text/html; charset=UTF-8\r\n"
+                 : "Content-Type: text/plain; charset=utf-8\r\n") +
+         "\r\n" + body + "\r\n";
 }
 
 bool EmailService::sendEmail(const std::vector<std::string>& recipients,
@@ -41,29 +119,18 @@ bool EmailService::sendEmail(const std::vector<std::string>& recipients,
     return false;
   }
 
-  CURL* curl = curl_easy_init();
+  UploadData upload;
+  upload.payload =
+      buildMessage(config_.fromEmail, recipients, subject, body, isHtml);
+
+  std::lock_guard<std::mutex> lock(sessionMutex_);
+
+  CURL* curl = static_cast<CURL*>(acquireSessionLocked());
   if (!curl) {
     std::cerr << "❌ Не удалось инициализировать CURL" << std::endl;
     return false;
   }
 
-  UploadData upload;
-
-  // Формируем email с MIME заголовками КАК В ФАЙЛЕ СОКОМАНДНИКА
-  std::string emailData =
-      "From: " + config_.fromEmail + "\r\n" + "To: " + recipients.front() +
-      "\r\n" +  // recipients.front() как в smtp.cpp
-      "Subject: " + subject + "\r\n" + "MIME-Version: 1.0\r\n" +
-      (isHtml ? "Content-Type: text/html; charset=UTF-8\r\n"
-              : "Content-Type: text/plain; charset=utf-8\r\n") +
-      "\r\n" + body + "\r\n";
-
-  upload.payload = emailData;
-
-  // Настраиваем CURL
-  std::string url =
-      "smtp://" + config_.server + ":" + std::to_string(config_.port);
-
   std::cout << "📧 Отправка email через " << config_.server << ":"
             << config_.port << std::endl;
   std::cout << "   • От: " << config_.fromEmail << std::endl;
@@ -71,21 +138,7 @@ bool EmailService::sendEmail(const std::vector<std::string>& recipients,
   std::cout << "   • Формат: " << (isHtml ? "HTML" : "Plain text") << std::endl;
   std::cout << "   • Получателей: " << recipients.size() << std::endl;
 
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(curl, CURLOPT_MAIL_FROM, config_.fromEmail.c_str());
-  curl_easy_setopt(curl, CURLOPT_USERNAME, config_.username.c_str());
-  curl_easy_setopt(curl, CURLOPT_PASSWORD, config_.password.c_str());
-  curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER,
-                   0L);  // Отключаем проверку SSL для тестов
-
-  // Таймауты
-  curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-
-  // Отладка (раскомментируйте для диагностики)
-  curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-
-  // Получатели
+  // Получатели - все в одной SMTP-транзакции
   curl_slist* recipientsList = nullptr;
   for (const auto& recipient : recipients) {
     recipientsList = curl_slist_append(recipientsList, recipient.c_str());
@@ -94,9 +147,7 @@ bool EmailService::sendEmail(const std::vector<std::string>& recipients,
   curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, recipientsList);
 
   // Источник данных
-  curl_easy_setopt(curl, CURLOPT_READFUNCTION, payloadSource);
   curl_easy_setopt(curl, CURLOPT_READDATA, &upload);
-  curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
 
   // Отправляем
   CURLcode res = curl_easy_perform(curl);
@@ -113,9 +164,18 @@ bool EmailService::sendEmail(const std::vector<std::string>& recipients,
     success = true;
   }
 
-  // Очистка
+  // Список и буфер живут только на время отправки
+  curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, nullptr);
+  curl_easy_setopt(curl, CURLOPT_READDATA, nullptr);
   curl_slist_free_all(recipientsList);
-  curl_easy_cleanup(curl);
+
+  if (success) {
+    lastUsed_ = std::chrono::steady_clock::now();
+  } else {
+    // После ошибки состояние соединения неизвестно - следующее письмо
+    // откроет новое
+    closeSessionLocked();
+  }
 
   return success;
 }
@@ -144,6 +204,44 @@ bool EmailService::sendAlertEmail(const std::string& deviceId, double value,
                    true);  // HTML формат
 }
 
+bool EmailService::sendAlertDigest(
+    const std::vector<models::AlertEvent>& alerts) {
+  if (alerts.empty()) {
+    return true;
+  }
+  if (alerts.size() == 1) {
+    const auto& alert = alerts.front();
+    return sendAlertEmail(alert.deviceId, alert.value, alert.metricType,
+                          alert.direction);
+  }
+
+  if (!configured_) {
+    std::cout << "⚠️  EmailService не настроен, пропускаем оповещение"
+              << std::endl;
+    return false;
+  }
+
+  if (!config_.hasRecipients()) {
+    std::cout << "⚠️  Нет получателей для оповещений" << std::endl;
+    return false;
+  }
+
+  std::vector<std::string> devices;
+  for (const auto& alert : alerts) {
+    if (std::find(devices.begin(), devices.end(), alert.deviceId) ==
+        devices.end()) {
+      devices.push_back(alert.deviceId);
+    }
+  }
+
+  std::string subject = "IoT Alert digest: " + std::to_string(alerts.size()) +
+                        " alerts on " + std::to_string(devices.size()) +
+                        " device(s)";
+
+  return sendEmail(config_.alertRecipients, subject, formatDigestBody(alerts),
+                   true);  // HTML формат
+}
+
 bool EmailService::testConnection() {
   if (!configured_) {
     return false;
@@ -289,6 +387,70 @@ std::string EmailService::formatAlertBody(const std::string& deviceId,
   return html.str();
 }
 
+std::string EmailService::formatDigestBody(
+    const std::vector<models::AlertEvent>& alerts) const {
+  std::ostringstream html;
+  html << R"(<!DOCTYPE html>
+<html>
+<head>
+    <meta charset="UTF-8">
+    <title>IoT Alert Digest</title>
+    <style>
+        body { font-family: Arial, sans-serif; color: #222; line-height: 1.6; margin: 0; padding: 20px; background-color: #f5f5f5; }
+        .container { max-width: 700px; margin: 0 auto; background: white; border-radius: 8px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); overflow: hidden; }
+        .header { background: linear-gradient(135deg, #667eea 0%, #764ba2 100%); color: white; padding: 20px; text-align: center; }
+        .content { padding: 30px; }
+        table { width: 100%; border-collapse: collapse; margin: 20px 0; }
+        th { background-color: #f7f7f7; text-align: left; padding: 10px 12px; border: 1px solid #ddd; }
+        td { padding: 10px 12px; border: 1px solid #ddd; }
+        .footer { background-color: #f9f9f9; padding: 20px; text-align: center; font-size: 12px; color: #888; border-top: 1px solid #eee; }
+        .device-name { color: #3498db; font-weight: bold; }
+    </style>
+</head>
+<body>
+    <div class="container">
+        <div class="header">
+            <h1>IoT Platform Alert Digest</h1>
+            <p>)"
+       << alerts.size() << R"( alerts</p>
+        </div>
+        <div class="content">
+            <table>
+                <tr><th></th><th>Device Name</th><th>Metric</th><th>Status</th><th>Value</th><th>Alert Time</th></tr>
+)";
+
+  for (const auto& alert : alerts) {
+    std::string unit = (alert.metricType == "temperature") ? "°C" : "%";
+    std::string time = "-";
+    if (alert.timestampUs > 0) {
+      auto seconds = static_cast<std::time_t>(alert.timestampUs / 1000000);
+      std::stringstream ss;
+      ss << std::put_time(std::localtime(&seconds), "%Y-%m-%d %H:%M:%S");
+      time = ss.str();
+    }
+
+    html << "                <tr><td>"
+         << getEmoji(alert.metricType, alert.direction)
+         << "</td><td class=\"device-name\">" << alert.deviceId << "</td><td>"
+         << humanMetricName(alert.metricType) << "</td><td>"
+         << humanDirection(alert.direction) << "</td><td>"
+         << formatDoubleNice(alert.value) << " " << unit << "</td><td>"
+         << time << "</td></tr>\n";
+  }
+
+  html << R"(            </table>
+        </div>
+        <div class="footer">
+            <p>This is an automated alert from IoT Platform.</p>
+            <p>Please do not reply to this email. To manage alerts, visit your IoT dashboard.</p>
+        </div>
+    </div>
+</body>
+</html>)";
+
+  return html.str();
+}
+
 // Вспомогательные методы форматирования (из кода сокомандника)
 std::string EmailService::formatDoubleNice(double value) {
   std::ostringstream oss;
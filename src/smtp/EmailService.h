@@ -1,12 +1,24 @@
 // src/smtp/EmailService.h
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "../models/IoTData.h"
 #include "EmailConfig.h"
 
 namespace iot_core::smtp {
 
+/**
+ * @brief Отправка писем через SMTP
+ *
+ * Держит одно SMTP-соединение (curl easy handle) между отправками, чтобы
+ * не повторять TCP, STARTTLS и AUTH для каждого письма. Соединение,
+ * простоявшее дольше idleTimeoutSeconds или завершившееся ошибкой,
+ * открывается заново. Отправки сериализуются.
+ */
 class EmailService {
  public:
   EmailService();
@@ -22,6 +34,9 @@ class EmailService {
                       const std::string& metricType,
                       const std::string& direction);
 
+  // Одно письмо-сводка по нескольким оповещениям
+  bool sendAlertDigest(const std::vector<models::AlertEvent>& alerts);
+
   // Проверка конфигурации
   bool isConfigured() const { return configured_; }
 
@@ -33,6 +48,9 @@ class EmailService {
   // Тестирование подключения
   bool testConnection();
 
+  // Сколько раз открывалось SMTP-соединение
+  uint64_t getSessionsOpened() const;
+
  private:
   struct UploadData {
     std::string payload;
@@ -42,14 +60,32 @@ class EmailService {
   static size_t payloadSource(void* ptr, size_t size, size_t nmemb,
                               void* userp);
 
+  // Готовый текст письма с заголовками
+  static std::string buildMessage(const std::string& from,
+                                  const std::vector<std::string>& recipients,
+                                  const std::string& subject,
+                                  const std::string& body, bool isHtml);
+
+  // Вызывать под sessionMutex_
+  void* acquireSessionLocked();
+  void closeSessionLocked();
+
   EmailConfig config_;
   bool configured_ = false;
 
+  mutable std::mutex sessionMutex_;
+  void* session_ = nullptr;  // CURL*
+  std::chrono::steady_clock::time_point lastUsed_;
+  uint64_t sessionsOpened_ = 0;
+
   // Форматирование email оповещения (HTML)
   std::string formatAlertBody(const std::string& deviceId, double value,
                               const std::string& metricType,
                               const std::string& direction) const;
 
+  std::string formatDigestBody(
+      const std::vector<models::AlertEvent>& alerts) const;
+
   // Вспомогательные методы для форматирования
   static std::string formatDoubleNice(double value);
   static std::string humanMetricName(const std::string& type);
@@ -0,0 +1,35 @@
+// src/storage/Crc32.cpp
+#include "Crc32.h"
+
+#include <array>
+
+namespace iot_core::storage {
+
+namespace {
+
+std::array<uint32_t, 256> buildTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; ++k) {
+      c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    table[i] = c;
+  }
+  return table;
+}
+
+}  // namespace
+
+uint32_t crc32(const void* data, size_t length, uint32_t seed) {
+  static const std::array<uint32_t, 256> table = buildTable();
+
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  uint32_t crc = seed ^ 0xFFFFFFFFu;
+  for (size_t i = 0; i < length; ++i) {
+    crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+}  // namespace iot_core::storage
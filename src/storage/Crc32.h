@@ -0,0 +1,16 @@
+// src/storage/Crc32.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace iot_core::storage {
+
+/**
+ * @brief CRC-32 (IEEE 802.3, полином 0xEDB88320)
+ *
+ * Используется для проверки целостности сегментов и манифеста.
+ * @param seed Предыдущее значение для инкрементального подсчета
+ */
+uint32_t crc32(const void* data, size_t length, uint32_t seed = 0);
+
+}  // namespace iot_core::storage
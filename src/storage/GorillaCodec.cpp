@@ -0,0 +1,273 @@
+// src/storage/GorillaCodec.cpp
+#include "GorillaCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace iot_core::storage {
+
+namespace {
+
+uint64_t doubleToBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double bitsToDouble(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Восстановление знака у числа из count младших бит
+int64_t signExtend(uint64_t value, int count) {
+  if (count >= 64) return static_cast<int64_t>(value);
+  uint64_t signBit = uint64_t{1} << (count - 1);
+  return static_cast<int64_t>((value ^ signBit) - signBit);
+}
+
+bool fitsSigned(int64_t value, int bits) {
+  int64_t limit = int64_t{1} << (bits - 1);
+  return value >= -limit && value < limit;
+}
+
+}  // namespace
+
+// ==================== BitWriter / BitReader ====================
+
+void BitWriter::writeBit(bool bit) { writeBits(bit ? 1 : 0, 1); }
+
+void BitWriter::writeBits(uint64_t value, int count) {
+  while (count > 0) {
+    int offset = static_cast<int>(bitCount_ & 7);
+    if (offset == 0) {
+      buffer_.push_back(0);
+    }
+
+    int free = 8 - offset;
+    int take = std::min(free, count);
+    auto chunk =
+        static_cast<uint8_t>((value >> (count - take)) & ((1u << take) - 1));
+    buffer_.back() |= static_cast<uint8_t>(chunk << (free - take));
+
+    bitCount_ += take;
+    count -= take;
+  }
+}
+
+bool BitReader::readBit() { return readBits(1) != 0; }
+
+uint64_t BitReader::readBits(int count) {
+  uint64_t value = 0;
+  while (count > 0) {
+    int offset = static_cast<int>(position_ & 7);
+    int available = 8 - offset;
+    int take = std::min(available, count);
+
+    if (position_ + take > bitCount_) {
+      throw std::out_of_range("Сжатый поток данных поврежден или обрезан");
+    }
+
+    uint8_t bits = (data_[position_ >> 3] >> (available - take)) &
+                   static_cast<uint8_t>((1u << take) - 1);
+    value = (value << take) | bits;
+
+    position_ += take;
+    count -= take;
+  }
+  return value;
+}
+
+// ==================== Временные метки ====================
+
+void TimestampEncoder::append(int64_t timestampUs) {
+  if (first_) {
+    out_.writeBits(static_cast<uint64_t>(timestampUs), 64);
+    previous_ = timestampUs;
+    first_ = false;
+    return;
+  }
+
+  int64_t delta = timestampUs - previous_;
+  int64_t deltaOfDelta = delta - previousDelta_;
+
+  if (deltaOfDelta == 0) {
+    out_.writeBit(false);
+  } else if (fitsSigned(deltaOfDelta, 16)) {
+    out_.writeBits(0b10, 2);
+    out_.writeBits(static_cast<uint64_t>(deltaOfDelta), 16);
+  } else if (fitsSigned(deltaOfDelta, 24)) {
+    out_.writeBits(0b110, 3);
+    out_.writeBits(static_cast<uint64_t>(deltaOfDelta), 24);
+  } else if (fitsSigned(deltaOfDelta, 32)) {
+    out_.writeBits(0b1110, 4);
+    out_.writeBits(static_cast<uint64_t>(deltaOfDelta), 32);
+  } else {
+    out_.writeBits(0b1111, 4);
+    out_.writeBits(static_cast<uint64_t>(deltaOfDelta), 64);
+  }
+
+  previousDelta_ = delta;
+  previous_ = timestampUs;
+}
+
+int64_t TimestampDecoder::next() {
+  if (first_) {
+    previous_ = static_cast<int64_t>(in_.readBits(64));
+    first_ = false;
+    return previous_;
+  }
+
+  int64_t deltaOfDelta = 0;
+  if (in_.readBit()) {
+    int bits;
+    if (!in_.readBit()) {
+      bits = 16;
+    } else if (!in_.readBit()) {
+      bits = 24;
+    } else if (!in_.readBit()) {
+      bits = 32;
+    } else {
+      bits = 64;
+    }
+    deltaOfDelta = signExtend(in_.readBits(bits), bits);
+  }
+
+  previousDelta_ += deltaOfDelta;
+  previous_ += previousDelta_;
+  return previous_;
+}
+
+// ==================== Значения ====================
+
+void ValueEncoder::append(double value) {
+  uint64_t bits = doubleToBits(value);
+
+  if (first_) {
+    out_.writeBits(bits, 64);
+    previous_ = bits;
+    first_ = false;
+    return;
+  }
+
+  uint64_t xorValue = bits ^ previous_;
+  previous_ = bits;
+
+  if (xorValue == 0) {
+    out_.writeBit(false);
+    return;
+  }
+
+  out_.writeBit(true);
+
+  int leading = std::min(__builtin_clzll(xorValue), 31);
+  int trailing = __builtin_ctzll(xorValue);
+
+  if (previousLeading_ >= 0 && leading >= previousLeading_ &&
+      trailing >= previousTrailing_) {
+    // Значащие биты помещаются в предыдущее окно
+    out_.writeBit(false);
+    int significant = 64 - previousLeading_ - previousTrailing_;
+    out_.writeBits(xorValue >> previousTrailing_, significant);
+    return;
+  }
+
+  int significant = 64 - leading - trailing;
+  out_.writeBit(true);
+  out_.writeBits(static_cast<uint64_t>(leading), 5);
+  out_.writeBits(static_cast<uint64_t>(significant == 64 ? 0 : significant),
+                 6);
+  out_.writeBits(xorValue >> trailing, significant);
+
+  previousLeading_ = leading;
+  previousTrailing_ = trailing;
+}
+
+double ValueDecoder::next() {
+  if (first_) {
+    previous_ = in_.readBits(64);
+    first_ = false;
+    return bitsToDouble(previous_);
+  }
+
+  if (!in_.readBit()) {
+    return bitsToDouble(previous_);
+  }
+
+  if (in_.readBit()) {
+    previousLeading_ = static_cast<int>(in_.readBits(5));
+    int significant = static_cast<int>(in_.readBits(6));
+    if (significant == 0) significant = 64;
+    previousTrailing_ = 64 - previousLeading_ - significant;
+  }
+
+  int significant = 64 - previousLeading_ - previousTrailing_;
+  uint64_t xorValue = in_.readBits(significant) << previousTrailing_;
+  previous_ ^= xorValue;
+  return bitsToDouble(previous_);
+}
+
+// ==================== SeriesEncoder ====================
+
+void SeriesEncoder::append(const DataPoint& point) {
+  if (count_ == 0) {
+    minTimestamp_ = maxTimestamp_ = point.timestampUs;
+    minTemperature_ = maxTemperature_ = point.temperature;
+    minHumidity_ = maxHumidity_ = point.humidity;
+  } else {
+    minTimestamp_ = std::min(minTimestamp_, point.timestampUs);
+    maxTimestamp_ = std::max(maxTimestamp_, point.timestampUs);
+    minTemperature_ = std::min(minTemperature_, point.temperature);
+    maxTemperature_ = std::max(maxTemperature_, point.temperature);
+    minHumidity_ = std::min(minHumidity_, point.humidity);
+    maxHumidity_ = std::max(maxHumidity_, point.humidity);
+  }
+
+  timestamps_.append(point.timestampUs);
+  temperatures_.append(point.temperature);
+  humidities_.append(point.humidity);
+  count_++;
+}
+
+size_t SeriesEncoder::encodedBytes() const {
+  return timestamps().bytes().size() + temperatures().bytes().size() +
+         humidities().bytes().size();
+}
+
+void SeriesEncoder::decode(int64_t fromUs, int64_t toUs,
+                           std::vector<DataPoint>& out) const {
+  if (count_ == 0 || maxTimestamp_ < fromUs || minTimestamp_ > toUs) {
+    return;
+  }
+
+  decodeColumns(timestamps().bytes().data(), timestamps().bitCount(),
+                temperatures().bytes().data(), temperatures().bitCount(),
+                humidities().bytes().data(), humidities().bitCount(), count_,
+                fromUs, toUs, out);
+}
+
+void decodeColumns(const uint8_t* timestamps, size_t timestampBits,
+                   const uint8_t* temperatures, size_t temperatureBits,
+                   const uint8_t* humidities, size_t humidityBits,
+                   size_t count, int64_t fromUs, int64_t toUs,
+                   std::vector<DataPoint>& out) {
+  TimestampDecoder timestampDecoder(timestamps, timestampBits);
+  ValueDecoder temperatureDecoder(temperatures, temperatureBits);
+  ValueDecoder humidityDecoder(humidities, humidityBits);
+
+  for (size_t i = 0; i < count; ++i) {
+    DataPoint point;
+    point.timestampUs = timestampDecoder.next();
+    // Значения декодируются всегда: XOR-цепочка зависит от предыдущих
+    point.temperature = temperatureDecoder.next();
+    point.humidity = humidityDecoder.next();
+
+    if (point.timestampUs >= fromUs && point.timestampUs <= toUs) {
+      out.push_back(point);
+    }
+  }
+}
+
+}  // namespace iot_core::storage
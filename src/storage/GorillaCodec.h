@@ -0,0 +1,162 @@
+// src/storage/GorillaCodec.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace iot_core::storage {
+
+// Одно показание устройства в колоночном хранилище
+struct DataPoint {
+  int64_t timestampUs = 0;  // микросекунды с начала эпохи (UTC)
+  double temperature = 0.0;
+  double humidity = 0.0;
+};
+
+// Побитовая запись (старший бит первым) в растущий буфер
+class BitWriter {
+ public:
+  void writeBit(bool bit);
+  void writeBits(uint64_t value, int count);
+
+  const std::vector<uint8_t>& bytes() const { return buffer_; }
+  size_t bitCount() const { return bitCount_; }
+
+ private:
+  std::vector<uint8_t> buffer_;
+  size_t bitCount_ = 0;
+};
+
+// Побитовое чтение без копирования (в т.ч. из mmap-памяти)
+class BitReader {
+ public:
+  BitReader(const uint8_t* data, size_t bitCount)
+      : data_(data), bitCount_(bitCount) {}
+
+  bool readBit();
+  uint64_t readBits(int count);
+  bool exhausted() const { return position_ >= bitCount_; }
+
+ private:
+  const uint8_t* data_;
+  size_t bitCount_;
+  size_t position_ = 0;
+};
+
+/**
+ * @brief Delta-of-delta кодирование временных меток (Gorilla)
+ *
+ * Первая метка пишется целиком, далее - разность соседних дельт
+ * в одном из пяти диапазонов: 0 | 10+16 | 110+24 | 1110+32 | 1111+64 бит.
+ * Диапазоны расширены относительно оригинала, т.к. метки в микросекундах.
+ */
+class TimestampEncoder {
+ public:
+  void append(int64_t timestampUs);
+  const BitWriter& output() const { return out_; }
+
+ private:
+  BitWriter out_;
+  int64_t previous_ = 0;
+  int64_t previousDelta_ = 0;
+  bool first_ = true;
+};
+
+class TimestampDecoder {
+ public:
+  TimestampDecoder(const uint8_t* data, size_t bitCount)
+      : in_(data, bitCount) {}
+  int64_t next();
+
+ private:
+  BitReader in_;
+  int64_t previous_ = 0;
+  int64_t previousDelta_ = 0;
+  bool first_ = true;
+};
+
+/**
+ * @brief XOR-кодирование значений с плавающей точкой (Gorilla)
+ *
+ * '0' - значение не изменилось; '10' - значащие биты помещаются в
+ * предыдущее окно; '11' + 5 бит ведущих нулей + 6 бит длины + биты.
+ */
+class ValueEncoder {
+ public:
+  void append(double value);
+  const BitWriter& output() const { return out_; }
+
+ private:
+  BitWriter out_;
+  uint64_t previous_ = 0;
+  int previousLeading_ = -1;
+  int previousTrailing_ = 0;
+  bool first_ = true;
+};
+
+class ValueDecoder {
+ public:
+  ValueDecoder(const uint8_t* data, size_t bitCount) : in_(data, bitCount) {}
+  double next();
+
+ private:
+  BitReader in_;
+  uint64_t previous_ = 0;
+  int previousLeading_ = 0;
+  int previousTrailing_ = 0;
+  bool first_ = true;
+};
+
+/**
+ * @brief Колоночный блок показаний одного устройства
+ *
+ * Три независимых потока: метки времени, температура, влажность.
+ * Попутно собирает min/max, по которым запросы пропускают блоки.
+ */
+class SeriesEncoder {
+ public:
+  void append(const DataPoint& point);
+
+  size_t count() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  int64_t minTimestamp() const { return minTimestamp_; }
+  int64_t maxTimestamp() const { return maxTimestamp_; }
+  double minTemperature() const { return minTemperature_; }
+  double maxTemperature() const { return maxTemperature_; }
+  double minHumidity() const { return minHumidity_; }
+  double maxHumidity() const { return maxHumidity_; }
+
+  const BitWriter& timestamps() const { return timestamps_.output(); }
+  const BitWriter& temperatures() const { return temperatures_.output(); }
+  const BitWriter& humidities() const { return humidities_.output(); }
+
+  // Размер сжатых данных в байтах
+  size_t encodedBytes() const;
+
+  // Декодирование точек из [fromUs, toUs] в out
+  void decode(int64_t fromUs, int64_t toUs,
+              std::vector<DataPoint>& out) const;
+
+ private:
+  TimestampEncoder timestamps_;
+  ValueEncoder temperatures_;
+  ValueEncoder humidities_;
+  size_t count_ = 0;
+
+  int64_t minTimestamp_ = 0;
+  int64_t maxTimestamp_ = 0;
+  double minTemperature_ = 0.0;
+  double maxTemperature_ = 0.0;
+  double minHumidity_ = 0.0;
+  double maxHumidity_ = 0.0;
+};
+
+// Декодирование трех колонок, лежащих в произвольной памяти
+void decodeColumns(const uint8_t* timestamps, size_t timestampBits,
+                   const uint8_t* temperatures, size_t temperatureBits,
+                   const uint8_t* humidities, size_t humidityBits,
+                   size_t count, int64_t fromUs, int64_t toUs,
+                   std::vector<DataPoint>& out);
+
+}  // namespace iot_core::storage
@@ -0,0 +1,278 @@
+// src/storage/HotWindowCache.cpp
+#include "HotWindowCache.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace iot_core::storage {
+
+namespace {
+
+int64_t nowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+using BlockList = std::vector<std::shared_ptr<const SeriesEncoder>>;
+
+// Блоки идут от старых к новым, хвост - точки активного блока
+void assembleNewestFirst(const BlockList& blocks, int64_t fromUs,
+                         int64_t toUs, std::vector<DataPoint> tail,
+                         size_t limit, std::vector<DataPoint>& out) {
+  std::vector<DataPoint> points;
+  for (const auto& block : blocks) {
+    block->decode(fromUs, toUs, points);
+  }
+  points.insert(points.end(), tail.begin(), tail.end());
+
+  size_t take = limit == 0 ? points.size() : std::min(limit, points.size());
+  out.assign(points.rbegin(), points.rbegin() + take);
+}
+
+}  // namespace
+
+HotWindowCache::HotWindowCache(Options options)
+    : options_(std::move(options)) {
+  if (options_.blockPoints == 0) {
+    options_.blockPoints = 1;
+  }
+}
+
+size_t HotWindowCache::blockBytes(const SeriesEncoder& block) {
+  return sizeof(SeriesEncoder) + block.encodedBytes();
+}
+
+int64_t HotWindowCache::oldestAllowedUs(int64_t nowUs) const {
+  return nowUs - std::chrono::duration_cast<std::chrono::microseconds>(
+                     options_.maxAge)
+                     .count();
+}
+
+void HotWindowCache::append(const std::string& deviceId,
+                            const DataPoint& point) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  appendLocked(deviceId, windowLocked(deviceId), point);
+  enforceLimitsLocked(nowMicros());
+}
+
+void HotWindowCache::mergeSnapshot(const std::string& deviceId,
+                                   std::vector<DataPoint> points) {
+  if (points.empty()) {
+    return;
+  }
+
+  std::sort(points.begin(), points.end(),
+            [](const DataPoint& a, const DataPoint& b) {
+              return a.timestampUs < b.timestampUs;
+            });
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& window = windowLocked(deviceId);
+
+  // Срез начинается позже последней известной точки: между ними
+  // могли быть показания, которых окно не видело
+  if (window.points > 0 &&
+      points.front().timestampUs > window.lastTimestampUs) {
+    resetLocked(window);
+  }
+
+  for (const auto& point : points) {
+    appendLocked(deviceId, window, point);
+  }
+  enforceLimitsLocked(nowMicros());
+}
+
+HotWindowCache::DeviceWindow& HotWindowCache::windowLocked(
+    const std::string& deviceId) {
+  auto [it, inserted] = windows_.try_emplace(deviceId);
+  if (inserted) {
+    it->second.recency = recency_.insert(recency_.end(), deviceId);
+  }
+  return it->second;
+}
+
+void HotWindowCache::eraseLocked(WindowMap::iterator it) {
+  resetLocked(it->second);
+  recency_.erase(it->second.recency);
+  windows_.erase(it);
+}
+
+void HotWindowCache::appendLocked(const std::string& deviceId,
+                                  DeviceWindow& window,
+                                  const DataPoint& point) {
+  if (window.points > 0 && point.timestampUs <= window.lastTimestampUs) {
+    return;
+  }
+
+  if (window.points == 0) {
+    window.coveredSinceUs = point.timestampUs;
+  }
+
+  if (!window.head) {
+    window.head = std::make_unique<SeriesEncoder>();
+    window.bytes += sizeof(SeriesEncoder);
+    memoryBytes_ += sizeof(SeriesEncoder);
+  }
+
+  size_t before = window.head->encodedBytes();
+  window.head->append(point);
+  size_t grown = window.head->encodedBytes() - before;
+  window.bytes += grown;
+  memoryBytes_ += grown;
+
+  window.lastTimestampUs = point.timestampUs;
+  ++window.points;
+  recency_.splice(recency_.end(), recency_, window.recency);
+
+  if (window.head->count() >= options_.blockPoints) {
+    Block sealed(std::move(window.head));
+    window.sealed.push_back(sealed);
+    evictionQueue_.push_back({deviceId, sealed});
+  }
+}
+
+void HotWindowCache::resetLocked(DeviceWindow& window) {
+  // Записи в очереди вытеснения протухнут сами (weak_ptr)
+  memoryBytes_ -= window.bytes;
+  window.sealed.clear();
+  window.head.reset();
+  window.points = 0;
+  window.bytes = 0;
+}
+
+void HotWindowCache::enforceLimitsLocked(int64_t nowUs) {
+  int64_t oldestAllowed = oldestAllowedUs(nowUs);
+
+  while (!evictionQueue_.empty()) {
+    auto block = evictionQueue_.front().block.lock();
+    if (!block) {
+      evictionQueue_.pop_front();
+      continue;
+    }
+
+    bool expired = block->maxTimestamp() < oldestAllowed;
+    if (memoryBytes_ <= options_.memoryBudgetBytes && !expired) {
+      break;
+    }
+
+    auto it = windows_.find(evictionQueue_.front().deviceId);
+    if (it != windows_.end() && !it->second.sealed.empty() &&
+        it->second.sealed.front() == block) {
+      auto& window = it->second;
+      size_t bytes = blockBytes(*block);
+
+      window.sealed.pop_front();
+      window.bytes -= bytes;
+      window.points -= block->count();
+      window.coveredSinceUs = block->maxTimestamp() + 1;
+      memoryBytes_ -= bytes;
+      ++statistics_.evictedBlocks;
+
+      if (window.sealed.empty() && !window.head) {
+        eraseLocked(it);
+      }
+    }
+
+    evictionQueue_.pop_front();
+  }
+
+  // Активные блоки в очередь не попадают: замолчавшие устройства и
+  // превышение бюджета без запечатанных блоков снимают окно целиком
+  while (!recency_.empty()) {
+    auto it = windows_.find(recency_.front());
+    bool expired = it->second.lastTimestampUs < oldestAllowed;
+    if (memoryBytes_ <= options_.memoryBudgetBytes && !expired) {
+      break;
+    }
+    statistics_.evictedBlocks +=
+        it->second.sealed.size() + (it->second.head ? 1 : 0);
+    eraseLocked(it);
+  }
+}
+
+bool HotWindowCache::latest(const std::string& deviceId, size_t limit,
+                            std::vector<DataPoint>& out) const {
+  out.clear();
+  std::vector<Block> blocks;
+  std::vector<DataPoint> tail;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = windows_.find(deviceId);
+    // Порядок вытеснения - по времени обновления, а не по времени
+    // точек: устаревшее окно может дожидаться очереди
+    if (limit == 0 || it == windows_.end() || it->second.points < limit ||
+        it->second.lastTimestampUs < oldestAllowedUs(nowMicros())) {
+      ++statistics_.misses;
+      return false;
+    }
+
+    const auto& window = it->second;
+    size_t collected = 0;
+    if (window.head) {
+      window.head->decode(INT64_MIN, INT64_MAX, tail);
+      collected = tail.size();
+    }
+
+    // Берем с конца столько блоков, сколько нужно для limit точек
+    for (auto block = window.sealed.rbegin();
+         block != window.sealed.rend() && collected < limit; ++block) {
+      blocks.push_back(*block);
+      collected += (*block)->count();
+    }
+    std::reverse(blocks.begin(), blocks.end());
+    ++statistics_.hits;
+  }
+
+  // Запечатанные блоки неизменяемы - декодируем без блокировки
+  assembleNewestFirst(blocks, INT64_MIN, INT64_MAX, std::move(tail), limit,
+                      out);
+  return true;
+}
+
+bool HotWindowCache::range(const std::string& deviceId, int64_t fromUs,
+                           int64_t toUs, std::vector<DataPoint>& out) const {
+  out.clear();
+  std::vector<Block> blocks;
+  std::vector<DataPoint> tail;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = windows_.find(deviceId);
+    if (it == windows_.end() || it->second.points == 0 ||
+        fromUs < it->second.coveredSinceUs ||
+        it->second.lastTimestampUs < oldestAllowedUs(nowMicros())) {
+      ++statistics_.misses;
+      return false;
+    }
+
+    const auto& window = it->second;
+    for (const auto& block : window.sealed) {
+      if (block->maxTimestamp() >= fromUs && block->minTimestamp() <= toUs) {
+        blocks.push_back(block);
+      }
+    }
+    if (window.head) {
+      window.head->decode(fromUs, toUs, tail);
+    }
+    ++statistics_.hits;
+  }
+
+  assembleNewestFirst(blocks, fromUs, toUs, std::move(tail), 0, out);
+  return true;
+}
+
+HotWindowCache::Statistics HotWindowCache::getStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics stats = statistics_;
+  stats.devices = windows_.size();
+  stats.memoryBytes = memoryBytes_;
+  for (const auto& [deviceId, window] : windows_) {
+    stats.blocks += window.sealed.size() + (window.head ? 1 : 0);
+    stats.points += window.points;
+  }
+  return stats;
+}
+
+}  // namespace iot_core::storage
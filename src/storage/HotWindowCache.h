@@ -0,0 +1,126 @@
+// src/storage/HotWindowCache.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GorillaCodec.h"
+
+namespace iot_core::storage {
+
+/**
+ * @brief Сжатое окно недавних показаний каждого устройства в памяти
+ *
+ * Показания устройства хранятся цепочкой блоков SeriesEncoder
+ * (delta-of-delta для времени, XOR для значений - около 1.5-2 байт на
+ * значение). Общий объем ограничен бюджетом памяти: при превышении
+ * вытесняются самые старые запечатанные блоки всех устройств, а если их
+ * не осталось - окна устройств, дольше всех не получавших показаний,
+ * вместе с активными блоками. Окно устройства, замолчавшего дольше
+ * maxAge, удаляется целиком.
+ *
+ * Окно отвечает на запрос, только если покрывает его целиком:
+ * для каждого устройства хранится момент, начиная с которого история
+ * в окне непрерывна (coveredSince). Точки не новее последней
+ * (повторы и опоздавшие показания) отбрасываются.
+ */
+class HotWindowCache {
+ public:
+  struct Options {
+    size_t memoryBudgetBytes = 32 * 1024 * 1024;
+    size_t blockPoints = 256;
+    std::chrono::seconds maxAge{24 * 3600};
+  };
+
+  struct Statistics {
+    size_t devices = 0;
+    size_t blocks = 0;
+    uint64_t points = 0;
+    size_t memoryBytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictedBlocks = 0;
+  };
+
+  explicit HotWindowCache(Options options);
+
+  // Новое показание из потока приема (точки идут подряд)
+  void append(const std::string& deviceId, const DataPoint& point);
+
+  /**
+   * @brief Срез последних показаний из удаленной БД
+   *
+   * Если срез не перекрывается с окном, непрерывность нарушена и окно
+   * устройства начинается заново с этого среза.
+   */
+  void mergeSnapshot(const std::string& deviceId,
+                     std::vector<DataPoint> points);
+
+  /**
+   * @brief Последние limit точек устройства, от новых к старым
+   * @return false если в непрерывной части окна меньше limit точек
+   */
+  bool latest(const std::string& deviceId, size_t limit,
+              std::vector<DataPoint>& out) const;
+
+  /**
+   * @brief Точки из [fromUs, toUs], от новых к старым
+   * @return false если окно не покрывает начало диапазона
+   */
+  bool range(const std::string& deviceId, int64_t fromUs, int64_t toUs,
+             std::vector<DataPoint>& out) const;
+
+  Statistics getStatistics() const;
+
+ private:
+  using Block = std::shared_ptr<const SeriesEncoder>;
+
+  struct DeviceWindow {
+    std::deque<Block> sealed;  // от старых к новым
+    std::unique_ptr<SeriesEncoder> head;
+    int64_t coveredSinceUs = 0;
+    int64_t lastTimestampUs = 0;
+    uint64_t points = 0;
+    size_t bytes = 0;
+    // Позиция в recency_
+    std::list<std::string>::iterator recency;
+  };
+
+  using WindowMap = std::unordered_map<std::string, DeviceWindow>;
+
+  struct EvictionEntry {
+    std::string deviceId;
+    std::weak_ptr<const SeriesEncoder> block;
+  };
+
+  // Все методы ниже вызываются под mutex_
+  DeviceWindow& windowLocked(const std::string& deviceId);
+  void eraseLocked(WindowMap::iterator it);
+  void appendLocked(const std::string& deviceId, DeviceWindow& window,
+                    const DataPoint& point);
+  void resetLocked(DeviceWindow& window);
+  void enforceLimitsLocked(int64_t nowUs);
+
+  static size_t blockBytes(const SeriesEncoder& block);
+  // Окна с последней точкой раньше этого момента устарели
+  int64_t oldestAllowedUs(int64_t nowUs) const;
+
+  Options options_;
+
+  mutable std::mutex mutex_;
+  WindowMap windows_;
+  // Запечатанные блоки в порядке запечатывания (кандидаты на вытеснение)
+  std::deque<EvictionEntry> evictionQueue_;
+  // Устройства в порядке последнего показания, от давних к свежим
+  std::list<std::string> recency_;
+  size_t memoryBytes_ = 0;
+  mutable Statistics statistics_;
+};
+
+}  // namespace iot_core::storage
@@ -0,0 +1,744 @@
+// src/storage/IngestSpool.cpp
+#include "IngestSpool.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "Crc32.h"
+#include "Segment.h"
+
+namespace fs = std::filesystem;
+
+namespace iot_core::storage {
+
+namespace {
+
+constexpr const char* kCursorName = "CURSOR";
+constexpr const char* kQuarantineName = "quarantine.csv";
+constexpr size_t kRecordHeaderBytes = 8;  // длина + CRC
+constexpr size_t kPayloadFixedBytes = 8 + 8 + 8 + 2;
+constexpr size_t kMaxDeviceIdBytes = 1024;
+// Буфер такого размера сбрасывается, не дожидаясь интервала
+constexpr size_t kEagerFlushBytes = 64 * 1024;
+constexpr size_t kMaxReadBytes = 1024 * 1024;
+
+enum class DecodeResult { kOk, kIncomplete, kCorrupt };
+
+void encodeRecord(const SpoolRecord& record, std::vector<uint8_t>& out) {
+  uint16_t idLength = static_cast<uint16_t>(
+      std::min(record.deviceId.size(), kMaxDeviceIdBytes));
+  uint32_t length = static_cast<uint32_t>(kPayloadFixedBytes + idLength);
+
+  size_t start = out.size();
+  out.resize(start + kRecordHeaderBytes + length);
+  uint8_t* payload = out.data() + start + kRecordHeaderBytes;
+
+  std::memcpy(payload, &record.timestampUs, 8);
+  std::memcpy(payload + 8, &record.temperature, 8);
+  std::memcpy(payload + 16, &record.humidity, 8);
+  std::memcpy(payload + 24, &idLength, 2);
+  std::memcpy(payload + kPayloadFixedBytes, record.deviceId.data(), idLength);
+
+  uint32_t crc = crc32(payload, length);
+  std::memcpy(out.data() + start, &length, 4);
+  std::memcpy(out.data() + start + 4, &crc, 4);
+}
+
+DecodeResult decodeRecord(const uint8_t* data, size_t available,
+                          SpoolRecord& record, size_t& consumed) {
+  if (available < kRecordHeaderBytes) {
+    return DecodeResult::kIncomplete;
+  }
+
+  uint32_t length = 0;
+  uint32_t crc = 0;
+  std::memcpy(&length, data, 4);
+  std::memcpy(&crc, data + 4, 4);
+
+  if (length < kPayloadFixedBytes ||
+      length > kPayloadFixedBytes + kMaxDeviceIdBytes) {
+    return DecodeResult::kCorrupt;
+  }
+  if (available < kRecordHeaderBytes + length) {
+    return DecodeResult::kIncomplete;
+  }
+
+  const uint8_t* payload = data + kRecordHeaderBytes;
+  if (crc32(payload, length) != crc) {
+    return DecodeResult::kCorrupt;
+  }
+
+  uint16_t idLength = 0;
+  std::memcpy(&record.timestampUs, payload, 8);
+  std::memcpy(&record.temperature, payload + 8, 8);
+  std::memcpy(&record.humidity, payload + 16, 8);
+  std::memcpy(&idLength, payload + 24, 2);
+  if (kPayloadFixedBytes + idLength != length) {
+    return DecodeResult::kCorrupt;
+  }
+  record.deviceId.assign(
+      reinterpret_cast<const char*>(payload + kPayloadFixedBytes), idLength);
+
+  consumed = kRecordHeaderBytes + length;
+  return DecodeResult::kOk;
+}
+
+// Читает [offset, offset + length) из файла; пустой вектор при ошибке
+std::vector<uint8_t> readRange(const std::string& path, uint64_t offset,
+                               size_t length) {
+  std::vector<uint8_t> data(length);
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+
+  size_t total = 0;
+  while (total < length) {
+    ssize_t n = ::pread(fd, data.data() + total, length - total,
+                        static_cast<off_t>(offset + total));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    total += static_cast<size_t>(n);
+  }
+  ::close(fd);
+
+  data.resize(total);
+  return data;
+}
+
+bool writeAll(int fd, const uint8_t* data, size_t length) {
+  while (length > 0) {
+    ssize_t written = ::write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    length -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool parseSegmentName(const std::string& name, uint64_t& segmentId) {
+  if (name.size() != 6 + 16 + 4 || name.rfind("spool-", 0) != 0 ||
+      name.compare(name.size() - 4, 4, ".log") != 0) {
+    return false;
+  }
+  try {
+    segmentId = std::stoull(name.substr(6, 16), nullptr, 16);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+int64_t nowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+IngestSpool::IngestSpool(Options options) : options_(std::move(options)) {
+  if (options_.replayBatchSize == 0) {
+    options_.replayBatchSize = 1;
+  }
+}
+
+IngestSpool::~IngestSpool() { close(); }
+
+std::string IngestSpool::segmentPath(uint64_t segmentId) const {
+  std::ostringstream name;
+  name << "spool-" << std::hex << std::setw(16) << std::setfill('0')
+       << segmentId << ".log";
+  return (fs::path(options_.directory) / name.str()).string();
+}
+
+bool IngestSpool::open() {
+  if (open_) {
+    return true;
+  }
+
+  std::error_code ec;
+  fs::create_directories(options_.directory, ec);
+  if (ec) {
+    std::cerr << "❌ Не удалось создать каталог журнала приема "
+              << options_.directory << ": " << ec.message() << std::endl;
+    return false;
+  }
+
+  if (!recoverSegments()) {
+    return false;
+  }
+  loadCursor();
+
+  stopWriter_ = false;
+  writerThread_ = std::thread(&IngestSpool::writerLoop, this);
+  open_ = true;
+
+  auto stats = getStatistics();
+  std::cout << "📼 Журнал приема открыт: " << options_.directory << " ("
+            << stats.pendingRecords << " записей ожидают загрузки в БД)"
+            << std::endl;
+  return true;
+}
+
+void IngestSpool::close() {
+  if (!open_) {
+    return;
+  }
+
+  stopReplay();
+
+  stopWriter_ = true;
+  bufferCv_.notify_all();
+  if (writerThread_.joinable()) {
+    writerThread_.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (activeFd_ >= 0) {
+      ::close(activeFd_);
+      activeFd_ = -1;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    saveCursor(cursor_);
+  }
+
+  open_ = false;
+}
+
+bool IngestSpool::append(const SpoolRecord& record) {
+  if (!open_) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(bufferMutex_);
+  if (buffer_.size() >= options_.maxBufferedBytes) {
+    // Диск не успевает - вызывающий обработает показание сам
+    std::lock_guard<std::mutex> stateLock(stateMutex_);
+    ++statistics_.rejected;
+    return false;
+  }
+
+  encodeRecord(record, buffer_);
+  if (bufferedRecords_++ == 0) {
+    bufferedOldestUs_ = record.timestampUs;
+  }
+
+  if (buffer_.size() >= kEagerFlushBytes) {
+    bufferCv_.notify_one();
+  }
+  return true;
+}
+
+void IngestSpool::flush() {
+  {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    writeBufferLocked();
+  }
+  enforceDiskLimit();
+}
+
+void IngestSpool::writerLoop() {
+  while (!stopWriter_) {
+    {
+      std::unique_lock<std::mutex> lock(bufferMutex_);
+      bufferCv_.wait_for(lock, options_.flushInterval, [this] {
+        return stopWriter_.load() || buffer_.size() >= kEagerFlushBytes;
+      });
+    }
+    flush();
+  }
+
+  // Последний сброс при остановке
+  flush();
+}
+
+void IngestSpool::writeBufferLocked() {
+  std::vector<uint8_t> data;
+  uint64_t records = 0;
+  int64_t oldestUs = 0;
+  {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    data.swap(buffer_);
+    records = bufferedRecords_;
+    oldestUs = bufferedOldestUs_;
+    bufferedRecords_ = 0;
+  }
+
+  if (data.empty()) {
+    return;
+  }
+
+  bool ok = true;
+  if (activeFd_ < 0 || activeBytes_ >= options_.segmentMaxBytes) {
+    ok = rollSegmentLocked();
+  }
+
+  if (ok) {
+    ok = writeAll(activeFd_, data.data(), data.size()) &&
+         ::fdatasync(activeFd_) == 0;
+    if (!ok) {
+      std::cerr << "❌ Ошибка записи журнала приема: " << std::strerror(errno)
+                << std::endl;
+      // Отрезаем частично записанный хвост, чтобы не дублировать записи
+      if (::ftruncate(activeFd_, static_cast<off_t>(activeBytes_)) != 0) {
+        ::close(activeFd_);
+        activeFd_ = -1;
+      }
+    }
+  }
+
+  if (!ok) {
+    // Возвращаем данные в начало буфера - попробуем на следующем цикле
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    data.insert(data.end(), buffer_.begin(), buffer_.end());
+    buffer_.swap(data);
+    if (bufferedRecords_ == 0) {
+      bufferedOldestUs_ = oldestUs;
+    }
+    bufferedRecords_ += records;
+    return;
+  }
+
+  activeBytes_ += data.size();
+
+  {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    auto& segment = segments_[activeSegmentId_];
+    segment.durableBytes = activeBytes_;
+    segment.records += records;
+
+    if (statistics_.pendingRecords == 0) {
+      oldestPendingUs_ = oldestUs;
+    }
+    statistics_.appended += records;
+    statistics_.pendingRecords += records;
+    statistics_.diskBytes += data.size();
+  }
+  replayCv_.notify_all();
+}
+
+bool IngestSpool::rollSegmentLocked() {
+  if (activeFd_ >= 0) {
+    ::close(activeFd_);
+    activeFd_ = -1;
+  }
+
+  uint64_t segmentId = 0;
+  {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    segmentId = nextSegmentId_++;
+  }
+
+  std::string path = segmentPath(segmentId);
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+  if (fd < 0) {
+    std::cerr << "❌ Не удалось создать сегмент журнала " << path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  syncPath(options_.directory, true);
+
+  activeFd_ = fd;
+  activeBytes_ = 0;
+
+  std::lock_guard<std::mutex> lock(stateMutex_);
+  segments_[segmentId] = SegmentInfo{};
+  activeSegmentId_ = segmentId;
+  return true;
+}
+
+void IngestSpool::enforceDiskLimit() {
+  std::lock_guard<std::mutex> lock(stateMutex_);
+
+  while (statistics_.diskBytes > options_.maxDiskBytes &&
+         segments_.size() > 1) {
+    auto oldest = segments_.begin();
+    if (oldest->first == activeSegmentId_) {
+      break;
+    }
+
+    uint64_t replayed =
+        oldest->first == cursor_.segmentId ? cursor_.records : 0;
+    uint64_t lost = oldest->first < cursor_.segmentId
+                        ? 0
+                        : oldest->second.records - replayed;
+
+    std::cerr << "⚠️  Журнал приема переполнен, удален сегмент "
+              << oldest->first << " (" << lost << " записей не загружено)"
+              << std::endl;
+
+    statistics_.dropped += lost;
+    statistics_.pendingRecords -= lost;
+    statistics_.diskBytes -= oldest->second.durableBytes;
+    ::unlink(segmentPath(oldest->first).c_str());
+
+    uint64_t droppedId = oldest->first;
+    segments_.erase(oldest);
+    if (cursor_.segmentId <= droppedId) {
+      cursor_ = Cursor{segments_.begin()->first, 0, 0};
+      saveCursor(cursor_);
+    }
+  }
+}
+
+void IngestSpool::startReplay(Sink sink) {
+  if (replayThread_.joinable()) {
+    return;
+  }
+  stopReplay_ = false;
+  replayThread_ = std::thread(&IngestSpool::replayLoop, this, std::move(sink));
+}
+
+void IngestSpool::replayLoop(Sink sink) {
+  const std::chrono::milliseconds initialDelay{1000};
+  std::chrono::milliseconds delay = initialDelay;
+
+  while (!stopReplay_) {
+    auto started = std::chrono::steady_clock::now();
+    bool failed = false;
+    size_t delivered = replayBatch(sink, failed);
+
+    std::chrono::milliseconds wait{0};
+    if (failed) {
+      // БД недоступна - ждем с растущей паузой, данные копятся в журнале
+      wait = delay;
+      delay = std::min<std::chrono::milliseconds>(
+          delay * 2, std::chrono::duration_cast<std::chrono::milliseconds>(
+                         options_.maxRetryDelay));
+    } else if (delivered == 0) {
+      delay = initialDelay;
+      wait = std::chrono::milliseconds(200);
+    } else if (options_.replayRatePerSecond > 0) {
+      // Ограничение скорости, чтобы догоняющая загрузка не душила БД
+      delay = initialDelay;
+      auto budget = std::chrono::milliseconds(
+          delivered * 1000 / options_.replayRatePerSecond);
+      auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - started);
+      wait = budget > spent ? budget - spent : std::chrono::milliseconds(0);
+    }
+
+    if (wait.count() > 0) {
+      std::unique_lock<std::mutex> lock(stateMutex_);
+      uint64_t appended = statistics_.appended;
+      // Без данных просыпаемся сразу, как только появились новые записи
+      replayCv_.wait_for(lock, wait, [&] {
+        return stopReplay_.load() ||
+               (!failed && delivered == 0 && statistics_.appended != appended);
+      });
+    }
+  }
+}
+
+void IngestSpool::stopReplay() {
+  stopReplay_ = true;
+  replayCv_.notify_all();
+  if (replayThread_.joinable()) {
+    replayThread_.join();
+  }
+}
+
+size_t IngestSpool::replayOnce(const Sink& sink) {
+  bool failed = false;
+  return replayBatch(sink, failed);
+}
+
+size_t IngestSpool::replayBatch(const Sink& sink, bool& failed) {
+  failed = false;
+  Cursor start;
+  uint64_t limitBytes = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    auto it = segments_.lower_bound(cursor_.segmentId);
+    if (it == segments_.end()) {
+      return 0;
+    }
+    if (it->first != cursor_.segmentId) {
+      cursor_ = Cursor{it->first, 0, 0};
+    }
+
+    // Полностью загруженные закрытые сегменты больше не нужны
+    while (cursor_.offset >= it->second.durableBytes &&
+           it->first != activeSegmentId_) {
+      statistics_.diskBytes -= it->second.durableBytes;
+      ::unlink(segmentPath(it->first).c_str());
+      it = segments_.erase(it);
+      if (it == segments_.end()) {
+        cursor_ = Cursor{nextSegmentId_, 0, 0};
+        saveCursor(cursor_);
+        return 0;
+      }
+      cursor_ = Cursor{it->first, 0, 0};
+      saveCursor(cursor_);
+    }
+
+    if (cursor_.offset >= it->second.durableBytes) {
+      return 0;
+    }
+    start = cursor_;
+    limitBytes = it->second.durableBytes;
+  }
+
+  size_t toRead = static_cast<size_t>(
+      std::min<uint64_t>(limitBytes - start.offset, kMaxReadBytes));
+  auto data = readRange(segmentPath(start.segmentId), start.offset, toRead);
+
+  std::vector<SpoolRecord> batch;
+  size_t consumed = 0;
+  bool corrupt = false;
+  while (batch.size() < options_.replayBatchSize && consumed < data.size()) {
+    SpoolRecord record;
+    size_t recordBytes = 0;
+    auto result = decodeRecord(data.data() + consumed, data.size() - consumed,
+                               record, recordBytes);
+    if (result == DecodeResult::kCorrupt) {
+      corrupt = true;
+      break;
+    }
+    if (result == DecodeResult::kIncomplete) {
+      break;
+    }
+    consumed += recordBytes;
+    batch.push_back(std::move(record));
+  }
+
+  if (batch.empty()) {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    if (corrupt && cursor_.segmentId == start.segmentId &&
+        cursor_.offset == start.offset) {
+      // Остаток сегмента не читается - пропускаем его
+      auto it = segments_.find(start.segmentId);
+      uint64_t lost = 0;
+      if (it != segments_.end() && it->second.records > start.records) {
+        lost = it->second.records - start.records;
+      }
+      std::cerr << "⚠️  Поврежденная запись в журнале приема, сегмент "
+                << start.segmentId << " пропущен (" << lost << " записей)"
+                << std::endl;
+      statistics_.corrupt += lost;
+      statistics_.pendingRecords -= std::min(lost, statistics_.pendingRecords);
+      cursor_.offset = limitBytes;
+      cursor_.records += lost;
+      saveCursor(cursor_);
+    }
+    return 0;
+  }
+
+  if (!sink(batch)) {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    ++statistics_.replayFailures;
+    failed = true;
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(stateMutex_);
+  // Сегмент мог быть удален при переполнении, пока шла загрузка
+  if (cursor_.segmentId == start.segmentId && cursor_.offset == start.offset) {
+    cursor_.offset += consumed;
+    cursor_.records += batch.size();
+    statistics_.pendingRecords -=
+        std::min<uint64_t>(batch.size(), statistics_.pendingRecords);
+    saveCursor(cursor_);
+  }
+  statistics_.replayed += batch.size();
+  // Следующая ожидающая запись не старше последней загруженной
+  oldestPendingUs_ =
+      statistics_.pendingRecords > 0 ? batch.back().timestampUs : 0;
+  return batch.size();
+}
+
+std::string IngestSpool::quarantinePath() const {
+  return (fs::path(options_.directory) / kQuarantineName).string();
+}
+
+bool IngestSpool::quarantine(const std::vector<SpoolRecord>& records) {
+  if (records.empty()) {
+    return true;
+  }
+
+  bool written = false;
+  {
+    std::lock_guard<std::mutex> lock(quarantineMutex_);
+    std::string path = quarantinePath();
+    bool exists = fs::exists(path);
+    std::ofstream out(path, std::ios::app);
+    if (!exists) {
+      out << "timestamp_us,device_id,temperature,humidity\n";
+    }
+    out << std::setprecision(17);
+    for (const auto& record : records) {
+      out << record.timestampUs << ',' << record.deviceId << ','
+          << record.temperature << ',' << record.humidity << '\n';
+    }
+    out.flush();
+    written = static_cast<bool>(out);
+  }
+
+  if (!written) {
+    std::cerr << "❌ Не удалось записать карантин журнала приема: "
+              << quarantinePath() << std::endl;
+    return false;
+  }
+
+  std::cerr << "⚠️  " << records.size()
+            << " записей журнала приема отвергнуты БД и отложены в "
+            << quarantinePath() << std::endl;
+  std::lock_guard<std::mutex> lock(stateMutex_);
+  statistics_.quarantined += records.size();
+  return true;
+}
+
+IngestSpool::Statistics IngestSpool::getStatistics() const {
+  std::lock_guard<std::mutex> lock(stateMutex_);
+  Statistics stats = statistics_;
+  stats.segments = segments_.size();
+  if (stats.pendingRecords > 0 && oldestPendingUs_ > 0) {
+    stats.lagSeconds =
+        std::max<int64_t>(0, nowMicros() - oldestPendingUs_) / 1e6;
+  }
+  return stats;
+}
+
+bool IngestSpool::recoverSegments() {
+  std::error_code ec;
+  std::vector<uint64_t> found;
+  for (const auto& entry : fs::directory_iterator(options_.directory, ec)) {
+    std::string name = entry.path().filename().string();
+    uint64_t segmentId = 0;
+    if (parseSegmentName(name, segmentId)) {
+      found.push_back(segmentId);
+    } else if (name.size() > 4 &&
+               name.compare(name.size() - 4, 4, ".tmp") == 0) {
+      fs::remove(entry.path(), ec);
+    }
+  }
+  if (ec) {
+    std::cerr << "❌ Не удалось прочитать каталог журнала приема: "
+              << ec.message() << std::endl;
+    return false;
+  }
+  std::sort(found.begin(), found.end());
+
+  std::lock_guard<std::mutex> lock(stateMutex_);
+  for (uint64_t segmentId : found) {
+    std::string path = segmentPath(segmentId);
+    uint64_t size = fs::file_size(path, ec);
+    auto data = readRange(path, 0, ec ? 0 : static_cast<size_t>(size));
+
+    SegmentInfo info;
+    size_t offset = 0;
+    while (offset < data.size()) {
+      SpoolRecord record;
+      size_t recordBytes = 0;
+      auto result = decodeRecord(data.data() + offset, data.size() - offset,
+                                 record, recordBytes);
+      if (result != DecodeResult::kOk) {
+        // Оборванный хвост после падения: все, что дальше, не было
+        // подтверждено fdatasync
+        std::cerr << "⚠️  Журнал приема: хвост сегмента " << segmentId
+                  << " отброшен (" << data.size() - offset << " байт)"
+                  << std::endl;
+        break;
+      }
+      offset += recordBytes;
+      ++info.records;
+    }
+    info.durableBytes = offset;
+
+    nextSegmentId_ = std::max(nextSegmentId_, segmentId + 1);
+    if (info.records == 0) {
+      ::unlink(path.c_str());
+      continue;
+    }
+    segments_[segmentId] = info;
+    statistics_.diskBytes += info.durableBytes;
+  }
+  return true;
+}
+
+void IngestSpool::loadCursor() {
+  std::ifstream in((fs::path(options_.directory) / kCursorName).string());
+  Cursor saved;
+  bool valid = static_cast<bool>(in >> saved.segmentId >> saved.offset >>
+                                 saved.records);
+
+  std::lock_guard<std::mutex> lock(stateMutex_);
+
+  // Сегменты до курсора уже загружены - остались после падения
+  while (valid && !segments_.empty() &&
+         segments_.begin()->first < saved.segmentId) {
+    statistics_.diskBytes -= segments_.begin()->second.durableBytes;
+    ::unlink(segmentPath(segments_.begin()->first).c_str());
+    segments_.erase(segments_.begin());
+  }
+
+  auto it = segments_.find(saved.segmentId);
+  if (valid && it != segments_.end() &&
+      saved.offset <= it->second.durableBytes &&
+      saved.records <= it->second.records) {
+    cursor_ = saved;
+  } else {
+    uint64_t first =
+        segments_.empty() ? nextSegmentId_ : segments_.begin()->first;
+    cursor_ = Cursor{first, 0, 0};
+  }
+
+  uint64_t pending = 0;
+  for (const auto& [segmentId, info] : segments_) {
+    pending += info.records;
+  }
+  statistics_.pendingRecords = pending - cursor_.records;
+
+  // Время самой старой ожидающей записи - для метрики отставания
+  oldestPendingUs_ = 0;
+  if (statistics_.pendingRecords > 0) {
+    auto first = segments_.lower_bound(cursor_.segmentId);
+    uint64_t offset = first->first == cursor_.segmentId ? cursor_.offset : 0;
+    auto data = readRange(segmentPath(first->first), offset,
+                          kRecordHeaderBytes + kPayloadFixedBytes +
+                              kMaxDeviceIdBytes);
+    SpoolRecord record;
+    size_t recordBytes = 0;
+    if (decodeRecord(data.data(), data.size(), record, recordBytes) ==
+        DecodeResult::kOk) {
+      oldestPendingUs_ = record.timestampUs;
+    }
+  }
+}
+
+void IngestSpool::saveCursor(const Cursor& cursor) {
+  // Без fsync: после падения курсор может откатиться на пачку назад,
+  // что допустимо при доставке "хотя бы один раз"
+  std::string path = (fs::path(options_.directory) / kCursorName).string();
+  std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::trunc);
+    out << cursor.segmentId << " " << cursor.offset << " " << cursor.records
+        << "\n";
+    if (!out.good()) {
+      return;
+    }
+  }
+  std::rename(tmpPath.c_str(), path.c_str());
+}
+
+}  // namespace iot_core::storage
@@ -0,0 +1,161 @@
+// src/storage/IngestSpool.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace iot_core::storage {
+
+// Показание, принятое на вход и ожидающее записи в БД
+struct SpoolRecord {
+  std::string deviceId;
+  int64_t timestampUs = 0;
+  double temperature = 0.0;
+  double humidity = 0.0;
+};
+
+/**
+ * @brief Журнал приема телеметрии (write-ahead spool)
+ *
+ * Входящие показания сначала дописываются в буфер, который фоновый поток
+ * пачками сбрасывает в сегментные файлы (write + fdatasync). Каждая
+ * запись снабжена длиной и CRC, поэтому оборванный хвост после падения
+ * просто отбрасывается. Поток воспроизведения читает журнал с позиции
+ * курсора и отдает пачки получателю (запись в БД); пока получатель
+ * возвращает false, журнал копит данные и повторяет попытки с паузой.
+ *
+ * Доставка "хотя бы один раз": курсор сохраняется после каждой
+ * успешной пачки, и после падения последняя пачка может повториться.
+ * Объем на диске ограничен - при переполнении удаляются самые старые
+ * сегменты (записи в них считаются потерянными). Записи, которые БД
+ * отвергла, получатель откладывает в карантин (quarantine.csv в каталоге
+ * журнала), чтобы они не задерживали воспроизведение.
+ */
+class IngestSpool {
+ public:
+  struct Options {
+    std::string directory = "data/spool";
+    size_t segmentMaxBytes = 8 * 1024 * 1024;
+    uint64_t maxDiskBytes = 512ull * 1024 * 1024;
+    std::chrono::milliseconds flushInterval{20};
+    size_t maxBufferedBytes = 16 * 1024 * 1024;
+    size_t replayBatchSize = 500;
+    size_t replayRatePerSecond = 2000;  // 0 - без ограничения
+    std::chrono::seconds maxRetryDelay{30};
+  };
+
+  struct Statistics {
+    uint64_t appended = 0;
+    uint64_t replayed = 0;
+    uint64_t dropped = 0;   // удалено при переполнении диска
+    uint64_t corrupt = 0;   // записи с неверной CRC
+    uint64_t rejected = 0;  // не принято: буфер переполнен
+    uint64_t quarantined = 0;  // отвергнуто БД, отложено в карантин
+    uint64_t replayFailures = 0;
+    uint64_t pendingRecords = 0;
+    uint64_t diskBytes = 0;
+    size_t segments = 0;
+    double lagSeconds = 0.0;  // возраст самых старых невоспроизведенных данных
+  };
+
+  // Получатель пачки; false - повторить позже
+  using Sink = std::function<bool(const std::vector<SpoolRecord>&)>;
+
+  explicit IngestSpool(Options options);
+  ~IngestSpool();
+
+  IngestSpool(const IngestSpool&) = delete;
+  IngestSpool& operator=(const IngestSpool&) = delete;
+
+  // Восстановление сегментов и курсора, запуск потока записи
+  bool open();
+  // Останавливает воспроизведение, сбрасывает буфер на диск
+  void close();
+  bool isOpen() const { return open_; }
+
+  // Не блокируется на диске; false если журнал закрыт или буфер полон
+  bool append(const SpoolRecord& record);
+
+  void startReplay(Sink sink);
+  void stopReplay();
+
+  // Синхронный сброс буфера на диск
+  void flush();
+  // Одна пачка воспроизведения в текущем потоке; число доставленных записей
+  size_t replayOnce(const Sink& sink);
+
+  // Дописывает записи в файл карантина; false - ошибка записи
+  bool quarantine(const std::vector<SpoolRecord>& records);
+  std::string quarantinePath() const;
+
+  Statistics getStatistics() const;
+
+ private:
+  struct SegmentInfo {
+    uint64_t durableBytes = 0;  // сколько байт записано и синхронизировано
+    uint64_t records = 0;
+  };
+
+  struct Cursor {
+    uint64_t segmentId = 0;
+    uint64_t offset = 0;
+    uint64_t records = 0;  // записей сегмента до offset
+  };
+
+  void writerLoop();
+  void replayLoop(Sink sink);
+  // failed = true если получатель отказал (БД недоступна)
+  size_t replayBatch(const Sink& sink, bool& failed);
+  // Записывает накопленный буфер; вызывать под writeMutex_
+  void writeBufferLocked();
+  bool rollSegmentLocked();
+  void enforceDiskLimit();
+
+  bool recoverSegments();
+  void loadCursor();
+  void saveCursor(const Cursor& cursor);
+
+  std::string segmentPath(uint64_t segmentId) const;
+
+  Options options_;
+  std::atomic<bool> open_{false};
+
+  // Буфер приема
+  std::mutex bufferMutex_;
+  std::condition_variable bufferCv_;
+  std::vector<uint8_t> buffer_;
+  uint64_t bufferedRecords_ = 0;
+  int64_t bufferedOldestUs_ = 0;
+
+  // Активный сегмент (только поток записи и flush)
+  std::mutex writeMutex_;
+  int activeFd_ = -1;
+  uint64_t activeBytes_ = 0;
+
+  // Сегменты, курсор и статистика
+  mutable std::mutex stateMutex_;
+  std::condition_variable replayCv_;
+  std::map<uint64_t, SegmentInfo> segments_;
+  uint64_t activeSegmentId_ = 0;
+  uint64_t nextSegmentId_ = 1;
+  Cursor cursor_;
+  int64_t oldestPendingUs_ = 0;
+  Statistics statistics_;
+
+  // Запись файла карантина
+  std::mutex quarantineMutex_;
+
+  std::thread writerThread_;
+  std::thread replayThread_;
+  std::atomic<bool> stopWriter_{false};
+  std::atomic<bool> stopReplay_{false};
+};
+
+}  // namespace iot_core::storage
@@ -0,0 +1,210 @@
+// src/storage/Segment.cpp
+#include "Segment.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+
+#include "Crc32.h"
+
+namespace iot_core::storage {
+
+namespace {
+
+constexpr char kSegmentMagic[8] = {'I', 'O', 'T', 'S', 'E', 'G', '0', '1'};
+constexpr uint32_t kSegmentVersion = 1;
+
+static_assert(std::is_trivially_copyable_v<SegmentHeader>,
+              "SegmentHeader is written to disk as raw bytes");
+
+size_t bitsToBytes(uint64_t bits) {
+  return static_cast<size_t>((bits + 7) / 8);
+}
+
+bool writeAll(int fd, const void* data, size_t length) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  while (length > 0) {
+    ssize_t written = ::write(fd, bytes, length);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    bytes += written;
+    length -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string segmentFileName(uint64_t segmentId) {
+  std::ostringstream oss;
+  oss << "seg-" << std::hex << std::setw(16) << std::setfill('0') << segmentId
+      << ".seg";
+  return oss.str();
+}
+
+bool syncPath(const std::string& path, bool directory) {
+  int fd = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = ::fsync(fd) == 0;
+  ::close(fd);
+  return ok;
+}
+
+bool writeSegmentFile(const std::string& path, uint64_t segmentId,
+                      const std::string& deviceId,
+                      const SeriesEncoder& series) {
+  SegmentHeader header{};
+  std::memcpy(header.magic, kSegmentMagic, sizeof(header.magic));
+  header.version = kSegmentVersion;
+  header.deviceIdLength = static_cast<uint32_t>(deviceId.size());
+  header.segmentId = segmentId;
+  header.pointCount = series.count();
+  header.minTimestampUs = series.minTimestamp();
+  header.maxTimestampUs = series.maxTimestamp();
+  header.minTemperature = series.minTemperature();
+  header.maxTemperature = series.maxTemperature();
+  header.minHumidity = series.minHumidity();
+  header.maxHumidity = series.maxHumidity();
+  header.timestampBits = series.timestamps().bitCount();
+  header.temperatureBits = series.temperatures().bitCount();
+  header.humidityBits = series.humidities().bitCount();
+
+  const auto& ts = series.timestamps().bytes();
+  const auto& temp = series.temperatures().bytes();
+  const auto& hum = series.humidities().bytes();
+
+  uint32_t crc = crc32(deviceId.data(), deviceId.size());
+  crc = crc32(ts.data(), ts.size(), crc);
+  crc = crc32(temp.data(), temp.size(), crc);
+  crc = crc32(hum.data(), hum.size(), crc);
+  header.payloadCrc = crc;
+
+  std::string tmpPath = path + ".tmp";
+  int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cerr << "❌ Не удалось создать сегмент " << tmpPath << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  bool ok = writeAll(fd, &header, sizeof(header)) &&
+            writeAll(fd, deviceId.data(), deviceId.size()) &&
+            writeAll(fd, ts.data(), ts.size()) &&
+            writeAll(fd, temp.data(), temp.size()) &&
+            writeAll(fd, hum.data(), hum.size()) && ::fsync(fd) == 0;
+  ::close(fd);
+
+  if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::cerr << "❌ Ошибка записи сегмента " << path << ": "
+              << std::strerror(errno) << std::endl;
+    ::unlink(tmpPath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+// ==================== MappedSegment ====================
+
+MappedSegment::~MappedSegment() {
+  if (data_) {
+    ::munmap(const_cast<uint8_t*>(data_), size_);
+  }
+}
+
+std::shared_ptr<MappedSegment> MappedSegment::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(SegmentHeader)) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+
+  std::shared_ptr<MappedSegment> segment(new MappedSegment());
+  segment->path_ = path;
+  segment->data_ = static_cast<const uint8_t*>(mapping);
+  segment->size_ = size;
+
+  SegmentHeader header;
+  std::memcpy(&header, segment->data_, sizeof(header));
+
+  if (std::memcmp(header.magic, kSegmentMagic, sizeof(header.magic)) != 0 ||
+      header.version != kSegmentVersion) {
+    std::cerr << "⚠️  Неизвестный формат сегмента: " << path << std::endl;
+    return nullptr;
+  }
+
+  size_t payload = header.deviceIdLength + bitsToBytes(header.timestampBits) +
+                   bitsToBytes(header.temperatureBits) +
+                   bitsToBytes(header.humidityBits);
+  if (sizeof(header) + payload != size) {
+    std::cerr << "⚠️  Сегмент обрезан: " << path << std::endl;
+    return nullptr;
+  }
+
+  const uint8_t* cursor = segment->data_ + sizeof(header);
+  if (crc32(cursor, payload) != header.payloadCrc) {
+    std::cerr << "⚠️  Контрольная сумма сегмента не совпадает: " << path
+              << std::endl;
+    return nullptr;
+  }
+
+  segment->meta_.segmentId = header.segmentId;
+  segment->meta_.deviceId.assign(reinterpret_cast<const char*>(cursor),
+                                 header.deviceIdLength);
+  segment->meta_.pointCount = header.pointCount;
+  segment->meta_.minTimestampUs = header.minTimestampUs;
+  segment->meta_.maxTimestampUs = header.maxTimestampUs;
+  cursor += header.deviceIdLength;
+
+  segment->timestamps_ = cursor;
+  segment->timestampBits_ = header.timestampBits;
+  cursor += bitsToBytes(header.timestampBits);
+
+  segment->temperatures_ = cursor;
+  segment->temperatureBits_ = header.temperatureBits;
+  cursor += bitsToBytes(header.temperatureBits);
+
+  segment->humidities_ = cursor;
+  segment->humidityBits_ = header.humidityBits;
+
+  return segment;
+}
+
+void MappedSegment::read(int64_t fromUs, int64_t toUs,
+                         std::vector<DataPoint>& out) const {
+  if (!meta_.overlaps(fromUs, toUs)) {
+    return;
+  }
+
+  decodeColumns(timestamps_, timestampBits_, temperatures_, temperatureBits_,
+                humidities_, humidityBits_, meta_.pointCount, fromUs, toUs,
+                out);
+}
+
+}  // namespace iot_core::storage
@@ -0,0 +1,106 @@
+// src/storage/Segment.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GorillaCodec.h"
+
+namespace iot_core::storage {
+
+// Метаданные запечатанного сегмента (дублируются в манифесте)
+struct SegmentMeta {
+  uint64_t segmentId = 0;
+  std::string deviceId;
+  uint64_t pointCount = 0;
+  int64_t minTimestampUs = 0;
+  int64_t maxTimestampUs = 0;
+
+  bool overlaps(int64_t fromUs, int64_t toUs) const {
+    return maxTimestampUs >= fromUs && minTimestampUs <= toUs;
+  }
+};
+
+/**
+ * @brief Заголовок файла сегмента
+ *
+ * За ним следуют: идентификатор устройства, затем три сжатые колонки
+ * (метки времени, температура, влажность). CRC считается по всему,
+ * что идет после заголовка.
+ */
+struct SegmentHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t deviceIdLength;
+  uint64_t segmentId;
+  uint64_t pointCount;
+  int64_t minTimestampUs;
+  int64_t maxTimestampUs;
+  double minTemperature;
+  double maxTemperature;
+  double minHumidity;
+  double maxHumidity;
+  uint64_t timestampBits;
+  uint64_t temperatureBits;
+  uint64_t humidityBits;
+  uint32_t payloadCrc;
+  uint32_t reserved;
+};
+
+// Имя файла сегмента по его идентификатору
+std::string segmentFileName(uint64_t segmentId);
+
+/**
+ * @brief Записывает блок на диск (tmp + fsync + rename)
+ * @return true если файл полностью записан и переименован
+ */
+bool writeSegmentFile(const std::string& path, uint64_t segmentId,
+                      const std::string& deviceId,
+                      const SeriesEncoder& series);
+
+/**
+ * @brief Запечатанный сегмент, отображенный в память только на чтение
+ *
+ * Декодирование идет прямо из mmap-области, без копирования файла.
+ * Объект можно держать через shared_ptr после удаления файла
+ * (например, при компакции) - отображение остается валидным.
+ */
+class MappedSegment {
+ public:
+  ~MappedSegment();
+
+  MappedSegment(const MappedSegment&) = delete;
+  MappedSegment& operator=(const MappedSegment&) = delete;
+
+  // Открывает и проверяет файл; nullptr если файл поврежден
+  static std::shared_ptr<MappedSegment> open(const std::string& path);
+
+  const SegmentMeta& meta() const { return meta_; }
+  const std::string& path() const { return path_; }
+  size_t fileSize() const { return size_; }
+
+  // Декодирует точки из [fromUs, toUs] в out
+  void read(int64_t fromUs, int64_t toUs, std::vector<DataPoint>& out) const;
+
+ private:
+  MappedSegment() = default;
+
+  std::string path_;
+  SegmentMeta meta_;
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+
+  const uint8_t* timestamps_ = nullptr;
+  const uint8_t* temperatures_ = nullptr;
+  const uint8_t* humidities_ = nullptr;
+  uint64_t timestampBits_ = 0;
+  uint64_t temperatureBits_ = 0;
+  uint64_t humidityBits_ = 0;
+};
+
+// fsync для файла/директории; false при ошибке
+bool syncPath(const std::string& path, bool directory = false);
+
+}  // namespace iot_core::storage
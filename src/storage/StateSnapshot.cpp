@@ -0,0 +1,259 @@
+// src/storage/StateSnapshot.cpp
+#include "StateSnapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Crc32.h"
+#include "Segment.h"
+
+namespace iot_core::storage {
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'I', 'O', 'T', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t sectionCount;
+  int64_t createdAtUs;
+};
+
+struct SectionEntry {
+  uint32_t tag;
+  uint32_t crc;
+  uint64_t offset;
+  uint64_t length;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader> &&
+                  std::is_trivially_copyable_v<SectionEntry>,
+              "Snapshot headers are written to disk as raw bytes");
+
+}  // namespace
+
+// ==================== ByteWriter / ByteReader ====================
+
+void ByteWriter::putRaw(const void* data, size_t length) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  bytes_.insert(bytes_.end(), bytes, bytes + length);
+}
+
+void ByteWriter::putU8(uint8_t value) { bytes_.push_back(value); }
+void ByteWriter::putU32(uint32_t value) { putRaw(&value, sizeof(value)); }
+void ByteWriter::putU64(uint64_t value) { putRaw(&value, sizeof(value)); }
+void ByteWriter::putI64(int64_t value) { putRaw(&value, sizeof(value)); }
+void ByteWriter::putDouble(double value) { putRaw(&value, sizeof(value)); }
+
+void ByteWriter::putString(const std::string& value) {
+  putU32(static_cast<uint32_t>(value.size()));
+  putRaw(value.data(), value.size());
+}
+
+void ByteReader::getRaw(void* out, size_t length) {
+  if (length > length_ - offset_) {
+    throw std::out_of_range("ByteReader: read past end of section");
+  }
+  std::memcpy(out, data_ + offset_, length);
+  offset_ += length;
+}
+
+uint8_t ByteReader::getU8() {
+  uint8_t value = 0;
+  getRaw(&value, sizeof(value));
+  return value;
+}
+
+uint32_t ByteReader::getU32() {
+  uint32_t value = 0;
+  getRaw(&value, sizeof(value));
+  return value;
+}
+
+uint64_t ByteReader::getU64() {
+  uint64_t value = 0;
+  getRaw(&value, sizeof(value));
+  return value;
+}
+
+int64_t ByteReader::getI64() {
+  int64_t value = 0;
+  getRaw(&value, sizeof(value));
+  return value;
+}
+
+double ByteReader::getDouble() {
+  double value = 0.0;
+  getRaw(&value, sizeof(value));
+  return value;
+}
+
+std::string ByteReader::getString() {
+  uint32_t length = getU32();
+  if (length > remaining()) {
+    throw std::out_of_range("ByteReader: string past end of section");
+  }
+  std::string value(reinterpret_cast<const char*>(data_ + offset_), length);
+  offset_ += length;
+  return value;
+}
+
+// ==================== SnapshotWriter ====================
+
+bool SnapshotWriter::writeTo(const std::string& path,
+                             int64_t createdAtUs) const {
+  SnapshotHeader header{};
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+  header.version = kSnapshotVersion;
+  header.sectionCount = static_cast<uint32_t>(sections_.size());
+  header.createdAtUs = createdAtUs;
+
+  std::vector<SectionEntry> entries;
+  uint64_t offset =
+      sizeof(SnapshotHeader) + sections_.size() * sizeof(SectionEntry);
+  for (const auto& [tag, writer] : sections_) {
+    const auto& bytes = writer.bytes();
+    entries.push_back(
+        SectionEntry{tag, crc32(bytes.data(), bytes.size()), offset,
+                     static_cast<uint64_t>(bytes.size())});
+    offset += bytes.size();
+  }
+
+  std::filesystem::path target(path);
+  if (target.has_parent_path()) {
+    std::error_code ec;
+    std::filesystem::create_directories(target.parent_path(), ec);
+  }
+
+  std::string tmpPath = path + ".tmp";
+  FILE* file = std::fopen(tmpPath.c_str(), "wb");
+  if (!file) {
+    std::cerr << "❌ Не удалось создать снимок состояния " << tmpPath << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+  if (!entries.empty()) {
+    ok = ok && std::fwrite(entries.data(), sizeof(SectionEntry),
+                           entries.size(), file) == entries.size();
+  }
+  for (const auto& [tag, writer] : sections_) {
+    const auto& bytes = writer.bytes();
+    ok = ok && (bytes.empty() ||
+                std::fwrite(bytes.data(), 1, bytes.size(), file) ==
+                    bytes.size());
+  }
+  ok = std::fflush(file) == 0 && ok;
+  ok = std::fclose(file) == 0 && ok;
+
+  if (!ok || !syncPath(tmpPath) ||
+      std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::cerr << "❌ Ошибка записи снимка состояния " << path << std::endl;
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+
+  if (target.has_parent_path()) {
+    syncPath(target.parent_path().string(), true);
+  }
+  return true;
+}
+
+// ==================== SnapshotReader ====================
+
+SnapshotReader::~SnapshotReader() {
+  if (data_) {
+    ::munmap(const_cast<uint8_t*>(data_), size_);
+  }
+}
+
+std::unique_ptr<SnapshotReader> SnapshotReader::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+
+  std::unique_ptr<SnapshotReader> reader(new SnapshotReader());
+  reader->data_ = static_cast<const uint8_t*>(mapping);
+  reader->size_ = size;
+
+  SnapshotHeader header;
+  std::memcpy(&header, reader->data_, sizeof(header));
+  if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 ||
+      header.version != kSnapshotVersion) {
+    std::cerr << "⚠️  Неизвестный формат снимка состояния: " << path
+              << std::endl;
+    return nullptr;
+  }
+
+  uint64_t tableEnd = sizeof(SnapshotHeader) +
+                      static_cast<uint64_t>(header.sectionCount) *
+                          sizeof(SectionEntry);
+  if (tableEnd > size) {
+    std::cerr << "⚠️  Снимок состояния обрезан: " << path << std::endl;
+    return nullptr;
+  }
+
+  for (uint32_t i = 0; i < header.sectionCount; ++i) {
+    SectionEntry entry;
+    std::memcpy(&entry,
+                reader->data_ + sizeof(SnapshotHeader) +
+                    i * sizeof(SectionEntry),
+                sizeof(entry));
+
+    if (entry.offset < tableEnd || entry.offset > size ||
+        entry.length > size - entry.offset) {
+      std::cerr << "⚠️  Снимок состояния обрезан: " << path << std::endl;
+      return nullptr;
+    }
+
+    const uint8_t* data = reader->data_ + entry.offset;
+    size_t length = static_cast<size_t>(entry.length);
+    if (crc32(data, length) != entry.crc) {
+      std::cerr << "⚠️  Контрольная сумма снимка не совпадает: " << path
+                << std::endl;
+      return nullptr;
+    }
+    reader->sections_[entry.tag] = Span{data, length};
+  }
+
+  reader->createdAtUs_ = header.createdAtUs;
+  return reader;
+}
+
+ByteReader SnapshotReader::section(uint32_t tag) const {
+  auto it = sections_.find(tag);
+  if (it == sections_.end()) {
+    return ByteReader();
+  }
+  return ByteReader(it->second.data, it->second.length);
+}
+
+}  // namespace iot_core::storage
@@ -0,0 +1,118 @@
+// src/storage/StateSnapshot.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace iot_core::storage {
+
+// Четырехсимвольный тег секции снимка
+constexpr uint32_t snapshotTag(char a, char b, char c, char d) {
+  return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+         static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8 |
+         static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16 |
+         static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24;
+}
+
+// Последовательная запись полей секции (little-endian, как на x86/ARM)
+class ByteWriter {
+ public:
+  void putU8(uint8_t value);
+  void putU32(uint32_t value);
+  void putU64(uint64_t value);
+  void putI64(int64_t value);
+  void putDouble(double value);
+  void putString(const std::string& value);
+
+  const std::vector<uint8_t>& bytes() const { return bytes_; }
+
+ private:
+  void putRaw(const void* data, size_t length);
+
+  std::vector<uint8_t> bytes_;
+};
+
+// Чтение полей секции; std::out_of_range при выходе за границу
+class ByteReader {
+ public:
+  ByteReader() = default;
+  ByteReader(const uint8_t* data, size_t length)
+      : data_(data), length_(length) {}
+
+  uint8_t getU8();
+  uint32_t getU32();
+  uint64_t getU64();
+  int64_t getI64();
+  double getDouble();
+  std::string getString();
+
+  bool atEnd() const { return offset_ >= length_; }
+  size_t remaining() const { return length_ - offset_; }
+
+ private:
+  void getRaw(void* out, size_t length);
+
+  const uint8_t* data_ = nullptr;
+  size_t length_ = 0;
+  size_t offset_ = 0;
+};
+
+/**
+ * @brief Снимок состояния в памяти для быстрого перезапуска
+ *
+ * Каждый компонент пишет свою секцию под своим тегом; неизвестные
+ * секции при чтении игнорируются, поэтому формат расширяется без
+ * смены версии. Файл заменяется атомарно (tmp + fsync + rename).
+ */
+class SnapshotWriter {
+ public:
+  // Секция с данным тегом (создается при первом обращении)
+  ByteWriter& section(uint32_t tag) { return sections_[tag]; }
+
+  bool writeTo(const std::string& path, int64_t createdAtUs) const;
+
+ private:
+  std::map<uint32_t, ByteWriter> sections_;
+};
+
+/**
+ * @brief Снимок, отображенный в память только на чтение
+ *
+ * Заголовок и CRC всех секций проверяются при открытии; секции
+ * читаются прямо из отображения без копирования файла.
+ */
+class SnapshotReader {
+ public:
+  ~SnapshotReader();
+
+  SnapshotReader(const SnapshotReader&) = delete;
+  SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+  // nullptr если файла нет или он поврежден
+  static std::unique_ptr<SnapshotReader> open(const std::string& path);
+
+  bool has(uint32_t tag) const { return sections_.count(tag) > 0; }
+  // Пустой ByteReader, если секции нет
+  ByteReader section(uint32_t tag) const;
+
+  int64_t createdAtUs() const { return createdAtUs_; }
+  size_t fileSize() const { return size_; }
+
+ private:
+  SnapshotReader() = default;
+
+  struct Span {
+    const uint8_t* data;
+    size_t length;
+  };
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  int64_t createdAtUs_ = 0;
+  std::map<uint32_t, Span> sections_;
+};
+
+}  // namespace iot_core::storage
@@ -0,0 +1,618 @@
+// src/storage/TimeSeriesStore.cpp
+#include "TimeSeriesStore.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "Crc32.h"
+
+namespace fs = std::filesystem;
+
+namespace iot_core::storage {
+
+namespace {
+
+constexpr const char* kManifestName = "MANIFEST";
+constexpr const char* kManifestHeader = "IOTMANIFEST 1";
+
+bool isSegmentFile(const std::string& name) {
+  return name.rfind("seg-", 0) == 0 && name.size() > 4 &&
+         name.compare(name.size() - 4, 4, ".seg") == 0;
+}
+
+bool endsWith(const std::string& value, const std::string& suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) ==
+             0;
+}
+
+void insertSorted(std::vector<std::shared_ptr<MappedSegment>>& segments,
+                  std::shared_ptr<MappedSegment> segment) {
+  auto pos = std::upper_bound(
+      segments.begin(), segments.end(), segment,
+      [](const auto& a, const auto& b) {
+        return a->meta().minTimestampUs < b->meta().minTimestampUs;
+      });
+  segments.insert(pos, std::move(segment));
+}
+
+}  // namespace
+
+TimeSeriesStore::TimeSeriesStore(Options options)
+    : options_(std::move(options)) {}
+
+TimeSeriesStore::~TimeSeriesStore() { close(); }
+
+std::string TimeSeriesStore::pathFor(const std::string& fileName) const {
+  return (fs::path(options_.directory) / fileName).string();
+}
+
+bool TimeSeriesStore::open() {
+  if (open_) {
+    return true;
+  }
+
+  std::error_code ec;
+  fs::create_directories(options_.directory, ec);
+  if (ec) {
+    std::cerr << "❌ Не удалось создать каталог хранилища "
+              << options_.directory << ": " << ec.message() << std::endl;
+    return false;
+  }
+
+  if (!loadManifest()) {
+    return false;
+  }
+
+  stopRequested_ = false;
+  maintenanceThread_ = std::thread(&TimeSeriesStore::maintenanceLoop, this);
+  open_ = true;
+
+  auto stats = getStatistics();
+  std::cout << "💾 Локальное хранилище открыто: " << options_.directory << " ("
+            << stats.segments << " сегментов, " << stats.sealedPoints
+            << " точек)" << std::endl;
+  return true;
+}
+
+void TimeSeriesStore::close() {
+  if (!open_) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(maintenanceMutex_);
+    stopRequested_ = true;
+  }
+  maintenanceCv_.notify_all();
+  if (maintenanceThread_.joinable()) {
+    maintenanceThread_.join();
+  }
+
+  sealPending(true);
+  open_ = false;
+  std::cout << "💾 Локальное хранилище закрыто" << std::endl;
+}
+
+void TimeSeriesStore::append(const std::string& deviceId,
+                             const DataPoint& point) {
+  bool requestSeal = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& series = series_[deviceId];
+    if (!series.active) {
+      series.active = std::make_unique<SeriesEncoder>();
+      series.activeSince = std::chrono::steady_clock::now();
+    }
+
+    series.active->append(point);
+
+    if (series.active->count() >= options_.segmentMaxPoints) {
+      series.sealing.push_back(std::move(series.active));
+      series.active.reset();
+      requestSeal = true;
+    }
+  }
+
+  if (requestSeal) {
+    {
+      std::lock_guard<std::mutex> lock(maintenanceMutex_);
+      sealRequested_ = true;
+    }
+    maintenanceCv_.notify_one();
+  }
+}
+
+std::vector<DataPoint> TimeSeriesStore::query(const std::string& deviceId,
+                                              int64_t fromUs, int64_t toUs,
+                                              size_t limit) const {
+  std::vector<DataPoint> out;
+  std::vector<std::shared_ptr<const SeriesEncoder>> sealing;
+  std::vector<std::shared_ptr<MappedSegment>> segments;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = series_.find(deviceId);
+    if (it == series_.end()) {
+      return out;
+    }
+
+    if (it->second.active) {
+      it->second.active->decode(fromUs, toUs, out);
+    }
+    sealing = it->second.sealing;
+    segments = it->second.segments;
+  }
+
+  // Запечатываемые блоки неизменяемы - читаем без блокировки
+  for (const auto& encoder : sealing) {
+    encoder->decode(fromUs, toUs, out);
+  }
+
+  auto newestFirst = [](const DataPoint& a, const DataPoint& b) {
+    return a.timestampUs > b.timestampUs;
+  };
+
+  // Сегменты от новых к старым; отсекаем по метаданным каждого сегмента.
+  // Порядок - по минимальному времени, но диапазоны могут пересекаться
+  // (показания не по порядку, журнал приема догоняет после простоя):
+  // более ранний сегмент может держать и самые новые точки, поэтому
+  // останавливать перебор нельзя
+  uint64_t skipped = 0;
+  for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+    const auto& meta = (*it)->meta();
+    if (!meta.overlaps(fromUs, toUs)) {
+      skipped++;
+      continue;
+    }
+
+    if (limit > 0 && out.size() >= limit) {
+      std::nth_element(out.begin(), out.begin() + (limit - 1), out.end(),
+                       newestFirst);
+      if (out[limit - 1].timestampUs > meta.maxTimestampUs) {
+        skipped++;
+        continue;
+      }
+    }
+
+    (*it)->read(fromUs, toUs, out);
+  }
+
+  std::sort(out.begin(), out.end(), newestFirst);
+  if (limit > 0 && out.size() > limit) {
+    out.resize(limit);
+  }
+
+  if (skipped > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics_.segmentsSkipped += skipped;
+  }
+
+  return out;
+}
+
+uint64_t TimeSeriesStore::pointCount(const std::string& deviceId) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = series_.find(deviceId);
+  if (it == series_.end()) {
+    return 0;
+  }
+
+  uint64_t count = it->second.active ? it->second.active->count() : 0;
+  for (const auto& encoder : it->second.sealing) {
+    count += encoder->count();
+  }
+  for (const auto& segment : it->second.segments) {
+    count += segment->meta().pointCount;
+  }
+  return count;
+}
+
+void TimeSeriesStore::flush() { sealPending(true); }
+
+void TimeSeriesStore::compact() {
+  std::vector<std::string> devices;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [deviceId, series] : series_) {
+      devices.push_back(deviceId);
+    }
+  }
+
+  for (const auto& deviceId : devices) {
+    while (compactDevice(deviceId)) {
+    }
+  }
+}
+
+TimeSeriesStore::Statistics TimeSeriesStore::getStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics stats = statistics_;
+  stats.devices = series_.size();
+  stats.segments = 0;
+  stats.activePoints = 0;
+  stats.sealedPoints = 0;
+  stats.diskBytes = 0;
+
+  for (const auto& [deviceId, series] : series_) {
+    if (series.active) stats.activePoints += series.active->count();
+    for (const auto& encoder : series.sealing) {
+      stats.activePoints += encoder->count();
+    }
+    for (const auto& segment : series.segments) {
+      stats.segments++;
+      stats.sealedPoints += segment->meta().pointCount;
+      stats.diskBytes += segment->fileSize();
+    }
+  }
+  return stats;
+}
+
+// ==================== Фоновое обслуживание ====================
+
+void TimeSeriesStore::maintenanceLoop() {
+  auto lastCompaction = std::chrono::steady_clock::now();
+
+  while (!stopRequested_) {
+    {
+      std::unique_lock<std::mutex> lock(maintenanceMutex_);
+      maintenanceCv_.wait_for(lock, std::chrono::seconds(5), [this] {
+        return sealRequested_ || stopRequested_;
+      });
+      sealRequested_ = false;
+    }
+
+    if (stopRequested_) {
+      break;
+    }
+
+    try {
+      sealPending(false);
+
+      auto now = std::chrono::steady_clock::now();
+      if (now - lastCompaction >= options_.compactionInterval) {
+        compact();
+        lastCompaction = now;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "❌ Ошибка обслуживания хранилища: " << e.what()
+                << std::endl;
+    }
+  }
+}
+
+void TimeSeriesStore::sealPending(bool sealActive) {
+  std::lock_guard<std::mutex> manifestLock(manifestMutex_);
+
+  struct Job {
+    std::string deviceId;
+    std::shared_ptr<const SeriesEncoder> encoder;
+    uint64_t segmentId;
+    std::shared_ptr<MappedSegment> segment;
+  };
+  std::vector<Job> jobs;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+
+    for (auto& [deviceId, series] : series_) {
+      if (series.active && !series.active->empty() &&
+          (sealActive ||
+           now - series.activeSince >= options_.segmentMaxAge)) {
+        series.sealing.push_back(std::move(series.active));
+        series.active.reset();
+      }
+
+      for (const auto& encoder : series.sealing) {
+        jobs.push_back({deviceId, encoder, nextSegmentId_++, nullptr});
+      }
+    }
+  }
+
+  if (jobs.empty()) {
+    return;
+  }
+
+  // Запись и fsync - без основной блокировки, приему данных не мешаем
+  for (auto& job : jobs) {
+    std::string path = pathFor(segmentFileName(job.segmentId));
+    if (writeSegmentFile(path, job.segmentId, job.deviceId, *job.encoder)) {
+      job.segment = MappedSegment::open(path);
+    }
+  }
+  syncPath(options_.directory, true);
+
+  std::string manifest;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& job : jobs) {
+      if (!job.segment) {
+        continue;  // останется в sealing, повторим позже
+      }
+
+      auto& series = series_[job.deviceId];
+      auto& sealing = series.sealing;
+      sealing.erase(std::remove(sealing.begin(), sealing.end(), job.encoder),
+                    sealing.end());
+      insertSorted(series.segments, job.segment);
+      statistics_.segmentsSealed++;
+    }
+
+    manifest = buildManifestLocked();
+  }
+
+  writeManifest(manifest);
+}
+
+bool TimeSeriesStore::compactDevice(const std::string& deviceId) {
+  std::lock_guard<std::mutex> manifestLock(manifestMutex_);
+
+  std::vector<std::shared_ptr<MappedSegment>> run;
+  uint64_t segmentId = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = series_.find(deviceId);
+    if (it == series_.end()) {
+      return false;
+    }
+
+    // Ищем первую цепочку соседних мелких сегментов
+    uint64_t total = 0;
+    for (const auto& segment : it->second.segments) {
+      uint64_t count = segment->meta().pointCount;
+      bool small = count < options_.compactionMinPoints;
+
+      if (small && total + count <= options_.compactionTargetPoints) {
+        run.push_back(segment);
+        total += count;
+        continue;
+      }
+      if (run.size() >= 2) {
+        break;
+      }
+      run.clear();
+      total = 0;
+      if (small) {
+        run.push_back(segment);
+        total = count;
+      }
+    }
+
+    if (run.size() < 2) {
+      return false;
+    }
+    segmentId = nextSegmentId_++;
+  }
+
+  SeriesEncoder merged;
+  std::vector<DataPoint> points;
+  for (const auto& segment : run) {
+    points.clear();
+    segment->read(INT64_MIN, INT64_MAX, points);
+    for (const auto& point : points) {
+      merged.append(point);
+    }
+  }
+
+  std::string path = pathFor(segmentFileName(segmentId));
+  if (!writeSegmentFile(path, segmentId, deviceId, merged)) {
+    return false;
+  }
+  auto segment = MappedSegment::open(path);
+  if (!segment) {
+    ::unlink(path.c_str());
+    return false;
+  }
+  syncPath(options_.directory, true);
+
+  std::string manifest;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& segments = series_[deviceId].segments;
+    for (const auto& old : run) {
+      segments.erase(std::remove(segments.begin(), segments.end(), old),
+                     segments.end());
+    }
+    insertSorted(segments, segment);
+    statistics_.compactions++;
+
+    manifest = buildManifestLocked();
+  }
+
+  if (!writeManifest(manifest)) {
+    return false;
+  }
+
+  // Старые файлы удаляем только после фиксации манифеста.
+  // Открытые запросы продолжают читать их через mmap.
+  for (const auto& old : run) {
+    ::unlink(old->path().c_str());
+  }
+
+  std::cout << "🗜️  Компакция " << deviceId << ": " << run.size()
+            << " сегментов -> 1 (" << merged.count() << " точек)"
+            << std::endl;
+  return true;
+}
+
+// ==================== Манифест ====================
+
+std::string TimeSeriesStore::buildManifestLocked() const {
+  std::ostringstream oss;
+  oss << kManifestHeader << "\n"
+      << "next_segment_id " << nextSegmentId_ << "\n";
+  for (const auto& [deviceId, series] : series_) {
+    for (const auto& segment : series.segments) {
+      const auto& meta = segment->meta();
+      oss << "segment " << meta.segmentId << " " << meta.pointCount << " "
+          << meta.minTimestampUs << " " << meta.maxTimestampUs << " "
+          << meta.deviceId << "\n";
+    }
+  }
+  return oss.str();
+}
+
+bool TimeSeriesStore::writeManifest(const std::string& content) {
+  std::string tmpPath = pathFor(std::string(kManifestName) + ".tmp");
+  std::string path = pathFor(kManifestName);
+
+  {
+    std::ofstream out(tmpPath, std::ios::trunc);
+    out << content << "crc " << crc32(content.data(), content.size())
+        << "\n";
+    if (!out.good()) {
+      std::cerr << "❌ Не удалось записать манифест хранилища" << std::endl;
+      return false;
+    }
+  }
+
+  if (!syncPath(tmpPath) ||
+      std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::cerr << "❌ Не удалось зафиксировать манифест хранилища" << std::endl;
+    return false;
+  }
+  return syncPath(options_.directory, true);
+}
+
+bool TimeSeriesStore::loadManifest() {
+  std::ifstream in(pathFor(kManifestName));
+  std::vector<SegmentMeta> listed;
+  bool manifestValid = false;
+
+  if (in.is_open()) {
+    std::string content;
+    std::string line;
+    uint32_t expectedCrc = 0;
+    bool hasCrc = false;
+
+    while (std::getline(in, line)) {
+      if (line.rfind("crc ", 0) == 0) {
+        expectedCrc = static_cast<uint32_t>(std::stoul(line.substr(4)));
+        hasCrc = true;
+        break;
+      }
+      content += line + "\n";
+    }
+
+    if (hasCrc && crc32(content.data(), content.size()) == expectedCrc &&
+        content.rfind(kManifestHeader, 0) == 0) {
+      manifestValid = true;
+      std::istringstream lines(content);
+      while (std::getline(lines, line)) {
+        std::istringstream iss(line);
+        std::string tag;
+        iss >> tag;
+        if (tag == "next_segment_id") {
+          iss >> nextSegmentId_;
+        } else if (tag == "segment") {
+          SegmentMeta meta;
+          iss >> meta.segmentId >> meta.pointCount >> meta.minTimestampUs >>
+              meta.maxTimestampUs;
+          iss.get();
+          std::getline(iss, meta.deviceId);
+          listed.push_back(meta);
+        }
+      }
+    } else {
+      std::cerr << "⚠️  Манифест хранилища поврежден, восстанавливаю по "
+                   "файлам сегментов"
+                << std::endl;
+    }
+  }
+
+  std::vector<std::shared_ptr<MappedSegment>> loaded;
+  if (manifestValid) {
+    for (const auto& meta : listed) {
+      auto segment =
+          MappedSegment::open(pathFor(segmentFileName(meta.segmentId)));
+      if (!segment) {
+        std::cerr << "⚠️  Сегмент " << meta.segmentId
+                  << " из манифеста недоступен, пропускаю" << std::endl;
+        continue;
+      }
+      loaded.push_back(std::move(segment));
+    }
+  } else {
+    // Манифеста нет или он битый: собираем список по самим сегментам.
+    // Сегмент, покрытый более новым (результат компакции), отбрасываем.
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(options_.directory, ec)) {
+      std::string name = entry.path().filename().string();
+      if (!isSegmentFile(name)) continue;
+      if (auto segment = MappedSegment::open(entry.path().string())) {
+        loaded.push_back(std::move(segment));
+      }
+    }
+
+    std::sort(loaded.begin(), loaded.end(), [](const auto& a, const auto& b) {
+      return a->meta().segmentId > b->meta().segmentId;
+    });
+
+    std::vector<std::shared_ptr<MappedSegment>> kept;
+    for (const auto& segment : loaded) {
+      const auto& meta = segment->meta();
+      bool covered = std::any_of(kept.begin(), kept.end(), [&](const auto& k) {
+        return k->meta().deviceId == meta.deviceId &&
+               k->meta().minTimestampUs <= meta.minTimestampUs &&
+               k->meta().maxTimestampUs >= meta.maxTimestampUs;
+      });
+      if (!covered) kept.push_back(segment);
+    }
+    loaded.swap(kept);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& segment : loaded) {
+      nextSegmentId_ = std::max(nextSegmentId_, segment->meta().segmentId + 1);
+      insertSorted(series_[segment->meta().deviceId].segments, segment);
+    }
+  }
+
+  removeOrphanFiles();
+
+  if (!manifestValid) {
+    // Фиксируем восстановленное (или пустое) состояние
+    std::string manifest;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      manifest = buildManifestLocked();
+    }
+    return writeManifest(manifest);
+  }
+  return true;
+}
+
+void TimeSeriesStore::removeOrphanFiles() {
+  std::set<std::string> known;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [deviceId, series] : series_) {
+      for (const auto& segment : series.segments) {
+        known.insert(fs::path(segment->path()).filename().string());
+      }
+    }
+  }
+
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(options_.directory, ec)) {
+    std::string name = entry.path().filename().string();
+    bool orphanSegment = isSegmentFile(name) && known.count(name) == 0;
+    bool leftover = endsWith(name, ".tmp");
+    if (orphanSegment || leftover) {
+      fs::remove(entry.path(), ec);
+      std::cout << "🧹 Удален незафиксированный файл хранилища: " << name
+                << std::endl;
+    }
+  }
+}
+
+}  // namespace iot_core::storage
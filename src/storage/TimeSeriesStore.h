@@ -0,0 +1,125 @@
+// src/storage/TimeSeriesStore.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "GorillaCodec.h"
+#include "Segment.h"
+
+namespace iot_core::storage {
+
+/**
+ * @brief Встроенное колоночное хранилище временных рядов
+ *
+ * Для каждого устройства ведется активный блок в памяти (Gorilla-сжатие).
+ * Заполненный блок запечатывается фоновым потоком в файл сегмента,
+ * который затем отображается в память. Список сегментов хранится в
+ * манифесте, который перезаписывается атомарно (tmp + fsync + rename),
+ * поэтому после падения на диске остается согласованное состояние.
+ * Тот же поток периодически сливает мелкие соседние сегменты (компакция).
+ *
+ * Незапечатанные точки живут только в памяти и при аварии теряются.
+ */
+class TimeSeriesStore {
+ public:
+  struct Options {
+    std::string directory = "data/tsdb";
+    size_t segmentMaxPoints = 4096;
+    std::chrono::seconds segmentMaxAge{3600};
+    size_t compactionMinPoints = 1024;
+    size_t compactionTargetPoints = 65536;
+    std::chrono::seconds compactionInterval{300};
+  };
+
+  struct Statistics {
+    size_t devices = 0;
+    size_t segments = 0;
+    uint64_t activePoints = 0;
+    uint64_t sealedPoints = 0;
+    uint64_t diskBytes = 0;
+    uint64_t segmentsSealed = 0;
+    uint64_t compactions = 0;
+    uint64_t segmentsSkipped = 0;  // отсечено по метаданным при запросах
+  };
+
+  explicit TimeSeriesStore(Options options);
+  ~TimeSeriesStore();
+
+  TimeSeriesStore(const TimeSeriesStore&) = delete;
+  TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+  // Открытие: чтение манифеста, mmap сегментов, запуск фонового потока
+  bool open();
+  // Запечатывает все активные блоки и останавливает фоновый поток
+  void close();
+  bool isOpen() const { return open_; }
+
+  void append(const std::string& deviceId, const DataPoint& point);
+
+  /**
+   * @brief Точки устройства из [fromUs, toUs], от новых к старым
+   * @param limit Максимум точек (0 - без ограничения)
+   */
+  std::vector<DataPoint> query(const std::string& deviceId, int64_t fromUs,
+                               int64_t toUs, size_t limit = 0) const;
+
+  // Сколько точек устройства доступно (для выбора источника истории)
+  uint64_t pointCount(const std::string& deviceId) const;
+
+  // Принудительное запечатывание и компакция (используется и в тестах)
+  void flush();
+  void compact();
+
+  Statistics getStatistics() const;
+
+ private:
+  struct DeviceSeries {
+    std::unique_ptr<SeriesEncoder> active;
+    std::chrono::steady_clock::time_point activeSince;
+    // Заполненные блоки, ожидающие записи на диск (доступны запросам)
+    std::vector<std::shared_ptr<const SeriesEncoder>> sealing;
+    // Отсортированы по времени
+    std::vector<std::shared_ptr<MappedSegment>> segments;
+  };
+
+  void maintenanceLoop();
+  void sealPending(bool sealActive);
+  bool compactDevice(const std::string& deviceId);
+
+  bool loadManifest();
+  // Вызывать под mutex_
+  std::string buildManifestLocked() const;
+  // Атомарная замена манифеста: tmp + fsync + rename + fsync каталога
+  bool writeManifest(const std::string& content);
+  void removeOrphanFiles();
+
+  std::string pathFor(const std::string& fileName) const;
+
+  Options options_;
+  std::atomic<bool> open_{false};
+
+  mutable std::mutex mutex_;  // защищает series_ и статистику
+  std::unordered_map<std::string, DeviceSeries> series_;
+  uint64_t nextSegmentId_ = 1;
+  mutable Statistics statistics_;
+
+  // Сериализует запись сегментов и манифеста
+  std::mutex manifestMutex_;
+
+  std::thread maintenanceThread_;
+  std::condition_variable maintenanceCv_;
+  std::mutex maintenanceMutex_;
+  bool sealRequested_ = false;
+  std::atomic<bool> stopRequested_{false};
+};
+
+}  // namespace iot_core::storage
@@ -1,6 +1,8 @@
 #include "Formatter.h"
 
+#include <ctime>
 #include <iomanip>
+#include <map>
 #include <sstream>
 #include <vector>
 
@@ -18,6 +20,52 @@ std::string Formatter::formatHumidity(double value) {
   return oss.str();
 }
 
+std::string Formatter::formatTimestamp(int64_t timestampUs) {
+  std::time_t seconds = static_cast<std::time_t>(timestampUs / 1000000);
+  std::tm local{};
+  localtime_r(&seconds, &local);
+
+  std::ostringstream oss;
+  oss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
+  return oss.str();
+}
+
+bool Formatter::parseTimestamp(const std::string& text,
+                               int64_t& timestampUs) {
+  std::tm local{};
+  std::istringstream iss(text);
+  iss >> std::get_time(&local, "%Y-%m-%d %H:%M:%S");
+  if (iss.fail()) {
+    return false;
+  }
+
+  local.tm_isdst = -1;
+  std::time_t seconds = std::mktime(&local);
+  if (seconds == static_cast<std::time_t>(-1)) {
+    return false;
+  }
+
+  timestampUs = static_cast<int64_t>(seconds) * 1000000;
+  return true;
+}
+
+int64_t Formatter::toLocalWallClock(int64_t timestampUs) {
+  std::time_t seconds = static_cast<std::time_t>(timestampUs / 1000000);
+  std::tm local{};
+  localtime_r(&seconds, &local);
+  return timestampUs + static_cast<int64_t>(local.tm_gmtoff) * 1000000;
+}
+
+int64_t Formatter::fromLocalWallClock(int64_t wallClockUs) {
+  std::time_t seconds = static_cast<std::time_t>(wallClockUs / 1000000);
+  std::tm local{};
+  gmtime_r(&seconds, &local);
+  local.tm_isdst = -1;
+  std::time_t timestamp = std::mktime(&local);
+  return static_cast<int64_t>(timestamp) * 1000000 +
+         wallClockUs % 1000000;
+}
+
 std::string Formatter::formatTelemetryMessage(const models::IoTData& data) {
   std::ostringstream oss;
 
@@ -44,7 +92,7 @@ std::string Formatter::formatTelemetryMessage(const models::IoTData& data) {
       << tempEmoji << " Температура: *" << formatTemperature(data.temperature)
       << "*\n"
       << humEmoji << " Влажность: *" << formatHumidity(data.humidity) << "*\n"
-      << "⏰ Время: " << data.timestamp << "\n";
+      << "⏰ Время: " << formatTimestamp(data.timestampUs) << "\n";
 
   return oss.str();
 }
@@ -85,6 +133,162 @@ std::string Formatter::formatAlertMessage(const std::string& deviceId,
   return oss.str();
 }
 
+std::string Formatter::formatResolvedMessage(const std::string& deviceId,
+                                             double value,
+                                             const std::string& metricType,
+                                             const std::string& direction) {
+  bool temperature = metricType == "temperature";
+
+  std::ostringstream oss;
+  oss << "✅ *НОРМА ВОССТАНОВЛЕНА*\n\n"
+      << "📟 Устройство: `" << deviceId << "`\n"
+      << "📊 Показание: *"
+      << (temperature ? formatTemperature(value) : formatHumidity(value))
+      << "*\n"
+      << "ℹ️  Было: " << (temperature ? "Температура" : "Влажность") << " "
+      << (direction == "above" ? "выше порога" : "ниже порога") << "\n";
+
+  return oss.str();
+}
+
+std::string Formatter::formatDeviceStatusMessage(const std::string& deviceId,
+                                                 bool online,
+                                                 double silentSeconds) {
+  std::ostringstream oss;
+  oss << (online ? "📶 *УСТРОЙСТВО СНОВА В СЕТИ*\n\n"
+                 : "📴 *УСТРОЙСТВО НЕ В СЕТИ*\n\n")
+      << "📟 Устройство: `" << deviceId << "`\n"
+      << "⏱ " << (online ? "Не было данных: " : "Нет данных: ")
+      << formatDuration(silentSeconds) << "\n";
+  return oss.str();
+}
+
+std::string Formatter::formatAnomalyMessage(const std::string& deviceId,
+                                            double value,
+                                            const std::string& metricType) {
+  bool temperature = metricType == "temperature";
+
+  std::ostringstream oss;
+  oss << "📈 *АНОМАЛЬНОЕ ПОКАЗАНИЕ*\n\n"
+      << "📟 Устройство: `" << deviceId << "`\n"
+      << "📊 Показание: *"
+      << (temperature ? formatTemperature(value) : formatHumidity(value))
+      << "*\n"
+      << "⚠️  " << (temperature ? "Температура" : "Влажность")
+      << " резко отличается от обычных значений устройства\n";
+  return oss.str();
+}
+
+std::string Formatter::formatDuration(double seconds) {
+  auto total = static_cast<int64_t>(seconds < 0 ? 0 : seconds);
+  if (total < 60) {
+    return std::to_string(total) + " с";
+  }
+  int64_t minutes = total / 60;
+  if (minutes < 60) {
+    return std::to_string(minutes) + " мин";
+  }
+  std::string result = std::to_string(minutes / 60) + " ч";
+  if (minutes % 60 != 0) {
+    result += " " + std::to_string(minutes % 60) + " мин";
+  }
+  return result;
+}
+
+std::string Formatter::formatSuppressedNote(uint32_t suppressed) {
+  if (suppressed == 0) {
+    return "";
+  }
+  return "\n🔕 Пропущено из-за лимита частоты: " + std::to_string(suppressed) +
+         " оповещ.\n";
+}
+
+std::string Formatter::formatAlertDigest(
+    const std::vector<models::AlertEvent>& alerts) {
+  // Telegram ограничивает сообщение 4096 символами
+  constexpr size_t kMaxLines = 40;
+
+  std::map<std::string, std::vector<const models::AlertEvent*>> byDevice;
+  for (const auto& alert : alerts) {
+    byDevice[alert.deviceId].push_back(&alert);
+  }
+
+  std::ostringstream oss;
+  oss << "🚨 *СВОДКА ОПОВЕЩЕНИЙ* (" << alerts.size() << " для "
+      << byDevice.size() << " устр.)\n";
+
+  size_t shown = 0;
+  for (const auto& [deviceId, events] : byDevice) {
+    if (shown >= kMaxLines) {
+      break;
+    }
+    oss << "\n📟 `" << deviceId << "`\n";
+
+    for (const auto* event : events) {
+      if (shown >= kMaxLines) {
+        break;
+      }
+      ++shown;
+
+      if (event->metricType == "connectivity") {
+        oss << "  " << (event->resolved ? "📶 снова в сети" : "📴 нет данных")
+            << " " << formatDuration(event->value);
+        if (event->timestampUs > 0) {
+          oss << " (" << formatTimestamp(event->timestampUs).substr(11) << ")";
+        }
+        oss << "\n";
+        continue;
+      }
+
+      bool temperature = event->metricType == "temperature";
+      if (event->direction == "anomaly") {
+        oss << "  📈 "
+            << (temperature ? formatTemperature(event->value)
+                            : formatHumidity(event->value))
+            << " - " << (temperature ? "температура" : "влажность")
+            << " необычна для устройства";
+        if (event->timestampUs > 0) {
+          oss << " (" << formatTimestamp(event->timestampUs).substr(11)
+              << ")";
+        }
+        oss << "\n";
+        continue;
+      }
+
+      bool above = event->direction == "above";
+      const char* emoji =
+          temperature ? (above ? "🔥" : "❄️") : (above ? "💦" : "🏜️");
+      if (event->resolved) {
+        emoji = "✅";
+      }
+
+      oss << "  " << emoji << " "
+          << (temperature ? formatTemperature(event->value)
+                          : formatHumidity(event->value))
+          << " - " << (temperature ? "температура" : "влажность") << " "
+          << (event->resolved ? "снова в норме"
+                              : (above ? "выше порога" : "ниже порога"));
+      if (event->timestampUs > 0) {
+        // Только время: дата у всех записей сводки одна
+        oss << " (" << formatTimestamp(event->timestampUs).substr(11) << ")";
+      }
+      oss << "\n";
+    }
+  }
+
+  if (shown < alerts.size()) {
+    oss << "\n…и еще " << alerts.size() - shown << " оповещений\n";
+  }
+
+  uint32_t suppressed = 0;
+  for (const auto& alert : alerts) {
+    suppressed += alert.suppressedBefore;
+  }
+  oss << formatSuppressedNote(suppressed);
+
+  return oss.str();
+}
+
 // Дополнительные методы для специфичных типов оповещений
 std::string Formatter::formatTemperatureAlert(const std::string& deviceId,
                                               double temperature,
@@ -111,7 +315,7 @@ std::string Formatter::createWelcomeMessage() {
 
 📊 *Работа с данными:*
 /last - Последние показания
-/history - История данных
+/history <device_id> [часы] - История данных
 /stats - Статистика
 
 ⚙️ *Настройка оповещений:*
@@ -154,9 +358,16 @@ std::string Formatter::createHelpMessage() {
 
 2. Проверить текущие данные:
    /last
+   /history sensor_01 6
    /stats
 
-3. Протестировать систему:
+3. Объединить устройства в группу и следить за средним:
+   /group_create kitchen
+   /group_add kitchen sensor_01
+   /group_alert kitchen temp mean above 28
+   /groups
+
+4. Протестировать систему:
    /test_hot
    /test_cold
 
@@ -186,6 +397,50 @@ std::string Formatter::formatDeviceList(
   return oss.str();
 }
 
+std::string Formatter::formatGroupList(
+    const std::vector<models::DeviceGroup>& groups,
+    const std::vector<models::GroupAggregate>& aggregates,
+    const std::vector<std::vector<models::GroupAlertRule>>& rules) {
+  if (groups.empty()) {
+    return "📭 *У вас нет групп устройств*\n\n"
+           "Используйте /group_create <имя> чтобы создать группу";
+  }
+
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1);
+  oss << "🏢 *Ваши группы:*\n";
+
+  for (size_t i = 0; i < groups.size(); ++i) {
+    const auto& group = groups[i];
+    oss << "\n*" << group.name << "* (" << group.deviceIds.size()
+        << " устройств)\n";
+
+    const auto& aggregate = aggregates[i];
+    if (aggregate.reporting == 0) {
+      oss << "• Нет свежих показаний\n";
+    } else {
+      oss << "• Температура: " << aggregate.temperatureMin << "…"
+          << aggregate.temperatureMax << "°C (средняя "
+          << aggregate.temperatureMean << "°C)\n"
+          << "• Влажность: " << aggregate.humidityMin << "…"
+          << aggregate.humidityMax << "% (средняя " << aggregate.humidityMean
+          << "%)\n"
+          << "• Отчитываются: " << aggregate.reporting << " из "
+          << aggregate.members << "\n";
+    }
+
+    for (const auto& rule : rules[i]) {
+      bool temperature = rule.metricType == "temperature";
+      oss << "• Оповещение: " << (temperature ? "температура" : "влажность")
+          << " " << rule.aggregate
+          << (rule.direction == "above" ? " > " : " < ")
+          << rule.threshold << (temperature ? "°C" : "%") << "\n";
+    }
+  }
+
+  return oss.str();
+}
+
 std::string Formatter::formatAlertSettings(const models::UserAlert& alert) {
   std::ostringstream oss;
   oss << "⚙️ *Текущие настройки оповещений:*\n\n";
@@ -1,5 +1,6 @@
 // src/utils/Formatter.h
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,11 +13,45 @@ class Formatter {
   static std::string formatTemperature(double value);
   static std::string formatHumidity(double value);
   static std::string formatTelemetryMessage(const models::IoTData& data);
+  // Микросекунды Unix-времени -> "YYYY-MM-DD HH:MM:SS" (локальное время)
+  static std::string formatTimestamp(int64_t timestampUs);
+  // Обратное преобразование; false если строка не в этом формате
+  static bool parseTimestamp(const std::string& text, int64_t& timestampUs);
+  // В БД время хранится как timestamp без зоны в местном времени и
+  // передается числом: микросекунды местных часов, отсчитанные как UTC
+  // (extract(epoch from ...) и to_timestamp(...) AT TIME ZONE 'UTC')
+  static int64_t toLocalWallClock(int64_t timestampUs);
+  static int64_t fromLocalWallClock(int64_t wallClockUs);
   static std::string formatAlertMessage(const std::string& deviceId,
                                         double value,
                                         const std::string& metricType,
                                         const std::string& direction);
 
+  // Значение вернулось в норму после оповещения
+  static std::string formatResolvedMessage(const std::string& deviceId,
+                                           double value,
+                                           const std::string& metricType,
+                                           const std::string& direction);
+
+  // Устройство перестало присылать данные (online = false) или снова в
+  // сети; silentSeconds - сколько данных не было
+  static std::string formatDeviceStatusMessage(const std::string& deviceId,
+                                               bool online,
+                                               double silentSeconds);
+  // Показание резко отличается от обычных значений устройства
+  static std::string formatAnomalyMessage(const std::string& deviceId,
+                                          double value,
+                                          const std::string& metricType);
+  // "45 с", "12 мин", "3 ч 5 мин"
+  static std::string formatDuration(double seconds);
+
+  // Строка о подавленных лимитом оповещениях; пустая если их не было
+  static std::string formatSuppressedNote(uint32_t suppressed);
+
+  // Несколько оповещений одним сообщением, сгруппировано по устройствам
+  static std::string formatAlertDigest(
+      const std::vector<models::AlertEvent>& alerts);
+
   // Специальные методы для конкретных типов оповещений
   static std::string formatTemperatureAlert(const std::string& deviceId,
                                             double temperature,
@@ -29,6 +64,11 @@ class Formatter {
   static std::string createHelpMessage();
   static std::string formatDeviceList(const std::vector<std::string>& devices);
   static std::string formatAlertSettings(const models::UserAlert& alert);
+  // aggregates и rules - по индексу группы
+  static std::string formatGroupList(
+      const std::vector<models::DeviceGroup>& groups,
+      const std::vector<models::GroupAggregate>& aggregates,
+      const std::vector<std::vector<models::GroupAlertRule>>& rules);
 };
 
 }  // namespace iot_core::utils
\ No newline at end of file
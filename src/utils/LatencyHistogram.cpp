@@ -0,0 +1,81 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace iot_core::utils {
+
+size_t LatencyHistogram::bucketFor(uint64_t nanos) {
+  if (nanos == 0) {
+    return 0;
+  }
+  // Номер старшего бита + 1: 1 -> 1, 2..3 -> 2, 4..7 -> 3, ...
+  size_t bucket = 64 - static_cast<size_t>(__builtin_clzll(nanos));
+  return std::min(bucket, kBuckets - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpperNanos(size_t bucket) {
+  return bucket == 0 ? 0 : (uint64_t{1} << bucket) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+  buckets_[bucketFor(nanos)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  totalNanos_.fetch_add(nanos, std::memory_order_relaxed);
+
+  uint64_t max = maxNanos_.load(std::memory_order_relaxed);
+  while (nanos > max && !maxNanos_.compare_exchange_weak(
+                            max, nanos, std::memory_order_relaxed)) {
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+  Snapshot snapshot;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count = count_.load(std::memory_order_relaxed);
+  snapshot.totalNanos = totalNanos_.load(std::memory_order_relaxed);
+  snapshot.maxNanos = maxNanos_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void LatencyHistogram::reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  totalNanos_.store(0, std::memory_order_relaxed);
+  maxNanos_.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::Snapshot::meanNanos() const {
+  return count == 0 ? 0.0
+                    : static_cast<double>(totalNanos) /
+                          static_cast<double>(count);
+}
+
+uint64_t LatencyHistogram::Snapshot::percentileNanos(double q) const {
+  uint64_t total = 0;
+  for (uint64_t bucket : buckets) {
+    total += bucket;
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  auto rank = static_cast<uint64_t>(
+      std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(total)));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      // Граница корзины не больше наблюдавшегося максимума
+      return std::min(bucketUpperNanos(i), maxNanos);
+    }
+  }
+  return maxNanos;
+}
+
+}  // namespace iot_core::utils
@@ -0,0 +1,48 @@
+// src/utils/LatencyHistogram.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace iot_core::utils {
+
+/**
+ * @brief Гистограмма длительностей без блокировок
+ *
+ * Корзины - степени двойки наносекунд: корзина i держит значения из
+ * [2^(i-1), 2^i), последняя - все, что больше. Запись - несколько
+ * relaxed-инкрементов, поэтому ее можно вести на каждом вызове в
+ * горячем пути; снимок читается без остановки писателей и может
+ * немного расходиться между полями.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t kBuckets = 32;  // до ~2 с, дальше - хвост
+
+  struct Snapshot {
+    uint64_t count = 0;
+    uint64_t totalNanos = 0;
+    uint64_t maxNanos = 0;
+    std::array<uint64_t, kBuckets> buckets{};
+
+    double meanNanos() const;
+    // Верхняя граница корзины, где лежит квантиль q (0..1)
+    uint64_t percentileNanos(double q) const;
+  };
+
+  void record(uint64_t nanos);
+  Snapshot snapshot() const;
+  void reset();
+
+  static size_t bucketFor(uint64_t nanos);
+  static uint64_t bucketUpperNanos(size_t bucket);
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> totalNanos_{0};
+  std::atomic<uint64_t> maxNanos_{0};
+};
+
+}  // namespace iot_core::utils
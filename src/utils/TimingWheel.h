@@ -0,0 +1,125 @@
+// src/utils/TimingWheel.h
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace iot_core::utils {
+
+/**
+ * @brief Иерархическое колесо таймеров
+ *
+ * Четыре уровня по 64 слота: уровень 0 покрывает ближайшие 64 тика,
+ * каждый следующий - в 64 раза больший горизонт. Постановка таймера и
+ * срабатывание стоят O(1); записи верхних уровней при переходе через
+ * границу блока переносятся ("каскадируются") на нижние уровни.
+ * Отмены нет: получатель сам проверяет, актуален ли сработавший таймер.
+ *
+ * Не потокобезопасно - синхронизация на стороне владельца.
+ */
+template <typename T>
+class TimingWheel {
+ public:
+  static constexpr int kLevels = 4;
+  static constexpr int kSlotBits = 6;
+  static constexpr size_t kSlots = size_t{1} << kSlotBits;
+
+  explicit TimingWheel(uint64_t startTick = 0) : currentTick_(startTick) {}
+
+  // Срабатывание не раньше expiryTick; прошедший тик - на следующем шаге
+  void schedule(uint64_t expiryTick, T item) {
+    // Слот текущего тика уже обработан
+    place(Node{std::max(expiryTick, currentTick_ + 1), std::move(item)});
+    ++size_;
+  }
+
+  // Продвигает время до toTick, вызывая onExpired для сработавших записей
+  template <typename Fn>
+  void advance(uint64_t toTick, Fn&& onExpired) {
+    while (currentTick_ < toTick) {
+      if (size_ == 0) {
+        currentTick_ = toTick;
+        return;
+      }
+
+      ++currentTick_;
+      cascade();
+
+      auto& slot = levels_[0][currentTick_ & (kSlots - 1)];
+      if (slot.empty()) {
+        continue;
+      }
+
+      std::vector<Node> expired;
+      expired.swap(slot);
+      size_ -= expired.size();
+      for (auto& node : expired) {
+        onExpired(node.item);
+      }
+    }
+  }
+
+  size_t size() const { return size_; }
+  uint64_t currentTick() const { return currentTick_; }
+
+ private:
+  struct Node {
+    uint64_t expiryTick;
+    T item;
+  };
+
+  // Срок не раньше текущего тика (слот текущего тика еще не обработан
+  // только во время каскадирования)
+  void place(Node node) {
+    // Самый нижний уровень, в блоке которого лежат и текущий тик, и срок
+    for (int level = 0; level < kLevels; ++level) {
+      int shift = kSlotBits * (level + 1);
+      if (((node.expiryTick ^ currentTick_) >> shift) == 0) {
+        size_t index = (node.expiryTick >> (kSlotBits * level)) & (kSlots - 1);
+        levels_[level][index].push_back(std::move(node));
+        return;
+      }
+    }
+    overflow_.push_back(std::move(node));
+  }
+
+  // Переносит записи слотов, чей блок только что начался
+  void cascade() {
+    int top = 0;
+    while (top < kLevels &&
+           ((currentTick_ >> (kSlotBits * top)) & (kSlots - 1)) == 0) {
+      ++top;
+    }
+
+    if (top == kLevels && !overflow_.empty()) {
+      std::vector<Node> pending;
+      pending.swap(overflow_);
+      for (auto& node : pending) {
+        place(std::move(node));
+      }
+    }
+
+    for (int level = std::min(top, kLevels - 1); level >= 1; --level) {
+      size_t index = (currentTick_ >> (kSlotBits * level)) & (kSlots - 1);
+      auto& slot = levels_[level][index];
+      if (slot.empty()) {
+        continue;
+      }
+      std::vector<Node> pending;
+      pending.swap(slot);
+      for (auto& node : pending) {
+        place(std::move(node));
+      }
+    }
+  }
+
+  std::array<std::array<std::vector<Node>, kSlots>, kLevels> levels_;
+  std::vector<Node> overflow_;
+  uint64_t currentTick_;
+  size_t size_ = 0;
+};
+
+}  // namespace iot_core::utils
@@ -0,0 +1,131 @@
+// Сравнение условий правил: std::function (как в фабриках RuleEngine)
+// против байткода RuleProgram на одинаковых показаниях, построчно и
+// масками по колонкам блоков (RuleProgram::evaluateColumns).
+//
+//   cmake -S . -B build -DBUILD_BENCHMARKS=ON && cmake --build build
+//   ./build/rule_bench [число показаний]
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/engine/BatchKernels.h"
+#include "../../src/engine/RuleProgram.h"
+
+using iot_core::engine::kBatchBlock;
+using iot_core::engine::RuleProgram;
+using iot_core::models::IoTData;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  double nsPerReading = 0.0;
+  size_t matches = 0;
+};
+
+template <typename Evaluate>
+Result measure(const std::vector<IoTData>& readings, size_t rules,
+               Evaluate&& evaluate) {
+  Result result;
+  auto start = Clock::now();
+  for (const auto& data : readings) {
+    for (size_t i = 0; i < rules; ++i) {
+      result.matches += evaluate(i, data) ? 1 : 0;
+    }
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+  result.nsPerReading = elapsed.count() / static_cast<double>(readings.size());
+  return result;
+}
+
+Result measureColumns(const std::vector<IoTData>& readings,
+                      const std::vector<RuleProgram>& programs) {
+  Result result;
+  double temperature[kBatchBlock];
+  double humidity[kBatchBlock];
+  const double* const columns[] = {temperature, humidity};
+
+  auto start = Clock::now();
+  for (size_t begin = 0; begin < readings.size(); begin += kBatchBlock) {
+    size_t count = std::min(kBatchBlock, readings.size() - begin);
+    for (size_t i = 0; i < count; ++i) {
+      temperature[i] = readings[begin + i].temperature;
+      humidity[i] = readings[begin + i].humidity;
+    }
+    for (const auto& program : programs) {
+      result.matches +=
+          std::bitset<64>(program.evaluateColumns(columns, count)).count();
+    }
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+  result.nsPerReading = elapsed.count() / static_cast<double>(readings.size());
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<double> temperature(5.0, 40.0);
+  std::uniform_real_distribution<double> humidity(10.0, 95.0);
+  std::vector<IoTData> readings(count);
+  for (auto& data : readings) {
+    data.deviceId = "sensor";
+    data.temperature = temperature(random);
+    data.humidity = humidity(random);
+  }
+
+  // Правила по умолчанию и одно составное
+  std::vector<std::function<bool(const IoTData&)>> functions = {
+      [](const IoTData& d) { return d.temperature > 28.0; },
+      [](const IoTData& d) { return d.temperature < 15.0; },
+      [](const IoTData& d) { return d.humidity > 70.0; },
+      [](const IoTData& d) { return d.humidity < 30.0; },
+      [](const IoTData& d) { return d.temperature > 28 && d.humidity > 60; },
+  };
+  std::vector<RuleProgram> programs = {
+      RuleProgram::compile("temperature > 28"),
+      RuleProgram::compile("temperature < 15"),
+      RuleProgram::compile("humidity > 70"),
+      RuleProgram::compile("humidity < 30"),
+      RuleProgram::compile("temperature > 28 && humidity > 60"),
+  };
+
+  // Прогрев
+  measure(readings, functions.size(),
+          [&](size_t i, const IoTData& d) { return functions[i](d); });
+
+  auto viaFunction =
+      measure(readings, functions.size(),
+              [&](size_t i, const IoTData& d) { return functions[i](d); });
+  auto viaProgram = measure(readings, programs.size(),
+                            [&](size_t i, const IoTData& d) {
+                              return programs[i].evaluate(d);
+                            });
+  auto viaColumns = measureColumns(readings, programs);
+
+  std::cout << "readings: " << count << ", rules: " << programs.size() << "\n"
+            << "std::function: " << viaFunction.nsPerReading
+            << " ns/reading (" << viaFunction.matches << " matches)\n"
+            << "RuleProgram:   " << viaProgram.nsPerReading
+            << " ns/reading (" << viaProgram.matches << " matches)\n"
+            << "columns (" << iot_core::engine::batchKernelName()
+            << "): " << viaColumns.nsPerReading << " ns/reading ("
+            << viaColumns.matches << " matches)\n";
+
+  if (viaFunction.matches != viaProgram.matches ||
+      viaFunction.matches != viaColumns.matches) {
+    std::cerr << "results differ" << std::endl;
+    return 1;
+  }
+  return 0;
+}
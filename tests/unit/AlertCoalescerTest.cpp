@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../../src/core/AlertCoalescer.h"
+
+using namespace iot_core::core;
+using namespace iot_core::models;
+using namespace std::chrono_literals;
+
+namespace {
+
+AlertEvent makeAlert(const std::string& deviceId, double value) {
+  AlertEvent alert;
+  alert.deviceId = deviceId;
+  alert.value = value;
+  alert.metricType = "temperature";
+  alert.direction = "above";
+  return alert;
+}
+
+struct Recorder {
+  std::mutex mutex;
+  std::vector<std::pair<long, size_t>> flushes;
+
+  AlertCoalescer::Flush callback() {
+    return [this](long chatId, std::vector<AlertEvent> alerts) {
+      std::lock_guard<std::mutex> lock(mutex);
+      flushes.emplace_back(chatId, alerts.size());
+    };
+  }
+
+  std::vector<std::pair<long, size_t>> snapshot() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flushes;
+  }
+};
+
+}  // namespace
+
+TEST(AlertCoalescerTest, MergesAlertsPerChatWithinWindow) {
+  AlertCoalescer::Options options;
+  options.window = 50ms;
+  AlertCoalescer coalescer(options);
+  Recorder recorder;
+  coalescer.start(recorder.callback());
+
+  for (int i = 0; i < 10; ++i) {
+    coalescer.add(1, makeAlert("sensor_" + std::to_string(i), 30.0 + i));
+  }
+  coalescer.add(2, makeAlert("sensor_0", 31.0));
+
+  EXPECT_TRUE(recorder.snapshot().empty());
+  std::this_thread::sleep_for(200ms);
+
+  auto flushes = recorder.snapshot();
+  std::map<long, size_t> byChat(flushes.begin(), flushes.end());
+  ASSERT_EQ(flushes.size(), 2u);
+  EXPECT_EQ(byChat[1], 10u);
+  EXPECT_EQ(byChat[2], 1u);
+
+  auto stats = coalescer.getStatistics();
+  EXPECT_EQ(stats.alerts, 11u);
+  EXPECT_EQ(stats.flushes, 2u);
+  EXPECT_EQ(stats.openWindows, 0u);
+}
+
+TEST(AlertCoalescerTest, FlushesFullBatchAndRemainderOnStop) {
+  AlertCoalescer::Options options;
+  options.window = 1h;
+  options.maxBatch = 4;
+  AlertCoalescer coalescer(options);
+  Recorder recorder;
+  coalescer.start(recorder.callback());
+
+  for (int i = 0; i < 6; ++i) {
+    coalescer.add(7, makeAlert("sensor_01", i));
+  }
+
+  // Полная пачка уходит сразу, остаток ждет окна
+  auto flushes = recorder.snapshot();
+  ASSERT_EQ(flushes.size(), 1u);
+  EXPECT_EQ(flushes[0].second, 4u);
+
+  coalescer.stop();
+  flushes = recorder.snapshot();
+  ASSERT_EQ(flushes.size(), 2u);
+  EXPECT_EQ(flushes[1].second, 2u);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+#include "../../src/services/AlertDeduplicator.h"
+#include "../../src/utils/TimingWheel.h"
+
+using iot_core::services::AlertDeduplicator;
+using iot_core::services::AlertKind;
+using iot_core::utils::TimingWheel;
+
+namespace {
+
+AlertDeduplicator::Clock::time_point at(int64_t seconds) {
+  return AlertDeduplicator::Clock::time_point(std::chrono::seconds(seconds));
+}
+
+}  // namespace
+
+TEST(TimingWheelTest, FiresAcrossAllLevels) {
+  TimingWheel<int> wheel(1000);
+  std::vector<uint64_t> deadlines = {1001, 1063, 1064, 5000, 300000, 20000000};
+  for (size_t i = 0; i < deadlines.size(); ++i) {
+    wheel.schedule(deadlines[i], static_cast<int>(i));
+  }
+  EXPECT_EQ(wheel.size(), deadlines.size());
+
+  std::vector<std::pair<uint64_t, int>> fired;
+  for (uint64_t tick : {1000ull, 1063ull, 1064ull, 4999ull, 5000ull,
+                        299999ull, 300000ull, 20000000ull}) {
+    wheel.advance(tick, [&](int item) {
+      fired.emplace_back(wheel.currentTick(), item);
+    });
+  }
+
+  ASSERT_EQ(fired.size(), deadlines.size());
+  for (const auto& [tick, item] : fired) {
+    EXPECT_EQ(tick, deadlines[item]);
+  }
+  EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(AlertDeduplicatorTest, SuppressesUntilCooldownExpires) {
+  AlertDeduplicator::Options options;
+  options.cooldown = std::chrono::seconds(60);
+  AlertDeduplicator dedup(options);
+
+  EXPECT_TRUE(dedup.tryAcquire(1, "sensor_1", AlertKind::TemperatureHigh,
+                               at(1000)));
+  EXPECT_FALSE(dedup.tryAcquire(1, "sensor_1", AlertKind::TemperatureHigh,
+                                at(1059)));
+  // Другой тип, устройство или пользователь - независимые ключи
+  EXPECT_TRUE(
+      dedup.tryAcquire(1, "sensor_1", AlertKind::HumidityLow, at(1001)));
+  EXPECT_TRUE(
+      dedup.tryAcquire(1, "sensor_2", AlertKind::TemperatureHigh, at(1001)));
+  EXPECT_TRUE(
+      dedup.tryAcquire(2, "sensor_1", AlertKind::TemperatureHigh, at(1001)));
+
+  EXPECT_TRUE(dedup.tryAcquire(1, "sensor_1", AlertKind::TemperatureHigh,
+                               at(1060)));
+  auto stats = dedup.getStatistics();
+  EXPECT_EQ(stats.suppressed, 1u);
+  EXPECT_EQ(stats.entries, 4u);
+}
+
+TEST(AlertDeduplicatorTest, ExpiresEntriesAndRoundTripsSnapshot) {
+  AlertDeduplicator::Options options;
+  options.cooldown = std::chrono::seconds(30);
+  options.shards = 4;
+  AlertDeduplicator dedup(options);
+
+  // Рост таблиц при множестве ключей
+  for (long user = 0; user < 500; ++user) {
+    ASSERT_TRUE(dedup.tryAcquire(user, "sensor_" + std::to_string(user % 7),
+                                 AlertKind::TemperatureLow, at(2000)));
+  }
+  EXPECT_EQ(dedup.getStatistics().entries, 500u);
+
+  auto entries = dedup.entries(at(2010));
+  ASSERT_EQ(entries.size(), 500u);
+
+  AlertDeduplicator restored(options);
+  for (const auto& entry : entries) {
+    restored.restore(entry, at(2010));
+  }
+  EXPECT_FALSE(restored.tryAcquire(42, "sensor_0", AlertKind::TemperatureLow,
+                                   at(2020)));
+
+  // После истечения колеса шардов удаляют старые записи
+  for (long user = 0; user < 500; ++user) {
+    EXPECT_TRUE(dedup.tryAcquire(user, "sensor_" + std::to_string(user % 7),
+                                 AlertKind::TemperatureLow, at(2100)));
+  }
+  auto stats = dedup.getStatistics();
+  EXPECT_EQ(stats.expired, 500u);
+  EXPECT_EQ(stats.entries, 500u);
+}
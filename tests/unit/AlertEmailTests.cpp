@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -100,6 +101,40 @@ TEST(EmailServiceTests, HumanHelpers_WorkAsExpected) {
   EXPECT_EQ(service.getEmoji("humidity", "below"), "🏜️");
 }
 
+TEST(EmailServiceTests, BuildMessage_ListsAllRecipients) {
+  std::string message = EmailService::buildMessage(
+      "iot@example.com", {"a@example.com", "b@example.com", "c@example.com"},
+      "Subject", "Body", false);
+
+  EXPECT_TRUE(
+      contains(message, "To: a@example.com, b@example.com, c@example.com\r\n"));
+  EXPECT_TRUE(contains(message, "From: iot@example.com\r\n"));
+  EXPECT_TRUE(contains(message, "text/plain"));
+}
+
+TEST(EmailServiceTests, DigestBody_ContainsEveryAlert) {
+  EmailService service;
+
+  std::vector<iot_core::models::AlertEvent> alerts(2);
+  alerts[0].deviceId = "device-1";
+  alerts[0].value = 31.5;
+  alerts[0].metricType = "temperature";
+  alerts[0].direction = "above";
+  alerts[1].deviceId = "device-2";
+  alerts[1].value = 12.0;
+  alerts[1].metricType = "humidity";
+  alerts[1].direction = "below";
+
+  std::string body = service.formatDigestBody(alerts);
+
+  EXPECT_TRUE(contains(body, "IoT Platform Alert Digest"));
+  EXPECT_TRUE(contains(body, "device-1"));
+  EXPECT_TRUE(contains(body, "31.5 °C"));
+  EXPECT_TRUE(contains(body, "device-2"));
+  EXPECT_TRUE(contains(body, "12 %"));
+  EXPECT_TRUE(contains(body, "🏜️"));
+}
+
 // ================== AlertProcessingService: shouldNotify ============
 
 TEST(AlertProcessingServiceTests, ShouldNotify_PreventsDuplicates) {
@@ -123,3 +158,35 @@ TEST(AlertProcessingServiceTests, ShouldNotify_PreventsDuplicates) {
   bool different = service.shouldNotify(userId, deviceId, "hum_low", 10.0);
   EXPECT_TRUE(different);
 }
+
+// ================== AlertProcessingService: контакты ================
+
+TEST(AlertProcessingServiceTests, IngestedReadings_RefreshHeartbeats) {
+  auto db = std::make_shared<iot_core::core::DatabaseRepository>("");
+  std::shared_ptr<iot_core::core::NotificationService> notifier;  // nullptr
+
+  AlertProcessingService service(db, notifier, std::chrono::seconds(300), 1);
+  iot_core::services::HeartbeatMonitor::Options options;
+  options.timeout = std::chrono::seconds(60);
+  auto heartbeats =
+      std::make_shared<iot_core::services::HeartbeatMonitor>(options);
+  service.attachHeartbeatMonitor(heartbeats);
+
+  // Показание мимо движка правил (прием, повтор журнала)
+  service.processTelemetryData("dev-A", 22.0, 50.0);
+  service.drain();
+  EXPECT_EQ(heartbeats->getStatistics().tracked, 1u);
+
+  int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+  auto events = heartbeats->advance(nowUs + int64_t{120} * 1000000);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].deviceId, "dev-A");
+
+  // Следующее показание возвращает устройство в сеть
+  service.processTelemetryData("dev-A", 22.5, 50.0);
+  service.drain();
+  EXPECT_EQ(heartbeats->getStatistics().offline, 0u);
+  EXPECT_EQ(service.getStatistics().onlineAlerts, 1);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/services/AlertRateLimiter.h"
+
+using namespace iot_core::services;
+using namespace std::chrono_literals;
+
+TEST(AlertRateLimiterTest, ChatBucketLimitsAndReportsSuppressed) {
+  AlertRateLimiter::Options options;
+  options.maxPerHourPerChat = 3;
+  options.maxPerHourPerDevice = 0;
+  options.maxPerHourGlobal = 0;
+  AlertRateLimiter limiter(options);
+
+  auto now = AlertRateLimiter::Clock::now();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(limiter.tryAcquire(1, "sensor", now).allowed);
+  }
+  EXPECT_FALSE(limiter.tryAcquire(1, "sensor", now).allowed);
+  EXPECT_FALSE(limiter.tryAcquire(1, "sensor", now).allowed);
+  // Другой чат не затронут
+  EXPECT_TRUE(limiter.tryAcquire(2, "sensor", now).allowed);
+
+  // Токен пополняется за час / емкость = 20 минут
+  auto later = limiter.tryAcquire(1, "sensor", now + 20min);
+  EXPECT_TRUE(later.allowed);
+  EXPECT_EQ(later.suppressedBefore, 2u);
+  EXPECT_EQ(limiter.tryAcquire(1, "sensor", now + 20min).suppressedBefore, 0u);
+
+  auto stats = limiter.getStatistics();
+  EXPECT_EQ(stats.allowed, 5u);
+  EXPECT_EQ(stats.suppressedByChat, 3u);
+}
+
+TEST(AlertRateLimiterTest, DeviceAndGlobalBucketsSpanChats) {
+  AlertRateLimiter::Options options;
+  options.maxPerHourPerChat = 100;
+  options.maxPerHourPerDevice = 2;
+  options.maxPerHourGlobal = 3;
+  AlertRateLimiter limiter(options);
+
+  auto now = AlertRateLimiter::Clock::now();
+  EXPECT_TRUE(limiter.tryAcquire(1, "noisy", now).allowed);
+  EXPECT_TRUE(limiter.tryAcquire(2, "noisy", now).allowed);
+  EXPECT_FALSE(limiter.tryAcquire(3, "noisy", now).allowed);
+
+  EXPECT_TRUE(limiter.tryAcquire(3, "quiet", now).allowed);
+  EXPECT_FALSE(limiter.tryAcquire(4, "other", now).allowed);
+
+  auto stats = limiter.getStatistics();
+  EXPECT_EQ(stats.suppressedByDevice, 1u);
+  EXPECT_EQ(stats.suppressedGlobal, 1u);
+}
+
+TEST(AlertRateLimiterTest, GlobalBucketHoldsUnderConcurrency) {
+  AlertRateLimiter::Options options;
+  options.maxPerHourPerChat = 0;
+  options.maxPerHourPerDevice = 0;
+  options.maxPerHourGlobal = 500;
+  AlertRateLimiter limiter(options);
+
+  // Разные чаты и устройства - общая корзина одна на все потоки
+  auto now = AlertRateLimiter::Clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&limiter, now, t] {
+      for (int i = 0; i < 200; ++i) {
+        limiter.tryAcquire(t * 1000 + i, "sensor-" + std::to_string(i), now);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = limiter.getStatistics();
+  EXPECT_EQ(stats.allowed, 500u);
+  EXPECT_EQ(stats.suppressedGlobal, 1100u);
+  // Токен пополняется за час / емкость = 7.2 секунды
+  EXPECT_TRUE(limiter.tryAcquire(1, "sensor", now + 8s).allowed);
+  EXPECT_FALSE(limiter.tryAcquire(2, "sensor", now + 8s).allowed);
+}
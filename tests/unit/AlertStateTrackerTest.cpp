@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "../../src/services/AlertStateTracker.h"
+
+using namespace iot_core::services;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Phase = AlertStateTracker::Phase;
+using Transition = AlertStateTracker::Transition;
+
+constexpr int64_t kSecondUs = 1000000;
+
+AlertStateTracker::Options testOptions() {
+  AlertStateTracker::Options options;
+  options.temperatureHysteresis = 1.0;
+  options.recoveryDwell = 10s;
+  return options;
+}
+
+}  // namespace
+
+TEST(AlertStateTrackerTest, FlappingAroundThresholdAlertsOnce) {
+  AlertStateTracker tracker(testOptions());
+  int triggered = 0;
+
+  // Колебания 29.5..30.5 вокруг порога 30 за час
+  for (int i = 0; i < 3600; ++i) {
+    double value = (i % 2 == 0) ? 30.5 : 29.5;
+    if (tracker.update(1, "sensor", AlertKind::TemperatureHigh, value, 30.0,
+                       i * kSecondUs) == Transition::Triggered) {
+      ++triggered;
+    }
+  }
+
+  EXPECT_EQ(triggered, 1);
+  EXPECT_EQ(tracker.phase(1, "sensor", AlertKind::TemperatureHigh),
+            Phase::Alerting);
+}
+
+TEST(AlertStateTrackerTest, ResolvesAfterDwellBelowBand) {
+  AlertStateTracker tracker(testOptions());
+  auto kind = AlertKind::TemperatureHigh;
+
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 35.0, 30.0, 0),
+            Transition::Triggered);
+  tracker.markNotified(1, "sensor", kind);
+  EXPECT_EQ(tracker.activeCount(), 1u);
+
+  // Ниже порога, но в полосе гистерезиса - восстановления нет
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 29.5, 30.0, 1 * kSecondUs),
+            Transition::None);
+  EXPECT_EQ(tracker.phase(1, "sensor", kind), Phase::Alerting);
+
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 28.0, 30.0, 2 * kSecondUs),
+            Transition::None);
+  EXPECT_EQ(tracker.phase(1, "sensor", kind), Phase::Recovering);
+
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 28.0, 30.0, 5 * kSecondUs),
+            Transition::None);
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 28.0, 30.0, 12 * kSecondUs),
+            Transition::Resolved);
+  EXPECT_EQ(tracker.phase(1, "sensor", kind), Phase::Normal);
+  EXPECT_EQ(tracker.activeCount(), 0u);
+}
+
+TEST(AlertStateTrackerTest, SuppressedAlertRecoversSilently) {
+  AlertStateTracker tracker(testOptions());
+  auto kind = AlertKind::TemperatureHigh;
+
+  // Оповещение подавлено (cooldown, лимит) - markNotified не вызван
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 35.0, 30.0, 0),
+            Transition::Triggered);
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 28.0, 30.0, kSecondUs),
+            Transition::None);
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 28.0, 30.0, 12 * kSecondUs),
+            Transition::None);
+  EXPECT_EQ(tracker.phase(1, "sensor", kind), Phase::Normal);
+
+  // Следующая тревога оповещается заново и восстанавливается с сообщением
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 35.0, 30.0, 20 * kSecondUs),
+            Transition::Triggered);
+  tracker.markNotified(1, "sensor", kind);
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 28.0, 30.0, 21 * kSecondUs),
+            Transition::None);
+  EXPECT_EQ(tracker.update(1, "sensor", kind, 28.0, 30.0, 32 * kSecondUs),
+            Transition::Resolved);
+}
+
+TEST(AlertStateTrackerTest, LowThresholdAndDisabledRule) {
+  AlertStateTracker tracker(testOptions());
+  auto kind = AlertKind::TemperatureLow;
+
+  EXPECT_EQ(tracker.update(2, "sensor", kind, 10.0, 15.0, 0),
+            Transition::Triggered);
+  // Порог снят - тревога сбрасывается молча
+  EXPECT_EQ(tracker.update(2, "sensor", kind, 10.0, 0.0, kSecondUs),
+            Transition::None);
+  EXPECT_EQ(tracker.phase(2, "sensor", kind), Phase::Normal);
+  EXPECT_EQ(tracker.activeCount(), 0u);
+}
+
+TEST(AlertStateTrackerTest, EntriesRoundTrip) {
+  AlertStateTracker source(testOptions());
+  source.update(1, "a", AlertKind::HumidityHigh, 80.0, 70.0, 5);
+  source.update(1, "b", AlertKind::HumidityHigh, 60.0, 70.0, 5);
+
+  auto entries = source.entries();
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0].deviceId, "a");
+  EXPECT_EQ(entries[0].alertedAtUs, 5);
+  EXPECT_FALSE(entries[0].notified);
+
+  AlertStateTracker restored(testOptions());
+  restored.restore(entries[0]);
+  EXPECT_EQ(restored.phase(1, "a", AlertKind::HumidityHigh), Phase::Alerting);
+  // Восстановленная тревога не повторяется
+  EXPECT_EQ(restored.update(1, "a", AlertKind::HumidityHigh, 80.0, 70.0, 10),
+            Transition::None);
+}
+
+TEST(AlertStateTrackerTest, ActiveUsersFollowTransitions) {
+  AlertStateTracker tracker(testOptions());
+
+  tracker.update(1, "sensor", AlertKind::TemperatureHigh, 31.0, 30.0, 0);
+  tracker.update(2, "sensor", AlertKind::TemperatureHigh, 31.0, 30.0, 0);
+  tracker.update(3, "sensor", AlertKind::TemperatureLow, 31.0, 30.0, 0);
+  EXPECT_EQ(tracker.activeUsers("sensor", AlertKind::TemperatureHigh).size(),
+            2u);
+  EXPECT_TRUE(tracker.activeUsers("other", AlertKind::TemperatureHigh).empty());
+
+  // Снятый порог и восстановление убирают правило из списка
+  tracker.update(1, "sensor", AlertKind::TemperatureHigh, 31.0, 0.0, 0);
+  tracker.update(2, "sensor", AlertKind::TemperatureHigh, 25.0, 30.0,
+                 kSecondUs);
+  tracker.update(2, "sensor", AlertKind::TemperatureHigh, 25.0, 30.0,
+                 20 * kSecondUs);
+  EXPECT_TRUE(
+      tracker.activeUsers("sensor", AlertKind::TemperatureHigh).empty());
+  EXPECT_EQ(tracker.activeCount(), 0u);
+}
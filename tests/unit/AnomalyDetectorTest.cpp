@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+#include "../../src/engine/AnomalyDetector.h"
+
+using iot_core::engine::AnomalyDetector;
+using iot_core::models::IoTData;
+
+namespace {
+
+IoTData reading(const std::string& deviceId, double temperature,
+                double humidity = 50.0) {
+  IoTData data;
+  data.deviceId = deviceId;
+  data.temperature = temperature;
+  data.humidity = humidity;
+  return data;
+}
+
+AnomalyDetector::Options options(uint32_t warmup) {
+  AnomalyDetector::Options result;
+  result.alpha = 0.05;
+  result.zScore = 4.0;
+  result.warmupSamples = warmup;
+  return result;
+}
+
+}  // namespace
+
+TEST(AnomalyDetectorTest, WarmupLearnsWithoutFlagging) {
+  AnomalyDetector detector(options(5));
+  AnomalyDetector::Result result;
+  // Выбросы во время обучения не сообщаются
+  for (double value : {20.0, 80.0, 20.0, 80.0, 20.0}) {
+    EXPECT_FALSE(detector.observe(reading("a", value), result));
+  }
+  // Среднее 44, отклонение ~29.4: 50 - в пределах
+  EXPECT_FALSE(detector.observe(reading("a", 50.0), result));
+}
+
+TEST(AnomalyDetectorTest, FlagsSpikeAgainstItsOwnDevice) {
+  AnomalyDetector detector(options(30));
+  std::mt19937 random(7);
+  std::normal_distribution<double> noise(0.0, 0.5);
+  AnomalyDetector::Result result;
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_FALSE(detector.observe(reading("cold", 5.0 + noise(random)),
+                                  result));
+    EXPECT_FALSE(detector.observe(reading("hot", 35.0 + noise(random)),
+                                  result));
+  }
+
+  // Нормальное для "hot" значение - аномалия для "cold"
+  ASSERT_TRUE(detector.observe(reading("cold", 35.0), result));
+  EXPECT_EQ(result.metric, AnomalyDetector::Metric::Temperature);
+  EXPECT_NEAR(result.mean, 5.0, 0.5);
+  EXPECT_GT(result.zScore, 4.0);
+
+  ASSERT_TRUE(detector.observe(reading("hot", 35.0, 5.0), result));
+  EXPECT_EQ(result.metric, AnomalyDetector::Metric::Humidity);
+  EXPECT_LT(result.zScore, -4.0);
+
+  auto stats = detector.getStatistics();
+  EXPECT_EQ(stats.devices, 2u);
+  EXPECT_EQ(stats.observed, 402u);
+  EXPECT_EQ(stats.anomalies, 2u);
+}
+
+TEST(AnomalyDetectorTest, SlowDriftIsFollowed) {
+  AnomalyDetector detector(options(10));
+  AnomalyDetector::Result result;
+  double value = 20.0;
+  for (int i = 0; i < 2000; ++i) {
+    // Шум +-0.5 и дрейф 0.01 на показание
+    value += 0.01;
+    double noisy = value + ((i % 2) != 0 ? 0.5 : -0.5);
+    EXPECT_FALSE(detector.observe(reading("sensor", noisy), result)) << i;
+  }
+}
+
+TEST(AnomalyDetectorTest, StateIsCompact) {
+  AnomalyDetector detector(options(30));
+  AnomalyDetector::Result result;
+  constexpr int kDevices = 100000;
+  for (int i = 0; i < kDevices; ++i) {
+    detector.observe(reading("dev-" + std::to_string(i), 20.0), result);
+  }
+  auto stats = detector.getStatistics();
+  EXPECT_EQ(stats.devices, static_cast<size_t>(kDevices));
+  // 18 байт на устройство плюс запас роста vector
+  EXPECT_LE(stats.memoryBytes, 2u * 18u * kDevices);
+}
+
+TEST(AnomalyDetectorTest, EntriesRestoreWithoutWarmup) {
+  AnomalyDetector source(options(30));
+  AnomalyDetector::Result result;
+  for (int i = 0; i < 100; ++i) {
+    source.observe(reading("sensor", (i % 2) != 0 ? 20.5 : 19.5), result);
+  }
+  auto entries = source.entries();
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0].deviceId, "sensor");
+
+  // Восстановленный детектор сразу отличает выброс от нормы
+  AnomalyDetector restored(options(30));
+  restored.restore(entries[0]);
+  EXPECT_FALSE(restored.observe(reading("sensor", 20.5), result));
+  EXPECT_TRUE(restored.observe(reading("sensor", 30.0), result));
+  EXPECT_EQ(restored.getStatistics().devices, 1u);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "../../src/engine/Backtester.h"
+
+using iot_core::engine::Backtester;
+using iot_core::models::RuleDefinition;
+using iot_core::models::UserAlert;
+
+namespace {
+
+constexpr int64_t kMinuteUs = 60LL * 1000000;
+
+struct Row {
+  std::string deviceId;
+  double temperature;
+  double humidity;
+  int64_t timestampUs;
+};
+
+// Сутки показаний раз в минуту: "boiler" раз в час на 10 минут
+// перегревается до 40 °C, "fridge" все время 4 °C
+std::vector<Row> history() {
+  std::vector<Row> rows;
+  for (int64_t minute = 0; minute < 24 * 60; ++minute) {
+    int64_t timestampUs = minute * kMinuteUs;
+    double boiler = minute % 60 < 10 ? 40.0 : 22.0;
+    rows.push_back({"boiler", boiler, 50.0, timestampUs});
+    rows.push_back({"fridge", 4.0, 50.0, timestampUs});
+  }
+  return rows;
+}
+
+Backtester makeBacktester(const std::vector<Row>& rows, size_t workers) {
+  Backtester::Options options;
+  options.workers = workers;
+  options.batchSize = 100;
+  return Backtester(
+      [&rows](int64_t fromUs, int64_t toUs, const Backtester::Sink& sink) {
+        for (const auto& row : rows) {
+          if (row.timestampUs >= fromUs && row.timestampUs < toUs) {
+            sink(row.deviceId, row.temperature, row.humidity,
+                 row.timestampUs);
+          }
+        }
+        return true;
+      },
+      [](const std::string& deviceId,
+         std::vector<std::pair<long, UserAlert>>& subscribers) {
+        // Пользователь 1 следит за котлом, порог 30 °C
+        subscribers.clear();
+        if (deviceId == "boiler") {
+          UserAlert alert;
+          alert.temperatureHighThreshold = 30.0;
+          subscribers.emplace_back(1, alert);
+        }
+        return true;
+      },
+      options);
+}
+
+RuleDefinition rule(const std::string& name, const std::string& expression) {
+  RuleDefinition definition;
+  definition.name = name;
+  definition.expression = expression;
+  return definition;
+}
+
+}  // namespace
+
+TEST(BacktesterTest, CountsRuleTriggersAndUserAlerts) {
+  auto rows = history();
+  auto backtester = makeBacktester(rows, 4);
+
+  Backtester::Scenario scenario;
+  scenario.rules = Backtester::defaultRules();
+  scenario.rules.push_back(rule("sustained_heat", "temperature > 35 for 5m"));
+  scenario.rules.push_back(rule("broken", "temperature >"));
+  scenario.hysteresis.recoveryDwell = std::chrono::seconds(0);
+  scenario.cooldown = std::chrono::minutes(30);
+
+  auto report = backtester.run(scenario, 0, 24 * 60 * kMinuteUs);
+  EXPECT_TRUE(report.completed);
+  EXPECT_EQ(report.readings, rows.size());
+  EXPECT_EQ(report.devices, 2u);
+  EXPECT_EQ(report.lastUs - report.firstUs, (24 * 60 - 1) * kMinuteUs);
+
+  // 24 перегрева по 10 показаний; "for 5m" - с 6-й минуты каждого
+  EXPECT_EQ(report.ruleTriggers["temperature_high_alert"], 240u);
+  EXPECT_EQ(report.ruleTriggers["temperature_low_alert"], 24u * 60u);
+  EXPECT_EQ(report.ruleTriggers["sustained_heat"], 24u * 5u);
+  EXPECT_EQ(report.ruleTriggers.count("broken"), 0u);
+  ASSERT_EQ(report.ruleErrors.size(), 1u);
+
+  // Каждый перегрев - вход в тревогу и восстановление; cooldown больше
+  // часа между ними не мешает
+  ASSERT_EQ(report.users.size(), 1u);
+  EXPECT_EQ(report.users[1].alerts, 24u);
+  EXPECT_EQ(report.users[1].suppressed, 0u);
+  EXPECT_EQ(report.users[1].resolved, 24u);
+  EXPECT_GT(report.speedup, 1.0);
+}
+
+TEST(BacktesterTest, OverridesAndCooldownChangeOnlyTheScenario) {
+  auto rows = history();
+  auto backtester = makeBacktester(rows, 2);
+
+  Backtester::Scenario scenario;
+  scenario.hysteresis.recoveryDwell = std::chrono::seconds(0);
+  scenario.cooldown = std::chrono::hours(2);
+  // Порог выше любого показания - оповещений нет
+  UserAlert quiet;
+  quiet.temperatureHighThreshold = 45.0;
+  scenario.alertOverrides[1] = quiet;
+  auto report = backtester.run(scenario, 0, 24 * 60 * kMinuteUs);
+  EXPECT_TRUE(report.users.empty());
+
+  // Без замены: cooldown 2 ч пропускает каждое второе оповещение
+  scenario.alertOverrides.clear();
+  report = backtester.run(scenario, 0, 24 * 60 * kMinuteUs);
+  EXPECT_EQ(report.users[1].alerts, 12u);
+  EXPECT_EQ(report.users[1].suppressed, 12u);
+
+  // Тот же результат при любом числе потоков
+  auto single = makeBacktester(rows, 1).run(scenario, 0,
+                                            24 * 60 * kMinuteUs);
+  EXPECT_EQ(single.users[1].alerts, 12u);
+  EXPECT_EQ(single.readings, report.readings);
+}
+
+TEST(BacktesterTest, ScopedRulesSeeOnlyTheirDevices) {
+  auto rows = history();
+  auto backtester = makeBacktester(rows, 3);
+
+  Backtester::Scenario scenario;
+  auto own = rule("fridge_warm", "temperature > 10");
+  own.deviceId = "fridge";
+  auto grouped = rule("group_hot", "temperature > 30");
+  grouped.groupId = 7;
+  iot_core::models::DeviceGroup group;
+  group.id = 7;
+  group.deviceIds = {"boiler"};
+  scenario.rules = {own, grouped};
+  scenario.groups = {group};
+
+  auto report = backtester.run(scenario, 0, 12 * 60 * kMinuteUs);
+  EXPECT_EQ(report.readings, 2u * 12u * 60u);
+  EXPECT_EQ(report.ruleTriggers["fridge_warm"], 0u);
+  EXPECT_EQ(report.ruleTriggers["group_hot"], 120u);
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <thread>
 
@@ -164,6 +166,67 @@ TEST_F(DatabaseTest, Statistics) {
   db->removeUserDevice(1002, "stat_device");
 }
 
+TEST_F(DatabaseTest, NotificationOutboxDeliversOncePerKey) {
+  // Второй узел со своим соединением
+  DatabaseRepository other(
+      "host=localhost port=5432 dbname=iot_test "
+      "user=test_user password=test_pass");
+  other.initialize();
+
+  OutboxEntry entry;
+  entry.dedupKey =
+      "tg:777777:outbox_ci:temp_high:" +
+      std::to_string(std::chrono::system_clock::now().time_since_epoch()
+                         .count());
+  entry.channel = "telegram";
+  entry.chatId = 777777;
+  entry.alert.deviceId = "outbox_ci";
+  entry.alert.value = 31.5;
+  entry.alert.metricType = "temperature";
+  entry.alert.direction = "above";
+  entry.alert.timestampUs = 1;
+
+  bool inserted = false;
+  if (!db->insertOutboxEntry(entry, inserted)) {
+    GTEST_SKIP() << "notification_outbox table not migrated";
+  }
+  EXPECT_TRUE(inserted);
+
+  // Тот же ключ с другого узла - дубликат
+  ASSERT_TRUE(other.insertOutboxEntry(entry, inserted));
+  EXPECT_FALSE(inserted);
+
+  // Запись забирает один узел; пока действует аренда, второй ее не видит
+  auto claimed =
+      db->claimOutboxEntries("node-a", 100, std::chrono::seconds(60));
+  auto mine = std::find_if(claimed.begin(), claimed.end(), [&](const auto& e) {
+    return e.dedupKey == entry.dedupKey;
+  });
+  ASSERT_NE(mine, claimed.end());
+  EXPECT_EQ(mine->attempts, 1);
+  EXPECT_DOUBLE_EQ(mine->alert.value, 31.5);
+
+  auto stolen =
+      other.claimOutboxEntries("node-b", 100, std::chrono::seconds(60));
+  EXPECT_TRUE(std::none_of(stolen.begin(), stolen.end(), [&](const auto& e) {
+    return e.dedupKey == entry.dedupKey;
+  }));
+
+  std::vector<int64_t> ids;
+  for (const auto& e : stolen) {
+    ids.push_back(e.id);
+  }
+  other.retryOutboxEntries(ids, "node-b", std::chrono::milliseconds(0), "");
+  db->completeOutboxEntries({mine->id});
+
+  // Доставленная запись больше не выдается
+  claimed = db->claimOutboxEntries("node-a", 100, std::chrono::seconds(0));
+  EXPECT_TRUE(std::none_of(claimed.begin(), claimed.end(), [&](const auto& e) {
+    return e.dedupKey == entry.dedupKey;
+  }));
+  db->purgeOutbox(std::chrono::hours(0));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include "../../src/utils/Formatter.h"
+
+using iot_core::utils::Formatter;
+
+namespace {
+
+constexpr int64_t kHourUs = int64_t{3600} * 1000000;
+// 2026-01-15 12:00:00 и 2026-07-15 12:00:00 UTC
+constexpr int64_t kWinterUs = int64_t{1768478400} * 1000000;
+constexpr int64_t kSummerUs = int64_t{1784116800} * 1000000;
+
+// Зона процесса на время теста
+class TimeZone {
+ public:
+  explicit TimeZone(const char* zone) {
+    const char* current = std::getenv("TZ");
+    hadZone_ = current != nullptr;
+    if (hadZone_) {
+      saved_ = current;
+    }
+    setenv("TZ", zone, 1);
+    tzset();
+  }
+
+  ~TimeZone() {
+    if (hadZone_) {
+      setenv("TZ", saved_.c_str(), 1);
+    } else {
+      unsetenv("TZ");
+    }
+    tzset();
+  }
+
+ private:
+  bool hadZone_ = false;
+  std::string saved_;
+};
+
+}  // namespace
+
+TEST(FormatterTest, WallClockFollowsZoneOffset) {
+  TimeZone zone("Europe/Berlin");
+  EXPECT_EQ(Formatter::toLocalWallClock(kWinterUs), kWinterUs + kHourUs);
+  EXPECT_EQ(Formatter::toLocalWallClock(kSummerUs), kSummerUs + 2 * kHourUs);
+  EXPECT_EQ(Formatter::formatTimestamp(kSummerUs), "2026-07-15 14:00:00");
+}
+
+TEST(FormatterTest, WallClockRoundTripKeepsMicroseconds) {
+  TimeZone zone("Europe/Berlin");
+  for (int64_t timestampUs : {kWinterUs + 123456, kSummerUs + 999999,
+                              kSummerUs + 17 * kHourUs + 1}) {
+    EXPECT_EQ(Formatter::fromLocalWallClock(
+                  Formatter::toLocalWallClock(timestampUs)),
+              timestampUs);
+  }
+}
+
+TEST(FormatterTest, WallClockIsIdentityInUtc) {
+  TimeZone zone("UTC");
+  EXPECT_EQ(Formatter::toLocalWallClock(kSummerUs + 42), kSummerUs + 42);
+  EXPECT_EQ(Formatter::fromLocalWallClock(kWinterUs + 42), kWinterUs + 42);
+}
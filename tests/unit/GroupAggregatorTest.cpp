@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "../../src/services/GroupAggregator.h"
+
+using namespace iot_core::services;
+using iot_core::models::DeviceGroup;
+using iot_core::models::GroupAggregate;
+using iot_core::models::GroupAlertRule;
+
+namespace {
+
+constexpr int64_t kSecondUs = 1000000;
+
+DeviceGroup makeGroup(int id, std::vector<std::string> devices) {
+  DeviceGroup group;
+  group.id = id;
+  group.chatId = 42;
+  group.name = "room" + std::to_string(id);
+  group.deviceIds = std::move(devices);
+  return group;
+}
+
+GroupAggregate aggregateOf(const GroupAggregator& aggregator, int groupId) {
+  GroupAggregate aggregate;
+  EXPECT_TRUE(aggregator.getAggregate(groupId, aggregate));
+  return aggregate;
+}
+
+}  // namespace
+
+TEST(GroupAggregatorTest, RunningAggregatesFollowLatestReadings) {
+  GroupAggregator aggregator([](auto& groups, auto& rules) {
+    groups.push_back(makeGroup(1, {"a", "b", "c"}));
+    GroupAlertRule rule;
+    rule.groupId = 1;
+    rule.metricType = "temperature";
+    rule.aggregate = "mean";
+    rule.direction = "above";
+    rule.threshold = 25.0;
+    rules.push_back(rule);
+    return true;
+  });
+
+  int calls = 0;
+  auto count = [&](const GroupAggregator::GroupView& view) {
+    ++calls;
+    EXPECT_EQ(view.rules.size(), 1u);
+  };
+
+  aggregator.update("a", 20.0, 40.0, 1 * kSecondUs, count);
+  aggregator.update("b", 30.0, 60.0, 2 * kSecondUs, count);
+  aggregator.update("unknown", 99.0, 99.0, 3 * kSecondUs, count);
+  EXPECT_EQ(calls, 2);
+
+  auto aggregate = aggregateOf(aggregator, 1);
+  EXPECT_EQ(aggregate.members, 3u);
+  EXPECT_EQ(aggregate.reporting, 2u);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMean, 25.0);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMin, 20.0);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMax, 30.0);
+  EXPECT_DOUBLE_EQ(aggregate.value("humidity", "max"), 60.0);
+
+  // Максимум отступил - пересчет по участникам
+  aggregator.update("b", 22.0, 50.0, 4 * kSecondUs, count);
+  aggregate = aggregateOf(aggregator, 1);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMax, 22.0);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMean, 21.0);
+
+  // Показание старее учтенного игнорируется
+  aggregator.update("b", 50.0, 50.0, 3 * kSecondUs, count);
+  EXPECT_DOUBLE_EQ(aggregateOf(aggregator, 1).temperatureMax, 22.0);
+  EXPECT_EQ(calls, 3);
+}
+
+TEST(GroupAggregatorTest, StaleMembersLeaveAggregates) {
+  GroupAggregator::Options options;
+  options.staleAfter = std::chrono::seconds(60);
+  GroupAggregator aggregator(
+      [](auto& groups, auto&) {
+        groups.push_back(makeGroup(1, {"a", "b"}));
+        return true;
+      },
+      options);
+
+  aggregator.update("a", 10.0, 40.0, 1 * kSecondUs, nullptr);
+  aggregator.update("b", 30.0, 60.0, 2 * kSecondUs, nullptr);
+  EXPECT_EQ(aggregateOf(aggregator, 1).reporting, 2u);
+
+  // "a" молчит дольше staleAfter
+  aggregator.update("b", 32.0, 60.0, 100 * kSecondUs, nullptr);
+  auto aggregate = aggregateOf(aggregator, 1);
+  EXPECT_EQ(aggregate.reporting, 1u);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMin, 32.0);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMean, 32.0);
+
+  // Вернувшийся участник снова учитывается
+  aggregator.update("a", 12.0, 40.0, 101 * kSecondUs, nullptr);
+  aggregate = aggregateOf(aggregator, 1);
+  EXPECT_EQ(aggregate.reporting, 2u);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMean, 22.0);
+}
+
+TEST(GroupAggregatorTest, ReloadKeepsReadingsAndRetriesAfterFailure) {
+  bool fail = false;
+  std::vector<std::string> devices = {"a", "b"};
+  GroupAggregator::Options options;
+  options.reloadRetry = std::chrono::seconds(0);
+  GroupAggregator aggregator(
+      [&](auto& groups, auto&) {
+        if (fail) {
+          return false;
+        }
+        groups.push_back(makeGroup(1, devices));
+        return true;
+      },
+      options);
+
+  aggregator.update("a", 10.0, 40.0, 1 * kSecondUs, nullptr);
+  aggregator.update("b", 20.0, 40.0, 2 * kSecondUs, nullptr);
+
+  // Ошибка загрузки: остается прежний состав
+  fail = true;
+  aggregator.invalidate();
+  aggregator.update("a", 12.0, 40.0, 3 * kSecondUs, nullptr);
+  EXPECT_DOUBLE_EQ(aggregateOf(aggregator, 1).temperatureMean, 16.0);
+
+  // Новый участник; показания "a" и "b" переносятся в новый снимок
+  fail = false;
+  devices.push_back("c");
+  aggregator.update("c", 30.0, 40.0, 4 * kSecondUs, nullptr);
+  auto aggregate = aggregateOf(aggregator, 1);
+  EXPECT_EQ(aggregate.members, 3u);
+  EXPECT_EQ(aggregate.reporting, 3u);
+  EXPECT_DOUBLE_EQ(aggregate.temperatureMean, 62.0 / 3.0);
+  EXPECT_EQ(aggregator.getStatistics().reloads, 2u);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "../../src/services/HeartbeatMonitor.h"
+
+using iot_core::services::HeartbeatMonitor;
+
+namespace {
+
+constexpr int64_t kSecondUs = 1000000;
+
+HeartbeatMonitor::Options options(int timeoutSeconds) {
+  HeartbeatMonitor::Options result;
+  result.timeout = std::chrono::seconds(timeoutSeconds);
+  result.tick = std::chrono::milliseconds(1000);
+  return result;
+}
+
+}  // namespace
+
+TEST(HeartbeatMonitorTest, SilentDeviceGoesOfflineAfterTimeout) {
+  HeartbeatMonitor monitor(options(60));
+  HeartbeatMonitor::Event event;
+  EXPECT_FALSE(monitor.heartbeat("sensor", 1000 * kSecondUs, event));
+
+  EXPECT_TRUE(monitor.advance(1030 * kSecondUs).empty());
+
+  auto events = monitor.advance(1062 * kSecondUs);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].deviceId, "sensor");
+  EXPECT_FALSE(events[0].online);
+  EXPECT_EQ(events[0].lastSeenUs, 1000 * kSecondUs);
+
+  // Повторно не сообщается
+  EXPECT_TRUE(monitor.advance(1200 * kSecondUs).empty());
+  EXPECT_EQ(monitor.getStatistics().offline, 1u);
+}
+
+TEST(HeartbeatMonitorTest, HeartbeatsKeepDeviceOnline) {
+  HeartbeatMonitor monitor(options(60));
+  HeartbeatMonitor::Event event;
+  for (int64_t second = 0; second <= 300; second += 30) {
+    EXPECT_FALSE(monitor.heartbeat("sensor", second * kSecondUs, event));
+    EXPECT_TRUE(monitor.advance(second * kSecondUs).empty());
+  }
+
+  // Один таймер на устройство, сколько бы ни было показаний
+  auto statistics = monitor.getStatistics();
+  EXPECT_EQ(statistics.tracked, 1u);
+  EXPECT_EQ(statistics.timers, 1u);
+  EXPECT_EQ(statistics.offlineEvents, 0u);
+
+  // Срок отсчитывается от последнего показания
+  EXPECT_TRUE(monitor.advance(355 * kSecondUs).empty());
+  EXPECT_EQ(monitor.advance(362 * kSecondUs).size(), 1u);
+}
+
+TEST(HeartbeatMonitorTest, ReturningDeviceReportsOnline) {
+  HeartbeatMonitor monitor(options(10));
+  HeartbeatMonitor::Event event;
+  monitor.heartbeat("a", 0, event);
+  monitor.heartbeat("b", 0, event);
+  monitor.heartbeat("b", 8 * kSecondUs, event);
+
+  auto events = monitor.advance(12 * kSecondUs);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].deviceId, "a");
+
+  ASSERT_TRUE(monitor.heartbeat("a", 20 * kSecondUs, event));
+  EXPECT_EQ(event.deviceId, "a");
+  EXPECT_TRUE(event.online);
+  EXPECT_EQ(event.lastSeenUs, 0);
+  EXPECT_EQ(event.timestampUs, 20 * kSecondUs);
+
+  auto statistics = monitor.getStatistics();
+  EXPECT_EQ(statistics.tracked, 2u);
+  EXPECT_EQ(statistics.offline, 0u);
+  EXPECT_EQ(statistics.offlineEvents, 1u);
+  EXPECT_EQ(statistics.onlineEvents, 1u);
+
+  // Снова под наблюдением
+  auto later = monitor.advance(40 * kSecondUs);
+  ASSERT_EQ(later.size(), 2u);
+}
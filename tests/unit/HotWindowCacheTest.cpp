@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../../src/storage/HotWindowCache.h"
+
+using namespace iot_core::storage;
+
+namespace {
+
+int64_t nowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+DataPoint makePoint(int64_t timestampUs, double temperature) {
+  DataPoint point;
+  point.timestampUs = timestampUs;
+  point.temperature = temperature;
+  point.humidity = 45.0;
+  return point;
+}
+
+}  // namespace
+
+TEST(HotWindowCacheTest, LatestServedOnlyWhenCovered) {
+  HotWindowCache::Options options;
+  options.blockPoints = 16;
+  HotWindowCache cache(options);
+
+  int64_t start = nowMicros() - 100'000'000;
+  for (int64_t i = 0; i < 40; ++i) {
+    cache.append("sensor_1", makePoint(start + i * 1'000'000, 20.0 + i));
+  }
+
+  std::vector<DataPoint> out;
+  ASSERT_TRUE(cache.latest("sensor_1", 20, out));
+  ASSERT_EQ(out.size(), 20u);
+  EXPECT_EQ(out.front().temperature, 59.0);
+  EXPECT_EQ(out.back().temperature, 40.0);
+
+  EXPECT_FALSE(cache.latest("sensor_1", 41, out));
+  EXPECT_FALSE(cache.latest("unknown", 1, out));
+
+  // Повтор и опоздавшая точка отбрасываются
+  cache.append("sensor_1", makePoint(start, 99.0));
+  EXPECT_EQ(cache.getStatistics().points, 40u);
+}
+
+TEST(HotWindowCacheTest, SnapshotWithoutOverlapRestartsWindow) {
+  HotWindowCache cache(HotWindowCache::Options{});
+  int64_t start = nowMicros() - 1'000'000'000;
+
+  std::vector<DataPoint> first;
+  for (int64_t i = 0; i < 10; ++i) {
+    first.push_back(makePoint(start + i * 1'000'000, 20.0));
+  }
+  cache.mergeSnapshot("sensor_2", first);
+
+  // Перекрывающийся срез дописывает только новые точки
+  std::vector<DataPoint> overlapping;
+  for (int64_t i = 5; i < 15; ++i) {
+    overlapping.push_back(makePoint(start + i * 1'000'000, 21.0));
+  }
+  cache.mergeSnapshot("sensor_2", overlapping);
+
+  std::vector<DataPoint> out;
+  ASSERT_TRUE(cache.range("sensor_2", start, INT64_MAX, out));
+  EXPECT_EQ(out.size(), 15u);
+
+  // Разрыв: окно начинается заново, старый диапазон больше не покрыт
+  std::vector<DataPoint> gap{makePoint(start + 100'000'000, 22.0),
+                             makePoint(start + 101'000'000, 22.0)};
+  cache.mergeSnapshot("sensor_2", gap);
+
+  EXPECT_FALSE(cache.range("sensor_2", start, INT64_MAX, out));
+  ASSERT_TRUE(cache.range("sensor_2", start + 100'000'000, INT64_MAX, out));
+  EXPECT_EQ(out.size(), 2u);
+}
+
+TEST(HotWindowCacheTest, MemoryBudgetEvictsOldestBlocks) {
+  HotWindowCache::Options options;
+  options.blockPoints = 32;
+  options.memoryBudgetBytes = 4096;
+  HotWindowCache cache(options);
+
+  int64_t start = nowMicros() - 10'000'000'000;
+  for (int64_t i = 0; i < 5000; ++i) {
+    cache.append("sensor_3",
+                 makePoint(start + i * 1'000'000, 20.0 + (i % 17) * 0.25));
+  }
+
+  auto stats = cache.getStatistics();
+  EXPECT_LE(stats.memoryBytes, options.memoryBudgetBytes);
+  EXPECT_GT(stats.evictedBlocks, 0u);
+
+  std::vector<DataPoint> out;
+  EXPECT_FALSE(cache.range("sensor_3", start, INT64_MAX, out));
+  ASSERT_TRUE(cache.latest("sensor_3", 10, out));
+  EXPECT_EQ(out.front().timestampUs, start + 4999 * int64_t{1'000'000});
+}
+
+TEST(HotWindowCacheTest, ActiveBlocksCountTowardBudgetAndAge) {
+  HotWindowCache::Options options;
+  options.blockPoints = 256;  // блоки не запечатываются
+  options.memoryBudgetBytes = 8192;
+  options.maxAge = std::chrono::seconds(3600);
+  HotWindowCache cache(options);
+
+  int64_t start = nowMicros() - 60'000'000;
+  for (int device = 0; device < 500; ++device) {
+    for (int64_t i = 0; i < 3; ++i) {
+      cache.append("sensor_" + std::to_string(device),
+                   makePoint(start + i * 1'000'000, 20.0 + device * 0.1));
+    }
+  }
+
+  auto stats = cache.getStatistics();
+  EXPECT_LE(stats.memoryBytes, options.memoryBudgetBytes);
+  EXPECT_LT(stats.devices, 500u);
+
+  // Вытесняются устройства, дольше всех не получавшие показаний
+  std::vector<DataPoint> out;
+  EXPECT_FALSE(cache.latest("sensor_0", 1, out));
+  EXPECT_TRUE(cache.latest("sensor_499", 3, out));
+
+  // Устройство, замолчавшее дольше maxAge, не обслуживается
+  cache.append("silent", makePoint(nowMicros() - 7200'000'000, 21.0));
+  EXPECT_FALSE(cache.latest("silent", 1, out));
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "../../src/utils/LatencyHistogram.h"
+
+using iot_core::utils::LatencyHistogram;
+
+TEST(LatencyHistogramTest, BucketsArePowersOfTwo) {
+  EXPECT_EQ(LatencyHistogram::bucketFor(0), 0u);
+  EXPECT_EQ(LatencyHistogram::bucketFor(1), 1u);
+  EXPECT_EQ(LatencyHistogram::bucketFor(3), 2u);
+  EXPECT_EQ(LatencyHistogram::bucketFor(4), 3u);
+  EXPECT_EQ(LatencyHistogram::bucketFor(1023), 10u);
+  EXPECT_EQ(LatencyHistogram::bucketFor(1024), 11u);
+  EXPECT_EQ(LatencyHistogram::bucketFor(~uint64_t{0}),
+            LatencyHistogram::kBuckets - 1);
+  EXPECT_EQ(LatencyHistogram::bucketUpperNanos(10), 1023u);
+}
+
+TEST(LatencyHistogramTest, PercentilesAndMean) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 99; ++i) {
+    histogram.record(100);  // корзина [64, 128)
+  }
+  histogram.record(50000);  // корзина [32768, 65536)
+
+  auto snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 100u);
+  EXPECT_EQ(snapshot.maxNanos, 50000u);
+  EXPECT_DOUBLE_EQ(snapshot.meanNanos(), (99 * 100 + 50000) / 100.0);
+  EXPECT_EQ(snapshot.percentileNanos(0.5), 127u);
+  EXPECT_EQ(snapshot.percentileNanos(0.99), 127u);
+  // Граница корзины ограничена максимумом
+  EXPECT_EQ(snapshot.percentileNanos(1.0), 50000u);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.snapshot().count, 0u);
+  EXPECT_EQ(histogram.snapshot().percentileNanos(0.5), 0u);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecordsAreNotLost) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram, t]() {
+      for (uint64_t i = 1; i <= 10000; ++i) {
+        histogram.record(i * (t + 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 40000u);
+  uint64_t inBuckets = 0;
+  for (uint64_t bucket : snapshot.buckets) {
+    inBuckets += bucket;
+  }
+  EXPECT_EQ(inBuckets, 40000u);
+  EXPECT_EQ(snapshot.maxNanos, 40000u);
+}
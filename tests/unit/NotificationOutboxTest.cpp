@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../../src/core/NotificationOutbox.h"
+
+using namespace iot_core::core;
+using namespace std::chrono_literals;
+
+namespace {
+
+NotificationOutbox::Options fastOptions() {
+  NotificationOutbox::Options options;
+  options.workers = 2;
+  options.maxAttempts = 3;
+  options.baseBackoff = 10ms;
+  options.maxBackoff = 40ms;
+  return options;
+}
+
+NotificationJob telegramJob(long chatId) {
+  NotificationJob job;
+  job.chatId = chatId;
+  job.text = "alert";
+  return job;
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate) {
+  auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(NotificationOutboxTest, RetriesTransientFailuresWithBackoff) {
+  NotificationOutbox outbox(fastOptions());
+  std::atomic<int> attempts{0};
+  outbox.start([&](const NotificationJob&) {
+    return ++attempts < 3 ? DeliveryResult::retry("timeout")
+                          : DeliveryResult::delivered();
+  });
+
+  auto started = std::chrono::steady_clock::now();
+  ASSERT_TRUE(outbox.enqueue(telegramJob(1)));
+  ASSERT_TRUE(waitFor([&]() { return outbox.getStatistics().delivered == 1; }));
+
+  // Две паузы: не меньше половины 10 мс и 20 мс
+  EXPECT_GE(std::chrono::steady_clock::now() - started, 15ms);
+  auto stats = outbox.getStatistics();
+  EXPECT_EQ(stats.retried, 2u);
+  EXPECT_EQ(stats.failed, 0u);
+  EXPECT_GT(stats.maxLatencyMs, 0.0);
+}
+
+TEST(NotificationOutboxTest, HonorsRetryAfterAndGivesUp) {
+  NotificationOutbox outbox(fastOptions());
+  std::mutex mutex;
+  std::vector<std::chrono::steady_clock::time_point> calls;
+  outbox.start([&](const NotificationJob& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    calls.push_back(std::chrono::steady_clock::now());
+    if (job.chatId == 2) {
+      return DeliveryResult::failed("chat not found");
+    }
+    return DeliveryResult::retry("Too Many Requests", 100ms);
+  });
+
+  outbox.enqueue(telegramJob(1));
+  outbox.enqueue(telegramJob(2));
+  ASSERT_TRUE(waitFor([&]() { return outbox.getStatistics().failed == 2; }));
+
+  auto stats = outbox.getStatistics();
+  EXPECT_EQ(stats.delivered, 0u);
+  EXPECT_EQ(stats.retried, 2u);  // только задание с 429, без повторов 4xx
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(calls.size(), 4u);
+  EXPECT_GE(calls.back() - calls.front(), 190ms);
+}
+
+TEST(NotificationOutboxTest, ManyWorkersShareDelayedRetries) {
+  auto options = fastOptions();
+  options.workers = 8;
+  options.baseBackoff = 1ms;
+  options.maxBackoff = 4ms;
+  NotificationOutbox outbox(options);
+
+  // Все исполнители ждут сроков повторов одних и тех же заданий
+  constexpr int kJobs = 200;
+  std::mutex mutex;
+  std::vector<int> attempts(kJobs, 0);
+  outbox.start([&](const NotificationJob& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ++attempts[static_cast<size_t>(job.chatId)] < 3
+               ? DeliveryResult::retry("timeout")
+               : DeliveryResult::delivered();
+  });
+
+  for (int i = 0; i < kJobs; ++i) {
+    ASSERT_TRUE(outbox.enqueue(telegramJob(i)));
+  }
+  ASSERT_TRUE(waitFor(
+      [&]() { return outbox.getStatistics().delivered == kJobs; }));
+
+  auto stats = outbox.getStatistics();
+  EXPECT_EQ(stats.retried, 2u * kJobs);
+  EXPECT_EQ(stats.failed, 0u);
+}
+
+TEST(NotificationOutboxTest, StopMakesFinalAttemptForQueuedJobs) {
+  auto options = fastOptions();
+  options.baseBackoff = 10s;
+  options.maxBackoff = 10s;
+  NotificationOutbox outbox(options);
+
+  std::atomic<int> attempts{0};
+  outbox.start([&](const NotificationJob&) {
+    ++attempts;
+    return DeliveryResult::retry("unreachable");
+  });
+
+  for (long chat = 0; chat < 5; ++chat) {
+    outbox.enqueue(telegramJob(chat));
+  }
+  ASSERT_TRUE(waitFor([&]() { return outbox.getStatistics().retried == 5; }));
+
+  auto started = std::chrono::steady_clock::now();
+  outbox.stop();
+  EXPECT_LT(std::chrono::steady_clock::now() - started, 5s);
+  EXPECT_EQ(attempts.load(), 10);
+  EXPECT_EQ(outbox.getStatistics().failed, 5u);
+  EXPECT_FALSE(outbox.enqueue(telegramJob(9)));
+}
@@ -0,0 +1,401 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "../../src/core/Database.h"
+#include "../../src/engine/RuleEngine.h"
+#include "../../src/services/AlertService.h"
+#include "../../src/storage/StateSnapshot.h"
+
+using namespace iot_core;
+using engine::Rule;
+using engine::RuleEngine;
+
+namespace {
+
+// Репозиторий без подключения: processData к БД не обращается
+std::unique_ptr<RuleEngine> makeEngine() {
+  auto database = std::make_shared<core::DatabaseRepository>("");
+  auto alerts = std::make_shared<services::AlertProcessingService>(
+      database, nullptr, std::chrono::seconds(300), 1);
+  return std::make_unique<RuleEngine>(database, alerts);
+}
+
+constexpr int64_t kMinuteUs = int64_t{60} * 1000000;
+constexpr int64_t kReadingUs = int64_t{1792317600} * 1000000;  // 2026-10-18
+
+models::IoTData reading(double temperature) {
+  models::IoTData data;
+  data.deviceId = "sensor";
+  data.temperature = temperature;
+  data.humidity = 50.0;
+  data.timestampUs = kReadingUs;
+  return data;
+}
+
+Rule countingRule(const std::string& name, int priority,
+                  std::atomic<int>& calls) {
+  return Rule(
+      name, "",
+      [](const models::IoTData& data) { return data.temperature > 0; },
+      [&calls](const models::IoTData&) { calls++; }, priority);
+}
+
+models::RuleDefinition definition(const std::string& name,
+                                  const std::string& expression,
+                                  int priority) {
+  models::RuleDefinition result;
+  result.name = name;
+  result.expression = expression;
+  result.priority = priority;
+  return result;
+}
+
+}  // namespace
+
+TEST(RuleEngineTest, RuleSnapshotOutlivesRemoval) {
+  auto engine = makeEngine();
+  std::atomic<int> calls{0};
+  engine->addRule(countingRule("hot", 10, calls));
+
+  auto rule = engine->getRule("hot");
+  ASSERT_TRUE(rule);
+  engine->removeRule("hot");
+
+  // Правило из снимка по-прежнему доступно, но движок его не видит
+  EXPECT_EQ(rule->name, "hot");
+  EXPECT_EQ(rule->priority, 10);
+  EXPECT_FALSE(engine->ruleExists("hot"));
+
+  engine->processData(reading(25.0));
+  EXPECT_EQ(calls, 0);
+}
+
+TEST(RuleEngineTest, DisabledRulesAreSkippedAndCountersSurviveChanges) {
+  auto engine = makeEngine();
+  std::atomic<int> hot{0};
+  std::atomic<int> warm{0};
+  engine->addRule(countingRule("warm", 1, warm));
+  engine->addRule(countingRule("hot", 10, hot));
+  EXPECT_EQ(engine->getRuleNames(),
+            (std::vector<std::string>{"hot", "warm"}));
+
+  engine->processData(reading(25.0));
+  engine->disableRule("warm");
+  engine->processData(reading(25.0));
+  engine->enableRule("warm");
+  engine->processData(reading(25.0));
+
+  EXPECT_EQ(hot, 3);
+  EXPECT_EQ(warm, 2);
+
+  auto stats = engine->getStatistics();
+  EXPECT_EQ(stats.totalProcessed, 3);
+  EXPECT_EQ(stats.rulesTriggered, 5);
+  EXPECT_EQ(stats.ruleTriggerCount["hot"], 3);
+  EXPECT_EQ(stats.ruleTriggerCount["warm"], 2);
+}
+
+TEST(RuleEngineTest, PerRuleMetricsCountEvaluationsAndErrors) {
+  auto engine = makeEngine();
+  std::atomic<int> calls{0};
+  engine->addRule(countingRule("hot", 10, calls));
+  engine->addRule(Rule(
+      "broken", "",
+      [](const models::IoTData& data) {
+        if (data.temperature > 30) {
+          throw std::runtime_error("bad reading");
+        }
+        return true;
+      },
+      [](const models::IoTData&) { throw std::runtime_error("no action"); },
+      5));
+
+  engine->processData(reading(25.0));
+  engine->processData(reading(35.0));
+
+  // Исключение правила не мешает остальным
+  EXPECT_EQ(calls, 2);
+
+  auto stats = engine->getStatistics();
+  ASSERT_EQ(stats.rules.size(), 2u);
+  const auto& hot = stats.rules[0];
+  const auto& broken = stats.rules[1];
+  EXPECT_EQ(hot.name, "hot");
+  EXPECT_EQ(hot.evaluations, 2u);
+  EXPECT_EQ(hot.triggers, 2u);
+  EXPECT_EQ(hot.errors, 0u);
+  EXPECT_EQ(hot.condition.count, 2u);
+  EXPECT_EQ(hot.action.count, 2u);
+
+  // Первое показание: действие бросило; второе: условие бросило
+  EXPECT_EQ(broken.name, "broken");
+  EXPECT_EQ(broken.evaluations, 2u);
+  EXPECT_EQ(broken.triggers, 1u);
+  EXPECT_EQ(broken.errors, 2u);
+
+  engine->resetStatistics();
+  stats = engine->getStatistics();
+  EXPECT_EQ(stats.rules[0].evaluations, 0u);
+  EXPECT_EQ(stats.rules[0].condition.count, 0u);
+}
+
+TEST(RuleEngineTest, ConcurrentUpdatesDoNotDisturbReaders) {
+  auto engine = makeEngine();
+  std::atomic<int> calls{0};
+  engine->addRule(countingRule("stable", 5, calls));
+
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    std::atomic<int> ignored{0};
+    for (int i = 0; i < 200; ++i) {
+      engine->addRule(countingRule("churn", i % 20, ignored));
+      engine->removeRule("churn");
+    }
+    done = true;
+  });
+
+  int readings = 0;
+  while (!done) {
+    engine->processData(reading(25.0));
+    ++readings;
+  }
+  writer.join();
+
+  EXPECT_EQ(calls, readings);
+  EXPECT_EQ(engine->getStatistics().ruleTriggerCount["stable"], readings);
+}
+
+TEST(RuleEngineTest, RuleDefinitionsReplaceOnlyExpressionRules) {
+  auto engine = makeEngine();
+  std::atomic<int> calls{0};
+  engine->addRule(countingRule("builtin", 5, calls));
+
+  auto hot = definition("hot", "temperature > 28", 10);
+  auto humid = definition("humid", "humidity > 60 for 10m", 1);
+  EXPECT_EQ(engine->applyRuleDefinitions({hot, humid}), 2u);
+  EXPECT_EQ(engine->getRuleNames(),
+            (std::vector<std::string>{"hot", "builtin", "humid"}));
+
+  // Ошибка в выражении: прежняя версия правила остается
+  auto broken = hot;
+  broken.expression = "temperature >";
+  EXPECT_EQ(engine->applyRuleDefinitions({broken, humid}), 2u);
+  EXPECT_EQ(engine->getRule("hot")->description, "temperature > 28");
+
+  EXPECT_EQ(engine->applyRuleDefinitions({humid}), 1u);
+  EXPECT_FALSE(engine->ruleExists("hot"));
+  EXPECT_TRUE(engine->ruleExists("builtin"));
+}
+
+TEST(RuleEngineTest, OverriddenBuiltinRuleComesBack) {
+  auto engine = makeEngine();
+  std::atomic<int> calls{0};
+  engine->addRule(countingRule("temperature_high_alert", 9, calls));
+
+  auto override = definition("temperature_high_alert", "temperature > 35", 9);
+  EXPECT_EQ(engine->applyRuleDefinitions({override}), 1u);
+  EXPECT_EQ(engine->getRule("temperature_high_alert")->description,
+            "temperature > 35");
+
+  // Выключенное определение возвращает встроенное правило
+  override.enabled = false;
+  EXPECT_EQ(engine->applyRuleDefinitions({override}), 0u);
+  auto builtin = engine->getRule("temperature_high_alert");
+  ASSERT_TRUE(builtin);
+  EXPECT_EQ(builtin->description, "");
+  EXPECT_TRUE(builtin->enabled);
+
+  override.enabled = true;
+  EXPECT_EQ(engine->applyRuleDefinitions({override}), 1u);
+  EXPECT_EQ(engine->getRule("temperature_high_alert")->description,
+            "temperature > 35");
+
+  // Удаленное определение - тоже
+  EXPECT_EQ(engine->applyRuleDefinitions({}), 0u);
+  EXPECT_EQ(engine->getRuleNames(),
+            std::vector<std::string>{"temperature_high_alert"});
+  EXPECT_EQ(engine->getRule("temperature_high_alert")->description, "");
+}
+
+TEST(RuleEngineTest, HoldSuffixRequiresConditionForDuration) {
+  auto engine = makeEngine();
+  engine->applyRuleDefinitions(
+      {definition("humid", "humidity > 60 for 10m", 1)});
+  auto rule = engine->getRule("humid");
+  ASSERT_TRUE(rule);
+
+  auto at = [](int minute, double humidity) {
+    auto data = reading(20.0);
+    data.humidity = humidity;
+    data.timestampUs = kReadingUs + minute * kMinuteUs;
+    return data;
+  };
+  EXPECT_FALSE(rule->condition(at(0, 70.0)));
+  EXPECT_FALSE(rule->condition(at(9, 70.0)));
+  EXPECT_TRUE(rule->condition(at(10, 70.0)));
+  // Перерыв сбрасывает отсчет
+  EXPECT_FALSE(rule->condition(at(11, 50.0)));
+  EXPECT_FALSE(rule->condition(at(15, 70.0)));
+}
+
+TEST(RuleEngineTest, WindowStateIsKeptPerDevice) {
+  auto engine = makeEngine();
+  engine->applyRuleDefinitions(
+      {definition("wet", "count(humidity > 80, 2) == 2", 1)});
+  auto rule = engine->getRule("wet");
+  ASSERT_TRUE(rule);
+
+  auto from = [](const char* device, double humidity) {
+    auto data = reading(20.0);
+    data.deviceId = device;
+    data.humidity = humidity;
+    return data;
+  };
+  EXPECT_FALSE(rule->condition(from("a", 90.0)));
+  // Показание другого устройства не попадает в окно "a"
+  EXPECT_FALSE(rule->condition(from("b", 90.0)));
+  EXPECT_TRUE(rule->condition(from("a", 85.0)));
+  EXPECT_FALSE(rule->condition(from("b", 50.0)));
+}
+
+TEST(RuleEngineTest, WindowsAndHoldSurviveSnapshot) {
+  std::vector<models::RuleDefinition> definitions = {
+      definition("humid", "humidity > 60 for 10m", 2),
+      definition("wet", "count(humidity > 80, 2) == 2", 1),
+  };
+  auto at = [](int minute, double humidity) {
+    auto data = reading(20.0);
+    data.humidity = humidity;
+    data.timestampUs = kReadingUs + minute * kMinuteUs;
+    return data;
+  };
+
+  auto source = makeEngine();
+  source->applyRuleDefinitions(definitions);
+  EXPECT_FALSE(source->getRule("humid")->condition(at(0, 90.0)));
+  EXPECT_FALSE(source->getRule("wet")->condition(at(0, 90.0)));
+
+  auto path = (std::filesystem::temp_directory_path() /
+               ("rule_state_" + std::to_string(::getpid()) + ".snap"))
+                  .string();
+  storage::SnapshotWriter writer;
+  source->saveState(writer);
+  ASSERT_TRUE(writer.writeTo(path, kReadingUs));
+  auto snapshot = storage::SnapshotReader::open(path);
+  std::filesystem::remove(path);
+  ASSERT_NE(snapshot, nullptr);
+
+  // "for" продолжает отсчет с минуты 0, окно помнит первое показание
+  auto restored = makeEngine();
+  restored->applyRuleDefinitions(definitions);
+  ASSERT_TRUE(restored->restoreState(*snapshot));
+  EXPECT_TRUE(restored->getRule("humid")->condition(at(10, 90.0)));
+  EXPECT_TRUE(restored->getRule("wet")->condition(at(10, 90.0)));
+
+  // Измененное выражение начинает окна заново
+  auto changed = makeEngine();
+  changed->applyRuleDefinitions(
+      {definition("wet", "count(humidity > 70, 2) == 2", 1)});
+  ASSERT_TRUE(changed->restoreState(*snapshot));
+  EXPECT_FALSE(changed->getRule("wet")->condition(at(10, 90.0)));
+}
+
+TEST(RuleEngineTest, AnomalyEstimatesSurviveSnapshot) {
+  engine::AnomalyDetector::Options options;
+  options.warmupSamples = 30;
+  auto source = makeEngine();
+  source->enableAnomalyDetection(options);
+  auto rule = source->getRule("anomaly_detection");
+  ASSERT_TRUE(rule);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_FALSE(rule->condition(reading((i % 2) != 0 ? 20.5 : 19.5)));
+  }
+
+  auto path = (std::filesystem::temp_directory_path() /
+               ("anomaly_state_" + std::to_string(::getpid()) + ".snap"))
+                  .string();
+  storage::SnapshotWriter writer;
+  source->saveState(writer);
+  ASSERT_TRUE(writer.writeTo(path, kReadingUs));
+  auto snapshot = storage::SnapshotReader::open(path);
+  std::filesystem::remove(path);
+  ASSERT_NE(snapshot, nullptr);
+
+  // Без снимка детектор снова учился бы warmupSamples показаний
+  auto restored = makeEngine();
+  restored->enableAnomalyDetection(options);
+  ASSERT_TRUE(restored->restoreState(*snapshot));
+  EXPECT_TRUE(restored->getRule("anomaly_detection")->condition(reading(35.0)));
+  EXPECT_EQ(restored->getAnomalyStatistics().devices, 1u);
+}
+
+TEST(RuleEngineTest, ScopedRulesOnlySeeTheirDevices) {
+  auto engine = makeEngine();
+  std::atomic<int> globalCalls{0};
+  std::atomic<int> deviceCalls{0};
+  std::atomic<int> groupCalls{0};
+
+  engine->addRule(countingRule("global", 1, globalCalls));
+  auto own = countingRule("kitchen_only", 5, deviceCalls);
+  own.scope.deviceId = "kitchen";
+  engine->addRule(own);
+  auto grouped = countingRule("office_group", 3, groupCalls);
+  grouped.scope.groupId = 7;
+  engine->addRule(grouped);
+
+  auto from = [](const char* device) {
+    auto data = reading(25.0);
+    data.deviceId = device;
+    return data;
+  };
+
+  engine->processData(from("kitchen"));
+  engine->processData(from("office"));
+  EXPECT_EQ(globalCalls, 2);
+  EXPECT_EQ(deviceCalls, 1);
+  // Группа еще не загружена: правило ни к кому не применяется
+  EXPECT_EQ(groupCalls, 0);
+
+  models::DeviceGroup office;
+  office.id = 7;
+  office.deviceIds = {"office", "hall"};
+  engine->setDeviceGroups({office});
+  engine->processData(from("office"));
+  engine->processData(from("hall"));
+  engine->processData(from("kitchen"));
+  EXPECT_EQ(groupCalls, 2);
+  EXPECT_EQ(deviceCalls, 2);
+  EXPECT_EQ(globalCalls, 5);
+}
+
+TEST(RuleEngineTest, RoutedRulesKeepPriorityOrder) {
+  auto engine = makeEngine();
+  std::vector<std::string> order;
+  auto recording = [&order](const std::string& name, int priority,
+                            const std::string& device) {
+    Rule rule(
+        name, "", [](const models::IoTData&) { return true; },
+        [&order, name](const models::IoTData&) { order.push_back(name); },
+        priority);
+    rule.scope.deviceId = device;
+    return rule;
+  };
+  engine->addRule(recording("low", 1, ""));
+  engine->addRule(recording("mid_device", 5, "a"));
+  engine->addRule(recording("high", 9, ""));
+  engine->addRule(recording("other_device", 7, "b"));
+
+  engine->processData(reading(25.0));
+  auto data = reading(25.0);
+  data.deviceId = "a";
+  engine->processData(data);
+  EXPECT_EQ(order, (std::vector<std::string>{"high", "low", "high",
+                                             "mid_device", "low"}));
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "../../src/engine/BatchKernels.h"
+#include "../../src/engine/RuleProgram.h"
+
+using iot_core::engine::RuleProgram;
+using iot_core::models::IoTData;
+
+namespace {
+
+IoTData reading(double temperature, double humidity) {
+  IoTData data;
+  data.deviceId = "sensor";
+  data.temperature = temperature;
+  data.humidity = humidity;
+  return data;
+}
+
+}  // namespace
+
+TEST(RuleProgramTest, EvaluatesComparisonsAndLogic) {
+  auto program = RuleProgram::compile("temperature > 28 && humidity > 60");
+  EXPECT_TRUE(program.evaluate(reading(30.0, 70.0)));
+  EXPECT_FALSE(program.evaluate(reading(30.0, 50.0)));
+  EXPECT_FALSE(program.evaluate(reading(28.0, 70.0)));
+
+  auto either = RuleProgram::compile(
+      "temperature < 15 or not (humidity >= 30 and humidity <= 70)");
+  EXPECT_TRUE(either.evaluate(reading(10.0, 50.0)));
+  EXPECT_TRUE(either.evaluate(reading(20.0, 80.0)));
+  EXPECT_FALSE(either.evaluate(reading(20.0, 50.0)));
+
+  auto arithmetic =
+      RuleProgram::compile("(temperature - humidity / 10) * 2 != -4");
+  EXPECT_TRUE(arithmetic.evaluate(reading(20.0, 50.0)));
+  EXPECT_FALSE(arithmetic.evaluate(reading(3.0, 50.0)));
+}
+
+TEST(RuleProgramTest, FusesFieldComparisonsAndParsesHoldSuffix) {
+  auto program = RuleProgram::compile("temperature>28&&humidity>60 for 5m");
+  // Два сравнения с константой и And
+  ASSERT_EQ(program.code().size(), 3u);
+  EXPECT_EQ(program.code()[0].op, RuleProgram::Op::GtField);
+  EXPECT_EQ(program.code()[1].field, RuleProgram::Field::Humidity);
+  EXPECT_EQ(program.holdFor(), std::chrono::minutes(5));
+
+  EXPECT_EQ(RuleProgram::compile("humidity < 30").holdFor().count(), 0);
+}
+
+TEST(RuleProgramTest, RejectsMalformedExpressions) {
+  EXPECT_THROW(RuleProgram::compile(""), std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("pressure > 3"), std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("temperature >"), std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("(temperature > 3"),
+               std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("temperature > 3 for 5"),
+               std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("temperature > 3 humidity"),
+               std::invalid_argument);
+
+  // Глубина стека ограничена: длинная цепочка слева вычисляется на
+  // двух ячейках, вложенность справа занимает ячейку на уровень
+  std::string deep = "temperature";
+  for (int i = 0; i < 20; ++i) {
+    deep = "(" + deep + " + 1)";
+  }
+  EXPECT_NO_THROW(RuleProgram::compile(deep));
+  deep = "temperature";
+  for (int i = 0; i < 20; ++i) {
+    deep = "1 + (" + deep + ")";
+  }
+  EXPECT_THROW(RuleProgram::compile(deep), std::invalid_argument);
+}
+
+TEST(RuleProgramTest, EvaluatesWindowFunctions) {
+  auto program = RuleProgram::compile("count(humidity > 80, 3) == 3");
+  ASSERT_EQ(program.windows().size(), 1u);
+  EXPECT_EQ(program.windows()[0].samples, 3u);
+
+  auto windows = program.makeWindows();
+  EXPECT_FALSE(program.evaluate(reading(20.0, 85.0), 0, windows.data()));
+  EXPECT_FALSE(program.evaluate(reading(20.0, 90.0), 1, windows.data()));
+  EXPECT_TRUE(program.evaluate(reading(20.0, 81.0), 2, windows.data()));
+  EXPECT_FALSE(program.evaluate(reading(20.0, 70.0), 3, windows.data()));
+
+  // Рост на 5 градусов за 10 минут
+  auto rise = RuleProgram::compile("delta(temperature, 10m) >= 5");
+  EXPECT_EQ(rise.windows()[0].spanUs, 600LL * 1000000);
+  windows = rise.makeWindows();
+  const int64_t minute = 60LL * 1000000;
+  EXPECT_FALSE(rise.evaluate(reading(20.0, 50.0), 0, windows.data()));
+  EXPECT_FALSE(rise.evaluate(reading(23.0, 50.0), 5 * minute, windows.data()));
+  EXPECT_TRUE(rise.evaluate(reading(25.5, 50.0), 9 * minute, windows.data()));
+  // Начальное значение ушло из окна
+  EXPECT_FALSE(
+      rise.evaluate(reading(26.0, 50.0), 12 * minute, windows.data()));
+
+  auto average = RuleProgram::compile(
+      "avg(temperature, 2) > 30 and max(humidity, 2) - min(humidity, 2) > 10");
+  EXPECT_EQ(average.windows().size(), 3u);
+  windows = average.makeWindows();
+  EXPECT_FALSE(average.evaluate(reading(35.0, 40.0), 0, windows.data()));
+  EXPECT_TRUE(average.evaluate(reading(27.0, 55.0), 1, windows.data()));
+}
+
+TEST(RuleProgramTest, RejectsMalformedWindows) {
+  EXPECT_THROW(RuleProgram::compile("avg(temperature) > 3"),
+               std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("avg(temperature, 0) > 3"),
+               std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("avg(temperature, 2.5) > 3"),
+               std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("avg temperature > 3"),
+               std::invalid_argument);
+  EXPECT_THROW(RuleProgram::compile("avg(temperature, 5m > 3"),
+               std::invalid_argument);
+}
+
+TEST(RuleProgramTest, ColumnMasksMatchRowEvaluation) {
+  auto program = RuleProgram::compile(
+      "temperature >= 28 and not humidity < 40 or humidity > 90");
+  ASSERT_TRUE(program.columnar());
+  EXPECT_FALSE(RuleProgram::compile("temperature + 1 > 28").columnar());
+  EXPECT_FALSE(RuleProgram::compile("avg(temperature, 3) > 28").columnar());
+
+  std::mt19937 random(11);
+  std::uniform_real_distribution<double> values(0.0, 100.0);
+  double temperature[iot_core::engine::kBatchBlock];
+  double humidity[iot_core::engine::kBatchBlock];
+  const double* const columns[] = {temperature, humidity};
+
+  // Неполные блоки проверяют хвост после векторной части
+  for (size_t count : {size_t{1}, size_t{7}, size_t{63}, size_t{64}}) {
+    for (size_t i = 0; i < count; ++i) {
+      temperature[i] = values(random) / 2;
+      humidity[i] = values(random);
+    }
+    humidity[0] = std::nan("");
+
+    uint64_t mask = program.evaluateColumns(columns, count);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(((mask >> i) & 1) != 0,
+                program.evaluate(reading(temperature[i], humidity[i])))
+          << iot_core::engine::batchKernelName() << " lane " << i;
+    }
+    if (count < 64) {
+      EXPECT_EQ(mask >> count, 0u);
+    }
+  }
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <random>
+
+#include "../../src/engine/SlidingWindow.h"
+
+using iot_core::engine::SlidingWindow;
+
+namespace {
+
+constexpr int64_t kSecondUs = 1000000;
+
+}  // namespace
+
+TEST(SlidingWindowTest, CountWindowKeepsLastSamples) {
+  SlidingWindow window(3, 0);
+  for (double value : {5.0, 1.0, 4.0, 2.0}) {
+    window.add(0, value);
+  }
+  // В окне 1, 4, 2
+  EXPECT_EQ(window.size(), 3u);
+  EXPECT_DOUBLE_EQ(window.sum(), 7.0);
+  EXPECT_DOUBLE_EQ(window.min(), 1.0);
+  EXPECT_DOUBLE_EQ(window.max(), 4.0);
+  EXPECT_DOUBLE_EQ(window.oldest(), 1.0);
+  EXPECT_DOUBLE_EQ(window.latest(), 2.0);
+
+  window.add(0, 3.0);
+  // Минимум ушел из окна: 4, 2, 3
+  EXPECT_DOUBLE_EQ(window.min(), 2.0);
+  EXPECT_DOUBLE_EQ(window.mean(), 3.0);
+}
+
+TEST(SlidingWindowTest, TimeWindowEvictsOldSamples) {
+  SlidingWindow window(0, 60 * kSecondUs);
+  window.add(0, 10.0);
+  window.add(30 * kSecondUs, 20.0);
+  window.add(60 * kSecondUs, 30.0);
+  // Граница включительно
+  EXPECT_EQ(window.size(), 3u);
+
+  window.add(61 * kSecondUs, 5.0);
+  EXPECT_EQ(window.size(), 3u);
+  EXPECT_DOUBLE_EQ(window.oldest(), 20.0);
+  EXPECT_DOUBLE_EQ(window.min(), 5.0);
+  EXPECT_DOUBLE_EQ(window.max(), 30.0);
+
+  window.add(200 * kSecondUs, 7.0);
+  EXPECT_EQ(window.size(), 1u);
+  EXPECT_DOUBLE_EQ(window.max(), 7.0);
+  EXPECT_DOUBLE_EQ(window.mean(), 7.0);
+}
+
+TEST(SlidingWindowTest, MatchesNaiveAggregates) {
+  std::mt19937 random(7);
+  std::uniform_real_distribution<double> values(-50.0, 50.0);
+  SlidingWindow window(17, 0);
+  std::deque<double> naive;
+
+  for (int i = 0; i < 5000; ++i) {
+    double value = values(random);
+    window.add(i, value);
+    naive.push_back(value);
+    if (naive.size() > 17) {
+      naive.pop_front();
+    }
+    ASSERT_DOUBLE_EQ(window.min(),
+                     *std::min_element(naive.begin(), naive.end()));
+    ASSERT_DOUBLE_EQ(window.max(),
+                     *std::max_element(naive.begin(), naive.end()));
+    ASSERT_NEAR(window.sum(), std::accumulate(naive.begin(), naive.end(), 0.0),
+                1e-9);
+  }
+}
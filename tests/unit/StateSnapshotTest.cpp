@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../../src/storage/StateSnapshot.h"
+
+using namespace iot_core::storage;
+
+namespace {
+
+constexpr uint32_t kFirst = snapshotTag('T', 'S', 'T', '1');
+constexpr uint32_t kSecond = snapshotTag('T', 'S', 'T', '2');
+
+}  // namespace
+
+class StateSnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path = (std::filesystem::temp_directory_path() /
+            ("snapshot_test_" + std::to_string(::getpid())) / "state.snap")
+               .string();
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+  }
+
+  std::string path;
+};
+
+TEST_F(StateSnapshotTest, RoundTripsSections) {
+  SnapshotWriter writer;
+  auto& first = writer.section(kFirst);
+  first.putU32(2);
+  first.putString("1_sensor_1_temp_high");
+  first.putI64(-42);
+  first.putDouble(21.5);
+  writer.section(kSecond).putU64(7);
+  ASSERT_TRUE(writer.writeTo(path, 123456));
+
+  auto reader = SnapshotReader::open(path);
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(reader->createdAtUs(), 123456);
+  EXPECT_TRUE(reader->has(kFirst));
+  EXPECT_FALSE(reader->has(snapshotTag('N', 'O', 'N', 'E')));
+
+  auto section = reader->section(kFirst);
+  EXPECT_EQ(section.getU32(), 2u);
+  EXPECT_EQ(section.getString(), "1_sensor_1_temp_high");
+  EXPECT_EQ(section.getI64(), -42);
+  EXPECT_DOUBLE_EQ(section.getDouble(), 21.5);
+  EXPECT_TRUE(section.atEnd());
+  EXPECT_THROW(section.getU8(), std::out_of_range);
+
+  EXPECT_EQ(reader->section(kSecond).getU64(), 7u);
+}
+
+TEST_F(StateSnapshotTest, RejectsCorruptedFile) {
+  SnapshotWriter writer;
+  writer.section(kFirst).putString("payload");
+  ASSERT_TRUE(writer.writeTo(path, 1));
+
+  // Портим последний байт данных секции
+  auto size = std::filesystem::file_size(path);
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(size - 1));
+    file.put('X');
+  }
+  EXPECT_EQ(SnapshotReader::open(path), nullptr);
+
+  // Обрезанный файл и отсутствующий файл
+  std::filesystem::resize_file(path, 10);
+  EXPECT_EQ(SnapshotReader::open(path), nullptr);
+  EXPECT_EQ(SnapshotReader::open(path + ".missing"), nullptr);
+}
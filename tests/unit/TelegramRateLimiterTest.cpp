@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "../../src/core/TelegramRateLimiter.h"
+
+using namespace iot_core::core;
+using namespace std::chrono_literals;
+
+TEST(TelegramRateLimiterTest, SpacesMessagesByGlobalRate) {
+  TelegramRateLimiter::Options options;
+  options.messagesPerSecond = 10.0;
+  TelegramRateLimiter limiter(options);
+
+  auto now = TelegramRateLimiter::Clock::now();
+  // Разные чаты: ограничивает только общий лимит бота
+  for (long chat = 1; chat <= 5; ++chat) {
+    auto slot = limiter.reserve(chat, now);
+    EXPECT_EQ(slot - now, (chat - 1) * 100ms);
+  }
+}
+
+TEST(TelegramRateLimiterTest, AppliesPerChatAndGroupIntervals) {
+  TelegramRateLimiter::Options options;
+  options.messagesPerSecond = 1000.0;
+  TelegramRateLimiter limiter(options);
+
+  auto now = TelegramRateLimiter::Clock::now();
+  EXPECT_EQ(limiter.reserve(42, now), now);
+  EXPECT_EQ(limiter.reserve(42, now) - now, 1000ms);
+  EXPECT_EQ(limiter.reserve(42, now) - now, 2000ms);
+
+  auto group = limiter.reserve(-100, now);
+  EXPECT_LT(group - now, 10ms);
+  EXPECT_EQ(limiter.reserve(-100, now) - group, 3000ms);
+}
+
+TEST(TelegramRateLimiterTest, PauseDelaysEveryChat) {
+  TelegramRateLimiter limiter(TelegramRateLimiter::Options{});
+
+  auto now = TelegramRateLimiter::Clock::now();
+  limiter.pauseUntil(now + 5s);
+  EXPECT_GE(limiter.reserve(1, now) - now, 5s);
+  EXPECT_GE(limiter.reserve(2, now) - now, 5s);
+}
+
+TEST(TelegramRateLimiterTest, DeferredChatsStillTakeGlobalSlots) {
+  TelegramRateLimiter::Options options;
+  options.messagesPerSecond = 10.0;
+  TelegramRateLimiter limiter(options);
+
+  auto now = TelegramRateLimiter::Clock::now();
+  std::vector<TelegramRateLimiter::Clock::time_point> slots;
+  // Пять чатов упираются в лимит своего чата, следом пишут другие
+  for (int round = 0; round < 3; ++round) {
+    for (long chat = 1; chat <= 5; ++chat) {
+      slots.push_back(limiter.reserve(chat, now));
+    }
+  }
+  for (long chat = 6; chat <= 40; ++chat) {
+    slots.push_back(limiter.reserve(chat, now));
+  }
+
+  // Не больше одного сообщения на слот общего лимита
+  std::sort(slots.begin(), slots.end());
+  for (size_t i = 1; i < slots.size(); ++i) {
+    EXPECT_GE(slots[i] - slots[i - 1], 100ms) << "slot " << i;
+  }
+  // Частые чаты не задерживают остальных дольше общего лимита
+  EXPECT_LE(slots.back() - now, 4900ms);
+}
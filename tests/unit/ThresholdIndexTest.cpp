@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "../../src/services/ThresholdIndex.h"
+
+using namespace iot_core::services;
+using iot_core::models::UserAlert;
+
+namespace {
+
+UserAlert temperatureAlert(double high, double low) {
+  UserAlert alert;
+  alert.temperatureHighThreshold = high;
+  alert.temperatureLowThreshold = low;
+  return alert;
+}
+
+std::vector<long> triggered(const ThresholdIndex::DeviceThresholds& index,
+                            AlertKind kind, double value) {
+  std::vector<long> users;
+  index.forEachTriggered(kind, value,
+                         [&](long userId, double) { users.push_back(userId); });
+  std::sort(users.begin(), users.end());
+  return users;
+}
+
+}  // namespace
+
+TEST(ThresholdIndexTest, FindsExactlyTriggeredSubscribers) {
+  int loads = 0;
+  ThresholdIndex index([&](const std::string&, auto& subscribers) {
+    ++loads;
+    // Пользователь i: выше 20+i, ниже 10-i (кроме 9 - без нижнего)
+    for (long i = 0; i < 10; ++i) {
+      subscribers.emplace_back(i, temperatureAlert(20.0 + i, 10.0 - i));
+    }
+    subscribers.emplace_back(100, UserAlert());
+    return true;
+  });
+
+  auto device = index.get("sensor");
+  ASSERT_TRUE(device);
+  EXPECT_EQ(device->subscribers(), 11u);
+
+  EXPECT_EQ(triggered(*device, AlertKind::TemperatureHigh, 22.5),
+            (std::vector<long>{0, 1, 2}));
+  // Ровно на пороге правило не срабатывает
+  EXPECT_EQ(triggered(*device, AlertKind::TemperatureHigh, 20.0),
+            std::vector<long>{});
+  EXPECT_EQ(triggered(*device, AlertKind::TemperatureLow, 7.5),
+            (std::vector<long>{0, 1, 2}));
+  EXPECT_TRUE(triggered(*device, AlertKind::HumidityHigh, 99.0).empty());
+
+  // Повторное обращение берет кэшированный снимок
+  index.get("sensor");
+  EXPECT_EQ(loads, 1);
+}
+
+TEST(ThresholdIndexTest, AlertChangeUpdatesLoadedDevicesInPlace) {
+  int loads = 0;
+  ThresholdIndex index([&](const std::string&, auto& subscribers) {
+    ++loads;
+    subscribers.emplace_back(1, temperatureAlert(30.0, 0.0));
+    subscribers.emplace_back(2, temperatureAlert(25.0, 0.0));
+    return true;
+  });
+
+  auto before = index.get("sensor");
+  index.onAlertChanged(1, temperatureAlert(20.0, 5.0));
+  auto after = index.get("sensor");
+
+  // Старый снимок не меняется под читателем
+  EXPECT_EQ(triggered(*before, AlertKind::TemperatureHigh, 22.0),
+            std::vector<long>{});
+  EXPECT_EQ(triggered(*after, AlertKind::TemperatureHigh, 22.0),
+            std::vector<long>{1});
+  EXPECT_EQ(triggered(*after, AlertKind::TemperatureLow, 4.0),
+            std::vector<long>{1});
+  EXPECT_DOUBLE_EQ(after->threshold(1, AlertKind::TemperatureLow), 5.0);
+
+  // Сброс порогов убирает пользователя из всех массивов
+  index.onAlertChanged(2, UserAlert());
+  EXPECT_EQ(triggered(*index.get("sensor"), AlertKind::TemperatureHigh, 40.0),
+            std::vector<long>{1});
+  EXPECT_EQ(loads, 1);
+  EXPECT_EQ(index.getStatistics().updates, 2u);
+}
+
+TEST(ThresholdIndexTest, SubscriptionChangeReloadsAndFailedLoadIsNotCached) {
+  bool fail = true;
+  int loads = 0;
+  ThresholdIndex index([&](const std::string&, auto& subscribers) {
+    ++loads;
+    if (fail) {
+      return false;
+    }
+    subscribers.emplace_back(1, temperatureAlert(30.0, 0.0));
+    return true;
+  });
+
+  EXPECT_FALSE(index.get("sensor"));
+  fail = false;
+  ASSERT_TRUE(index.get("sensor"));
+  index.get("sensor");
+  EXPECT_EQ(loads, 2);
+
+  index.onSubscriptionChanged(1, "sensor");
+  index.get("sensor");
+  EXPECT_EQ(loads, 3);
+}
+
+TEST(ThresholdIndexTest, ExpiredSnapshotPicksUpRemoteChanges) {
+  double high = 30.0;
+  bool fail = false;
+  int loads = 0;
+  ThresholdIndex index([&](const std::string&, auto& subscribers) {
+    ++loads;
+    if (fail) {
+      return false;
+    }
+    subscribers.emplace_back(1, temperatureAlert(high, 0.0));
+    return true;
+  });
+  index.setMaxAge(std::chrono::seconds(30));
+
+  auto start = ThresholdIndex::Clock::now();
+  auto loaded = index.get("sensor", start);
+  EXPECT_EQ(loaded->threshold(1, AlertKind::TemperatureHigh), 30.0);
+
+  // Порог изменил другой узел: до истечения срока виден старый
+  high = 25.0;
+  auto fresh = index.get("sensor", start + std::chrono::seconds(10));
+  EXPECT_EQ(fresh->threshold(1, AlertKind::TemperatureHigh), 30.0);
+  EXPECT_EQ(loads, 1);
+
+  auto refreshed = index.get("sensor", start + std::chrono::seconds(30));
+  EXPECT_EQ(refreshed->threshold(1, AlertKind::TemperatureHigh), 25.0);
+  EXPECT_EQ(loads, 2);
+  EXPECT_EQ(index.getStatistics().refreshes, 1u);
+
+  // Неудачная перезагрузка оставляет прежний снимок до следующего срока
+  fail = true;
+  auto kept = index.get("sensor", start + std::chrono::seconds(60));
+  ASSERT_TRUE(kept);
+  EXPECT_EQ(kept->threshold(1, AlertKind::TemperatureHigh), 25.0);
+  index.get("sensor", start + std::chrono::seconds(70));
+  EXPECT_EQ(loads, 3);
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../../src/storage/GorillaCodec.h"
+#include "../../src/storage/TimeSeriesStore.h"
+
+using namespace iot_core::storage;
+
+namespace {
+
+std::vector<DataPoint> makeSeries(size_t count, int64_t startUs) {
+  std::vector<DataPoint> points;
+  for (size_t i = 0; i < count; ++i) {
+    DataPoint p;
+    // 10 секунд с небольшим дрожанием
+    p.timestampUs = startUs + static_cast<int64_t>(i) * 10'000'000 +
+                    static_cast<int64_t>(i % 7) * 1'000;
+    p.temperature = 22.0 + std::round(std::sin(i * 0.1) * 30.0) / 10.0;
+    p.humidity = 50.0 + static_cast<double>(i % 5);
+    points.push_back(p);
+  }
+  return points;
+}
+
+}  // namespace
+
+class TimeSeriesStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory = (std::filesystem::temp_directory_path() /
+                 ("tsdb_test_" + std::to_string(::getpid())))
+                    .string();
+    std::filesystem::remove_all(directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory); }
+
+  TimeSeriesStore::Options options() const {
+    TimeSeriesStore::Options opts;
+    opts.directory = directory;
+    opts.segmentMaxPoints = 100;
+    opts.compactionMinPoints = 1000;
+    opts.compactionTargetPoints = 10000;
+    return opts;
+  }
+
+  std::string directory;
+};
+
+TEST(GorillaCodecTest, RoundTripPreservesValues) {
+  auto points = makeSeries(1000, 1'700'000'000'000'000);
+  points[500].timestampUs -= 3'000'000;  // точка не по порядку
+  points[600].temperature = -12.75;
+
+  SeriesEncoder encoder;
+  for (const auto& p : points) encoder.append(p);
+
+  std::vector<DataPoint> decoded;
+  encoder.decode(INT64_MIN, INT64_MAX, decoded);
+
+  ASSERT_EQ(decoded.size(), points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(decoded[i].timestampUs, points[i].timestampUs);
+    EXPECT_EQ(decoded[i].temperature, points[i].temperature);
+    EXPECT_EQ(decoded[i].humidity, points[i].humidity);
+  }
+
+  // Регулярный ряд должен сжиматься в разы относительно 24 байт на точку
+  EXPECT_LT(encoder.encodedBytes(), points.size() * 24 / 3);
+}
+
+TEST_F(TimeSeriesStoreTest, QueryReturnsNewestFirstWithLimit) {
+  TimeSeriesStore store(options());
+  ASSERT_TRUE(store.open());
+
+  auto points = makeSeries(250, 1'000'000);
+  for (const auto& p : points) store.append("sensor_1", p);
+  store.flush();
+
+  auto result = store.query("sensor_1", INT64_MIN, INT64_MAX, 10);
+  ASSERT_EQ(result.size(), 10u);
+  EXPECT_EQ(result.front().timestampUs, points.back().timestampUs);
+  EXPECT_GT(result[0].timestampUs, result[9].timestampUs);
+
+  // Диапазон внутри первого сегмента: остальные отсекаются по метаданным
+  auto range = store.query("sensor_1", points[10].timestampUs,
+                           points[20].timestampUs);
+  EXPECT_EQ(range.size(), 11u);
+  EXPECT_GT(store.getStatistics().segmentsSkipped, 0u);
+}
+
+TEST_F(TimeSeriesStoreTest, QueryWithLimitSeesOverlappingSegments) {
+  TimeSeriesStore store(options());
+  ASSERT_TRUE(store.open());
+
+  // Первый сегмент начинается раньше всех, но последнее показание в нем
+  // пришло не по порядку и новее всех остальных сегментов
+  auto wide = makeSeries(100, 0);
+  wide.back().timestampUs = 5'000'000'000;
+  auto old = makeSeries(100, 1'000'000);
+  auto recent = makeSeries(100, 2'000'000'000);
+  for (const auto* series : {&wide, &old, &recent}) {
+    for (const auto& p : *series) store.append("sensor_4", p);
+  }
+  store.flush();
+
+  auto result = store.query("sensor_4", INT64_MIN, INT64_MAX, 50);
+  ASSERT_EQ(result.size(), 50u);
+  EXPECT_EQ(result.front().timestampUs, wide.back().timestampUs);
+  EXPECT_EQ(result[1].timestampUs, recent.back().timestampUs);
+}
+
+TEST_F(TimeSeriesStoreTest, ReopenRestoresSealedSegments) {
+  auto points = makeSeries(230, 5'000'000);
+  {
+    TimeSeriesStore store(options());
+    ASSERT_TRUE(store.open());
+    for (const auto& p : points) store.append("sensor_2", p);
+    store.close();
+  }
+
+  TimeSeriesStore reopened(options());
+  ASSERT_TRUE(reopened.open());
+  EXPECT_EQ(reopened.pointCount("sensor_2"), points.size());
+
+  auto all = reopened.query("sensor_2", INT64_MIN, INT64_MAX);
+  ASSERT_EQ(all.size(), points.size());
+  EXPECT_EQ(all.back().timestampUs, points.front().timestampUs);
+}
+
+TEST_F(TimeSeriesStoreTest, CompactionMergesSmallSegments) {
+  TimeSeriesStore store(options());
+  ASSERT_TRUE(store.open());
+
+  auto points = makeSeries(450, 9'000'000);
+  for (const auto& p : points) store.append("sensor_3", p);
+  store.flush();
+  ASSERT_EQ(store.getStatistics().segments, 5u);
+
+  store.compact();
+
+  auto stats = store.getStatistics();
+  EXPECT_EQ(stats.segments, 1u);
+  EXPECT_EQ(stats.sealedPoints, points.size());
+  EXPECT_EQ(store.query("sensor_3", INT64_MIN, INT64_MAX).size(),
+            points.size());
+}
+
+TEST_F(TimeSeriesStoreTest, CorruptManifestIsRebuiltFromSegments) {
+  auto points = makeSeries(300, 1'000);
+  {
+    TimeSeriesStore store(options());
+    ASSERT_TRUE(store.open());
+    for (const auto& p : points) store.append("sensor_4", p);
+    store.flush();
+    store.compact();
+    store.close();
+  }
+
+  {
+    std::ofstream manifest(directory + "/MANIFEST", std::ios::trunc);
+    manifest << "garbage";
+  }
+
+  TimeSeriesStore reopened(options());
+  ASSERT_TRUE(reopened.open());
+  EXPECT_EQ(reopened.pointCount("sensor_4"), points.size());
+}